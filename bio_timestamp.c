@@ -22,12 +22,22 @@ static inline int env_is_enabled(const char *value) {
     return (*endptr == 0 && val == 1);
 }
 
+// kTLS ctrls OpenSSL sends to its socket BIOs (include/internal/bio.h, not public)
+#define BIO_TS_CTRL_SET_KTLS                  72
+#define BIO_TS_CTRL_SET_KTLS_TX_SEND_CTRL_MSG 74
+#define BIO_TS_CTRL_CLEAR_KTLS_TX_CTRL_MSG    75
+
+#define BIO_TS_RECORD_HEADER 5   // Rebuilt in front of kTLS RX records for OpenSSL
+#define BIO_TS_RECORD_TAG    16  // Kept free at the end, as OpenSSL's ktls_read_record() does
+
 // Internal structure to store BIO state
 typedef struct {
     int fd;                        // Socket file descriptor
     bio_timestamp_t *ts_storage;   // Pointer to shared timestamp storage
     int ktls_tx_enabled;           // kTLS TX enabled flag
     int ktls_rx_enabled;           // kTLS RX enabled flag
+    int ulp_set;                   // TCP_ULP "tls" installed
+    uint8_t tx_ctrl_type;          // Record type of the next write (0 = application data)
 } bio_ts_data_t;
 
 // Forward declarations
@@ -36,7 +46,6 @@ static int bio_ts_write(BIO *bio, const char *buf, int len);
 static long bio_ts_ctrl(BIO *bio, int cmd, long num, void *ptr);
 static int bio_ts_create(BIO *bio);
 static int bio_ts_destroy(BIO *bio);
-static void bio_ts_check_ktls(bio_ts_data_t *data);
 
 // BIO method structure (OpenSSL 1.1.0+ API)
 #if OPENSSL_VERSION_NUMBER >= 0x10100000L
@@ -70,22 +79,18 @@ static BIO_METHOD bio_ts_method_v1 = {
 };
 #endif
 
-// Custom BIO read function with hardware timestamp capture
-static int bio_ts_read(BIO *bio, char *buf, int len) {
-    if (buf == NULL || len <= 0) return 0;
-
-    // Get internal data
-    bio_ts_data_t *data = (bio_ts_data_t *)BIO_get_data(bio);
-    if (data == NULL || data->fd < 0) {
-        return -1;
-    }
+// Nanoseconds of a timespec (saturates in year 2262+)
+static inline uint64_t bio_ts_timespec_ns(const struct timespec *t) {
+    if ((uint64_t)t->tv_sec > (UINT64_MAX / 1000000000ULL)) return UINT64_MAX;
+    return (uint64_t)t->tv_sec * 1000000000ULL + t->tv_nsec;
+}
 
-    // Setup for recvmsg with timestamping
+ssize_t bio_ts_recvmsg(int fd, void *buf, size_t len, bio_timestamp_t *ts, uint8_t *record_type) {
     struct iovec iov;
     iov.iov_base = buf;
     iov.iov_len = len;
 
-    char control[512];  // Buffer for control messages
+    char control[512];  // Buffer for control messages (timestamps + kTLS record type)
     struct msghdr msg;
     memset(&msg, 0, sizeof(msg));
     msg.msg_iov = &iov;
@@ -93,10 +98,67 @@ static int bio_ts_read(BIO *bio, char *buf, int len) {
     msg.msg_control = control;
     msg.msg_controllen = sizeof(control);
 
-    // Perform recvmsg to capture timestamp
     // Note: Don't use MSG_DONTWAIT - respect the socket's blocking mode
     // The socket is blocking during handshake and non-blocking during data transfer
-    ssize_t bytes_read = recvmsg(data->fd, &msg, 0);
+    ssize_t bytes_read = recvmsg(fd, &msg, 0);
+    if (record_type) *record_type = BIO_TS_RECORD_APPDATA;
+    if (bytes_read <= 0) return bytes_read;
+
+    struct cmsghdr *cmsg;
+    for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_TLS && cmsg->cmsg_type == TLS_GET_RECORD_TYPE) {
+            // kTLS RX: one record type per read (the kernel stops at a type change)
+            if (record_type) *record_type = *(uint8_t *)CMSG_DATA(cmsg);
+        } else if (ts != NULL && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMPING) {
+            struct timespec *t = (struct timespec *)CMSG_DATA(cmsg);
+
+            // Validate control message has space for timestamp array
+            size_t cmsg_data_len = cmsg->cmsg_len - CMSG_LEN(0);
+            size_t num_timestamps = cmsg_data_len / sizeof(struct timespec);
+
+            // t[0] = software timestamp
+            // t[1] = (deprecated)
+            // t[2] = hardware timestamp (if available)
+
+            // Prefer hardware timestamp (t[2])
+            if (num_timestamps >= 3 && (t[2].tv_sec != 0 || t[2].tv_nsec != 0)) {
+                ts->hw_timestamp_ns = bio_ts_timespec_ns(&t[2]);
+                ts->hw_available = 1;
+            } else if (num_timestamps >= 1 && (t[0].tv_sec != 0 || t[0].tv_nsec != 0)) {
+                // Fallback to software timestamp
+                ts->hw_timestamp_ns = bio_ts_timespec_ns(&t[0]);
+                ts->hw_available = 0;
+            }
+        }
+    }
+    return bytes_read;
+}
+
+// Custom BIO read function with hardware timestamp capture
+static int bio_ts_read(BIO *bio, char *buf, int len) {
+    if (buf == NULL || len <= 0) return 0;
+
+    // Get internal data
+    bio_ts_data_t *data = (bio_ts_data_t *)BIO_get_data(bio);
+    if (data == NULL || data->fd < 0) {
+        return -1;
+    }
+
+    // kTLS RX: the kernel decrypts and strips the record header; rebuild the header the way
+    // OpenSSL's socket BIO does, so its record layer still sees whole records
+    size_t skip = 0;
+    size_t room = (size_t)len;
+    if (data->ktls_rx_enabled) {
+        if (room < BIO_TS_RECORD_HEADER + BIO_TS_RECORD_TAG) {
+            errno = EINVAL;
+            return -1;
+        }
+        skip = BIO_TS_RECORD_HEADER;
+        room -= BIO_TS_RECORD_HEADER + BIO_TS_RECORD_TAG;
+    }
+
+    uint8_t record_type;
+    ssize_t bytes_read = bio_ts_recvmsg(data->fd, buf + skip, room, data->ts_storage, &record_type);
 
     if (bytes_read < 0) {
         // Handle errors
@@ -111,41 +173,14 @@ static int bio_ts_read(BIO *bio, char *buf, int len) {
         return 0;  // Connection closed
     }
 
-    // Parse control messages for hardware timestamp
-    if (data->ts_storage != NULL) {
-        struct cmsghdr *cmsg;
-        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
-            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMPING) {
-                struct timespec *ts = (struct timespec *)CMSG_DATA(cmsg);
-
-                // Validate control message has space for timestamp array
-                size_t cmsg_data_len = cmsg->cmsg_len - CMSG_LEN(0);
-                size_t num_timestamps = cmsg_data_len / sizeof(struct timespec);
-
-                // ts[0] = software timestamp
-                // ts[1] = (deprecated)
-                // ts[2] = hardware timestamp (if available)
-
-                // Prefer hardware timestamp (ts[2])
-                if (num_timestamps >= 3 && (ts[2].tv_sec != 0 || ts[2].tv_nsec != 0)) {
-                    // Check for overflow (year 2262+)
-                    if ((uint64_t)ts[2].tv_sec > (UINT64_MAX / 1000000000ULL)) {
-                        data->ts_storage->hw_timestamp_ns = UINT64_MAX;  // Saturate
-                    } else {
-                        data->ts_storage->hw_timestamp_ns = (uint64_t)ts[2].tv_sec * 1000000000ULL + ts[2].tv_nsec;
-                    }
-                    data->ts_storage->hw_available = 1;
-                } else if (num_timestamps >= 1 && (ts[0].tv_sec != 0 || ts[0].tv_nsec != 0)) {
-                    // Fallback to software timestamp
-                    if ((uint64_t)ts[0].tv_sec > (UINT64_MAX / 1000000000ULL)) {
-                        data->ts_storage->hw_timestamp_ns = UINT64_MAX;  // Saturate
-                    } else {
-                        data->ts_storage->hw_timestamp_ns = (uint64_t)ts[0].tv_sec * 1000000000ULL + ts[0].tv_nsec;
-                    }
-                    data->ts_storage->hw_available = 0;
-                }
-            }
-        }
+    if (skip) {
+        uint8_t *p = (uint8_t *)buf;
+        p[0] = record_type;
+        p[1] = 3;  // TLS 1.2 legacy version, as OpenSSL rebuilds it
+        p[2] = 3;
+        p[3] = (uint8_t)(bytes_read >> 8);
+        p[4] = (uint8_t)bytes_read;
+        bytes_read += BIO_TS_RECORD_HEADER;
     }
 
     return (int)bytes_read;
@@ -160,7 +195,32 @@ static int bio_ts_write(BIO *bio, const char *buf, int len) {
         return -1;
     }
 
-    ssize_t bytes_written = write(data->fd, buf, len);
+    ssize_t bytes_written;
+    if (__builtin_expect(data->tx_ctrl_type != 0, 0)) {
+        // kTLS TX, non-data record (alert, handshake): its type travels in a cmsg
+        char control[CMSG_SPACE(sizeof(uint8_t))];
+        struct iovec iov = { .iov_base = (void *)buf, .iov_len = (size_t)len };
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_TLS;
+        cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(uint8_t));
+        *(uint8_t *)CMSG_DATA(cmsg) = data->tx_ctrl_type;
+
+        bytes_written = sendmsg(data->fd, &msg, MSG_NOSIGNAL);
+        if (bytes_written >= 0) {
+            // The kernel takes the whole record or nothing
+            data->tx_ctrl_type = 0;
+            bytes_written = len;
+        }
+    } else {
+        bytes_written = write(data->fd, buf, len);
+    }
 
     if (bytes_written < 0) {
         if (errno == EAGAIN || errno == EWOULDBLOCK) {
@@ -173,56 +233,63 @@ static int bio_ts_write(BIO *bio, const char *buf, int len) {
     return (int)bytes_written;
 }
 
-// Check if kTLS is enabled on the socket
-static void bio_ts_check_ktls(bio_ts_data_t *data) {
-    if (data == NULL || data->fd < 0) return;
-
-    // Reset flags before checking
-    data->ktls_tx_enabled = 0;
-    data->ktls_rx_enabled = 0;
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+// Size of the kernel crypto_info for a cipher, 0 if the kernel headers lack it
+static size_t bio_ts_crypto_info_len(uint16_t cipher_type) {
+    switch (cipher_type) {
+#ifdef TLS_CIPHER_AES_GCM_128
+        case TLS_CIPHER_AES_GCM_128: return sizeof(struct tls12_crypto_info_aes_gcm_128);
+#endif
+#ifdef TLS_CIPHER_AES_GCM_256
+        case TLS_CIPHER_AES_GCM_256: return sizeof(struct tls12_crypto_info_aes_gcm_256);
+#endif
+#ifdef TLS_CIPHER_AES_CCM_128
+        case TLS_CIPHER_AES_CCM_128: return sizeof(struct tls12_crypto_info_aes_ccm_128);
+#endif
+#ifdef TLS_CIPHER_CHACHA20_POLY1305
+        case TLS_CIPHER_CHACHA20_POLY1305: return sizeof(struct tls12_crypto_info_chacha20_poly1305);
+#endif
+        default: return 0;
+    }
+}
 
-    // Check if TCP ULP (Upper Layer Protocol) is set to "tls"
-    // This indicates kTLS is enabled
-    char ulp_name[16] = {0};
-    socklen_t optlen = sizeof(ulp_name);
+// Install the keys OpenSSL hands over after a handshake (its socket BIO's ktls_start())
+// OpenSSL's own length field sits behind a build-dependent union, so size by cipher here
+// Returns 1 when the direction is offloaded, 0 to stay in userspace
+static int bio_ts_start_ktls(bio_ts_data_t *data, const void *crypto_info, int is_tx) {
+    const char *debug = getenv("WS_DEBUG_KTLS");
+    const struct tls_crypto_info *info = (const struct tls_crypto_info *)crypto_info;
+    size_t info_len = info ? bio_ts_crypto_info_len(info->cipher_type) : 0;
+    if (info_len == 0) return 0;
+
+    if (!data->ulp_set) {
+        if (setsockopt(data->fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) != 0 && errno != EEXIST) {
+            if (env_is_enabled(debug)) {
+                fprintf(stderr, "[BIO kTLS Debug] TCP_ULP tls failed: %s\n", strerror(errno));
+            }
+            return 0;
+        }
+        data->ulp_set = 1;
+    }
 
-    // Try to get the ULP name - if it returns "tls", kTLS is enabled
-    if (getsockopt(data->fd, SOL_TCP, TCP_ULP, ulp_name, &optlen) == 0) {
-        const char *debug = getenv("WS_DEBUG_KTLS");
+    if (setsockopt(data->fd, SOL_TLS, is_tx ? TLS_TX : TLS_RX, crypto_info, info_len) != 0) {
         if (env_is_enabled(debug)) {
-            fprintf(stderr, "[BIO kTLS Debug] ULP name: '%s'\n", ulp_name);
+            fprintf(stderr, "[BIO kTLS Debug] %s setup failed: %s\n", is_tx ? "TX" : "RX", strerror(errno));
         }
+        return 0;
+    }
 
-        if (strcmp(ulp_name, "tls") == 0) {
-            // kTLS is enabled - check both TX and RX
-            // If we can read the TLS_TX/RX crypto info, it's enabled
-            struct tls12_crypto_info_aes_gcm_128 crypto_info;
-            socklen_t crypto_len = sizeof(crypto_info);
-
-            // Check TX
-            if (getsockopt(data->fd, SOL_TLS, TLS_TX, &crypto_info, &crypto_len) == 0) {
-                data->ktls_tx_enabled = 1;
-                if (env_is_enabled(debug)) {
-                    fprintf(stderr, "[BIO kTLS Debug] TX enabled\n");
-                }
-            }
-
-            // Check RX
-            crypto_len = sizeof(crypto_info);
-            if (getsockopt(data->fd, SOL_TLS, TLS_RX, &crypto_info, &crypto_len) == 0) {
-                data->ktls_rx_enabled = 1;
-                if (env_is_enabled(debug)) {
-                    fprintf(stderr, "[BIO kTLS Debug] RX enabled\n");
-                }
-            }
-        }
+    if (is_tx) {
+        data->ktls_tx_enabled = 1;
     } else {
-        const char *debug = getenv("WS_DEBUG_KTLS");
-        if (env_is_enabled(debug)) {
-            fprintf(stderr, "[BIO kTLS Debug] getsockopt TCP_ULP failed: %s\n", strerror(errno));
-        }
+        data->ktls_rx_enabled = 1;
     }
+    if (env_is_enabled(debug)) {
+        fprintf(stderr, "[BIO kTLS Debug] %s enabled\n", is_tx ? "TX" : "RX");
+    }
+    return 1;
 }
+#endif
 
 // BIO control function
 static long bio_ts_ctrl(BIO *bio, int cmd, long num, void *ptr) {
@@ -269,23 +336,25 @@ static long bio_ts_ctrl(BIO *bio, int cmd, long num, void *ptr) {
             }
             break;
 #if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        case BIO_TS_CTRL_SET_KTLS:
+            // num: 1 = TX, 0 = RX; ptr: the kernel crypto_info
+            ret = data != NULL ? bio_ts_start_ktls(data, ptr, (int)num) : 0;
+            break;
         case BIO_CTRL_GET_KTLS_SEND:
-            // Check kTLS status and return current state
-            if (data != NULL) {
-                bio_ts_check_ktls(data);
-                ret = data->ktls_tx_enabled;
-            } else {
-                ret = 0;
-            }
+            // Only this BIO installs keys, so its flags are the socket's state (no syscall
+            // per record, OpenSSL asks on every read and write)
+            ret = data != NULL ? data->ktls_tx_enabled : 0;
             break;
         case BIO_CTRL_GET_KTLS_RECV:
-            // Check kTLS status and return current state
-            if (data != NULL) {
-                bio_ts_check_ktls(data);
-                ret = data->ktls_rx_enabled;
-            } else {
-                ret = 0;
-            }
+            ret = data != NULL ? data->ktls_rx_enabled : 0;
+            break;
+        case BIO_TS_CTRL_SET_KTLS_TX_SEND_CTRL_MSG:
+            if (data != NULL) data->tx_ctrl_type = (uint8_t)num;
+            ret = 0;
+            break;
+        case BIO_TS_CTRL_CLEAR_KTLS_TX_CTRL_MSG:
+            if (data != NULL) data->tx_ctrl_type = 0;
+            ret = 0;
             break;
 #endif
         default:
@@ -347,8 +416,10 @@ BIO* BIO_new_timestamp_socket(int fd, bio_timestamp_t *ts_storage) {
 
     data->fd = fd;
     data->ts_storage = ts_storage;
-    data->ktls_tx_enabled = 0;  // Will be set by bio_ts_check_ktls()
-    data->ktls_rx_enabled = 0;  // Will be set by bio_ts_check_ktls()
+    data->ktls_tx_enabled = 0;  // Set when OpenSSL hands over the keys (BIO_TS_CTRL_SET_KTLS)
+    data->ktls_rx_enabled = 0;
+    data->ulp_set = 0;
+    data->tx_ctrl_type = 0;
 
     BIO_set_data(bio, data);
     BIO_set_init(bio, 1);
@@ -2,6 +2,7 @@
 #define BIO_TIMESTAMP_H
 
 #include <stdint.h>
+#include <sys/types.h>
 #include <openssl/bio.h>
 
 // Shared structure to store hardware timestamp from BIO layer
@@ -13,7 +14,16 @@ typedef struct {
 #ifdef __linux__
 // Create a custom BIO for a socket with hardware timestamping support
 // Returns BIO* on success, NULL on failure
+// kTLS: OpenSSL hands the session keys to the BIO, which installs them on the socket;
+// reads then stay on recvmsg() so timestamps survive the kernel taking over the records
 BIO* BIO_new_timestamp_socket(int fd, bio_timestamp_t *ts_storage);
+
+#define BIO_TS_RECORD_APPDATA 23  // TLS application_data record type
+
+// recvmsg() that parses SO_TIMESTAMPING into ts (when not NULL) and reports the kTLS
+// record type of the bytes read (BIO_TS_RECORD_APPDATA without kTLS RX)
+// Returns recvmsg()'s result
+ssize_t bio_ts_recvmsg(int fd, void *buf, size_t len, bio_timestamp_t *ts, uint8_t *record_type);
 #endif
 
 #endif // BIO_TIMESTAMP_H
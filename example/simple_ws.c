@@ -6,13 +6,6 @@
 #include <signal.h>
 #include <unistd.h>
 
-// WebSocket frame opcodes (from RFC 6455)
-#define WS_OPCODE_TEXT   0x1
-#define WS_OPCODE_BINARY 0x2
-#define WS_OPCODE_CLOSE  0x8
-#define WS_OPCODE_PING   0x9
-#define WS_OPCODE_PONG   0xA
-
 static int running = 1;
 static int connected = 0;
 static int message_count = 0;
@@ -21,15 +14,15 @@ static int message_count = 0;
 void on_message(websocket_context_t *ws, const uint8_t *payload_ptr, size_t payload_len, uint8_t opcode) {
     (void)ws;
 
-    if (opcode == WS_OPCODE_TEXT) {
+    if (opcode == WS_FRAME_TEXT) {
         printf("\n📩 Received text message (%zu bytes):\n%.*s\n",
                payload_len, (int)payload_len, payload_ptr);
-    } else if (opcode == WS_OPCODE_BINARY) {
+    } else if (opcode == WS_FRAME_BINARY) {
         printf("\n📩 Received binary message: %zu bytes\n", payload_len);
         // Process binary data directly from payload_ptr - no copying!
-    } else if (opcode == WS_OPCODE_PING) {
+    } else if (opcode == WS_FRAME_PING) {
         printf("🏓 Received PING\n");
-    } else if (opcode == WS_OPCODE_PONG) {
+    } else if (opcode == WS_FRAME_PONG) {
         printf("🏓 Received PONG\n");
     }
 
@@ -151,7 +144,7 @@ int main(int argc, char *argv[]) {
         // Register file descriptor with notifier
         int fd = ws_get_fd(ws);
         if (fd >= 0) {
-            if (ws_notifier_add(notifier, fd, WS_EVENT_READ) < 0) {
+            if (ws_notifier_add(notifier, fd, WS_EVENT_READ, ws) < 0) {
                 fprintf(stderr, "❌ Failed to register fd with notifier\n");
                 running = 0;
             }
@@ -174,10 +167,13 @@ int main(int argc, char *argv[]) {
 
         printf("\n⏳ Waiting for echo responses...\n");
 
-        // Main event loop
+        // Main event loop - batched wait returns only the contexts that are ready
+        ws_notifier_event_t events[16];
         while (running) {
-            ws_notifier_wait(notifier);
-            ws_update(ws);
+            int n = ws_notifier_wait_events(notifier, events, 16);
+            for (int i = 0; i < n; i++) {
+                ws_update((websocket_context_t *)events[i].user_data);
+            }
 
             if (!running) break;
         }
@@ -12,6 +12,7 @@
 #ifdef __linux__
 #include <sched.h>
 #include <sys/types.h>
+#include <sys/syscall.h>
 #elif defined(__APPLE__)
 #include <mach/thread_policy.h>
 #include <mach/thread_act.h>
@@ -22,6 +23,7 @@
 // Platform-specific includes for timing
 #if defined(__i386__) || defined(__x86_64__)
 #include <x86intrin.h>
+#include <cpuid.h>
 #endif
 
 // CPU Affinity and Real-Time Priority Implementation
@@ -116,6 +118,14 @@ int os_get_thread_realtime_priority(void) {
     return param.sched_priority;
 }
 
+int os_get_numa_node(void) {
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) {
+        return -1;
+    }
+    return (int)node;
+}
+
 #elif defined(__APPLE__)
 // macOS implementation using thread affinity tags and pthread scheduling
 
@@ -196,6 +206,10 @@ int os_get_thread_realtime_priority(void) {
     return param.sched_priority;
 }
 
+int os_get_numa_node(void) {
+    return -1;  // No NUMA API (Apple Silicon and Intel Macs are single node)
+}
+
 #else
 // Fallback implementation for unsupported platforms
 
@@ -219,6 +233,10 @@ int os_get_thread_realtime_priority(void) {
     return -1;
 }
 
+int os_get_numa_node(void) {
+    return -1;
+}
+
 #endif
 
 // Time-constraint policy (macOS only)
@@ -376,6 +394,17 @@ int os_verify_env(int verbose) {
         printf("      Check: CPU isolation, RT scheduling, IRQ affinity\n\n");
     }
 
+    // Cycle stamps are only comparable across frequency changes with an invariant TSC
+    if (!os_tsc_invariant()) {
+        warnings++;
+        if (verbose) {
+            printf("[WARN] TSC is not invariant (no nonstop_tsc)\n");
+            printf("       Cycle timestamps drift with CPU frequency scaling\n\n");
+        }
+    } else if (verbose) {
+        printf("[OK] Invariant TSC\n\n");
+    }
+
 #else
     if (verbose) {
         printf("Platform: Unknown\n");
@@ -423,13 +452,42 @@ static inline uint64_t rdtsc(void) {
 }
 #endif
 
-// Prewarmed calibration data to eliminate initialization checks in hot path
-#if defined(__APPLE__) && defined(__aarch64__)
-static mach_timebase_info_data_t g_timebase = {0, 0};
-#elif defined(__i386__) || defined(__x86_64__)
-static double g_ns_per_cycle = 0.0;
+// Clocksource-style conversion: ns = (cycles * mult) >> OS_CLOCK_SHIFT, one 64x64->128
+// multiply with no overflow range; the FP rate estimate is only used while calibrating
+#define OS_CLOCK_SHIFT 32
+#define OS_CLOCK_SYNC_INTERVAL_NS 1000000000ULL  // Default re-anchor period (os_cycles_to_realtime_ns)
+#define OS_CLOCK_MIN_REFINE_NS 100000000ULL      // Rate refinement needs >= 100 ms between anchors
+#define OS_CLOCK_MAX_SLEW_PPM 500.0              // Larger rate changes are REALTIME steps, not drift
+#define OS_CLOCK_SAMPLE_TRIES 5
+
+// Seqlock-published calibration: readers retry while seq is odd
+typedef struct {
+    uint32_t seq;
+    uint64_t mult;                // ns per cycle << OS_CLOCK_SHIFT
+    uint64_t inv_mult;            // cycles per ns << OS_CLOCK_SHIFT
+    uint64_t anchor_cycles;       // (anchor_cycles, anchor_realtime_ns) sampled together
+    uint64_t anchor_realtime_ns;
+    uint64_t sync_interval_cycles;  // 0 = re-anchor only on os_clock_sync()
+    uint64_t syncs;
+    uint64_t steps;
+} os_clock_t;
+
+static os_clock_t g_clock;
+static pthread_once_t g_clock_once = PTHREAD_ONCE_INIT;
+static int g_clock_sync_busy = 0;
+
+static inline uint64_t mul_shift(uint64_t v, uint64_t mult) {
+#ifdef __SIZEOF_INT128__
+    return (uint64_t)(((unsigned __int128)v * mult) >> OS_CLOCK_SHIFT);
+#else
+    // 32-bit halves: partial products cannot wrap unless the result itself does
+    uint64_t vh = v >> 32, vl = v & 0xFFFFFFFFULL;
+    uint64_t mh = mult >> 32, ml = mult & 0xFFFFFFFFULL;
+    return ((vh * mh) << 32) + vh * ml + vl * mh + ((vl * ml) >> 32);
 #endif
+}
 
+#if defined(__i386__) || defined(__x86_64__)
 // Comparison function for qsort (used for median calculation)
 static int compare_double(const void *a, const void *b) {
     double diff = *(const double*)a - *(const double*)b;
@@ -437,11 +495,52 @@ static int compare_double(const void *a, const void *b) {
     if (diff > 0) return 1;
     return 0;
 }
+#endif
+
+static uint64_t realtime_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// (cycles, CLOCK_REALTIME) pair: the tightest of a few bracketed reads, cycles at the midpoint
+static void clock_sample(uint64_t *cycles, uint64_t *real_ns) {
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < OS_CLOCK_SAMPLE_TRIES; i++) {
+        uint64_t before = rdtsc();
+        uint64_t real = realtime_ns();
+        uint64_t after = rdtsc();
+        if (after - before < best) {
+            best = after - before;
+            *cycles = before + (after - before) / 2;
+            *real_ns = real;
+        }
+    }
+}
+
+// Publish new calibration (single writer: init or the os_clock_sync() holder)
+// sync: 0 = initial anchor, 1 = periodic sync, 2 = sync that found REALTIME stepped
+static void clock_publish(uint64_t mult, uint64_t cycles, uint64_t real_ns, int sync) {
+    uint32_t seq = __atomic_load_n(&g_clock.seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_clock.seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&g_clock.inv_mult, (uint64_t)((double)(1ULL << OS_CLOCK_SHIFT) *
+                                                   (double)(1ULL << OS_CLOCK_SHIFT) / (double)mult), __ATOMIC_RELAXED);
+    __atomic_store_n(&g_clock.anchor_cycles, cycles, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_clock.anchor_realtime_ns, real_ns, __ATOMIC_RELAXED);
+    if (sync) __atomic_store_n(&g_clock.syncs, g_clock.syncs + 1, __ATOMIC_RELAXED);
+    if (sync == 2) __atomic_store_n(&g_clock.steps, g_clock.steps + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_clock.mult, mult, __ATOMIC_RELEASE);  // Non-zero mult = initialized
+    __atomic_store_n(&g_clock.seq, seq + 2, __ATOMIC_RELEASE);
+}
 
-// Initialize timer conversion - called lazily on first os_cycles_to_ns() call
+// Initialize timer conversion - once, on the first os_get_cpu_cycle() or conversion
 static void init_timer_conversion(void) {
+    double ns_per_cycle;
 #if defined(__APPLE__) && defined(__aarch64__)
-    mach_timebase_info(&g_timebase);
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+    ns_per_cycle = (double)timebase.numer / (double)timebase.denom;
 #elif defined(__i386__) || defined(__x86_64__)
     // Calibrate TSC frequency against CLOCK_MONOTONIC
     // Take 3 measurements and use median for robustness against interrupts
@@ -470,71 +569,143 @@ static void init_timer_conversion(void) {
 
     // Use median to filter out outliers
     qsort(samples, 3, sizeof(double), compare_double);
-    g_ns_per_cycle = samples[1];  // Middle value
+    ns_per_cycle = samples[1];  // Middle value
+#elif defined(__aarch64__)
+    // Generic timer: the counter frequency is architectural
+    uint64_t freq;
+    __asm__ volatile("mrs %0, cntfrq_el0" : "=r" (freq));
+    ns_per_cycle = freq ? 1e9 / (double)freq : 1.0;
+#else
+    ns_per_cycle = 1.0;  // Cycles are already nanoseconds from clock_gettime
 #endif
+
+    uint64_t mult = (uint64_t)(ns_per_cycle * (double)(1ULL << OS_CLOCK_SHIFT) + 0.5);
+    if (mult == 0) mult = 1;
+    __atomic_store_n(&g_clock.sync_interval_cycles,
+                     (uint64_t)((double)OS_CLOCK_SYNC_INTERVAL_NS / ns_per_cycle), __ATOMIC_RELAXED);
+
+    uint64_t cycles = 0, real = 0;
+    clock_sample(&cycles, &real);
+    clock_publish(mult, cycles, real, 0);
+}
+
+static inline void clock_ensure(void) {
+    if (__builtin_expect(__atomic_load_n(&g_clock.mult, __ATOMIC_ACQUIRE) == 0, 0)) {
+        pthread_once(&g_clock_once, init_timer_conversion);
+    }
 }
 
 // Public API: Get current CPU cycle count
 uint64_t os_get_cpu_cycle(void) {
-    // Initialize timer conversion on first call (moved here from os_cycles_to_ns)
-    static int timer_initialized = 0;
-    if (__builtin_expect(!timer_initialized, 0)) {
-        init_timer_conversion();
-        timer_initialized = 1;
-    }
+    clock_ensure();
     return rdtsc();
 }
 
-// Public API: Convert CPU cycles to nanoseconds (branch-free, integer-only hot path)
-// Note: Calls init if needed (rare on first call only)
+uint64_t os_cycles_to_ns_u64(uint64_t cycles) {
+    clock_ensure();
+    return mul_shift(cycles, __atomic_load_n(&g_clock.mult, __ATOMIC_RELAXED));
+}
+
+// Public API: Convert CPU cycles to nanoseconds (integer mult/shift, returned as double)
 double os_cycles_to_ns(uint64_t cycles) {
-#if defined(__APPLE__) && defined(__aarch64__)
-    // Ensure initialization (only happens once, on first call if not already done)
-    if (__builtin_expect(g_timebase.denom == 0, 0)) {
-        init_timer_conversion();
-    }
-
-    // macOS ARM - mach_absolute_time to nanoseconds using integer math
-    // Common case: numer=125, denom=3 (M1/M2/M3/M4)
-    // cycles * 125 / 3 = (cycles * 42667) >> 10 (error < 0.01%)
-    if (g_timebase.numer == 125 && g_timebase.denom == 3) {
-        // Check for potential overflow in fast path
-        if (cycles > (UINT64_MAX / 42667ULL)) {
-            // Use floating-point to avoid overflow (for processes running >49 hours)
-            return (double)cycles * (double)g_timebase.numer / (double)g_timebase.denom;
+    return (double)os_cycles_to_ns_u64(cycles);
+}
+
+uint64_t os_ns_to_cycles(uint64_t ns) {
+    clock_ensure();
+    return mul_shift(ns, __atomic_load_n(&g_clock.inv_mult, __ATOMIC_RELAXED));
+}
+
+int os_tsc_invariant(void) {
+#if defined(__i386__) || defined(__x86_64__)
+    // CPUID.80000007H:EDX[8]: constant rate in all P/C-states (Linux "nonstop_tsc")
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) return 0;
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx >> 8) & 1;
+#else
+    return 1;  // Generic timer, mach_absolute_time or clock_gettime: fixed rate by design
+#endif
+}
+
+int os_clock_sync(void) {
+    clock_ensure();
+    if (__atomic_exchange_n(&g_clock_sync_busy, 1, __ATOMIC_ACQUIRE)) return 0;  // Another thread is at it
+
+    uint64_t cycles = 0, real = 0;
+    clock_sample(&cycles, &real);
+
+    uint64_t mult = __atomic_load_n(&g_clock.mult, __ATOMIC_RELAXED);
+    uint64_t prev_cycles = __atomic_load_n(&g_clock.anchor_cycles, __ATOMIC_RELAXED);
+    uint64_t prev_real = __atomic_load_n(&g_clock.anchor_realtime_ns, __ATOMIC_RELAXED);
+    int sync = 1;
+    if (cycles > prev_cycles) {
+        // Refine the rate against REALTIME elapsed since the last anchor (PTP-disciplined when
+        // phc2sys runs); a jump beyond any plausible drift is a clock step: re-anchor only
+        uint64_t predicted = mul_shift(cycles - prev_cycles, mult);
+        if (predicted >= OS_CLOCK_MIN_REFINE_NS) {
+            double ratio = ((double)real - (double)prev_real) / (double)predicted;
+            double ppm = (ratio - 1.0) * 1e6;
+            if (ppm <= OS_CLOCK_MAX_SLEW_PPM && ppm >= -OS_CLOCK_MAX_SLEW_PPM) {
+                mult = (uint64_t)((double)mult * ratio + 0.5);
+            } else {
+                sync = 2;
+            }
         }
-        // Fast path: fixed-point multiplication (5-10x faster than FP)
-        return (double)((cycles * 42667ULL) >> 10);
-    }
-    // Generic fallback: check for overflow before multiplication
-    if (cycles > (UINT64_MAX / (uint64_t)g_timebase.numer)) {
-        // Use floating-point to avoid overflow (for processes running >49 hours)
-        return (double)cycles * (double)g_timebase.numer / (double)g_timebase.denom;
-    }
-    // Fast path: integer multiplication (faster than FP)
-    return (double)(cycles * g_timebase.numer / g_timebase.denom);
-#elif defined(__i386__) || defined(__x86_64__)
-    // Ensure initialization (only happens once, on first call if not already done)
-    if (__builtin_expect(g_ns_per_cycle == 0.0, 0)) {
-        init_timer_conversion();
     }
+    clock_publish(mult, cycles, real, sync);
 
-    // x86/x64 - TSC cycles to nanoseconds
-    // Use fixed-point for common frequencies (2.0-4.0 GHz range)
-    // Pre-compute: g_ns_per_cycle_fp = (uint64_t)(g_ns_per_cycle * (1ULL << 32))
-    static uint64_t g_ns_per_cycle_fp = 0;
-    if (__builtin_expect(g_ns_per_cycle_fp == 0, 0)) {
-        g_ns_per_cycle_fp = (uint64_t)(g_ns_per_cycle * 4294967296.0);
-    }
+    __atomic_store_n(&g_clock_sync_busy, 0, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void os_clock_set_sync_interval(uint64_t interval_ns) {
+    clock_ensure();
+    __atomic_store_n(&g_clock.sync_interval_cycles, interval_ns ? os_ns_to_cycles(interval_ns) : 0,
+                     __ATOMIC_RELAXED);
+}
 
-    // Check for overflow
-    if (cycles > (UINT64_MAX / g_ns_per_cycle_fp)) {
-        // Fall back to floating-point for very large values
-        return cycles * g_ns_per_cycle;
+uint64_t os_cycles_to_realtime_ns(uint64_t cycles) {
+    clock_ensure();
+    for (int resynced = 0;; resynced = 1) {
+        uint32_t seq;
+        uint64_t mult, anchor, real;
+        do {
+            seq = __atomic_load_n(&g_clock.seq, __ATOMIC_ACQUIRE);
+            mult = __atomic_load_n(&g_clock.mult, __ATOMIC_RELAXED);
+            anchor = __atomic_load_n(&g_clock.anchor_cycles, __ATOMIC_RELAXED);
+            real = __atomic_load_n(&g_clock.anchor_realtime_ns, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        } while ((seq & 1) || seq != __atomic_load_n(&g_clock.seq, __ATOMIC_RELAXED));
+
+        if (__builtin_expect(cycles >= anchor, 1)) {
+            // Stamps past the re-anchor period trigger one sync (no extra TSC read to find out)
+            uint64_t interval = __atomic_load_n(&g_clock.sync_interval_cycles, __ATOMIC_RELAXED);
+            if (__builtin_expect(interval && cycles - anchor > interval && !resynced, 0)) {
+                os_clock_sync();
+                continue;
+            }
+            return real + mul_shift(cycles - anchor, mult);
+        }
+        uint64_t back = mul_shift(anchor - cycles, mult);  // Stamp taken before the anchor
+        return back < real ? real - back : 0;
     }
-    return (double)((cycles * g_ns_per_cycle_fp) >> 32);
-#else
-    // Fallback - cycles are already in nanoseconds from clock_gettime
-    return (double)cycles;
-#endif
+}
+
+void os_clock_get_info(os_clock_info_t *out) {
+    if (!out) return;
+    clock_ensure();
+    uint32_t seq;
+    do {
+        seq = __atomic_load_n(&g_clock.seq, __ATOMIC_ACQUIRE);
+        out->mult = __atomic_load_n(&g_clock.mult, __ATOMIC_RELAXED);
+        out->anchor_cycles = __atomic_load_n(&g_clock.anchor_cycles, __ATOMIC_RELAXED);
+        out->anchor_realtime_ns = __atomic_load_n(&g_clock.anchor_realtime_ns, __ATOMIC_RELAXED);
+        out->syncs = __atomic_load_n(&g_clock.syncs, __ATOMIC_RELAXED);
+        out->steps = __atomic_load_n(&g_clock.steps, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) || seq != __atomic_load_n(&g_clock.seq, __ATOMIC_RELAXED));
+    out->shift = OS_CLOCK_SHIFT;
+    out->cycles_per_sec = (uint64_t)((double)(1ULL << OS_CLOCK_SHIFT) * 1e9 / (double)out->mult + 0.5);
+    out->tsc_invariant = os_tsc_invariant();
 }
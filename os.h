@@ -29,6 +29,10 @@ int os_get_thread_affinity(void);
 // Returns: Priority level (0 = normal, >0 = real-time), -1 on error
 int os_get_thread_realtime_priority(void);
 
+// Get NUMA node of the CPU the calling thread runs on (call after os_set_thread_affinity)
+// Returns: Node ID, -1 if unknown or not supported
+int os_get_numa_node(void);
+
 // Set time-constraint policy (macOS only)
 // This provides real-time guarantees based on time budgets
 // period: Time period in nanoseconds
@@ -59,9 +63,55 @@ uint64_t os_get_cpu_cycle(void);
 // Convert CPU cycles to nanoseconds
 // cycles: Cycle count from os_get_cpu_cycle()
 // Returns: Equivalent time in nanoseconds (double precision)
-// Note: Uses prewarmed calibration data for zero-branch hot-path performance
+// Note: Same integer conversion as os_cycles_to_ns_u64(), kept for existing callers
 double os_cycles_to_ns(uint64_t cycles);
 
+// Convert CPU cycles to nanoseconds in integer arithmetic
+// Returns: (cycles * mult) >> shift like a kernel clocksource: no FP, no overflow
+//          range (128-bit product), so any cycle count or difference converts exactly
+uint64_t os_cycles_to_ns_u64(uint64_t cycles);
+
+// Convert nanoseconds to CPU cycles (deadlines and intervals in cycle units)
+uint64_t os_ns_to_cycles(uint64_t ns);
+
+// Returns: 1 if the cycle counter ticks at a constant rate across P/C-states
+//          (x86 invariant TSC, CPUID 80000007H:EDX[8]; always 1 on other counters)
+// Note: Without it cycle stamps drift with CPU frequency scaling; os_verify_env() warns
+int os_tsc_invariant(void);
+
+// Wall-clock mapping: cycle stamps on the CLOCK_REALTIME timeline
+//
+// An anchor pairs a cycle count with CLOCK_REALTIME (tightest of a few bracketed reads).
+// os_clock_sync() takes a new anchor and refines the rate from the REALTIME time elapsed
+// since the previous one, so a REALTIME disciplined by PTP (phc2sys, scripts/setup_ptp_sync.sh)
+// pins the counter frequency too; a jump beyond plausible drift (clock step) only re-anchors.
+// As the NIC clock is synced to REALTIME, ws_get_hw_timestamp() and cycle stages mapped with
+// os_cycles_to_realtime_ns() are on one timeline and subtract directly.
+
+// Re-anchor now (thread-safe, readers never block). Returns 0
+int os_clock_sync(void);
+
+// Re-anchor automatically when os_cycles_to_realtime_ns() sees a stamp this far past the
+// anchor (default 1 s, 0 = only explicit os_clock_sync() calls)
+void os_clock_set_sync_interval(uint64_t interval_ns);
+
+// Map a cycle stamp to CLOCK_REALTIME nanoseconds since the epoch
+// Note: May take a new anchor (a few clock_gettime() calls) once per sync interval
+uint64_t os_cycles_to_realtime_ns(uint64_t cycles);
+
+typedef struct {
+    uint64_t mult;               // ns = (cycles * mult) >> shift
+    uint32_t shift;
+    uint64_t cycles_per_sec;     // Current rate estimate
+    uint64_t anchor_cycles;      // Latest anchor
+    uint64_t anchor_realtime_ns;
+    uint64_t syncs;              // os_clock_sync() runs (explicit or automatic)
+    uint64_t steps;              // Syncs that found CLOCK_REALTIME stepped
+    int tsc_invariant;
+} os_clock_info_t;
+
+void os_clock_get_info(os_clock_info_t *out);
+
 // Inline performance utilities for hot-path optimization
 //
 // These inline functions provide low-level performance hints and intrinsics
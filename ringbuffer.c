@@ -11,6 +11,18 @@
 #include <sys/shm.h>
 #endif
 
+#ifdef __linux__
+#include <sys/syscall.h>
+#include "os.h"
+// From <linux/mempolicy.h> (not always installed with the libc headers)
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE (1 << 1)
+#endif
+#endif
+
 // Platform-specific prefetch intrinsics
 #if defined(__x86_64__) || defined(__i386__)
 #include <emmintrin.h>  // SSE2 for _mm_prefetch
@@ -21,20 +33,38 @@
 #define WS_USE_HUGEPAGES 1
 #endif
 
-// Try to create virtual memory mirroring for zero-wraparound ringbuffer
-// Returns 0 on success, -1 on failure
-static int try_create_mirrored_buffer(ringbuffer_t *rb) {
-#if defined(__APPLE__) || defined(__linux__)
-    // Step 1: Reserve virtual address space (2x size)
-    void *addr = mmap(NULL, 2 * RINGBUFFER_SIZE, PROT_NONE,
-                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-    if (addr == MAP_FAILED) {
-        return -1;
-    }
+#define RINGBUFFER_HUGEPAGE_SIZE (2u * 1024u * 1024u)
 
-    // Step 2: Create shared memory
+// Shared pool: one memory object, pre-faulted once, that rings map windows of
+typedef struct {
+    size_t offset;
+    size_t len;
+} pool_slot_t;
+
+struct ringbuffer_pool {
+    int fd;
+    uint8_t *base;              // Whole region mapped once (keeps it resident)
+    size_t capacity;
+    size_t used;                // Bump allocation
+    size_t granule;             // Slot alignment: page or hugepage size
+    int hugepage;
+    pool_slot_t *free_slots;    // Slots of freed rings, reused for equal sizes
+    size_t free_count;
+    size_t free_cap;
+};
+
+static size_t round_up_pow2(size_t v) {
+    if (v <= 1) return 1;
+    return (size_t)1 << (sizeof(unsigned long long) * 8 - (size_t)__builtin_clzll((unsigned long long)(v - 1)));
+}
+
+#if defined(__APPLE__) || defined(__linux__)
+// Anonymous shared memory object of size bytes (fd closed by the caller)
+// Returns fd, -1 on failure
+static int create_shm_fd(const void *tag, size_t size, int hugepage) {
     int fd;
 #ifdef __APPLE__
+    (void)hugepage;
     // macOS: Use temporary file for shared memory
     // Use atomic counter for unique naming to avoid collisions
     static _Atomic int shm_counter = 0;
@@ -43,22 +73,27 @@ static int try_create_mirrored_buffer(ringbuffer_t *rb) {
     char shm_name[256];
     // Check snprintf return value
     int ret = snprintf(shm_name, sizeof(shm_name), "/tmp/ringbuffer_%d_%d_%lx",
-                       getpid(), counter, (unsigned long)(uintptr_t)rb);
+                       getpid(), counter, (unsigned long)(uintptr_t)tag);
     if (ret < 0 || ret >= (int)sizeof(shm_name)) {
-        munmap(addr, 2 * RINGBUFFER_SIZE);
         return -1;
     }
 
     fd = shm_open(shm_name, O_RDWR | O_CREAT | O_EXCL, 0600);
     if (fd < 0) {
-        munmap(addr, 2 * RINGBUFFER_SIZE);
         return -1;
     }
     shm_unlink(shm_name);  // Unlink immediately (file deleted when last fd closed)
 #else
     // Linux: Use memfd_create if available, otherwise shm_open
+#ifdef MFD_HUGETLB
+    fd = memfd_create("ringbuffer", hugepage ? MFD_HUGETLB : 0);
+#else
+    if (hugepage) return -1;
     fd = memfd_create("ringbuffer", 0);
+#endif
     if (fd < 0) {
+        if (hugepage) return -1;  // hugetlbfs only through memfd
+
         // Use atomic counter for unique naming
         static _Atomic int shm_counter = 0;
         int counter = __atomic_fetch_add(&shm_counter, 1, __ATOMIC_SEQ_CST);
@@ -66,64 +101,234 @@ static int try_create_mirrored_buffer(ringbuffer_t *rb) {
         char shm_name[256];
         // Check snprintf return value
         int ret = snprintf(shm_name, sizeof(shm_name), "/ringbuffer_%d_%d_%lx",
-                           getpid(), counter, (unsigned long)(uintptr_t)rb);
+                           getpid(), counter, (unsigned long)(uintptr_t)tag);
         if (ret < 0 || ret >= (int)sizeof(shm_name)) {
-            munmap(addr, 2 * RINGBUFFER_SIZE);
             return -1;
         }
 
         fd = shm_open(shm_name, O_RDWR | O_CREAT | O_EXCL, 0600);
         if (fd < 0) {
-            munmap(addr, 2 * RINGBUFFER_SIZE);
             return -1;
         }
         shm_unlink(shm_name);
     }
 #endif
 
-    // Step 3: Size the shared memory
-    if (ftruncate(fd, RINGBUFFER_SIZE) != 0) {
+    // Size the shared memory
+    if (ftruncate(fd, (off_t)size) != 0) {
         close(fd);
-        munmap(addr, 2 * RINGBUFFER_SIZE);
         return -1;
     }
+    return fd;
+}
 
-    // Step 4: Map first half
-    void *addr1 = mmap(addr, RINGBUFFER_SIZE, PROT_READ | PROT_WRITE,
-                       MAP_FIXED | MAP_SHARED, fd, 0);
+uint8_t *ringbuffer_map_mirrored(int fd, off_t offset, size_t size, int writable) {
+    // Step 1: Reserve virtual address space (2x size)
+    void *addr = mmap(NULL, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) {
+        return NULL;
+    }
+
+    int flags = MAP_FIXED | MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (offset != 0) flags |= MAP_POPULATE;  // Pool slot: pages already resident, just wire the PTEs
+#endif
+
+    // Step 2: Map first half
+    int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void *addr1 = mmap(addr, size, prot, flags, fd, offset);
     if (addr1 == MAP_FAILED || addr1 != addr) {
-        close(fd);
-        munmap(addr, 2 * RINGBUFFER_SIZE);
-        return -1;
+        munmap(addr, 2 * size);
+        return NULL;
     }
 
-    // Step 5: Map second half (same physical memory)
-    void *addr2 = mmap((uint8_t*)addr + RINGBUFFER_SIZE, RINGBUFFER_SIZE,
-                       PROT_READ | PROT_WRITE, MAP_FIXED | MAP_SHARED, fd, 0);
-    if (addr2 == MAP_FAILED || addr2 != (uint8_t*)addr + RINGBUFFER_SIZE) {
+    // Step 3: Map second half (same physical memory)
+    void *addr2 = mmap((uint8_t*)addr + size, size, prot, flags, fd, offset);
+    if (addr2 == MAP_FAILED || addr2 != (uint8_t*)addr + size) {
         // Clean up first mapping
-        munmap(addr1, RINGBUFFER_SIZE);
+        munmap(addr1, size);
         // Clean up the second half of the reserved region (still PROT_NONE)
-        munmap((uint8_t*)addr + RINGBUFFER_SIZE, RINGBUFFER_SIZE);
+        munmap((uint8_t*)addr + size, size);
         // Don't munmap addr2 - it was never successfully mapped
-        close(fd);
+        return NULL;
+    }
+
+    return (uint8_t*)addr;
+}
+#else
+uint8_t *ringbuffer_map_mirrored(int fd, off_t offset, size_t size, int writable) {
+    (void)fd; (void)offset; (void)size; (void)writable;
+    return NULL;
+}
+#endif
+
+// Try to create virtual memory mirroring for zero-wraparound ringbuffer
+// Returns 0 on success, -1 on failure
+static int try_create_mirrored_buffer(ringbuffer_t *rb, size_t size) {
+#if defined(__APPLE__) || defined(__linux__)
+    int fd = create_shm_fd(rb, size, 0);
+    if (fd < 0) {
         return -1;
     }
 
-    // Success! No longer need the fd
+    uint8_t *addr = ringbuffer_map_mirrored(fd, 0, size, 1);
+    // Success or not, no longer need the fd (mappings keep the memory alive)
     close(fd);
+    if (!addr) {
+        return -1;
+    }
 
-    rb->pulled_data = (uint8_t*)addr;
+    rb->pulled_data = addr;
     rb->is_mmap = 1;
     rb->is_mirrored = 1;
 
     return 0;
 #else
     (void)rb;
+    (void)size;
     return -1;  // Not supported on this platform
 #endif
 }
 
+ringbuffer_pool_t *ringbuffer_pool_create(size_t pool_bytes) {
+#if defined(__APPLE__) || defined(__linux__)
+    if (pool_bytes == 0) return NULL;
+
+    ringbuffer_pool_t *pool = (ringbuffer_pool_t *)calloc(1, sizeof(ringbuffer_pool_t));
+    if (!pool) return NULL;
+    pool->fd = -1;
+
+#ifdef WS_USE_HUGEPAGES
+    // Hugepages first: fewer TLB misses across every ring in the pool
+    size_t huge_cap = (pool_bytes + RINGBUFFER_HUGEPAGE_SIZE - 1) & ~(size_t)(RINGBUFFER_HUGEPAGE_SIZE - 1);
+    pool->fd = create_shm_fd(pool, huge_cap, 1);
+    if (pool->fd >= 0) {
+        // hugetlbfs reserves at mmap time: fails cleanly when not enough pages are configured
+        void *base = mmap(NULL, huge_cap, PROT_READ | PROT_WRITE, MAP_SHARED, pool->fd, 0);
+        if (base != MAP_FAILED) {
+            pool->base = (uint8_t *)base;
+            pool->capacity = huge_cap;
+            pool->granule = RINGBUFFER_HUGEPAGE_SIZE;
+            pool->hugepage = 1;
+        } else {
+            close(pool->fd);
+            pool->fd = -1;
+        }
+    }
+#endif
+
+    if (!pool->base) {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        if (page < RINGBUFFER_MIN_SIZE) page = RINGBUFFER_MIN_SIZE;
+        size_t cap = (pool_bytes + page - 1) & ~(page - 1);
+        pool->fd = create_shm_fd(pool, cap, 0);
+        if (pool->fd < 0) {
+            free(pool);
+            return NULL;
+        }
+        void *base = mmap(NULL, cap, PROT_READ | PROT_WRITE, MAP_SHARED, pool->fd, 0);
+        if (base == MAP_FAILED) {
+            close(pool->fd);
+            free(pool);
+            return NULL;
+        }
+        pool->base = (uint8_t *)base;
+        pool->capacity = cap;
+        pool->granule = page;
+    }
+
+    // Pre-fault the whole region once so no ring ever takes a major fault on the hot path
+    memset(pool->base, 0, pool->capacity);
+    return pool;
+#else
+    (void)pool_bytes;
+    return NULL;  // Needs mirrored shared memory
+#endif
+}
+
+void ringbuffer_pool_destroy(ringbuffer_pool_t *pool) {
+    if (!pool) return;
+    munmap(pool->base, pool->capacity);
+    close(pool->fd);
+    free(pool->free_slots);
+    free(pool);
+}
+
+size_t ringbuffer_pool_used(const ringbuffer_pool_t *pool) {
+    if (!pool) return 0;
+    size_t freed = 0;
+    for (size_t i = 0; i < pool->free_count; i++) freed += pool->free_slots[i].len;
+    return pool->used - freed;
+}
+
+size_t ringbuffer_pool_capacity(const ringbuffer_pool_t *pool) {
+    return pool ? pool->capacity : 0;
+}
+
+int ringbuffer_pool_is_hugepage(const ringbuffer_pool_t *pool) {
+    return pool ? pool->hugepage : 0;
+}
+
+// Carve a ring of size bytes (power of two) out of the pool
+// Returns 0 on success, -1 if the pool is exhausted
+static int pool_alloc_ring(ringbuffer_t *rb, ringbuffer_pool_t *pool, size_t size) {
+#if defined(__APPLE__) || defined(__linux__)
+    // Reuse a freed slot of the same size first
+    size_t offset = SIZE_MAX;
+    for (size_t i = 0; i < pool->free_count; i++) {
+        if (pool->free_slots[i].len == size) {
+            offset = pool->free_slots[i].offset;
+            pool->free_slots[i] = pool->free_slots[--pool->free_count];
+            break;
+        }
+    }
+    if (offset == SIZE_MAX) {
+        if (pool->capacity - pool->used < size) return -1;
+        offset = pool->used;
+        pool->used += size;
+    }
+
+    rb->pool = pool;
+    rb->pool_offset = offset;
+    uint8_t *addr = ringbuffer_map_mirrored(pool->fd, (off_t)offset, size, 1);
+    if (addr) {
+        rb->pulled_data = addr;
+        rb->is_mmap = 1;
+        rb->is_mirrored = 1;
+    } else {
+        // Mirroring failed: use the slot through the pool's own mapping
+        rb->pulled_data = pool->base + offset;
+        rb->is_mmap = 0;
+        rb->is_mirrored = 0;
+    }
+    return 0;
+#else
+    (void)rb;
+    (void)pool;
+    (void)size;
+    return -1;
+#endif
+}
+
+static void pool_free_ring(ringbuffer_t *rb) {
+    ringbuffer_pool_t *pool = rb->pool;
+    size_t size = rb->mask + 1;
+    if (rb->is_mirrored) {
+        munmap(rb->pulled_data, 2 * size);
+    }
+
+    if (pool->free_count == pool->free_cap) {
+        size_t cap = pool->free_cap ? pool->free_cap * 2 : 16;
+        pool_slot_t *slots = (pool_slot_t *)realloc(pool->free_slots, cap * sizeof(pool_slot_t));
+        if (!slots) return;  // Slot leaks until the pool is destroyed
+        pool->free_slots = slots;
+        pool->free_cap = cap;
+    }
+    pool->free_slots[pool->free_count].offset = rb->pool_offset;
+    pool->free_slots[pool->free_count].len = size;
+    pool->free_count++;
+}
+
 // Software prefetch helpers
 static inline void prefetch_read(const void *addr) {
 #if defined(__x86_64__) || defined(__i386__)
@@ -146,8 +351,17 @@ static inline void prefetch_write(void *addr) {
 }
 
 int ringbuffer_init(ringbuffer_t *rb) {
+    return ringbuffer_init_size(rb, RINGBUFFER_SIZE, NULL);
+}
+
+int ringbuffer_init_size(ringbuffer_t *rb, size_t size, ringbuffer_pool_t *pool) {
     if (!rb) return -1;
 
+    // Power of two keeps the branchless mask math
+    if (size < RINGBUFFER_MIN_SIZE) size = RINGBUFFER_MIN_SIZE;
+    if (size > RINGBUFFER_MAX_SIZE) size = RINGBUFFER_MAX_SIZE;
+    size = round_up_pow2(size);
+
     // Ensure structure itself is cache-line aligned
     if (((uintptr_t)rb) % CACHE_LINE_SIZE != 0) {
         fprintf(stderr, "Warning: ringbuffer_t not cache-line aligned\n");
@@ -157,9 +371,23 @@ int ringbuffer_init(ringbuffer_t *rb) {
     rb->read_offset = 0;
     rb->write_offset = 0;
     rb->is_mirrored = 0;
+    rb->pool = NULL;
+    rb->pool_offset = 0;
+    rb->mem_status = 0;
+
+    if (pool) {
+        // Slots are whole pool granules (hugepage pools: at least 2 MB per ring)
+        size_t slot = size < pool->granule ? pool->granule : size;
+        rb->mask = slot - 1;
+        if (pool_alloc_ring(rb, pool, slot) == 0) {
+            return 0;
+        }
+        fprintf(stderr, "Warning: ringbuffer pool exhausted, allocating standalone ring\n");
+    }
+    rb->mask = size - 1;
 
     // Try virtual memory mirroring first (best performance)
-    if (try_create_mirrored_buffer(rb) == 0) {
+    if (try_create_mirrored_buffer(rb, size) == 0) {
         // Success - mirrored buffer allocated
         return 0;
     }
@@ -169,16 +397,19 @@ int ringbuffer_init(ringbuffer_t *rb) {
 
 #ifdef WS_USE_HUGEPAGES
 #ifdef __linux__
-    // Linux: Try to use hugepages (2MB)
-    rb->pulled_data = (uint8_t *)mmap(NULL, RINGBUFFER_SIZE,
-                                      PROT_READ | PROT_WRITE,
-                                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
-                                      -1, 0);
+    // Linux: Try to use hugepages (2MB) when the ring is a whole number of them
+    rb->pulled_data = MAP_FAILED;
+    if (size % RINGBUFFER_HUGEPAGE_SIZE == 0) {
+        rb->pulled_data = (uint8_t *)mmap(NULL, size,
+                                          PROT_READ | PROT_WRITE,
+                                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                                          -1, 0);
+    }
 
     if (rb->pulled_data == MAP_FAILED) {
         // Fallback to regular pages with cache-line alignment
         fprintf(stderr, "Warning: Hugepage allocation failed, using aligned malloc\n");
-        if (posix_memalign((void**)&rb->pulled_data, CACHE_LINE_SIZE, RINGBUFFER_SIZE) != 0) {
+        if (posix_memalign((void**)&rb->pulled_data, CACHE_LINE_SIZE, size) != 0) {
             return -1;
         }
         rb->is_mmap = 0;
@@ -189,7 +420,7 @@ int ringbuffer_init(ringbuffer_t *rb) {
     // macOS: Use superpages (VM_FLAGS_SUPERPAGE_SIZE_2MB)
     // Note: macOS will automatically use superpages for large allocations
     // We use mmap with alignment hints
-    rb->pulled_data = (uint8_t *)mmap(NULL, RINGBUFFER_SIZE,
+    rb->pulled_data = (uint8_t *)mmap(NULL, size,
                                       PROT_READ | PROT_WRITE,
                                       MAP_PRIVATE | MAP_ANONYMOUS,
                                       -1, 0);
@@ -197,25 +428,25 @@ int ringbuffer_init(ringbuffer_t *rb) {
     if (rb->pulled_data != MAP_FAILED) {
         // Advise the kernel to use superpages for this region
         // MADV_WILLNEED helps with superpage allocation
-        madvise(rb->pulled_data, RINGBUFFER_SIZE, MADV_WILLNEED);
+        madvise(rb->pulled_data, size, MADV_WILLNEED);
         rb->is_mmap = 1;
     } else {
         // Fallback: aligned malloc
-        if (posix_memalign((void**)&rb->pulled_data, CACHE_LINE_SIZE, RINGBUFFER_SIZE) != 0) {
+        if (posix_memalign((void**)&rb->pulled_data, CACHE_LINE_SIZE, size) != 0) {
             return -1;
         }
         rb->is_mmap = 0;
     }
 #else
     // Other platforms: use regular mmap
-    rb->pulled_data = (uint8_t *)mmap(NULL, RINGBUFFER_SIZE,
+    rb->pulled_data = (uint8_t *)mmap(NULL, size,
                                       PROT_READ | PROT_WRITE,
                                       MAP_PRIVATE | MAP_ANONYMOUS,
                                       -1, 0);
 
     if (rb->pulled_data == MAP_FAILED) {
         // Fallback to aligned malloc
-        if (posix_memalign((void**)&rb->pulled_data, CACHE_LINE_SIZE, RINGBUFFER_SIZE) != 0) {
+        if (posix_memalign((void**)&rb->pulled_data, CACHE_LINE_SIZE, size) != 0) {
             return -1;
         }
         rb->is_mmap = 0;
@@ -225,7 +456,7 @@ int ringbuffer_init(ringbuffer_t *rb) {
 #endif
 #else
     // Hugepages disabled, use cache-line aligned allocation
-    if (posix_memalign((void**)&rb->pulled_data, CACHE_LINE_SIZE, RINGBUFFER_SIZE) != 0) {
+    if (posix_memalign((void**)&rb->pulled_data, CACHE_LINE_SIZE, size) != 0) {
         return -1;
     }
     rb->is_mmap = 0;
@@ -236,9 +467,12 @@ int ringbuffer_init(ringbuffer_t *rb) {
 
 void ringbuffer_free(ringbuffer_t *rb) {
     if (rb && rb->pulled_data) {
-        if (rb->is_mmap) {
+        if (rb->pool) {
+            pool_free_ring(rb);
+            rb->pool = NULL;
+        } else if (rb->is_mmap) {
             // Unmap mirrored buffer (2x size) or regular mmap
-            size_t unmap_size = rb->is_mirrored ? (2 * RINGBUFFER_SIZE) : RINGBUFFER_SIZE;
+            size_t unmap_size = rb->is_mirrored ? (2 * (rb->mask + 1)) : (rb->mask + 1);
             munmap(rb->pulled_data, unmap_size);
         } else {
             free(rb->pulled_data);
@@ -290,7 +524,7 @@ void ringbuffer_get_write_ptr(ringbuffer_t *rb, uint8_t **data, size_t *len) {
         *len = available;
     } else {
         // Non-mirrored: need to handle wraparound
-        size_t space_to_end = RINGBUFFER_SIZE - rb->write_offset;
+        size_t space_to_end = rb->mask + 1 - rb->write_offset;
 
         if (__builtin_expect(rb->write_offset >= rb->read_offset, 1)) {
             // Write pointer ahead, can write to end but leave 1 byte buffer
@@ -313,11 +547,9 @@ void ringbuffer_commit_write(ringbuffer_t *rb, size_t len) {
     size_t available = ringbuffer_available_write(rb);
     if (__builtin_expect(len > available, 0)) len = available;
 
-    // Ensure all data writes complete before updating offset (critical for ARM)
-    WRITE_BARRIER();
-
+    // Release: data written before this store is visible to a consumer that loads the offset
     // Optimized: bitwise AND instead of expensive modulo
-    rb->write_offset = (rb->write_offset + len) & (RINGBUFFER_SIZE - 1);
+    RB_STORE_RELEASE(&rb->write_offset, (rb->write_offset + len) & rb->mask);
 }
 
 void ringbuffer_next_read(ringbuffer_t *rb, uint8_t **data, size_t *len) {
@@ -327,9 +559,7 @@ void ringbuffer_next_read(ringbuffer_t *rb, uint8_t **data, size_t *len) {
         return;
     }
 
-    // Ensure offset read completes before accessing data (critical for ARM)
-    READ_BARRIER();
-
+    // Acquire load of write_offset inside: data up to it is visible
     size_t available = ringbuffer_available_read(rb);
 
     if (__builtin_expect(available == 0, 0)) {
@@ -351,7 +581,7 @@ void ringbuffer_next_read(ringbuffer_t *rb, uint8_t **data, size_t *len) {
             *len = rb->write_offset - rb->read_offset;
         } else {
             // Wrapped around - return first contiguous chunk
-            *len = RINGBUFFER_SIZE - rb->read_offset;
+            *len = rb->mask + 1 - rb->read_offset;
         }
 
         if (__builtin_expect(*len > available, 0)) *len = available;
@@ -365,9 +595,7 @@ void ringbuffer_peek_read(const ringbuffer_t *rb, uint8_t **data, size_t *len) {
         return;
     }
 
-    // Ensure offset read completes before accessing data (critical for ARM)
-    READ_BARRIER();
-
+    // Acquire load of write_offset inside: data up to it is visible
     size_t available = ringbuffer_available_read(rb);
 
     if (__builtin_expect(available == 0, 0)) {
@@ -399,7 +627,7 @@ void ringbuffer_peek_read(const ringbuffer_t *rb, uint8_t **data, size_t *len) {
             *len = rb->write_offset - rb->read_offset;
         } else {
             // Wrapped around - return first contiguous chunk
-            *len = RINGBUFFER_SIZE - rb->read_offset;
+            *len = rb->mask + 1 - rb->read_offset;
         }
 
         if (__builtin_expect(*len > available, 0)) *len = available;
@@ -412,8 +640,59 @@ void ringbuffer_advance_read(ringbuffer_t *rb, size_t len) {
     size_t available = ringbuffer_available_read(rb);
     if (__builtin_expect(len > available, 0)) len = available;
 
+    // Release: our reads of the data complete before the producer may reuse the space
     // Optimized: bitwise AND instead of expensive modulo
-    rb->read_offset = (rb->read_offset + len) & (RINGBUFFER_SIZE - 1);
+    RB_STORE_RELEASE(&rb->read_offset, (rb->read_offset + len) & rb->mask);
+}
+
+int ringbuffer_prepare(ringbuffer_t *rb, int flags, int numa_node) {
+    if (!rb || !rb->pulled_data) return 0;
+
+    size_t size = rb->mask + 1;
+    size_t span = rb->is_mirrored ? 2 * size : size;  // Both halves have their own page tables
+    int done = 0;
+
+#ifdef __linux__
+    // Policy first: pages faulted afterwards are allocated on the node, MPOL_MF_MOVE
+    // migrates any already resident (pool memory, earlier touches)
+    if (flags & RINGBUFFER_MEM_NUMA_BIND) {
+        if (numa_node < 0) numa_node = os_get_numa_node();
+        if (numa_node >= 0 && numa_node < (int)(8 * sizeof(unsigned long))) {
+            unsigned long nodemask = 1UL << numa_node;
+            uintptr_t page_mask = (uintptr_t)sysconf(_SC_PAGESIZE) - 1;
+            uintptr_t start = (uintptr_t)rb->pulled_data & ~page_mask;
+            if (syscall(SYS_mbind, (void *)start, span, MPOL_BIND, &nodemask,
+                        8 * sizeof(nodemask), MPOL_MF_MOVE) == 0) {
+                done |= RINGBUFFER_MEM_NUMA_BIND;
+            } else {
+                fprintf(stderr, "Warning: mbind to NUMA node %d failed\n", numa_node);
+            }
+        }
+    }
+#else
+    (void)numa_node;
+#endif
+
+    if (flags & RINGBUFFER_MEM_PREFAULT) {
+        // Write one byte per page: contents are don't-care before the first producer write
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        volatile uint8_t *p = rb->pulled_data;
+        for (size_t off = 0; off < span; off += page) {
+            p[off] = 0;
+        }
+        done |= RINGBUFFER_MEM_PREFAULT;
+    }
+
+    if (flags & RINGBUFFER_MEM_MLOCK) {
+        if (mlock(rb->pulled_data, span) == 0) {
+            done |= RINGBUFFER_MEM_MLOCK;
+        } else {
+            fprintf(stderr, "Warning: mlock of %zu bytes failed (raise RLIMIT_MEMLOCK / ulimit -l)\n", span);
+        }
+    }
+
+    rb->mem_status |= done;
+    return done;
 }
 
 int ringbuffer_is_mirrored(const ringbuffer_t *rb) {
@@ -425,3 +704,8 @@ int ringbuffer_is_mmap(const ringbuffer_t *rb) {
     if (!rb) return 0;
     return rb->is_mmap;
 }
+
+int ringbuffer_mem_status(const ringbuffer_t *rb) {
+    if (!rb) return 0;
+    return rb->mem_status;
+}
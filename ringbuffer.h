@@ -3,21 +3,14 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <sys/types.h>
 
-// Memory barriers for multi-core safety
-#ifdef __aarch64__
-// ARM64 (Apple Silicon, etc.) - use DMB (Data Memory Barrier)
-#define WRITE_BARRIER() __asm__ __volatile__("dmb ishst" ::: "memory")
-#define READ_BARRIER()  __asm__ __volatile__("dmb ishld" ::: "memory")
-#elif defined(__x86_64__) || defined(__i386__)
-// x86/x64 - TSO memory model, only need compiler barrier
-#define WRITE_BARRIER() __asm__ __volatile__("" ::: "memory")
-#define READ_BARRIER()  __asm__ __volatile__("" ::: "memory")
-#else
-// Generic fallback - compiler barrier
-#define WRITE_BARRIER() __asm__ __volatile__("" ::: "memory")
-#define READ_BARRIER()  __asm__ __volatile__("" ::: "memory")
-#endif
+// Multi-core safety: each side publishes its offset with a release store and reads the
+// other side's offset with an acquire load (plain mov on x86, ldar/stlr on ARM64), so the
+// producer and consumer may run on different threads
+#define RB_LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RB_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define RB_LOAD_RELAXED(p)     __atomic_load_n((p), __ATOMIC_RELAXED)
 
 // Platform-specific expectations for branch prediction
 // Virtual memory mirroring works better on Linux than macOS
@@ -27,9 +20,12 @@
 #define LIKELY_MIRRORED 0    // macOS/others: mirroring often fails, expect fallback
 #endif
 
-// Power-of-2 size for cheap modulo via bitwise AND
+// Default power-of-2 size for cheap modulo via bitwise AND
 // 1u << 23 = 8,388,608 bytes = 8 MB
+// Per-ring sizes (ringbuffer_init_size) are powers of two in [RINGBUFFER_MIN_SIZE, RINGBUFFER_MAX_SIZE]
 #define RINGBUFFER_SIZE (1u << 23)
+#define RINGBUFFER_MIN_SIZE (1u << 12)   // One page: mirroring maps whole pages
+#define RINGBUFFER_MAX_SIZE (1u << 30)
 
 // Compile-time assertion: ensure size is power of 2
 _Static_assert((RINGBUFFER_SIZE & (RINGBUFFER_SIZE - 1)) == 0,
@@ -42,17 +38,24 @@ _Static_assert((RINGBUFFER_SIZE & (RINGBUFFER_SIZE - 1)) == 0,
 #define CACHE_LINE_SIZE 64   // x86/x64, other ARM
 #endif
 
+// Shared backing region for many rings (see ringbuffer_pool_create)
+typedef struct ringbuffer_pool ringbuffer_pool_t;
+
 typedef struct {
     //
     // === PRODUCER-OWNED CACHE LINE ===
     //
     uint8_t *pulled_data;       // Buffer pointer (shared read-only after init)
     size_t write_offset;        // Producer writes frequently
+    size_t mask;                // Size - 1 (read-only after init)
     int is_mmap;                // Initialization only (read-only after init)
     int is_mirrored;            // Virtual memory mirroring enabled (read-only after init)
+    ringbuffer_pool_t *pool;    // Owning pool, NULL for standalone rings
+    size_t pool_offset;         // Slot offset in the pool
+    int mem_status;             // RINGBUFFER_MEM_* steps that succeeded (ringbuffer_prepare)
 
     // Padding to next cache line boundary
-    uint8_t _pad_producer[CACHE_LINE_SIZE - sizeof(uint8_t*) - sizeof(size_t) - 2*sizeof(int)];
+    uint8_t _pad_producer[CACHE_LINE_SIZE - sizeof(uint8_t*) - 3*sizeof(size_t) - 3*sizeof(int) - sizeof(void*)];
 
     //
     // === CONSUMER-OWNED CACHE LINE ===
@@ -64,9 +67,42 @@ typedef struct {
 
 } __attribute__((aligned(CACHE_LINE_SIZE))) ringbuffer_t;
 
-// Initialize ring buffer
+_Static_assert(offsetof(ringbuffer_t, read_offset) == CACHE_LINE_SIZE,
+               "producer fields must fill exactly one cache line");
+
+// ringbuffer_prepare() steps
+#define RINGBUFFER_MEM_NUMA_BIND 0x1   // mbind(MPOL_BIND) to one NUMA node (Linux)
+#define RINGBUFFER_MEM_PREFAULT  0x2   // Touch every page (both mirror halves) now, not on the hot path
+#define RINGBUFFER_MEM_MLOCK     0x4   // mlock: never swapped or reclaimed (needs RLIMIT_MEMLOCK)
+
+// Initialize ring buffer (RINGBUFFER_SIZE)
 int ringbuffer_init(ringbuffer_t *rb);
 
+// Initialize ring buffer of size bytes (rounded up to a power of two, clamped to the
+// RINGBUFFER_MIN_SIZE..RINGBUFFER_MAX_SIZE range)
+// pool: carve the ring out of a shared pool (falls back to a standalone ring when the
+//       pool is exhausted), NULL for a standalone allocation
+// Returns 0 on success, -1 on failure
+int ringbuffer_init_size(ringbuffer_t *rb, size_t size, ringbuffer_pool_t *pool);
+
+// Bind, pre-fault and/or lock the ring's memory (call right after init, or while the ring
+// is empty: pre-faulting writes over every page)
+// numa_node: target for RINGBUFFER_MEM_NUMA_BIND, -1 = node of the calling thread's CPU
+// Returns the RINGBUFFER_MEM_* steps that succeeded (accumulated in rb->mem_status)
+int ringbuffer_prepare(ringbuffer_t *rb, int flags, int numa_node);
+
+// Create a pool of pool_bytes backing memory, pre-faulted once, that rings are carved from
+// Tries hugepages first (every ring then takes at least one 2 MB page); rings stay mirrored
+// Not thread-safe: create and carve rings at init time, destroy after every ring is freed
+// Returns NULL on failure
+ringbuffer_pool_t *ringbuffer_pool_create(size_t pool_bytes);
+void ringbuffer_pool_destroy(ringbuffer_pool_t *pool);
+
+// Pool usage (bytes carved out / total), for sizing
+size_t ringbuffer_pool_used(const ringbuffer_pool_t *pool);
+size_t ringbuffer_pool_capacity(const ringbuffer_pool_t *pool);
+int ringbuffer_pool_is_hugepage(const ringbuffer_pool_t *pool);
+
 // Free ring buffer
 void ringbuffer_free(ringbuffer_t *rb);
 
@@ -74,22 +110,27 @@ void ringbuffer_free(ringbuffer_t *rb);
 static inline size_t ringbuffer_available_write(const ringbuffer_t *rb) {
     if (!rb || !rb->pulled_data) return 0;
 
-    size_t w = rb->write_offset;
-    size_t r = rb->read_offset;
+    size_t w = RB_LOAD_RELAXED(&rb->write_offset);  // Own offset (producer)
+    size_t r = RB_LOAD_ACQUIRE(&rb->read_offset);   // Consumer may release concurrently
 
     // Branchless calculation using power-of-2 wraparound
-    return (r - w - 1) & (RINGBUFFER_SIZE - 1);
+    return (r - w - 1) & rb->mask;
 }
 
 // Get available data for reading (hot function - inlined for performance)
 static inline size_t ringbuffer_available_read(const ringbuffer_t *rb) {
     if (!rb || !rb->pulled_data) return 0;
 
-    size_t w = rb->write_offset;
-    size_t r = rb->read_offset;
+    size_t w = RB_LOAD_ACQUIRE(&rb->write_offset);  // Data before w is visible after this load
+    size_t r = RB_LOAD_RELAXED(&rb->read_offset);   // Own offset (relaxed: stats may read it from the producer)
 
     // Branchless calculation using power-of-2 wraparound
-    return (w - r) & (RINGBUFFER_SIZE - 1);
+    return (w - r) & rb->mask;
+}
+
+// Ring capacity in bytes (0 before init)
+static inline size_t ringbuffer_size(const ringbuffer_t *rb) {
+    return rb->pulled_data ? rb->mask + 1 : 0;
 }
 
 // Get write pointer for direct SSL_read() writes
@@ -110,8 +151,20 @@ void ringbuffer_peek_read(const ringbuffer_t *rb, uint8_t **data, size_t *len);
 // Advance read position (consume data that was read)
 void ringbuffer_advance_read(ringbuffer_t *rb, size_t len);
 
+// Release everything before offset (masked ring position) in one step
+// For consumers that hold an absolute position, e.g. a parse cursor on another thread
+static inline void ringbuffer_release_to(ringbuffer_t *rb, size_t offset) {
+    RB_STORE_RELEASE(&rb->read_offset, offset & rb->mask);
+}
+
+// Map [offset, offset + size) of fd twice, back to back (size and offset page-aligned)
+// writable: 0 = PROT_READ only (e.g. readers of a shared ring)
+// Returns the base of the 2 * size mapping (munmap both halves), NULL on failure
+uint8_t *ringbuffer_map_mirrored(int fd, off_t offset, size_t size, int writable);
+
 // Get ringbuffer status information
 int ringbuffer_is_mirrored(const ringbuffer_t *rb);
 int ringbuffer_is_mmap(const ringbuffer_t *rb);
+int ringbuffer_mem_status(const ringbuffer_t *rb);
 
 #endif // RINGBUFFER_H
@@ -1,9 +1,9 @@
 #include "ssl.h"
 #include "ssl_backend.h"
+#include "tcp.h"
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 #include <sys/socket.h>
-#include <sys/select.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
@@ -13,6 +13,8 @@
 #include <string.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <time.h>
+#include <pthread.h>
 
 #ifdef __linux__
 #include "bio_timestamp.h"
@@ -35,6 +37,24 @@
 static SSL_CTX *global_ctx = NULL;
 static int ssl_initialized = 0;
 
+// Client session cache: host:port -> newest resumable session the server issued (ticket or ID)
+// Shared by every context so a reconnect wave resumes instead of doing full handshakes;
+// cold path only (once per handshake), one mutex
+#define SSL_SESSION_CACHE_SIZE 64
+#define SSL_SESSION_KEY_MAX 272  // hostname (255) + ":65535"
+
+typedef struct {
+    char key[SSL_SESSION_KEY_MAX];  // Empty = free slot
+    SSL_SESSION *session;
+    int needs_tls13;             // Refused our TLS 1.2 pin (kTLS backend before OpenSSL 3.2)
+    uint64_t used;               // LRU clock
+} ssl_session_entry_t;
+
+static pthread_mutex_t session_lock = PTHREAD_MUTEX_INITIALIZER;
+static ssl_session_entry_t session_cache[SSL_SESSION_CACHE_SIZE];
+static uint64_t session_clock = 0;
+static int session_cache_enabled = 0;
+
 // Helper: Safe environment variable parsing (returns 1 if valid "1", 0 otherwise)
 static inline int env_is_enabled(const char *value) {
     if (!value) return 0;
@@ -46,6 +66,40 @@ static inline int env_is_enabled(const char *value) {
     return (val == 1);
 }
 
+static void session_key(char *key, const char *hostname, int port) {
+    snprintf(key, SSL_SESSION_KEY_MAX, "%s:%d", hostname, port);
+}
+
+// Caller holds session_lock
+static ssl_session_entry_t *session_find(const char *key) {
+    for (int i = 0; i < SSL_SESSION_CACHE_SIZE; i++) {
+        if (session_cache[i].key[0] && strcmp(session_cache[i].key, key) == 0) return &session_cache[i];
+    }
+    return NULL;
+}
+
+// Caller holds session_lock; existing entry, else a free slot, else the least recently used
+// (its session is returned in *evicted for freeing outside the lock)
+static ssl_session_entry_t *session_slot(const char *key, SSL_SESSION **evicted) {
+    ssl_session_entry_t *e = session_find(key);
+    if (e) return e;
+    e = &session_cache[0];
+    for (int i = 0; i < SSL_SESSION_CACHE_SIZE; i++) {
+        if (!session_cache[i].key[0]) {
+            e = &session_cache[i];
+            break;
+        }
+        if (session_cache[i].used < e->used) e = &session_cache[i];
+    }
+    *evicted = e->session;
+    e->session = NULL;
+    e->needs_tls13 = 0;
+    strcpy(e->key, key);
+    return e;
+}
+
+static int ssl_new_session_cb(SSL *ssl, SSL_SESSION *session);
+
 // Initialize OpenSSL library only once (called on first connection)
 static void ssl_init_once(void) {
     if (ssl_initialized) return;
@@ -63,20 +117,30 @@ static void ssl_init_once(void) {
     SSL_CTX_set_verify(global_ctx, SSL_VERIFY_NONE, NULL);
     SSL_CTX_set_verify_depth(global_ctx, 0);
     
-    // Disable session caching for deterministic performance
-    SSL_CTX_set_session_cache_mode(global_ctx, SSL_SESS_CACHE_OFF);
-    
-    // Disable session tickets for slightly faster handshake
-    SSL_CTX_set_options(global_ctx, SSL_OP_NO_TICKET);
+    // Client-side session resumption (our own host:port cache, see ssl_new_session_cb)
+    // Set WS_DISABLE_SESSION_CACHE=1 for a full handshake every time
+    if (env_is_enabled(getenv("WS_DISABLE_SESSION_CACHE"))) {
+        SSL_CTX_set_session_cache_mode(global_ctx, SSL_SESS_CACHE_OFF);
+        SSL_CTX_set_options(global_ctx, SSL_OP_NO_TICKET);
+    } else {
+        SSL_CTX_set_session_cache_mode(global_ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(global_ctx, ssl_new_session_cb);
+        session_cache_enabled = 1;
+    }
     
     // Skip renegotiation time limit
     SSL_CTX_set_options(global_ctx, SSL_OP_ALLOW_UNSAFE_LEGACY_RENEGOTIATION);
+
+    // TX flush hands out whatever is contiguous in the ring: allow partial writes and
+    // retries with a longer length/moved pointer after WANT_WRITE
+    SSL_CTX_set_mode(global_ctx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
     
     ssl_initialized = 1;
 }
 
 struct ssl_context {
     SSL *ssl;
+    tcp_connect_t *connecting;   // NULL once the TCP connection is up (or for ssl_init)
     int sockfd;
     int port;
     char *hostname;
@@ -90,230 +154,165 @@ struct ssl_context {
 #ifdef __linux__
     // Hardware timestamp storage (shared with custom BIO)
     bio_timestamp_t bio_ts_storage;
+    // kTLS RX with timestamps on TLS 1.2: ssl_read_into() recvmsg()s the socket itself
+    int ktls_rx_direct;
+    int rx_failed;               // Direct path: last read was a socket error or non-data record
 #endif
 };
 
 #define SSL_CONTEXT_MAGIC 0x53534C00  // "SSL\0" in little-endian
 
-ssl_context_t *ssl_init(const char *hostname, int port) {
-    // Initialize OpenSSL library if not already done
-    ssl_init_once();
-    if (!global_ctx) return NULL;
-
-    // Check for NULL parameters and valid port range
-    if (!hostname || port <= 0 || port > 65535) return NULL;
+// Server issued a session (TLS 1.2 after the handshake, TLS 1.3 NewSessionTicket during the
+// first reads): keep the newest one per host:port. Returns 1 when the reference is kept
+static int ssl_new_session_cb(SSL *ssl, SSL_SESSION *session) {
+    ssl_context_t *sctx = (ssl_context_t *)SSL_get_app_data(ssl);
+    if (!sctx || !sctx->hostname) return 0;
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+    if (!SSL_SESSION_is_resumable(session)) return 0;
+#endif
 
-    // Use getaddrinfo() instead of deprecated gethostbyname()
-    // Resolve hostname BEFORE allocating context to avoid leaks on failure
-    struct addrinfo hints, *result = NULL;
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_INET;
-    hints.ai_socktype = SOCK_STREAM;
+    char key[SSL_SESSION_KEY_MAX];
+    session_key(key, sctx->hostname, sctx->port);
 
-    // Port string buffer: "65535\0" = 6 bytes (max port) + safety margin
-    char port_str[8];
-    _Static_assert(sizeof(port_str) > 6, "port_str buffer must fit max port (65535) + null");
-    snprintf(port_str, sizeof(port_str), "%d", port);
+    SSL_SESSION *evicted = NULL;
+    pthread_mutex_lock(&session_lock);
+    ssl_session_entry_t *e = session_slot(key, &evicted);
+    SSL_SESSION *old = e->session;
+    e->session = session;
+    e->used = ++session_clock;
+    pthread_mutex_unlock(&session_lock);
 
-    if (getaddrinfo(hostname, port_str, &hints, &result) != 0) {
-        return NULL;
-    }
-
-    // Allocate context AFTER successful hostname resolution
-    ssl_context_t *sctx = (ssl_context_t *)malloc(sizeof(ssl_context_t));
-    if (!sctx) {
-        freeaddrinfo(result);
-        return NULL;
-    }
+    if (old) SSL_SESSION_free(old);
+    if (evicted) SSL_SESSION_free(evicted);
+    return 1;
+}
 
-    // Check strdup() return value
-    sctx->hostname = strdup(hostname);
-    if (!sctx->hostname) {
-        free(sctx);
-        freeaddrinfo(result);
-        return NULL;
-    }
+// Offer the cached session for this endpoint (expired ones are dropped)
+static void ssl_offer_session(ssl_context_t *sctx) {
+    if (!session_cache_enabled) return;
 
-    sctx->port = port;
-    sctx->ssl = NULL;
-    sctx->sockfd = -1;
-    sctx->magic = SSL_CONTEXT_MAGIC;  // Set magic value
-    sctx->hw_timestamping_enabled = 0;  // Will be set if successful
-    sctx->ktls_enabled = 0;  // Will be set if kTLS is enabled
-    sctx->ktls_checked = 0;  // Will be set to 1 after kTLS detection completes
-#ifdef __linux__
-    sctx->bio_ts_storage.hw_timestamp_ns = 0;
-    sctx->bio_ts_storage.hw_available = 0;
-#endif
+    char key[SSL_SESSION_KEY_MAX];
+    session_key(key, sctx->hostname, sctx->port);
 
-    // Create socket
-    sctx->sockfd = socket(AF_INET, SOCK_STREAM, 0);
-    if (sctx->sockfd < 0) {
-        free(sctx->hostname);
-        free(sctx);
-        freeaddrinfo(result);
-        return NULL;
+    SSL_SESSION *stale = NULL;
+    pthread_mutex_lock(&session_lock);
+    ssl_session_entry_t *e = session_find(key);
+    if (e && e->session) {
+        if ((uint64_t)time(NULL) >= (uint64_t)SSL_SESSION_get_time(e->session) + (uint64_t)SSL_SESSION_get_timeout(e->session)) {
+            stale = e->session;
+            e->session = NULL;
+        } else {
+            SSL_set_session(sctx->ssl, e->session);  // Takes its own reference
+            e->used = ++session_clock;
+        }
     }
+    pthread_mutex_unlock(&session_lock);
 
-    // NOTE: Keep socket in blocking mode during TLS handshake for kTLS activation
-    // We'll switch to non-blocking mode after handshake completes successfully
-    // (OpenSSL's kTLS has issues activating on non-blocking sockets)
-
-    // Optimize socket buffer sizes for low latency
-    // Larger buffers reduce the chance of drops but may increase latency
-    // For HFT, we prefer smaller buffers with faster processing
-    int rcvbuf_size = 256 * 1024;  // 256KB receive buffer
-    int sndbuf_size = 256 * 1024;  // 256KB send buffer
-
-    // Note: Buffer size failures are non-critical (kernel may choose different sizes)
-    if (setsockopt(sctx->sockfd, SOL_SOCKET, SO_RCVBUF, &rcvbuf_size, sizeof(rcvbuf_size)) != 0) {
-        fprintf(stderr, "Warning: Failed to set SO_RCVBUF: %s\n", strerror(errno));
-    }
-    if (setsockopt(sctx->sockfd, SOL_SOCKET, SO_SNDBUF, &sndbuf_size, sizeof(sndbuf_size)) != 0) {
-        fprintf(stderr, "Warning: Failed to set SO_SNDBUF: %s\n", strerror(errno));
-    }
+    if (stale) SSL_SESSION_free(stale);
+}
 
-    // Check return values from critical setsockopt() calls
-    // Enable TCP_NODELAY to disable Nagle's algorithm (reduce latency)
-    int nodelay = 1;
-    if (setsockopt(sctx->sockfd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)) != 0) {
-        fprintf(stderr, "Warning: Failed to set TCP_NODELAY: %s\n", strerror(errno));
+void ssl_session_cache_flush(void) {
+    pthread_mutex_lock(&session_lock);
+    for (int i = 0; i < SSL_SESSION_CACHE_SIZE; i++) {
+        if (session_cache[i].session) SSL_SESSION_free(session_cache[i].session);
+        memset(&session_cache[i], 0, sizeof(session_cache[i]));
     }
+    pthread_mutex_unlock(&session_lock);
+}
 
-    // Enable SO_KEEPALIVE to detect dead connections
-    int keepalive = 1;
-    if (setsockopt(sctx->sockfd, SOL_SOCKET, SO_KEEPALIVE, &keepalive, sizeof(keepalive)) != 0) {
-        fprintf(stderr, "Warning: Failed to set SO_KEEPALIVE: %s\n", strerror(errno));
-    }
+#if defined(SSL_BACKEND_KTLS) && defined(KTLS_SUPPORTED) && OPENSSL_VERSION_NUMBER < 0x30200000L
+// TLS 1.2 pin refused (TLS 1.3-only venue): remember it so the reconnect offers TLS 1.3
+static void ssl_remember_needs_tls13(ssl_context_t *sctx) {
+    char key[SSL_SESSION_KEY_MAX];
+    session_key(key, sctx->hostname, sctx->port);
+
+    SSL_SESSION *evicted = NULL;
+    pthread_mutex_lock(&session_lock);
+    ssl_session_entry_t *e = session_slot(key, &evicted);
+    e->needs_tls13 = 1;
+    e->used = ++session_clock;
+    pthread_mutex_unlock(&session_lock);
+    if (evicted) SSL_SESSION_free(evicted);
+}
 
-#ifdef __APPLE__
-    // macOS-specific socket optimizations
-    // Set TCP_NOOPT to disable TCP options processing for lower latency
-    int tcp_noopt = 1;
-    if (setsockopt(sctx->sockfd, IPPROTO_TCP, TCP_NOOPT, &tcp_noopt, sizeof(tcp_noopt)) != 0) {
-        fprintf(stderr, "Warning: Failed to set TCP_NOOPT: %s\n", strerror(errno));
-    }
+static int ssl_host_needs_tls13(ssl_context_t *sctx) {
+    char key[SSL_SESSION_KEY_MAX];
+    session_key(key, sctx->hostname, sctx->port);
 
-    // Set SO_NOSIGPIPE to prevent SIGPIPE on broken connections
-    int nosigpipe = 1;
-    if (setsockopt(sctx->sockfd, SOL_SOCKET, SO_NOSIGPIPE, &nosigpipe, sizeof(nosigpipe)) != 0) {
-        fprintf(stderr, "Warning: Failed to set SO_NOSIGPIPE: %s\n", strerror(errno));
-    }
+    pthread_mutex_lock(&session_lock);
+    ssl_session_entry_t *e = session_find(key);
+    int needs = e && e->needs_tls13;
+    pthread_mutex_unlock(&session_lock);
+    return needs;
+}
 #endif
 
-#ifdef HW_TIMESTAMPING_SUPPORTED
-    // Hardware timestamping support (Linux only)
-    // IMPORTANT: Hardware timestamping and kTLS are mutually exclusive!
-    // - With kTLS (default): Best CPU performance, no HW timestamps (EVENT→SSL→APP only)
-    // - With HW timestamps: Full latency visibility (HW→EVENT→SSL→APP), higher CPU usage
-    // Set WS_ENABLE_HW_TIMESTAMPS=1 to prioritize hardware timestamps over kTLS
-    const char *enable_hw_ts = getenv("WS_ENABLE_HW_TIMESTAMPS");
-    if (env_is_enabled(enable_hw_ts)) {
-        // User explicitly requested hardware timestamping
-        // This will disable kTLS (custom BIO required for recvmsg)
-        int timestamping_flags = SOF_TIMESTAMPING_RX_HARDWARE |
-                                 SOF_TIMESTAMPING_RX_SOFTWARE |
-                                 SOF_TIMESTAMPING_SOFTWARE |
-                                 SOF_TIMESTAMPING_RAW_HARDWARE;
-
-        if (setsockopt(sctx->sockfd, SOL_SOCKET, SO_TIMESTAMPING,
-                       &timestamping_flags, sizeof(timestamping_flags)) == 0) {
-            sctx->hw_timestamping_enabled = 1;
-
-            const char *debug = getenv("WS_DEBUG_KTLS");
-            if (env_is_enabled(debug)) {
-                fprintf(stderr, "[HW Timestamps] Enabled - kTLS will be disabled\n");
-            }
-        }
-    }
-    // If not explicitly enabled, hw_timestamping_enabled remains 0 and kTLS can activate
-#endif
+int ssl_session_reused(ssl_context_t *sctx) {
+    if (!sctx || !sctx->ssl || !sctx->ktls_checked) return 0;
+    return SSL_session_reused(sctx->ssl);
+}
 
-    // Use non-blocking connect with timeout to avoid stalling application
-    // (kTLS requires blocking mode, but we can temporarily switch for connect)
+int ssl_global_init(void) {
+    ssl_init_once();
+    return global_ctx ? 0 : -1;
+}
 
-    // Set socket to non-blocking for connect with timeout
-    int flags = fcntl(sctx->sockfd, F_GETFL, 0);
-    if (flags < 0 || fcntl(sctx->sockfd, F_SETFL, flags | O_NONBLOCK) < 0) {
-        close(sctx->sockfd);
-        free(sctx->hostname);
+static ssl_context_t *ssl_context_new(const char *hostname, int port) {
+    ssl_context_t *sctx = (ssl_context_t *)calloc(1, sizeof(ssl_context_t));
+    if (!sctx) return NULL;
+
+    // Check strdup() return value
+    sctx->hostname = strdup(hostname);
+    if (!sctx->hostname) {
         free(sctx);
-        freeaddrinfo(result);
         return NULL;
     }
 
-    // Attempt non-blocking connect
-    int connect_result = connect(sctx->sockfd, result->ai_addr, result->ai_addrlen);
-
-    if (connect_result < 0) {
-        if (errno == EINPROGRESS) {
-            // Connection in progress - wait with timeout (5 seconds for HFT)
-
-            // CRITICAL: Check FD_SETSIZE before using select()
-            // FD_SET() has no bounds checking and will cause buffer overflow if sockfd >= FD_SETSIZE
-            // Common in production servers with many open files (logs, DB connections, etc.)
-            if (sctx->sockfd >= FD_SETSIZE) {
-                // File descriptor too high for select() - fail with diagnostic
-                fprintf(stderr, "ERROR: Socket FD %d >= FD_SETSIZE %d. Close unused files or use poll() instead of select().\n",
-                        sctx->sockfd, FD_SETSIZE);
-                close(sctx->sockfd);
-                free(sctx->hostname);
-                free(sctx);
-                freeaddrinfo(result);
-                return NULL;
-            }
+    sctx->port = port;
+    sctx->sockfd = -1;
+    sctx->magic = SSL_CONTEXT_MAGIC;  // Set magic value
+    return sctx;
+}
 
-            fd_set write_fds;
-            struct timeval timeout;
-            timeout.tv_sec = 5;
-            timeout.tv_usec = 0;
+ssl_context_t *ssl_init(const char *hostname, int port) {
+    // Initialize OpenSSL library if not already done
+    ssl_init_once();
+    if (!global_ctx) return NULL;
 
-            FD_ZERO(&write_fds);
-            FD_SET(sctx->sockfd, &write_fds);
+    // Check for NULL parameters and valid port range
+    if (!hostname || port <= 0 || port > 65535) return NULL;
 
-            int select_result = select(sctx->sockfd + 1, NULL, &write_fds, NULL, &timeout);
+    // Connect BEFORE allocating the context to avoid leaks on failure
+    // NOTE: The socket stays in blocking mode during the TLS handshake for kTLS activation;
+    // ssl_handshake() switches it to non-blocking once the handshake completes
+    int hw_timestamping = 0;
+    int fd = tcp_connect_blocking(hostname, port, &hw_timestamping);
+    if (fd < 0) return NULL;
 
-            if (select_result <= 0) {
-                // Timeout or error
-                close(sctx->sockfd);
-                free(sctx->hostname);
-                free(sctx);
-                freeaddrinfo(result);
-                return NULL;
-            }
-
-            // Check if connection succeeded
-            int so_error;
-            socklen_t len = sizeof(so_error);
-            if (getsockopt(sctx->sockfd, SOL_SOCKET, SO_ERROR, &so_error, &len) < 0 || so_error != 0) {
-                // Connection failed
-                close(sctx->sockfd);
-                free(sctx->hostname);
-                free(sctx);
-                freeaddrinfo(result);
-                return NULL;
-            }
-        } else {
-            // Immediate connection failure
-            close(sctx->sockfd);
-            free(sctx->hostname);
-            free(sctx);
-            freeaddrinfo(result);
-            return NULL;
-        }
+    ssl_context_t *sctx = ssl_context_new(hostname, port);
+    if (!sctx) {
+        close(fd);
+        return NULL;
     }
+    sctx->sockfd = fd;
+    sctx->hw_timestamping_enabled = hw_timestamping;
+    return sctx;
+}
 
-    // Restore blocking mode for kTLS activation during TLS handshake
-    // (OpenSSL's kTLS has issues activating on non-blocking sockets)
-    if (fcntl(sctx->sockfd, F_SETFL, flags) < 0) {
-        close(sctx->sockfd);
+ssl_context_t *ssl_init_async(const char *hostname, int port) {
+    ssl_init_once();
+    if (!global_ctx) return NULL;
+    if (!hostname || port <= 0 || port > 65535) return NULL;
+
+    ssl_context_t *sctx = ssl_context_new(hostname, port);
+    if (!sctx) return NULL;
+    // sockfd is set to the winning attempt once connected
+    sctx->connecting = tcp_connect_start(hostname);
+    if (!sctx->connecting) {
         free(sctx->hostname);
         free(sctx);
-        freeaddrinfo(result);
         return NULL;
     }
-
-    freeaddrinfo(result);
     return sctx;
 }
 
@@ -326,6 +325,8 @@ void ssl_free(ssl_context_t *sctx) {
     // Clear magic to prevent reuse
     sctx->magic = 0;
     
+    tcp_connect_abort(sctx->connecting);
+
     if (sctx->ssl) {
         SSL_shutdown(sctx->ssl);
         SSL_free(sctx->ssl);
@@ -346,6 +347,14 @@ void ssl_free(ssl_context_t *sctx) {
 int ssl_handshake(ssl_context_t *sctx) {
     if (!sctx) return -1;
 
+    // ssl_init_async(): finish the TCP connect race first (never blocks)
+    if (__builtin_expect(sctx->connecting != NULL, 0)) {
+        int tcp = tcp_connect_step(sctx->connecting, sctx->hostname, sctx->port, &sctx->sockfd,
+                                   &sctx->hw_timestamping_enabled);
+        if (tcp <= 0) return tcp;
+        sctx->connecting = NULL;
+    }
+
     // If handshake already complete and kTLS already checked, return success
     if (sctx->ssl && sctx->ktls_checked) {
         return 1;  // Already connected and kTLS checked
@@ -355,6 +364,7 @@ int ssl_handshake(ssl_context_t *sctx) {
     if (!sctx->ssl) {
         sctx->ssl = SSL_new(global_ctx);
         if (!sctx->ssl) return -1;
+        SSL_set_app_data(sctx->ssl, sctx);  // ssl_new_session_cb finds host:port through it
 
 #ifdef __linux__
         // Use custom BIO for hardware timestamping on Linux
@@ -379,17 +389,23 @@ int ssl_handshake(ssl_context_t *sctx) {
         }
 
         #if defined(SSL_BACKEND_KTLS) && defined(KTLS_SUPPORTED)
-        // For kTLS: Default to TLS 1.2 (production-ready kTLS)
-        // Set WS_FORCE_TLS13=1 to override and use TLS 1.3 (disables kTLS)
+        // For kTLS: negotiate only versions the kernel offload covers in both directions
+        // - OpenSSL 3.2+: TLS 1.2 and 1.3 (TLS 1.3 RX offload arrived with the 3.2 record layer,
+        //   including resumed sessions and post-handshake tickets/KeyUpdate)
+        // - Older OpenSSL: TLS 1.2 only (3.0/3.1 offload TLS 1.3 TX only)
+        // Set WS_FORCE_TLS13=1 to use TLS 1.3 only (older OpenSSL: userspace RX)
         const char *force_tls13 = getenv("WS_FORCE_TLS13");
         if (env_is_enabled(force_tls13)) {
-            // Override: Force TLS 1.3 only (disables kTLS, uses userspace OpenSSL)
             SSL_set_min_proto_version(sctx->ssl, TLS1_3_VERSION);
             SSL_set_max_proto_version(sctx->ssl, TLS1_3_VERSION);
         } else {
-            // Default: Force TLS 1.2 for kTLS support (kernel offload, best HFT performance)
             SSL_set_min_proto_version(sctx->ssl, TLS1_2_VERSION);
-            SSL_set_max_proto_version(sctx->ssl, TLS1_2_VERSION);
+#if OPENSSL_VERSION_NUMBER >= 0x30200000L
+            SSL_set_max_proto_version(sctx->ssl, TLS1_3_VERSION);
+#else
+            // A venue that refused the pin before gets TLS 1.3 (userspace RX) instead of failing forever
+            SSL_set_max_proto_version(sctx->ssl, ssl_host_needs_tls13(sctx) ? TLS1_3_VERSION : TLS1_2_VERSION);
+#endif
         }
 
         // Set TLS 1.3 cipher suites (kTLS-compatible: AES-GCM and ChaCha20-Poly1305)
@@ -426,6 +442,9 @@ int ssl_handshake(ssl_context_t *sctx) {
         #endif
         #endif
 
+        // Abbreviated handshake when we hold a session for this host:port
+        ssl_offer_session(sctx);
+
         // Check if socket is connected (only check on first SSL creation)
         int optval;
         socklen_t optlen = sizeof(optval);
@@ -440,6 +459,12 @@ int ssl_handshake(ssl_context_t *sctx) {
         if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) {
             return 0;  // Handshake in progress
         }
+#if defined(SSL_BACKEND_KTLS) && defined(KTLS_SUPPORTED) && OPENSSL_VERSION_NUMBER < 0x30200000L
+        if (err == SSL_ERROR_SSL && SSL_get_max_proto_version(sctx->ssl) == TLS1_2_VERSION &&
+            ERR_GET_REASON(ERR_peek_last_error()) == SSL_R_TLSV1_ALERT_PROTOCOL_VERSION) {
+            ssl_remember_needs_tls13(sctx);
+        }
+#endif
         return -1;  // Handshake failed
     }
 
@@ -465,6 +490,12 @@ int ssl_handshake(ssl_context_t *sctx) {
         if (env_is_enabled(debug_ktls)) {
             fprintf(stderr, "[kTLS Debug] kTLS successfully enabled!\n");
         }
+        // TLS 1.2 after the handshake carries only data and alerts, so the kernel's records
+        // can go straight into the ring. TLS 1.3 stays on SSL_read: tickets and KeyUpdate
+        // arrive as post-handshake messages that OpenSSL must process
+        if (sctx->hw_timestamping_enabled && SSL_version(sctx->ssl) == TLS1_2_VERSION) {
+            sctx->ktls_rx_direct = 1;
+        }
     } else {
         if (env_is_enabled(debug_ktls)) {
             fprintf(stderr, "[kTLS Debug] kTLS not enabled (send=%d, recv=%d)\n", send_ktls, recv_ktls);
@@ -507,16 +538,42 @@ int ssl_send(ssl_context_t *sctx, const uint8_t *data, size_t len) {
         len = INT_MAX;
     }
 
-    int result = SSL_write(sctx->ssl, data, (int)len);
-    if (__builtin_expect(result <= 0, 0)) {  // Unlikely: error path
-        int err = SSL_get_error(sctx->ssl, result);
-        if (err == SSL_ERROR_WANT_WRITE || err == SSL_ERROR_WANT_READ) {
-            return 0; // Would block, not an error
+#ifdef KTLS_SUPPORTED
+    // kTLS TX: the kernel frames and encrypts records, so skip OpenSSL entirely
+    // (MSG_ZEROCOPY is not used: kTLS software crypto copies anyway, and the ring
+    // slice would have to stay untouched until the completion notification)
+    if (sctx->ktls_enabled) {
+        ssize_t sent = send(sctx->sockfd, data, len, MSG_NOSIGNAL);
+        if (__builtin_expect(sent < 0, 0)) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                return 0;  // Would block, not an error
+            }
+            return -1;
         }
-        return -1;
+        return (int)sent;
     }
+#endif
 
-    return result;
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L && !defined(SSL_BACKEND_LIBRESSL) && !defined(SSL_BACKEND_BORINGSSL)
+    size_t written = 0;
+    int ok = SSL_write_ex(sctx->ssl, data, len, &written);
+    if (__builtin_expect(ok, 1)) {
+        return (int)written;
+    }
+    int result = 0;
+#else
+    int result = SSL_write(sctx->ssl, data, (int)len);
+    if (__builtin_expect(result > 0, 1)) {
+        return result;
+    }
+#endif
+
+    // Unlikely: error path
+    int err = SSL_get_error(sctx->ssl, result);
+    if (err == SSL_ERROR_WANT_WRITE || err == SSL_ERROR_WANT_READ) {
+        return 0; // Would block, not an error
+    }
+    return -1;
 }
 
 int ssl_recv(ssl_context_t *sctx, uint8_t *data, size_t len) {
@@ -551,10 +608,42 @@ int ssl_get_error_code(ssl_context_t *sctx, int ret) {
     return SSL_get_error(sctx->ssl, ret);
 }
 
+int ssl_read_failed(ssl_context_t *sctx, int ret) {
+    if (!sctx || !sctx->ssl) return 1;
+    if (ret > 0) return 0;
+#ifdef __linux__
+    if (sctx->ktls_rx_direct) return ret == 0 || sctx->rx_failed;
+#endif
+    int err = SSL_get_error(sctx->ssl, ret);
+    return err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE;
+}
+
+#ifdef __linux__
+// kTLS RX without OpenSSL: the kernel decrypts into buf and the same recvmsg() carries the
+// RX timestamp, so no record is copied through OpenSSL's buffer
+static inline int ssl_ktls_read_into(ssl_context_t *sctx, uint8_t *buf, size_t len) {
+    uint8_t record_type;
+    ssize_t n = bio_ts_recvmsg(sctx->sockfd, buf, len, &sctx->bio_ts_storage, &record_type);
+    if (__builtin_expect(n > 0 && record_type == BIO_TS_RECORD_APPDATA, 1)) return (int)n;
+
+    if (n < 0) {
+        sctx->rx_failed = !(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+        return -1;
+    }
+    // EOF, or an alert (close_notify or fatal): either way the peer is done. A handshake
+    // record would be a renegotiation, which kTLS cannot follow
+    sctx->rx_failed = 1;
+    return 0;
+}
+#endif
+
 int ssl_read_into(ssl_context_t *sctx, uint8_t *buf, size_t len) {
     if (!sctx || !sctx->ssl) return -1;
     // Clamp to INT_MAX for safe cast (SSL_read takes int)
     if (len > INT_MAX) len = INT_MAX;
+#ifdef __linux__
+    if (sctx->ktls_rx_direct) return ssl_ktls_read_into(sctx, buf, len);
+#endif
     return SSL_read(sctx->ssl, buf, len);
 }
 
@@ -574,7 +663,7 @@ uint64_t ssl_get_hw_timestamp(ssl_context_t *sctx) {
     if (!sctx || !sctx->hw_timestamping_enabled) return 0;
 
 #ifdef HW_TIMESTAMPING_SUPPORTED
-    // Return timestamp from BIO storage (updated during SSL_read via custom BIO)
+    // Return timestamp from BIO storage (updated by every recvmsg: custom BIO or kTLS direct read)
     return sctx->bio_ts_storage.hw_timestamp_ns;
 #else
     return 0;
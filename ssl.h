@@ -10,9 +10,19 @@
 
 typedef struct ssl_context ssl_context_t;
 
+// Initialize the TLS library and the shared SSL_CTX now instead of on the first connection
+// Returns 0, -1 if the library could not be initialized
+int ssl_global_init(void);
+
 // Initialize SSL context with hostname and port
 ssl_context_t *ssl_init(const char *hostname, int port);
 
+// Non-blocking variant: returns at once, without a socket yet. ssl_handshake() then drives
+// DNS (ws_resolver cache), a Happy Eyeballs connect race across the IPv4/IPv6 candidates
+// and the TLS handshake, returning 0 until done; ssl_get_fd() is -1 until TCP is up
+// The socket stays non-blocking throughout (kTLS activates where OpenSSL supports that)
+ssl_context_t *ssl_init_async(const char *hostname, int port);
+
 // Free SSL context
 void ssl_free(ssl_context_t *ctx);
 
@@ -37,7 +47,12 @@ int ssl_pending(ssl_context_t *ctx);
 // Get SSL error code
 int ssl_get_error_code(ssl_context_t *ctx, int ret);
 
+// Returns 1 if a read result (<= 0) means the connection is gone (EOF, close_notify,
+// socket error), 0 if the socket is merely drained
+int ssl_read_failed(ssl_context_t *ctx, int ret);
+
 // Read directly into buffer (for ring buffer zero-copy writes)
+// kTLS RX with hardware timestamps on TLS 1.2 bypasses SSL_read: one recvmsg() per call
 int ssl_read_into(ssl_context_t *ctx, uint8_t *buf, size_t len);
 
 // Get SSL handle (for direct access to SSL_read)
@@ -72,6 +87,14 @@ const char* ssl_get_cipher_name(ssl_context_t *ctx);
 // Returns 1 if AES-NI (x86) or ARM Crypto Extensions are available, 0 otherwise
 int ssl_has_hw_crypto(void);
 
+// Returns 1 if the completed handshake resumed a cached session (abbreviated handshake)
+// Sessions (TLS 1.2 tickets/IDs, TLS 1.3 tickets) are cached process-wide per host:port and
+// offered on the next connection to the same endpoint; WS_DISABLE_SESSION_CACHE=1 turns it off
+int ssl_session_reused(ssl_context_t *ctx);
+
+// Drop every cached session (e.g. after rotating to a different venue environment)
+void ssl_session_cache_flush(void);
+
 // Get SSL backend version string
 // Returns version string (e.g., "LibreSSL 3.8.2", "BoringSSL", "OpenSSL 3.0.0")
 const char* ssl_get_backend_version(void);
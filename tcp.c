@@ -0,0 +1,479 @@
+#include "tcp.h"
+#include "ws_resolver.h"
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <errno.h>
+#include <time.h>
+
+// Linux hardware timestamping support
+#ifdef __linux__
+#include "bio_timestamp.h"
+#include <linux/net_tstamp.h>
+#define HW_TIMESTAMPING_SUPPORTED 1
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0  // macOS: SO_NOSIGPIPE is set on the socket instead
+#endif
+
+// Non-blocking connect (tcp_connect_start): resolve, then race TCP attempts (Happy Eyeballs)
+#define TCP_CONNECT_TIMEOUT_NS 5000000000ULL    // Same budget as the blocking connect
+#define TCP_ATTEMPT_DELAY_NS 250000000ULL       // RFC 8305 recommended Connection Attempt Delay
+
+struct tcp_connect {
+    ws_resolved_t addrs;         // Candidates, families interleaved (resolved on the first step)
+    int resolved;
+    int fds[WS_RESOLVER_MAX_ADDRS];  // Attempt sockets, -1 = not started or failed
+    int next;                    // Next candidate to start
+    int active;                  // Attempts in flight
+    int hw_timestamping;         // tcp_configure_socket() result of the attempts
+    uint64_t next_attempt_ns;    // Start the next candidate then even if earlier ones are pending
+    uint64_t deadline_ns;
+};
+
+struct tcp_context {
+    tcp_connect_t *connecting;   // NULL once connected (or for tcp_init)
+    int sockfd;
+    int port;
+    char *hostname;
+    int hw_timestamping_enabled;
+    int rx_failed;               // Last read was EOF or a socket error
+#ifdef __linux__
+    bio_timestamp_t ts;          // RX timestamp of the last recvmsg()
+#endif
+};
+
+// Helper: Safe environment variable parsing (returns 1 if valid "1", 0 otherwise)
+static inline int env_is_enabled(const char *value) {
+    if (!value) return 0;
+    char *endptr;
+    errno = 0;  // Clear errno before strtol
+    long val = strtol(value, &endptr, 10);
+    // Reject on overflow, parse error, or value != 1
+    if (errno == ERANGE || *endptr != '\0') return 0;
+    return (val == 1);
+}
+
+static uint64_t tcp_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Latency socket options and optional hardware timestamping (shared by every connect path)
+int tcp_configure_socket(int fd) {
+    // Optimize socket buffer sizes for low latency
+    // Larger buffers reduce the chance of drops but may increase latency
+    // For HFT, we prefer smaller buffers with faster processing
+    int rcvbuf_size = 256 * 1024;  // 256KB receive buffer
+    int sndbuf_size = 256 * 1024;  // 256KB send buffer
+
+    // Note: Buffer size failures are non-critical (kernel may choose different sizes)
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf_size, sizeof(rcvbuf_size)) != 0) {
+        fprintf(stderr, "Warning: Failed to set SO_RCVBUF: %s\n", strerror(errno));
+    }
+    if (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf_size, sizeof(sndbuf_size)) != 0) {
+        fprintf(stderr, "Warning: Failed to set SO_SNDBUF: %s\n", strerror(errno));
+    }
+
+    // Check return values from critical setsockopt() calls
+    // Enable TCP_NODELAY to disable Nagle's algorithm (reduce latency)
+    int nodelay = 1;
+    if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)) != 0) {
+        fprintf(stderr, "Warning: Failed to set TCP_NODELAY: %s\n", strerror(errno));
+    }
+
+    // Enable SO_KEEPALIVE to detect dead connections
+    int keepalive = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &keepalive, sizeof(keepalive)) != 0) {
+        fprintf(stderr, "Warning: Failed to set SO_KEEPALIVE: %s\n", strerror(errno));
+    }
+
+#ifdef __APPLE__
+    // macOS-specific socket optimizations
+    // Set TCP_NOOPT to disable TCP options processing for lower latency
+    int tcp_noopt = 1;
+    if (setsockopt(fd, IPPROTO_TCP, TCP_NOOPT, &tcp_noopt, sizeof(tcp_noopt)) != 0) {
+        fprintf(stderr, "Warning: Failed to set TCP_NOOPT: %s\n", strerror(errno));
+    }
+
+    // Set SO_NOSIGPIPE to prevent SIGPIPE on broken connections
+    int nosigpipe = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &nosigpipe, sizeof(nosigpipe)) != 0) {
+        fprintf(stderr, "Warning: Failed to set SO_NOSIGPIPE: %s\n", strerror(errno));
+    }
+#endif
+
+#ifdef HW_TIMESTAMPING_SUPPORTED
+    // Hardware timestamping support (Linux only)
+    // Set WS_ENABLE_HW_TIMESTAMPS=1 for full latency visibility (HW→EVENT→SSL→APP)
+    // TLS reads go through the timestamp BIO (recvmsg with cmsgs), which also accepts the kTLS
+    // keys, so kTLS stays on; once RX is offloaded on TLS 1.2, ssl_read_into() skips SSL_read
+    const char *enable_hw_ts = getenv("WS_ENABLE_HW_TIMESTAMPS");
+    if (env_is_enabled(enable_hw_ts)) {
+        int timestamping_flags = SOF_TIMESTAMPING_RX_HARDWARE |
+                                 SOF_TIMESTAMPING_RX_SOFTWARE |
+                                 SOF_TIMESTAMPING_SOFTWARE |
+                                 SOF_TIMESTAMPING_RAW_HARDWARE;
+
+        if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING,
+                       &timestamping_flags, sizeof(timestamping_flags)) == 0) {
+            const char *debug = getenv("WS_DEBUG_KTLS");
+            if (env_is_enabled(debug)) {
+                fprintf(stderr, "[HW Timestamps] Enabled\n");
+            }
+            return 1;
+        }
+    }
+    // If not explicitly enabled, timestamping stays off and kTLS can activate
+#endif
+    return 0;
+}
+
+int tcp_connect_blocking(const char *hostname, int port, int *hw_timestamping) {
+    *hw_timestamping = 0;
+
+    // Use getaddrinfo() instead of deprecated gethostbyname()
+    struct addrinfo hints, *result = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    // Port string buffer: "65535\0" = 6 bytes (max port) + safety margin
+    char port_str[8];
+    _Static_assert(sizeof(port_str) > 6, "port_str buffer must fit max port (65535) + null");
+    snprintf(port_str, sizeof(port_str), "%d", port);
+
+    if (getaddrinfo(hostname, port_str, &hints, &result) != 0) {
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        freeaddrinfo(result);
+        return -1;
+    }
+
+    *hw_timestamping = tcp_configure_socket(fd);
+
+    // Use non-blocking connect with timeout to avoid stalling application
+    // (kTLS requires blocking mode, but we can temporarily switch for connect)
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        close(fd);
+        freeaddrinfo(result);
+        return -1;
+    }
+
+    // Attempt non-blocking connect
+    int connect_result = connect(fd, result->ai_addr, result->ai_addrlen);
+    freeaddrinfo(result);
+
+    if (connect_result < 0) {
+        if (errno != EINPROGRESS) {
+            // Immediate connection failure
+            close(fd);
+            return -1;
+        }
+
+        // Connection in progress - wait with timeout (5 seconds for HFT)
+
+        // CRITICAL: Check FD_SETSIZE before using select()
+        // FD_SET() has no bounds checking and will cause buffer overflow if fd >= FD_SETSIZE
+        // Common in production servers with many open files (logs, DB connections, etc.)
+        if (fd >= FD_SETSIZE) {
+            // File descriptor too high for select() - fail with diagnostic
+            fprintf(stderr, "ERROR: Socket FD %d >= FD_SETSIZE %d. Close unused files or use poll() instead of select().\n",
+                    fd, FD_SETSIZE);
+            close(fd);
+            return -1;
+        }
+
+        fd_set write_fds;
+        struct timeval timeout;
+        timeout.tv_sec = 5;
+        timeout.tv_usec = 0;
+
+        FD_ZERO(&write_fds);
+        FD_SET(fd, &write_fds);
+
+        if (select(fd + 1, NULL, &write_fds, NULL, &timeout) <= 0) {
+            // Timeout or error
+            close(fd);
+            return -1;
+        }
+
+        // Check if connection succeeded
+        int so_error;
+        socklen_t len = sizeof(so_error);
+        if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &so_error, &len) < 0 || so_error != 0) {
+            close(fd);
+            return -1;
+        }
+    }
+
+    // Restore blocking mode (OpenSSL's kTLS has issues activating on non-blocking sockets)
+    if (fcntl(fd, F_SETFL, flags) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+tcp_connect_t *tcp_connect_start(const char *hostname) {
+    tcp_connect_t *cs = (tcp_connect_t *)calloc(1, sizeof(tcp_connect_t));
+    if (!cs) return NULL;
+    for (int i = 0; i < WS_RESOLVER_MAX_ADDRS; i++) {
+        cs->fds[i] = -1;
+    }
+    cs->deadline_ns = tcp_now_ns() + TCP_CONNECT_TIMEOUT_NS;
+
+    // Kick off the lookup now so it overlaps with whatever the caller does next
+    ws_resolver_prefetch(hostname);
+    return cs;
+}
+
+// Close every attempt socket except keep (-1 = all)
+static void tcp_connect_close(tcp_connect_t *cs, int keep) {
+    for (int i = 0; i < WS_RESOLVER_MAX_ADDRS; i++) {
+        if (cs->fds[i] >= 0 && cs->fds[i] != keep) {
+            close(cs->fds[i]);
+        }
+        cs->fds[i] = -1;
+    }
+    cs->active = 0;
+}
+
+void tcp_connect_abort(tcp_connect_t *cs) {
+    if (!cs) return;
+    tcp_connect_close(cs, -1);
+    free(cs);
+}
+
+// Start candidate i: returns 1 if connected immediately, 0 if in progress, -1 on failure
+static int tcp_attempt_start(tcp_connect_t *cs, int i) {
+    const struct sockaddr_storage *ss = &cs->addrs.addrs[i];
+    int fd = socket(ss->ss_family, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    // Non-blocking from the start: connect, TLS and the HTTP upgrade all progress
+    // from ws_update() without stalling the other connections on this thread
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        close(fd);
+        return -1;
+    }
+    cs->hw_timestamping = tcp_configure_socket(fd);
+
+    cs->fds[i] = fd;
+    if (connect(fd, (const struct sockaddr *)ss, cs->addrs.lens[i]) == 0) return 1;
+    if (errno != EINPROGRESS) {
+        close(fd);
+        cs->fds[i] = -1;
+        return -1;
+    }
+    cs->active++;
+    return 0;
+}
+
+// One non-blocking step of the connect race (RFC 8305): a new attempt starts every
+// TCP_ATTEMPT_DELAY_NS or as soon as one fails, the first socket to connect wins
+int tcp_connect_step(tcp_connect_t *cs, const char *hostname, int port, int *fd, int *hw_timestamping) {
+    uint64_t now = tcp_now_ns();
+    if (__builtin_expect(now >= cs->deadline_ns, 0)) return -1;
+
+    if (!cs->resolved) {
+        int r = ws_resolver_lookup(hostname, port, &cs->addrs);
+        if (r <= 0) return r;
+        cs->resolved = 1;
+        cs->next_attempt_ns = now;
+    }
+
+    int winner = -1;
+    while (cs->next < cs->addrs.count && (cs->active == 0 || now >= cs->next_attempt_ns)) {
+        int i = cs->next++;
+        int r = tcp_attempt_start(cs, i);
+        if (r == 1) {
+            winner = i;
+            break;
+        }
+        if (r == 0) {
+            cs->next_attempt_ns = now + TCP_ATTEMPT_DELAY_NS;
+            break;
+        }
+        // Immediate failure (e.g. no route for that family): try the next candidate now
+    }
+
+    if (winner < 0 && cs->active > 0) {
+        struct pollfd pfds[WS_RESOLVER_MAX_ADDRS];
+        int idx[WS_RESOLVER_MAX_ADDRS];
+        int n = 0;
+        for (int i = 0; i < cs->next; i++) {
+            if (cs->fds[i] < 0) continue;
+            pfds[n].fd = cs->fds[i];
+            pfds[n].events = POLLOUT;
+            pfds[n].revents = 0;
+            idx[n++] = i;
+        }
+        if (poll(pfds, (nfds_t)n, 0) > 0) {
+            for (int k = 0; k < n && winner < 0; k++) {
+                if (!(pfds[k].revents & (POLLOUT | POLLERR | POLLHUP))) continue;
+                int so_error = 0;
+                socklen_t len = sizeof(so_error);
+                if (getsockopt(pfds[k].fd, SOL_SOCKET, SO_ERROR, &so_error, &len) == 0 && so_error == 0) {
+                    winner = idx[k];
+                    break;
+                }
+                close(pfds[k].fd);
+                cs->fds[idx[k]] = -1;
+                cs->active--;
+                cs->next_attempt_ns = now;  // A failed attempt starts the next one right away
+            }
+        }
+    }
+
+    if (winner >= 0) {
+        *fd = cs->fds[winner];
+        *hw_timestamping = cs->hw_timestamping;
+        tcp_connect_close(cs, *fd);  // Close the losing attempts
+        free(cs);
+        return 1;
+    }
+    if (cs->active == 0 && cs->next >= cs->addrs.count) return -1;
+    return 0;
+}
+
+static tcp_context_t *tcp_context_new(const char *hostname, int port) {
+    if (!hostname || port <= 0 || port > 65535) return NULL;
+    tcp_context_t *ctx = (tcp_context_t *)calloc(1, sizeof(tcp_context_t));
+    if (!ctx) return NULL;
+    ctx->hostname = strdup(hostname);
+    if (!ctx->hostname) {
+        free(ctx);
+        return NULL;
+    }
+    ctx->port = port;
+    ctx->sockfd = -1;
+    return ctx;
+}
+
+tcp_context_t *tcp_init(const char *hostname, int port) {
+    tcp_context_t *ctx = tcp_context_new(hostname, port);
+    if (!ctx) return NULL;
+
+    ctx->sockfd = tcp_connect_blocking(hostname, port, &ctx->hw_timestamping_enabled);
+    if (ctx->sockfd < 0) {
+        tcp_free(ctx);
+        return NULL;
+    }
+    // No TLS handshake to wait for: the upgrade and every read are non-blocking
+    int flags = fcntl(ctx->sockfd, F_GETFL, 0);
+    if (flags < 0 || fcntl(ctx->sockfd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        tcp_free(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+tcp_context_t *tcp_init_async(const char *hostname, int port) {
+    tcp_context_t *ctx = tcp_context_new(hostname, port);
+    if (!ctx) return NULL;
+    ctx->connecting = tcp_connect_start(hostname);
+    if (!ctx->connecting) {
+        tcp_free(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+void tcp_free(tcp_context_t *ctx) {
+    if (!ctx) return;
+    tcp_connect_abort(ctx->connecting);
+    if (ctx->sockfd >= 0) close(ctx->sockfd);
+    free(ctx->hostname);
+    free(ctx);
+}
+
+int tcp_handshake(tcp_context_t *ctx) {
+    if (!ctx) return -1;
+    if (__builtin_expect(ctx->connecting == NULL, 1)) return ctx->sockfd >= 0 ? 1 : -1;
+
+    int r = tcp_connect_step(ctx->connecting, ctx->hostname, ctx->port, &ctx->sockfd,
+                             &ctx->hw_timestamping_enabled);
+    if (r == 1) ctx->connecting = NULL;
+    return r;
+}
+
+int tcp_send(tcp_context_t *ctx, const uint8_t *data, size_t len) {
+    if (__builtin_expect(!ctx || ctx->sockfd < 0, 0)) return -1;
+    if (len > INT_MAX) len = INT_MAX;
+
+    ssize_t sent = send(ctx->sockfd, data, len, MSG_NOSIGNAL);
+    if (__builtin_expect(sent < 0, 0)) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return 0;  // Would block, not an error
+        }
+        return -1;
+    }
+    return (int)sent;
+}
+
+int tcp_read_into(tcp_context_t *ctx, uint8_t *buf, size_t len) {
+    if (__builtin_expect(!ctx || ctx->sockfd < 0, 0)) return -1;
+    if (len > INT_MAX) len = INT_MAX;
+
+    ssize_t n;
+#ifdef __linux__
+    if (ctx->hw_timestamping_enabled) {
+        uint8_t record_type;
+        n = bio_ts_recvmsg(ctx->sockfd, buf, len, &ctx->ts, &record_type);
+    } else
+#endif
+    {
+        n = recv(ctx->sockfd, buf, len, 0);
+    }
+    if (__builtin_expect(n > 0, 1)) return (int)n;
+
+    if (n < 0) {
+        ctx->rx_failed = !(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+        return -1;
+    }
+    ctx->rx_failed = 1;  // EOF
+    return 0;
+}
+
+int tcp_read_failed(tcp_context_t *ctx, int ret) {
+    if (!ctx) return 1;
+    if (ret > 0) return 0;
+    return ret == 0 || ctx->rx_failed;
+}
+
+int tcp_get_fd(tcp_context_t *ctx) {
+    if (!ctx) return -1;
+    return ctx->sockfd;
+}
+
+int tcp_hw_timestamping_enabled(tcp_context_t *ctx) {
+    if (!ctx) return 0;
+    return ctx->hw_timestamping_enabled;
+}
+
+uint64_t tcp_get_hw_timestamp(tcp_context_t *ctx) {
+    if (!ctx || !ctx->hw_timestamping_enabled) return 0;
+#ifdef __linux__
+    return ctx->ts.hw_timestamp_ns;
+#else
+    return 0;
+#endif
+}
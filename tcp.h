@@ -0,0 +1,56 @@
+#ifndef TCP_H
+#define TCP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Plain TCP connections: the ws:// transport, and the connect machinery ssl.c builds on
+// (socket options, blocking connect, the Happy Eyeballs race of ssl_init_async)
+
+typedef struct tcp_connect tcp_connect_t;
+typedef struct tcp_context tcp_context_t;
+
+// Latency socket options (buffers, TCP_NODELAY, keepalive) and, with WS_ENABLE_HW_TIMESTAMPS=1,
+// SO_TIMESTAMPING. Returns 1 if RX timestamping is on for fd
+int tcp_configure_socket(int fd);
+
+// Blocking IPv4 connect with a 5 s timeout; the socket is left in blocking mode
+// *hw_timestamping = tcp_configure_socket()'s result. Returns the fd, -1 on failure
+int tcp_connect_blocking(const char *hostname, int port, int *hw_timestamping);
+
+// Non-blocking connect race: DNS through the ws_resolver cache, then RFC 8305 attempts
+// across the candidates with a 5 s budget. Starts the lookup; returns NULL on allocation failure
+tcp_connect_t *tcp_connect_start(const char *hostname);
+
+// One step of the race, never blocks. 1 = connected (*fd and *hw_timestamping set, cs freed),
+// 0 = in progress, -1 = every candidate failed or the budget ran out (free with tcp_connect_abort)
+int tcp_connect_step(tcp_connect_t *cs, const char *hostname, int port, int *fd, int *hw_timestamping);
+
+// Close every attempt still in flight and free the state
+void tcp_connect_abort(tcp_connect_t *cs);
+
+// ws:// transport: same calling conventions as the ssl_* functions of ssl.h
+tcp_context_t *tcp_init(const char *hostname, int port);
+tcp_context_t *tcp_init_async(const char *hostname, int port);
+void tcp_free(tcp_context_t *ctx);
+
+// 1 = connected, 0 = connect in progress (tcp_init_async), -1 = failed
+int tcp_handshake(tcp_context_t *ctx);
+
+// Bytes written, 0 = would block, -1 = error
+int tcp_send(tcp_context_t *ctx, const uint8_t *data, size_t len);
+
+// recv() straight into buf (recvmsg() with the RX timestamp when timestamping is on)
+// Returns bytes read, 0 on EOF, -1 when drained or on error (see tcp_read_failed)
+int tcp_read_into(tcp_context_t *ctx, uint8_t *buf, size_t len);
+
+// Returns 1 if a read result (<= 0) means the connection is gone, 0 if merely drained
+int tcp_read_failed(tcp_context_t *ctx, int ret);
+
+int tcp_get_fd(tcp_context_t *ctx);
+int tcp_hw_timestamping_enabled(tcp_context_t *ctx);
+
+// NIC timestamp of the last read in nanoseconds, 0 if not available
+uint64_t tcp_get_hw_timestamp(tcp_context_t *ctx);
+
+#endif // TCP_H
@@ -0,0 +1,194 @@
+#include "../ws_deflate.h"
+#include "../os.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#ifdef WS_HAVE_ZLIB
+#include <zlib.h>
+
+#define MESSAGE_COUNT 20000
+#define WARMUP_MESSAGES 1000
+#define MAX_MESSAGE 8192
+
+typedef struct {
+    uint8_t *raw;
+    size_t raw_len;
+    uint8_t *comp;
+    size_t comp_len;
+} message_t;
+
+static int compare_uint64(const void *a, const void *b) {
+    uint64_t val_a = *(const uint64_t *)a;
+    uint64_t val_b = *(const uint64_t *)b;
+    if (val_a < val_b) return -1;
+    if (val_a > val_b) return 1;
+    return 0;
+}
+
+// Order book depth update in the shape most exchanges publish (10-40 levels per side)
+static size_t make_depth_update(char *buf, size_t cap, uint64_t seq, uint32_t *rng) {
+    size_t pos = 0;
+    *rng = *rng * 1103515245u + 12345u;
+    int levels = 10 + (int)((*rng >> 16) % 31);
+    double mid = 67000.0 + (double)((*rng >> 8) % 2000) / 10.0;
+
+    pos += (size_t)snprintf(buf + pos, cap - pos,
+        "{\"stream\":\"btcusdt@depth@100ms\",\"data\":{\"e\":\"depthUpdate\",\"E\":%" PRIu64
+        ",\"s\":\"BTCUSDT\",\"U\":%" PRIu64 ",\"u\":%" PRIu64 ",\"b\":[",
+        (uint64_t)1730000000000ULL + seq * 100, seq * 7, seq * 7 + 6);
+    for (int i = 0; i < levels && pos < cap - 64; i++) {
+        *rng = *rng * 1103515245u + 12345u;
+        pos += (size_t)snprintf(buf + pos, cap - pos, "%s[\"%.2f\",\"%.5f\"]",
+            i ? "," : "", mid - 0.1 * i, (double)((*rng >> 12) % 500000) / 100000.0);
+    }
+    pos += (size_t)snprintf(buf + pos, cap - pos, "],\"a\":[");
+    for (int i = 0; i < levels && pos < cap - 64; i++) {
+        *rng = *rng * 1103515245u + 12345u;
+        pos += (size_t)snprintf(buf + pos, cap - pos, "%s[\"%.2f\",\"%.5f\"]",
+            i ? "," : "", mid + 0.1 * (i + 1), (double)((*rng >> 12) % 500000) / 100000.0);
+    }
+    pos += (size_t)snprintf(buf + pos, cap - pos, "]}}");
+    return pos;
+}
+
+// Compress like a permessage-deflate server: raw deflate, sync flush, tail stripped
+static int build_corpus(message_t *msgs, int count, int no_context_takeover) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return -1;
+    }
+
+    char buf[MAX_MESSAGE];
+    uint32_t rng = 42;
+    for (int i = 0; i < count; i++) {
+        size_t len = make_depth_update(buf, sizeof(buf), (uint64_t)i, &rng);
+        msgs[i].raw = (uint8_t *)malloc(len);
+        msgs[i].raw_len = len;
+        memcpy(msgs[i].raw, buf, len);
+
+        size_t bound = deflateBound(&zs, len) + 16;
+        msgs[i].comp = (uint8_t *)malloc(bound);
+        zs.next_in = (Bytef *)msgs[i].raw;
+        zs.avail_in = (uInt)len;
+        zs.next_out = msgs[i].comp;
+        zs.avail_out = (uInt)bound;
+        if (deflate(&zs, Z_SYNC_FLUSH) != Z_OK) {
+            deflateEnd(&zs);
+            return -1;
+        }
+        msgs[i].comp_len = bound - zs.avail_out - 4;  // Strip 00 00 FF FF
+        if (no_context_takeover) {
+            deflateReset(&zs);
+        }
+    }
+
+    deflateEnd(&zs);
+    return 0;
+}
+
+static void free_corpus(message_t *msgs, int count) {
+    for (int i = 0; i < count; i++) {
+        free(msgs[i].raw);
+        free(msgs[i].comp);
+    }
+}
+
+static int run_case(const char *name, int no_context_takeover) {
+    message_t *msgs = (message_t *)calloc(MESSAGE_COUNT, sizeof(message_t));
+    uint64_t *samples = (uint64_t *)malloc(MESSAGE_COUNT * sizeof(uint64_t));
+    if (!msgs || !samples || build_corpus(msgs, MESSAGE_COUNT, no_context_takeover) < 0) {
+        printf("  ✗ Failed to build corpus\n");
+        free(msgs);
+        free(samples);
+        return 1;
+    }
+
+    size_t raw_total = 0, comp_total = 0;
+    for (int i = 0; i < MESSAGE_COUNT; i++) {
+        raw_total += msgs[i].raw_len;
+        comp_total += msgs[i].comp_len;
+    }
+
+    // Uncompressed path baseline: the library hands out the ring pointer, so the
+    // only cost is the application touching the payload once
+    uint64_t sink = 0;
+    uint64_t start = os_get_cpu_cycle();
+    for (int i = 0; i < MESSAGE_COUNT; i++) {
+        const uint8_t *p = msgs[i].raw;
+        for (size_t j = 0; j < msgs[i].raw_len; j += 64) sink += p[j];
+        __asm__ __volatile__("" : "+r"(sink));  // Keep the touch loop
+    }
+    double plain_ns = os_cycles_to_ns(os_get_cpu_cycle() - start) / MESSAGE_COUNT;
+
+    ws_inflater_t *inf = ws_inflater_create(64 * 1024, no_context_takeover);
+    int mismatches = 0;
+    for (int i = 0; i < MESSAGE_COUNT; i++) {
+        size_t out_len = 0;
+        uint64_t t0 = os_get_cpu_cycle();
+        const uint8_t *out = ws_inflater_message(inf, msgs[i].comp, msgs[i].comp_len, &out_len);
+        uint64_t t1 = os_get_cpu_cycle();
+        samples[i] = t1 - t0;
+        if (!out || out_len != msgs[i].raw_len || memcmp(out, msgs[i].raw, out_len) != 0) {
+            mismatches++;
+            continue;
+        }
+        sink += out[0];
+    }
+
+    uint64_t total_cycles = 0;
+    for (int i = WARMUP_MESSAGES; i < MESSAGE_COUNT; i++) total_cycles += samples[i];
+    qsort(samples + WARMUP_MESSAGES, MESSAGE_COUNT - WARMUP_MESSAGES, sizeof(uint64_t), compare_uint64);
+    int measured = MESSAGE_COUNT - WARMUP_MESSAGES;
+    double mean_ns = os_cycles_to_ns(total_cycles) / measured;
+    double p50_ns = os_cycles_to_ns(samples[WARMUP_MESSAGES + measured / 2]);
+    double p99_ns = os_cycles_to_ns(samples[WARMUP_MESSAGES + (int)(measured * 0.99)]);
+
+    double avg_raw = (double)raw_total / MESSAGE_COUNT;
+    double avg_comp = (double)comp_total / MESSAGE_COUNT;
+
+    printf("=== %s ===\n", name);
+    printf("  Messages:          %d (avg %.0f bytes raw, %.0f bytes on wire)\n", MESSAGE_COUNT, avg_raw, avg_comp);
+    printf("  Compression ratio: %.2fx\n", avg_raw / avg_comp);
+    printf("  Correctness:       %s\n", mismatches ? "✗ MISMATCH" : "✓ all messages round-trip");
+    printf("  Uncompressed path: %8.1f ns/msg (zero-copy, payload touch only)\n", plain_ns);
+    printf("  Inflate path:      %8.1f ns/msg mean, %.1f p50, %.1f p99 (%.0f MB/s output)\n",
+           mean_ns, p50_ns, p99_ns, avg_raw / mean_ns * 1000.0);
+    printf("  Arena high-water:  %zu bytes\n", ws_inflater_arena_size(inf));
+    printf("  Wire time saved per message vs inflate cost:\n");
+    static const double LINK_MBPS[] = {50.0, 100.0, 1000.0, 10000.0};
+    for (int i = 0; i < 4; i++) {
+        double saved_ns = (avg_raw - avg_comp) * 8.0 / LINK_MBPS[i] * 1000.0;
+        printf("    %6.0f Mbit/s: %9.1f ns saved, net %+9.1f ns  %s\n", LINK_MBPS[i], saved_ns,
+               saved_ns - (mean_ns - plain_ns), saved_ns > mean_ns - plain_ns ? "(compression wins)" : "(plain wins)");
+    }
+    printf("\n");
+    (void)sink;
+
+    ws_inflater_free(inf);
+    free_corpus(msgs, MESSAGE_COUNT);
+    free(msgs);
+    free(samples);
+    return mismatches;
+}
+
+int main(void) {
+    printf("╔══════════════════════════════════════════════════════════════════╗\n");
+    printf("║              permessage-deflate Inflate Benchmark                ║\n");
+    printf("╚══════════════════════════════════════════════════════════════════╝\n\n");
+
+    int failures = run_case("Context takeover (shared window)", 0);
+    failures += run_case("server_no_context_takeover", 1);
+    return failures ? 1 : 0;
+}
+
+#else  // !WS_HAVE_ZLIB
+
+int main(void) {
+    printf("permessage-deflate benchmark requires zlib (build with WS_DEFLATE=1)\n");
+    return 0;
+}
+
+#endif // WS_HAVE_ZLIB
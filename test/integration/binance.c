@@ -19,7 +19,7 @@
 
 // Timing record for each message - pre-allocated to avoid I/O during measurement
 typedef struct {
-    uint64_t hw_timestamp_ns;    // Stage 1: NIC hardware timestamp in nanoseconds (if available)
+    uint64_t hw_timestamp_ns;    // Stage 1: NIC hardware timestamp in nanoseconds, CLOCK_REALTIME domain (if available)
     uint64_t event_cycle;        // Stage 2: When event loop received data (TSC cycles)
     uint64_t recv_start_cycle;   // Stage 3: Before SSL_read/recv call (TSC cycles)
     uint64_t recv_end_cycle;     // Stage 4: When SSL_read/recv completed (TSC cycles)
@@ -35,8 +35,6 @@ static int message_count = 0;
 static int runs_reported = 0;
 static timing_record_t timing_records[MAX_MESSAGES];
 static int hw_timestamping_available = 0;
-static uint64_t hw_timestamp_baseline_ns = 0;  // Baseline for hardware timestamps
-static uint64_t event_timestamp_baseline_ns = 0;  // Baseline for event timestamps
 
 // Forward declarations
 static double cycles_to_nanoseconds(uint64_t cycles);
@@ -69,24 +67,7 @@ void on_message(websocket_context_t *ws, const uint8_t *payload_ptr, size_t payl
     record->opcode = opcode;
 
     // Capture hardware NIC timestamp if available
-    if (hw_timestamping_available) {
-        uint64_t hw_ts = ws_get_hw_timestamp(ws);
-
-        // Initialize baseline on first message with valid HW timestamp
-        if (hw_timestamp_baseline_ns == 0 && hw_ts != 0) {
-            hw_timestamp_baseline_ns = hw_ts;
-            event_timestamp_baseline_ns = (uint64_t)cycles_to_nanoseconds(event_cycle);
-        }
-
-        // Store relative timestamp (relative to baseline)
-        if (hw_ts != 0 && hw_timestamp_baseline_ns != 0) {
-            record->hw_timestamp_ns = hw_ts - hw_timestamp_baseline_ns;
-        } else {
-            record->hw_timestamp_ns = 0;
-        }
-    } else {
-        record->hw_timestamp_ns = 0;
-    }
+    record->hw_timestamp_ns = hw_timestamping_available ? ws_get_hw_timestamp(ws) : 0;
 
     message_count++;
 
@@ -207,12 +188,11 @@ static void print_run_statistics(int run_index) {
         parsed_callback[i] = timing_records[idx].callback_cycle - timing_records[idx].frame_parsed_cycle;
 
         // Stage 1: HW→EVENT latency (only valid if HW timestamp available)
-        if (hw_timestamping_available && timing_records[idx].hw_timestamp_ns != 0 && event_timestamp_baseline_ns != 0) {
-            double event_ns_absolute = cycles_to_nanoseconds(timing_records[idx].event_cycle);
-            double event_ns_relative = event_ns_absolute - event_timestamp_baseline_ns;
-            double hw_ns_relative = (double)timing_records[idx].hw_timestamp_ns;
-            double hw_event_ns = event_ns_relative - hw_ns_relative;
-            hw_event_latencies[i] = (hw_event_ns >= 0) ? (uint64_t)hw_event_ns : 0;
+        // Both stamps on the CLOCK_REALTIME timeline: a plain difference
+        if (hw_timestamping_available && timing_records[idx].hw_timestamp_ns != 0) {
+            uint64_t event_real_ns = os_cycles_to_realtime_ns(timing_records[idx].event_cycle);
+            uint64_t hw_ns = timing_records[idx].hw_timestamp_ns;
+            hw_event_latencies[i] = event_real_ns > hw_ns ? event_real_ns - hw_ns : 0;
         } else {
             hw_event_latencies[i] = 0;
         }
@@ -643,9 +623,8 @@ int main(int argc, char *argv[]) {
         printf("   Latency Tracking: HW→EVENT, EVENT→SSL, SSL→APP breakdown available\n");
     } else {
 #ifdef __linux__
-        printf("   Status: ❌ DISABLED (default - kTLS mode active)\n");
-        printf("   Reason: Hardware timestamps disabled to allow kTLS kernel offload\n");
-        printf("   Enable: Set WS_ENABLE_HW_TIMESTAMPS=1 to enable (disables kTLS)\n");
+        printf("   Status: ❌ DISABLED (default)\n");
+        printf("   Enable: Set WS_ENABLE_HW_TIMESTAMPS=1 to enable (kTLS stays active)\n");
         printf("   Latency Tracking: EVENT→SSL, SSL→APP breakdown only\n");
 #else
         printf("   Status: ❌ NOT AVAILABLE (Linux-only feature)\n");
@@ -707,7 +686,7 @@ int main(int argc, char *argv[]) {
     if (connected) {
         int fd = ws_get_fd(ws);
         if (fd >= 0) {
-            if (ws_notifier_add(notifier, fd, WS_EVENT_READ) < 0) {
+            if (ws_notifier_add(notifier, fd, WS_EVENT_READ, ws) < 0) {
                 fprintf(stderr, "❌ Failed to register fd with notifier\n");
                 running = 0;
             }
@@ -619,7 +619,7 @@ int main(int argc, char *argv[]) {
     if (connected) {
         int fd = ws_get_fd(ws);
         if (fd >= 0) {
-            if (ws_notifier_add(notifier, fd, WS_EVENT_READ) < 0) {
+            if (ws_notifier_add(notifier, fd, WS_EVENT_READ, ws) < 0) {
                 fprintf(stderr, "❌ Failed to register fd with notifier\n");
                 running = 0;
             }
@@ -0,0 +1,149 @@
+#include "../ws_mask.h"
+#include "../os.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#define BENCHMARK_BYTES (64u * 1024u * 1024u)  // Bytes masked per size/variant
+#define MAX_PAYLOAD 65536
+#define SIZES_COUNT 10
+
+// Payload sizes (bytes) - odd sizes exercise head/tail handling
+static const size_t SIZES[SIZES_COUNT] = {
+    6, 15, 32, 125, 256, 1024, 1500, 4096, 16384, 65536
+};
+
+// Reference: the byte loop previously inlined in ws_send()
+static void mask_reference(uint8_t *dst, const uint8_t *src, size_t len, uint32_t key) {
+    uint8_t mask[4];
+    mask[0] = (key >> 0) & 0xFF;
+    mask[1] = (key >> 8) & 0xFF;
+    mask[2] = (key >> 16) & 0xFF;
+    mask[3] = (key >> 24) & 0xFF;
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = src[i] ^ mask[i & 3];
+    }
+}
+
+typedef void (*mask_fn)(uint8_t *dst, const uint8_t *src, size_t len, uint32_t key);
+
+// Every length 0..300 at every dst/src misalignment 0..7
+static int check_correctness(uint8_t *src, uint8_t *dst, uint8_t *expect) {
+    int failures = 0;
+    uint32_t key = 0xA1B2C3D4u;
+
+    for (size_t len = 0; len <= 300; len++) {
+        for (size_t dalign = 0; dalign < 8; dalign++) {
+            for (size_t salign = 0; salign < 8; salign++) {
+                mask_reference(expect, src + salign, len, key);
+                ws_mask_apply(dst + dalign, src + salign, len, key);
+                if (memcmp(dst + dalign, expect, len) != 0) {
+                    if (failures++ < 5) {
+                        printf("  ✗ Mismatch: len=%zu dst_align=%zu src_align=%zu\n", len, dalign, salign);
+                    }
+                }
+            }
+        }
+        key = key * 1103515245u + 12345u;
+    }
+
+    // In-place masking twice must restore the original
+    memcpy(dst, src, MAX_PAYLOAD);
+    ws_mask_apply(dst + 3, dst + 3, 4099, key);
+    ws_mask_apply(dst + 3, dst + 3, 4099, key);
+    if (memcmp(dst, src, MAX_PAYLOAD) != 0) {
+        printf("  ✗ In-place round trip failed\n");
+        failures++;
+    }
+
+    // Forward overlap (dst < src) used when ws_send_commit() slides the payload down
+    for (size_t shift = 2; shift <= 8; shift += 2) {
+        memcpy(dst, src, MAX_PAYLOAD);
+        mask_reference(expect, src + shift, 3000, key);
+        ws_mask_apply(dst, dst + shift, 3000, key);
+        if (memcmp(dst, expect, 3000) != 0) {
+            printf("  ✗ Forward overlap (shift %zu) failed\n", shift);
+            failures++;
+        }
+    }
+
+    // Split masking with a rotated key must match one-shot masking
+    mask_reference(expect, src, 1000, key);
+    ws_mask_apply(dst, src, 333, key);
+    ws_mask_apply(dst + 333, src + 333, 667, ws_mask_rotate(key, 333));
+    if (memcmp(dst, expect, 1000) != 0) {
+        printf("  ✗ Rotated key continuation failed\n");
+        failures++;
+    }
+
+    return failures;
+}
+
+// Returns throughput in GB/s (bytes per ns)
+static double run_one(mask_fn fn, uint8_t *dst, const uint8_t *src, size_t len, uint32_t key) {
+    size_t iterations = BENCHMARK_BYTES / len;
+    if (iterations < 1000) iterations = 1000;
+
+    // Warmup
+    for (size_t i = 0; i < 1000; i++) {
+        fn(dst, src, len, key);
+    }
+
+    uint64_t start = os_get_cpu_cycle();
+    for (size_t i = 0; i < iterations; i++) {
+        fn(dst, src, len, key);
+        __asm__ __volatile__("" : : "r"(dst) : "memory");  // Keep stores observable
+    }
+    uint64_t end = os_get_cpu_cycle();
+
+    double ns = (double)os_cycles_to_ns(end - start);
+    return ns > 0 ? (double)(len * iterations) / ns : 0.0;
+}
+
+int main(void) {
+    printf("╔══════════════════════════════════════════════════════════════════╗\n");
+    printf("║                 WebSocket Masking Benchmark                      ║\n");
+    printf("╚══════════════════════════════════════════════════════════════════╝\n\n");
+
+    uint8_t *src = NULL;
+    uint8_t *dst = NULL;
+    uint8_t *expect = NULL;
+    if (posix_memalign((void **)&src, 64, MAX_PAYLOAD + 64) != 0 ||
+        posix_memalign((void **)&dst, 64, MAX_PAYLOAD + 64) != 0 ||
+        posix_memalign((void **)&expect, 64, MAX_PAYLOAD + 64) != 0) {
+        fprintf(stderr, "Failed to allocate buffers\n");
+        return 1;
+    }
+    for (size_t i = 0; i < MAX_PAYLOAD + 64; i++) {
+        src[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    printf("Selected implementation: %s\n\n", ws_mask_get_impl_name());
+
+    printf("=== Correctness ===\n");
+    int failures = check_correctness(src, dst, expect);
+    if (failures) {
+        printf("  ✗ %d mismatches\n\n", failures);
+    } else {
+        printf("  ✓ All lengths 0-300, all alignments, in-place, overlapping and split masking\n\n");
+    }
+
+    printf("=== Throughput (GB/s) ===\n");
+    printf("  %8s  %12s  %12s  %12s  %8s\n", "Size", "byte loop", "scalar64", "dispatched", "Speedup");
+    for (int s = 0; s < SIZES_COUNT; s++) {
+        size_t len = SIZES[s];
+        uint32_t key = 0x12345678u;
+        double ref = run_one(mask_reference, dst, src, len, key);
+        double word = run_one(ws_mask_apply_scalar, dst, src, len, key);
+        double simd = run_one(ws_mask_apply, dst, src, len, key);
+        printf("  %8zu  %12.2f  %12.2f  %12.2f  %7.1fx\n", len, ref, word, simd, ref > 0 ? simd / ref : 0.0);
+    }
+    printf("\n");
+
+    free(src);
+    free(dst);
+    free(expect);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,287 @@
+// Replay Benchmark
+// Feeds a capture through ws_init_replay() and reports parse + callback throughput
+// Deterministic (no network, no TLS): use it to A/B parser or callback changes
+//
+// Usage: ./replay_benchmark [--iterations N] [--speed X] [--deflate] [--pipeline DEPTH]
+//                           [--profile NAME] [--synth SHAPE] [CAPTURE]
+//   CAPTURE       Raw RX stream (ws_trace_dump --raw) or ws_set_trace() file
+//                 Without one a synthetic market-data-like stream is generated
+//   --iterations  Replay the capture N times (default 20)
+//   --speed       0 = max speed (default), 1.0 = original timing (trace files)
+//   --deflate     Capture was recorded with permessage-deflate
+//   --pipeline    Deliver on a consumer thread through a DEPTH-descriptor queue
+//   --profile     Parser profile: generic (default), small, medium, large, or all to
+//                 replay the capture once per profile and compare each against generic
+//   --synth       Synthetic frame sizes: mixed (20-400 bytes, default), small (20-125),
+//                 medium (126-4000) or large (64-256 KB snapshots)
+
+#include "../ws.h"
+#include "../os.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define SYNTH_MESSAGES 200000
+#define SYNTH_LARGE_MESSAGES 2000
+
+static const char *const profile_names[WS_PARSER_PROFILES] = {"generic", "small", "medium", "large"};
+
+static uint64_t messages = 0;
+static uint64_t payload_bytes = 0;
+static uint64_t checksum = 0;
+
+// Touch the payload like a real handler would (first and last byte)
+static void on_msg(websocket_context_t *ws __attribute__((unused)), const uint8_t *payload, size_t len,
+                   uint8_t opcode __attribute__((unused))) {
+    messages++;
+    payload_bytes += len;
+    if (len) checksum += payload[0] + payload[len - 1];
+}
+
+// Pipeline consumer: drains until the IO loop is done and the queue is empty
+static volatile int io_done = 0;
+
+static void *consumer(void *arg) {
+    websocket_context_t *ws = (websocket_context_t *)arg;
+    while (!__atomic_load_n(&io_done, __ATOMIC_ACQUIRE) || ws_pipeline_backlog(ws) > 0) {
+        if (ws_pipeline_poll(ws, 0) == 0) sched_yield();  // Let the IO thread run on a shared core
+    }
+    return NULL;
+}
+
+// Synthetic frame size ranges
+typedef enum { SYNTH_MIXED = 0, SYNTH_SMALL, SYNTH_MEDIUM, SYNTH_LARGE } synth_shape_t;
+static const char *const synth_names[] = {"mixed", "small", "medium", "large"};
+
+// Unmasked server frames carrying JSON-ish ticker updates padded to the shape's sizes
+static int write_synthetic(const char *path, synth_shape_t shape, int count) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return -1;
+
+    static const size_t pad_range[][2] = {{0, 360}, {0, 60}, {90, 3900}, {65536, 196608}};
+    size_t max_pad = pad_range[shape][0] + pad_range[shape][1];
+    char *pad = (char *)malloc(max_pad);
+    char *payload = (char *)malloc(max_pad + 128);
+    if (!pad || !payload) {
+        free(pad);
+        free(payload);
+        fclose(f);
+        return -1;
+    }
+    memset(pad, '.', max_pad);
+
+    uint32_t seed = 12345;
+    for (int i = 0; i < count; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int n_pad = (int)(pad_range[shape][0] + (seed >> 8) % pad_range[shape][1]);
+        int n = snprintf(payload, max_pad + 128,
+                         "{\"e\":\"trade\",\"s\":\"BTCUSDT\",\"t\":%d,\"p\":\"%u.%02u\",\"q\":\"%u\",\"x\":\"%.*s\"}",
+                         i, 60000 + (seed >> 20) % 1000, (seed >> 8) % 100, (seed >> 4) % 50, n_pad, pad);
+        uint8_t hdr[10];
+        size_t hlen;
+        hdr[0] = 0x81;  // FIN + TEXT
+        if (n < 126) {
+            hdr[1] = (uint8_t)n;
+            hlen = 2;
+        } else if (n <= 65535) {
+            hdr[1] = 126;
+            hdr[2] = (uint8_t)(n >> 8);
+            hdr[3] = (uint8_t)n;
+            hlen = 4;
+        } else {
+            hdr[1] = 127;
+            for (int b = 0; b < 8; b++) hdr[2 + b] = (uint8_t)((uint64_t)n >> (56 - 8 * b));
+            hlen = 10;
+        }
+        fwrite(hdr, 1, hlen, f);
+        fwrite(payload, 1, (size_t)n, f);
+    }
+
+    free(pad);
+    free(payload);
+    fclose(f);
+    return 0;
+}
+
+typedef struct {
+    uint64_t best_cycles;
+    uint64_t total_cycles;
+    uint64_t messages;           // Per run
+    uint64_t bytes;
+    ws_stats_t stats;            // Last run
+} run_result_t;
+
+// Replay the capture `iterations` times with one parser profile
+static int run_profile(const char *capture, ws_parser_profile_t profile, int iterations, double speed,
+                       int deflate, size_t pipeline, run_result_t *r) {
+    r->best_cycles = UINT64_MAX;
+    r->total_cycles = 0;
+
+    for (int it = 0; it < iterations; it++) {
+        websocket_context_t *ws = ws_init_replay(capture, speed);
+        if (!ws) {
+            fprintf(stderr, "Cannot load capture %s\n", capture);
+            return -1;
+        }
+        ws_set_on_msg(ws, on_msg);
+        ws_set_parser_profile(ws, profile);
+        if (deflate && ws_set_permessage_deflate(ws, 1, 0) < 0) {
+            fprintf(stderr, "permessage-deflate unavailable (built without zlib)\n");
+            ws_free(ws);
+            return -1;
+        }
+
+        if (pipeline && ws_set_pipeline(ws, pipeline) < 0) {
+            fprintf(stderr, "Pipeline mode unavailable (needs a mirrored RX ring, no deflate)\n");
+            ws_free(ws);
+            return -1;
+        }
+
+        uint64_t before = messages;
+        uint64_t before_bytes = payload_bytes;
+        pthread_t thread;
+        io_done = 0;
+        if (pipeline && pthread_create(&thread, NULL, consumer, ws) != 0) {
+            fprintf(stderr, "Cannot start consumer thread\n");
+            ws_free(ws);
+            return -1;
+        }
+        uint64_t start = os_get_cpu_cycle();
+        while (ws_get_state(ws) == WS_STATE_CONNECTED) {
+            ws_update(ws);
+            if (pipeline && ws_pipeline_backlog(ws) >= pipeline) sched_yield();  // Queue full
+        }
+        if (pipeline) {
+            __atomic_store_n(&io_done, 1, __ATOMIC_RELEASE);
+            pthread_join(thread, NULL);  // Run ends when the consumer has seen every message
+        }
+        uint64_t cycles = os_get_cpu_cycle() - start;
+
+        r->total_cycles += cycles;
+        if (cycles < r->best_cycles) r->best_cycles = cycles;
+        r->messages = messages - before;
+        r->bytes = payload_bytes - before_bytes;
+        if (it == iterations - 1) ws_stats_snapshot(ws_get_stats(ws), &r->stats);
+        ws_free(ws);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int iterations = 20;
+    double speed = 0.0;
+    int deflate = 0;
+    size_t pipeline = 0;
+    int profile = WS_PARSER_GENERIC;  // WS_PARSER_PROFILES = all
+    synth_shape_t shape = SYNTH_MIXED;
+    const char *capture = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            speed = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--deflate") == 0) {
+            deflate = 1;
+        } else if (strcmp(argv[i], "--pipeline") == 0 && i + 1 < argc) {
+            pipeline = (size_t)atol(argv[++i]);
+        } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            const char *name = argv[++i];
+            for (profile = 0; profile < WS_PARSER_PROFILES; profile++) {
+                if (strcmp(name, profile_names[profile]) == 0) break;
+            }
+            if (profile == WS_PARSER_PROFILES && strcmp(name, "all") != 0) {
+                fprintf(stderr, "Unknown profile %s\n", name);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--synth") == 0 && i + 1 < argc) {
+            const char *name = argv[++i];
+            int s;
+            for (s = 0; s <= SYNTH_LARGE; s++) {
+                if (strcmp(name, synth_names[s]) == 0) break;
+            }
+            if (s > SYNTH_LARGE) {
+                fprintf(stderr, "Unknown synthetic shape %s\n", name);
+                return 1;
+            }
+            shape = (synth_shape_t)s;
+        } else if (argv[i][0] != '-' && !capture) {
+            capture = argv[i];
+        } else {
+            fprintf(stderr, "Usage: %s [--iterations N] [--speed X] [--deflate] [--pipeline DEPTH] "
+                            "[--profile generic|small|medium|large|all] [--synth mixed|small|medium|large] [CAPTURE]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (iterations < 1) iterations = 1;
+
+    char synth_path[] = "/tmp/ws_replay_synth_XXXXXX";
+    if (!capture) {
+        int count = shape == SYNTH_LARGE ? SYNTH_LARGE_MESSAGES : SYNTH_MESSAGES;
+        int fd = mkstemp(synth_path);
+        if (fd < 0 || (close(fd), write_synthetic(synth_path, shape, count)) < 0) {
+            fprintf(stderr, "Cannot write synthetic capture\n");
+            return 1;
+        }
+        capture = synth_path;
+        printf("Capture:    synthetic %s (%d text frames)\n", synth_names[shape], count);
+    } else {
+        printf("Capture:    %s\n", capture);
+    }
+
+    // Every profile against generic on the same capture
+    if (profile == WS_PARSER_PROFILES) {
+        printf("Iterations: %d per profile (speed %s)\n", iterations, speed > 0.0 ? "paced" : "max");
+        double generic_ns = 0.0;
+        for (int p = 0; p < WS_PARSER_PROFILES; p++) {
+            static run_result_t r;
+            if (run_profile(capture, (ws_parser_profile_t)p, iterations, speed, deflate, pipeline, &r) < 0 ||
+                r.messages == 0) {
+                if (capture == synth_path) unlink(synth_path);
+                return 1;
+            }
+            double ns = os_cycles_to_ns(r.best_cycles) / (double)r.messages;
+            if (p == WS_PARSER_GENERIC) generic_ns = ns;
+            const ws_histogram_t *parse = &r.stats.stages[WS_STAT_PARSE];
+            printf("  %-8s best %7.1f ns/msg  %+6.1f%% vs generic   parse p50 %.0f ns p99 %.0f ns\n",
+                   profile_names[p], ns, (ns - generic_ns) * 100.0 / generic_ns,
+                   os_cycles_to_ns(ws_hist_percentile(parse, 50.0)), os_cycles_to_ns(ws_hist_percentile(parse, 99.0)));
+        }
+        if (capture == synth_path) unlink(synth_path);
+        printf("Checksum:   %" PRIu64 "\n", checksum);
+        return 0;
+    }
+
+    static run_result_t r;
+    int rc = run_profile(capture, (ws_parser_profile_t)profile, iterations, speed, deflate, pipeline, &r);
+    if (capture == synth_path) unlink(synth_path);
+    if (rc < 0) return 1;
+
+    double best_ns = os_cycles_to_ns(r.best_cycles);
+    double mean_ns = os_cycles_to_ns(r.total_cycles / (uint64_t)iterations);
+    printf("Iterations: %d (speed %s, %s parser)\n", iterations, speed > 0.0 ? "paced" : "max", profile_names[profile]);
+    if (pipeline) printf("Pipeline:   depth %zu, queue full %" PRIu64 " times (last run)\n", pipeline, r.stats.pipeline_full);
+    printf("Per run:    %" PRIu64 " messages, %" PRIu64 " payload bytes, %" PRIu64 " batches\n",
+           r.messages, r.bytes, r.stats.reads);
+    if (r.messages == 0) {
+        printf("No messages decoded\n");
+        return 1;
+    }
+    printf("Best run:   %.3f ms  %.1f ns/msg  %.2f M msg/s  %.1f MB/s\n",
+           best_ns / 1e6, best_ns / (double)r.messages,
+           (double)r.messages * 1e3 / best_ns, (double)r.bytes * 1e3 / best_ns);
+    printf("Mean run:   %.3f ms  %.1f ns/msg\n", mean_ns / 1e6, mean_ns / (double)r.messages);
+
+    const ws_histogram_t *parse = &r.stats.stages[WS_STAT_PARSE];
+    const ws_histogram_t *dispatch = &r.stats.stages[WS_STAT_DISPATCH];
+    printf("Per batch (last run, ns):  parse p50 %.0f p99 %.0f   dispatch p50 %.0f p99 %.0f\n",
+           os_cycles_to_ns(ws_hist_percentile(parse, 50.0)), os_cycles_to_ns(ws_hist_percentile(parse, 99.0)),
+           os_cycles_to_ns(ws_hist_percentile(dispatch, 50.0)), os_cycles_to_ns(ws_hist_percentile(dispatch, 99.0)));
+    printf("Checksum:   %" PRIu64 "\n", checksum);
+    return 0;
+}
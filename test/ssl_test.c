@@ -232,6 +232,21 @@ static void test_ssl_handshake_no_connection(void **state) {
     ssl_free(ctx);
 }
 
+// Test: Session resumption queries before any handshake
+static void test_ssl_session_reused_before_handshake(void **state) {
+    (void)state;
+
+    assert_int_equal(ssl_session_reused(NULL), 0);
+
+    ssl_context_t *ctx = ssl_init_async("127.0.0.1", 9);
+    assert_non_null(ctx);
+    assert_int_equal(ssl_session_reused(ctx), 0);
+    assert_int_equal(ssl_get_fd(ctx), -1);  // No socket until the connect race starts
+    ssl_free(ctx);
+
+    ssl_session_cache_flush();  // Empty cache: must be a no-op
+}
+
 // Test: Multiple SSL contexts initialization (tests global context)
 static void test_ssl_multiple_init(void **state) {
     (void)state;
@@ -433,6 +448,7 @@ int main(void) {
         cmocka_unit_test(test_ssl_recv_null),
         cmocka_unit_test(test_ssl_recv_null_buffer),
         cmocka_unit_test(test_ssl_handshake_null),
+        cmocka_unit_test(test_ssl_session_reused_before_handshake),
         
         // Operation tests
         cmocka_unit_test(test_ssl_handshake_no_connection),
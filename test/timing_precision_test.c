@@ -430,6 +430,88 @@ static void test_long_duration(void) {
     test_result("1 second measurement accuracy", accurate, details);
 }
 
+// Test 9: Integer mult/shift conversion
+static void test_integer_conversion(void) {
+    printf("\n%s[Test 9: Integer Conversion]%s\n", COLOR_BLUE, COLOR_RESET);
+
+    os_clock_info_t info;
+    os_clock_get_info(&info);
+    char details[256];
+    snprintf(details, sizeof(details), "mult %llu, shift %u, %.3f MHz, invariant TSC: %s",
+             (unsigned long long)info.mult, info.shift, (double)info.cycles_per_sec / 1e6,
+             info.tsc_invariant ? "yes" : "no");
+    test_result("Calibration published", info.mult != 0 && info.cycles_per_sec > 0, details);
+
+    // Exactly (cycles * mult) >> shift for small and huge values (no overflow fallback)
+    static const uint64_t values[] = {0, 1, 1000, 1ULL << 32, 1ULL << 40, 1ULL << 56, UINT64_MAX / 3};
+    int exact = 1;
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        long double expect = (long double)values[i] * (long double)info.mult / (long double)(1ULL << info.shift);
+        long double got = (long double)os_cycles_to_ns_u64(values[i]);
+        if (got > expect + 1.0L || got < expect - 1.0L) exact = 0;
+    }
+    test_result("u64 conversion exact up to 2^64 cycles", exact, "");
+
+    uint64_t ns = 123456789ULL;
+    uint64_t back = os_cycles_to_ns_u64(os_ns_to_cycles(ns));
+    int64_t diff = (int64_t)(back - ns);
+    snprintf(details, sizeof(details), "123456789 ns -> cycles -> %llu ns", (unsigned long long)back);
+    test_result("ns -> cycles -> ns round trip", diff >= -2 && diff <= 2, details);
+
+    test_result("Double API matches integer API",
+                os_cycles_to_ns(1000000) == (double)os_cycles_to_ns_u64(1000000), "");
+}
+
+// Test 10: Cycle stamps on the CLOCK_REALTIME timeline
+static void test_realtime_mapping(void) {
+    printf("\n%s[Test 10: Realtime Mapping]%s\n", COLOR_BLUE, COLOR_RESET);
+
+    char details[256];
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t cycle = os_get_cpu_cycle();
+    uint64_t real = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    uint64_t mapped = os_cycles_to_realtime_ns(cycle);
+    int64_t err = (int64_t)(mapped - real);
+    snprintf(details, sizeof(details), "mapped - CLOCK_REALTIME = %lld ns", (long long)err);
+    test_result("Current stamp maps to CLOCK_REALTIME (within 100 us)", err > -100000 && err < 100000, details);
+
+    uint64_t earlier = os_cycles_to_realtime_ns(cycle - os_ns_to_cycles(1000000));
+    int64_t gap = (int64_t)(mapped - earlier);
+    snprintf(details, sizeof(details), "1 ms earlier stamp maps %lld ns earlier", (long long)gap);
+    test_result("Mapping keeps durations", gap > 999000 && gap < 1001000, details);
+
+    // 200 ms apart: the second sync refines the rate against REALTIME
+    os_clock_info_t before, after;
+    os_clock_get_info(&before);
+    os_clock_sync();
+    sleep_ns(200000000);
+    os_clock_sync();
+    os_clock_get_info(&after);
+    double ppm = ((double)after.mult - (double)before.mult) * 1e6 / (double)before.mult;
+    snprintf(details, sizeof(details), "%llu syncs, %llu steps, rate adjusted %.1f ppm",
+             (unsigned long long)after.syncs, (unsigned long long)after.steps, ppm);
+    test_result("os_clock_sync() re-anchors and refines the rate",
+                after.syncs >= before.syncs + 2 && after.anchor_cycles > before.anchor_cycles &&
+                ppm < 500.0 && ppm > -500.0, details);
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    cycle = os_get_cpu_cycle();
+    real = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    err = (int64_t)(os_cycles_to_realtime_ns(cycle) - real);
+    snprintf(details, sizeof(details), "mapped - CLOCK_REALTIME = %lld ns", (long long)err);
+    test_result("Mapping still agrees after resync", err > -100000 && err < 100000, details);
+
+    // Automatic re-anchor once a stamp is past the interval
+    os_clock_set_sync_interval(50000000);  // 50 ms
+    os_clock_get_info(&before);
+    sleep_ns(60000000);
+    os_cycles_to_realtime_ns(os_get_cpu_cycle());
+    os_clock_get_info(&after);
+    test_result("Stale anchor re-synced automatically", after.syncs == before.syncs + 1, "");
+    os_clock_set_sync_interval(1000000000);
+}
+
 // Print system information
 static void print_system_info(void) {
     printf("\n%s=== System Information ===%s\n", COLOR_BLUE, COLOR_RESET);
@@ -499,6 +581,8 @@ int main(int argc, char *argv[]) {
     test_rapid_measurements();
     test_cpu_frequency();
     test_long_duration();
+    test_integer_conversion();
+    test_realtime_mapping();
 
     // Print summary
     printf("\n");
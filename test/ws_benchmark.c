@@ -0,0 +1,798 @@
+// Loopback multi-connection WebSocket benchmark
+//
+// Starts an in-process TLS WebSocket server on 127.0.0.1 that floods binary frames
+// (configurable size distribution and rate) to N client contexts driven by a single
+// notifier loop. Every frame carries the server's TSC send stamp, so the client can
+// report end-to-end latency next to the library's per-stage timestamps without any
+// internet jitter. The client side uses whatever SSL_BACKEND the library was built
+// with (OpenSSL userspace, kTLS, LibreSSL); the server always runs in userspace.
+//
+// Usage: ./ws_benchmark [--conns N] [--messages N] [--rate N] [--sizes SPEC] [--tls12] [--async]
+//                      [--latency-first [BYTES]]
+//   SPEC: fixed:N | uniform:MIN-MAX | market (mostly small frames, occasional snapshots)
+
+#include "../ws.h"
+#include "../ws_notifier.h"
+#include "../ssl.h"
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+#include <openssl/sha.h>
+#include <openssl/x509.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#define MAX_CONNS 64
+#define MAX_FRAME_PAYLOAD (1024 * 1024)
+#define MIN_FRAME_PAYLOAD 24          // Room for the benchmark prefix
+#define SIZE_TABLE_LEN 8192           // Pre-sampled sizes per connection (power of two)
+#define BATCH_BYTES (64 * 1024)       // Server coalesces frames up to this per SSL_write
+#define MAX_SAMPLES (1u << 20)        // Per-stage latency samples kept
+#define WARMUP_MESSAGES 1000          // Per connection, excluded from latency stats
+#define RUN_TIMEOUT_SEC 120
+
+// Payload prefix written by the server into every frame
+typedef struct {
+    uint64_t send_cycle;  // os_get_cpu_cycle() just before SSL_write
+    uint64_t seq;         // Per-connection sequence number
+    uint32_t conn_id;
+} __attribute__((packed)) bench_prefix_t;
+
+typedef enum {
+    SIZE_FIXED,
+    SIZE_UNIFORM,
+    SIZE_MARKET
+} size_kind_t;
+
+typedef struct {
+    size_kind_t kind;
+    size_t min;
+    size_t max;
+} size_spec_t;
+
+typedef struct {
+    int num_conns;
+    uint64_t messages;     // Per connection
+    uint64_t rate;         // Messages/s per connection (0 = flood)
+    size_spec_t sizes;
+    int tls12_only;
+    int cpu;
+    int server_cpu;
+    int uring;             // 0 = default notifier, 1 = io_uring, 2 = io_uring + SQPOLL
+    int async_connect;     // ws_options_t.async_connect: all handshakes in parallel
+    size_t rx_read_budget; // > 0: WS_RX_LATENCY with this many bytes per read
+} bench_config_t;
+
+typedef struct {
+    SSL_CTX *ctx;
+    int listen_fd;
+    int port;
+    const bench_config_t *cfg;
+    volatile int ready;     // Handshakes completed (atomic)
+    volatile int failed;
+} bench_server_t;
+
+typedef struct {
+    bench_server_t *server;
+    int fd;
+    int conn_id;
+} server_conn_t;
+
+// Client-side per-connection tracking
+typedef struct {
+    websocket_context_t *ws;
+    uint64_t next_seq;
+    uint64_t received;
+    uint64_t bytes;
+    uint64_t errors;
+    int connected;
+} client_conn_t;
+
+// Latency stages (all TSC cycles, converted at report time)
+enum {
+    STAGE_WIRE,      // server send stamp -> event loop (stage 2)
+    STAGE_EVENT,     // event loop -> SSL_read start (stage 3)
+    STAGE_DECRYPT,   // SSL_read start -> end (stage 4)
+    STAGE_PARSE,     // SSL_read end -> frame parsed (stage 5)
+    STAGE_DELIVER,   // frame parsed -> callback (stage 6)
+    STAGE_E2E,       // server send stamp -> callback
+    STAGE_COUNT
+};
+
+static const char *STAGE_NAMES[STAGE_COUNT] = {
+    "send -> event", "event -> recv start", "SSL_read (decrypt)",
+    "recv end -> parsed", "parsed -> callback", "end-to-end"
+};
+
+static client_conn_t clients[MAX_CONNS];
+static int num_clients = 0;
+static uint64_t *samples[STAGE_COUNT];
+static size_t sample_count = 0;
+static uint64_t first_msg_cycle = 0;
+static uint64_t last_msg_cycle = 0;
+static uint64_t total_received = 0;
+static uint64_t total_bytes = 0;
+static uint64_t target_messages = 0;
+static int connections_lost = 0;
+
+static int compare_uint64(const void *a, const void *b) {
+    uint64_t val_a = *(const uint64_t *)a;
+    uint64_t val_b = *(const uint64_t *)b;
+    if (val_a < val_b) return -1;
+    if (val_a > val_b) return 1;
+    return 0;
+}
+
+static inline uint64_t cycle_delta(uint64_t later, uint64_t earlier) {
+    return later > earlier ? later - earlier : 0;
+}
+
+// ═══════════════════════════════════════════════════════════════════
+// Server
+// ═══════════════════════════════════════════════════════════════════
+
+// Self-signed RSA certificate generated at startup (client cipher list is ECDHE-RSA)
+static int server_setup_cert(SSL_CTX *ctx) {
+    EVP_PKEY *pkey = NULL;
+    EVP_PKEY_CTX *kctx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, NULL);
+    if (!kctx || EVP_PKEY_keygen_init(kctx) <= 0 ||
+        EVP_PKEY_CTX_set_rsa_keygen_bits(kctx, 2048) <= 0 ||
+        EVP_PKEY_keygen(kctx, &pkey) <= 0) {
+        EVP_PKEY_CTX_free(kctx);
+        return -1;
+    }
+    EVP_PKEY_CTX_free(kctx);
+
+    X509 *x509 = X509_new();
+    if (!x509) {
+        EVP_PKEY_free(pkey);
+        return -1;
+    }
+    X509_set_version(x509, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(x509), 1);
+    X509_gmtime_adj(X509_getm_notBefore(x509), 0);
+    X509_gmtime_adj(X509_getm_notAfter(x509), 86400);
+    X509_set_pubkey(x509, pkey);
+    X509_NAME *name = X509_get_subject_name(x509);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *)"127.0.0.1", -1, -1, 0);
+    X509_set_issuer_name(x509, name);
+
+    int ok = X509_sign(x509, pkey, EVP_sha256()) > 0 &&
+             SSL_CTX_use_certificate(ctx, x509) == 1 &&
+             SSL_CTX_use_PrivateKey(ctx, pkey) == 1;
+
+    X509_free(x509);
+    EVP_PKEY_free(pkey);
+    return ok ? 0 : -1;
+}
+
+static int server_init(bench_server_t *srv, const bench_config_t *cfg) {
+    memset(srv, 0, sizeof(*srv));
+    srv->cfg = cfg;
+
+    srv->ctx = SSL_CTX_new(TLS_server_method());
+    if (!srv->ctx) return -1;
+    SSL_CTX_set_min_proto_version(srv->ctx, TLS1_2_VERSION);
+    if (cfg->tls12_only) {
+        SSL_CTX_set_max_proto_version(srv->ctx, TLS1_2_VERSION);
+    }
+    if (server_setup_cert(srv->ctx) < 0) {
+        fprintf(stderr, "Failed to create server certificate\n");
+        return -1;
+    }
+
+    srv->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (srv->listen_fd < 0) return -1;
+    int one = 1;
+    setsockopt(srv->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;  // Ephemeral port
+    socklen_t addr_len = sizeof(addr);
+    if (bind(srv->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(srv->listen_fd, MAX_CONNS) < 0 ||
+        getsockname(srv->listen_fd, (struct sockaddr *)&addr, &addr_len) < 0) {
+        close(srv->listen_fd);
+        return -1;
+    }
+    srv->port = ntohs(addr.sin_port);
+    return 0;
+}
+
+// Read the upgrade request and answer with 101 Switching Protocols
+static int server_ws_handshake(SSL *ssl) {
+    char req[4096];
+    size_t len = 0;
+    while (len < sizeof(req) - 1) {
+        int n = SSL_read(ssl, req + len, (int)(sizeof(req) - 1 - len));
+        if (n <= 0) return -1;
+        len += (size_t)n;
+        req[len] = '\0';
+        if (strstr(req, "\r\n\r\n")) break;
+    }
+
+    const char *key = strstr(req, "Sec-WebSocket-Key:");
+    if (!key) return -1;
+    key += strlen("Sec-WebSocket-Key:");
+    while (*key == ' ') key++;
+    const char *key_end = strstr(key, "\r\n");
+    if (!key_end || key_end - key > 64) return -1;
+
+    static const char GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    char concat[128];
+    int concat_len = snprintf(concat, sizeof(concat), "%.*s%s", (int)(key_end - key), key, GUID);
+    unsigned char digest[SHA_DIGEST_LENGTH];
+    SHA1((const unsigned char *)concat, (size_t)concat_len, digest);
+    unsigned char accept[64];
+    EVP_EncodeBlock(accept, digest, SHA_DIGEST_LENGTH);
+
+    char resp[256];
+    int resp_len = snprintf(resp, sizeof(resp),
+                            "HTTP/1.1 101 Switching Protocols\r\n"
+                            "Upgrade: websocket\r\n"
+                            "Connection: Upgrade\r\n"
+                            "Sec-WebSocket-Accept: %s\r\n\r\n", accept);
+    return SSL_write(ssl, resp, resp_len) == resp_len ? 0 : -1;
+}
+
+static inline uint32_t xorshift32(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static size_t sample_size(const size_spec_t *spec, uint32_t *rng) {
+    size_t lo = spec->min, hi = spec->max;
+    if (spec->kind == SIZE_FIXED) return spec->min;
+    if (spec->kind == SIZE_MARKET) {
+        // Trades/tickers dominate, depth updates next, rare snapshots
+        uint32_t bucket = xorshift32(rng) % 1000;
+        if (bucket < 700)      { lo = 64;    hi = 256; }
+        else if (bucket < 950) { lo = 256;   hi = 2048; }
+        else if (bucket < 995) { lo = 2048;  hi = 16384; }
+        else                   { lo = 16384; hi = 65536; }
+    }
+    return lo + xorshift32(rng) % (hi - lo + 1);
+}
+
+static inline size_t server_frame_header(uint8_t *hdr, size_t len) {
+    hdr[0] = 0x80 | WS_FRAME_BINARY;
+    if (len < 126) {
+        hdr[1] = (uint8_t)len;
+        return 2;
+    }
+    if (len <= 0xFFFF) {
+        hdr[1] = 126;
+        hdr[2] = (uint8_t)(len >> 8);
+        hdr[3] = (uint8_t)len;
+        return 4;
+    }
+    hdr[1] = 127;
+    for (int i = 0; i < 8; i++) {
+        hdr[2 + i] = (uint8_t)((uint64_t)len >> (56 - 8 * i));
+    }
+    return 10;
+}
+
+static void *server_conn_thread(void *arg) {
+    server_conn_t *conn = (server_conn_t *)arg;
+    bench_server_t *srv = conn->server;
+    const bench_config_t *cfg = srv->cfg;
+
+    if (cfg->server_cpu >= 0) {
+        os_set_thread_affinity(cfg->server_cpu);
+    }
+
+    SSL *ssl = SSL_new(srv->ctx);
+    uint8_t *batch = (uint8_t *)malloc(BATCH_BYTES + MAX_FRAME_PAYLOAD + 16);
+    size_t *stamp_offsets = (size_t *)malloc(sizeof(size_t) * (BATCH_BYTES / MIN_FRAME_PAYLOAD + 2));
+    size_t *sizes = (size_t *)malloc(sizeof(size_t) * SIZE_TABLE_LEN);
+    if (!ssl || !batch || !stamp_offsets || !sizes) goto fail;
+
+    SSL_set_fd(ssl, conn->fd);
+    if (SSL_accept(ssl) != 1 || server_ws_handshake(ssl) < 0) goto fail;
+
+    uint32_t rng = 0x9E3779B9u ^ (uint32_t)(conn->conn_id * 7919 + 1);
+    for (int i = 0; i < SIZE_TABLE_LEN; i++) {
+        sizes[i] = sample_size(&cfg->sizes, &rng);
+    }
+    memset(batch, 'x', BATCH_BYTES + MAX_FRAME_PAYLOAD + 16);
+
+    // Start flooding only once every connection is up
+    __atomic_add_fetch(&srv->ready, 1, __ATOMIC_RELEASE);
+    while (__atomic_load_n(&srv->ready, __ATOMIC_ACQUIRE) < cfg->num_conns &&
+           !__atomic_load_n(&srv->failed, __ATOMIC_ACQUIRE)) {
+        usleep(100);
+    }
+
+    uint64_t start_cycle = os_get_cpu_cycle();
+    uint64_t seq = 0;
+    while (seq < cfg->messages) {
+        // Rate control: send what is due now, sleep through long gaps
+        uint64_t due = cfg->messages;
+        if (cfg->rate > 0) {
+            double elapsed_ns = os_cycles_to_ns(os_get_cpu_cycle() - start_cycle);
+            due = (uint64_t)(elapsed_ns * (double)cfg->rate / 1e9) + 1;
+            if (due > cfg->messages) due = cfg->messages;
+            if (due <= seq) {
+                double next_ns = (double)seq * 1e9 / (double)cfg->rate;
+                double wait_ns = next_ns - elapsed_ns;
+                if (wait_ns > 100000.0) {
+                    usleep((useconds_t)((wait_ns - 50000.0) / 1000.0));
+                } else {
+                    os_pause();
+                }
+                continue;
+            }
+        }
+
+        // Coalesce due frames into one write
+        size_t used = 0;
+        int stamps = 0;
+        while (seq < due && (used == 0 || used + sizes[seq & (SIZE_TABLE_LEN - 1)] + 10 <= BATCH_BYTES)) {
+            size_t len = sizes[seq & (SIZE_TABLE_LEN - 1)];
+            used += server_frame_header(batch + used, len);
+            bench_prefix_t prefix = { 0, seq, (uint32_t)conn->conn_id };
+            memcpy(batch + used, &prefix, sizeof(prefix));
+            stamp_offsets[stamps++] = used;
+            used += len;
+            seq++;
+        }
+
+        uint64_t now = os_get_cpu_cycle();
+        for (int i = 0; i < stamps; i++) {
+            memcpy(batch + stamp_offsets[i], &now, sizeof(now));
+        }
+        if (SSL_write(ssl, batch, (int)used) != (int)used) goto fail;
+    }
+
+    // Wait for the client to close
+    uint8_t sink[256];
+    while (SSL_read(ssl, sink, sizeof(sink)) > 0) {
+    }
+    SSL_shutdown(ssl);
+    goto done;
+
+fail:
+    __atomic_store_n(&srv->failed, 1, __ATOMIC_RELEASE);
+done:
+    if (ssl) SSL_free(ssl);
+    close(conn->fd);
+    free(batch);
+    free(stamp_offsets);
+    free(sizes);
+    free(conn);
+    return NULL;
+}
+
+static void *server_accept_thread(void *arg) {
+    bench_server_t *srv = (bench_server_t *)arg;
+    for (int i = 0; i < srv->cfg->num_conns; i++) {
+        int fd = accept(srv->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            __atomic_store_n(&srv->failed, 1, __ATOMIC_RELEASE);
+            break;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        server_conn_t *conn = (server_conn_t *)calloc(1, sizeof(server_conn_t));
+        pthread_t tid;
+        if (!conn) {
+            close(fd);
+            continue;
+        }
+        conn->server = srv;
+        conn->fd = fd;
+        conn->conn_id = i;
+        if (pthread_create(&tid, NULL, server_conn_thread, conn) != 0) {
+            close(fd);
+            free(conn);
+            continue;
+        }
+        pthread_detach(tid);
+    }
+    return NULL;
+}
+
+// ═══════════════════════════════════════════════════════════════════
+// Client
+// ═══════════════════════════════════════════════════════════════════
+
+static void on_message(websocket_context_t *ws, const uint8_t *payload_ptr, size_t payload_len, uint8_t opcode) {
+    // Capture callback timestamp first
+    uint64_t callback_cycle = os_get_cpu_cycle();
+    (void)ws;
+
+    if (__builtin_expect(opcode != WS_FRAME_BINARY || payload_len < sizeof(bench_prefix_t), 0)) {
+        return;
+    }
+
+    bench_prefix_t prefix;
+    memcpy(&prefix, payload_ptr, sizeof(prefix));
+    if (__builtin_expect(prefix.conn_id >= (uint32_t)num_clients, 0)) {
+        return;
+    }
+
+    client_conn_t *c = &clients[prefix.conn_id];
+    if (__builtin_expect(prefix.seq != c->next_seq, 0)) {
+        c->errors++;  // Lost, duplicated or reordered frame
+    }
+    c->next_seq = prefix.seq + 1;
+    c->received++;
+    c->bytes += payload_len;
+    total_received++;
+    total_bytes += payload_len;
+
+    if (__builtin_expect(first_msg_cycle == 0, 0)) first_msg_cycle = callback_cycle;
+    last_msg_cycle = callback_cycle;
+
+    if (c->received <= WARMUP_MESSAGES || sample_count >= MAX_SAMPLES) {
+        return;
+    }
+
+    uint64_t event_cycle = ws_get_event_timestamp(ws);
+    uint64_t recv_start_cycle = ws_get_recv_start_timestamp(ws);
+    uint64_t recv_end_cycle = ws_get_recv_end_timestamp(ws);
+    uint64_t frame_parsed_cycle = ws_get_frame_parsed_timestamp(ws);
+
+    size_t i = sample_count++;
+    samples[STAGE_WIRE][i] = cycle_delta(event_cycle, prefix.send_cycle);
+    samples[STAGE_EVENT][i] = cycle_delta(recv_start_cycle, event_cycle);
+    samples[STAGE_DECRYPT][i] = cycle_delta(recv_end_cycle, recv_start_cycle);
+    samples[STAGE_PARSE][i] = cycle_delta(frame_parsed_cycle, recv_end_cycle);
+    samples[STAGE_DELIVER][i] = cycle_delta(callback_cycle, frame_parsed_cycle);
+    samples[STAGE_E2E][i] = cycle_delta(callback_cycle, prefix.send_cycle);
+}
+
+static void on_status(websocket_context_t *ws, int status) {
+    for (int i = 0; i < num_clients; i++) {
+        if (clients[i].ws != ws) continue;
+        if (status == 0) {
+            clients[i].connected = 1;
+        } else if (clients[i].connected) {
+            clients[i].connected = 0;
+            connections_lost++;
+        }
+    }
+}
+
+static int all_received(void) {
+    return total_received >= target_messages;
+}
+
+static void print_stage_table(void) {
+    printf("=== Latency (ns, %zu samples after %d warmup msgs/conn) ===\n", sample_count, WARMUP_MESSAGES);
+    printf("  %-22s %10s %10s %10s %10s %10s\n", "Stage", "mean", "p50", "p99", "p99.9", "max");
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        uint64_t *v = samples[s];
+        qsort(v, sample_count, sizeof(uint64_t), compare_uint64);
+        uint64_t sum = 0;
+        for (size_t i = 0; i < sample_count; i++) sum += v[i];
+        printf("  %-22s %10.0f %10.0f %10.0f %10.0f %10.0f\n", STAGE_NAMES[s],
+               os_cycles_to_ns(sum) / (double)sample_count,
+               os_cycles_to_ns(v[sample_count / 2]),
+               os_cycles_to_ns(v[(size_t)((double)sample_count * 0.99)]),
+               os_cycles_to_ns(v[(size_t)((double)sample_count * 0.999)]),
+               os_cycles_to_ns(v[sample_count - 1]));
+    }
+}
+
+static int parse_sizes(const char *spec, size_spec_t *out) {
+    if (strcmp(spec, "market") == 0) {
+        out->kind = SIZE_MARKET;
+        out->min = 64;
+        out->max = 65536;
+        return 0;
+    }
+    if (strncmp(spec, "fixed:", 6) == 0) {
+        out->kind = SIZE_FIXED;
+        out->min = out->max = strtoul(spec + 6, NULL, 10);
+    } else if (strncmp(spec, "uniform:", 8) == 0) {
+        char *end = NULL;
+        out->kind = SIZE_UNIFORM;
+        out->min = strtoul(spec + 8, &end, 10);
+        out->max = (end && *end == '-') ? strtoul(end + 1, NULL, 10) : 0;
+    } else {
+        return -1;
+    }
+    if (out->min < MIN_FRAME_PAYLOAD || out->max < out->min || out->max > MAX_FRAME_PAYLOAD) {
+        return -1;
+    }
+    return 0;
+}
+
+static const char *describe_sizes(const size_spec_t *spec, char *buf, size_t len) {
+    if (spec->kind == SIZE_MARKET) {
+        snprintf(buf, len, "market (70%% 64-256B, 25%% 256B-2KB, 4.5%% 2-16KB, 0.5%% 16-64KB)");
+    } else if (spec->kind == SIZE_FIXED) {
+        snprintf(buf, len, "fixed %zu bytes", spec->min);
+    } else {
+        snprintf(buf, len, "uniform %zu-%zu bytes", spec->min, spec->max);
+    }
+    return buf;
+}
+
+int main(int argc, char *argv[]) {
+    bench_config_t cfg = {
+        .num_conns = 4,
+        .messages = 200000,
+        .rate = 0,
+        .sizes = { SIZE_MARKET, 64, 65536 },
+        .tls12_only = 0,
+        .cpu = -1,
+        .server_cpu = -1,
+        .uring = 0,
+        .async_connect = 0,
+        .rx_read_budget = 0,
+    };
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--conns") == 0 && i + 1 < argc) {
+            cfg.num_conns = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--messages") == 0 && i + 1 < argc) {
+            cfg.messages = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            cfg.rate = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            if (parse_sizes(argv[++i], &cfg.sizes) < 0) {
+                fprintf(stderr, "Invalid --sizes '%s' (fixed:N, uniform:MIN-MAX or market; %d..%d bytes)\n",
+                        argv[i], MIN_FRAME_PAYLOAD, MAX_FRAME_PAYLOAD);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--tls12") == 0) {
+            cfg.tls12_only = 1;
+        } else if (strcmp(argv[i], "--cpu") == 0 && i + 1 < argc) {
+            cfg.cpu = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--server-cpu") == 0 && i + 1 < argc) {
+            cfg.server_cpu = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--uring") == 0) {
+            cfg.uring = 1;
+        } else if (strcmp(argv[i], "--sqpoll") == 0) {
+            cfg.uring = 2;
+        } else if (strcmp(argv[i], "--async") == 0) {
+            cfg.async_connect = 1;
+        } else if (strcmp(argv[i], "--latency-first") == 0) {
+            cfg.rx_read_budget = WS_RX_READ_BUDGET;
+            if (i + 1 < argc && argv[i + 1][0] != '-') cfg.rx_read_budget = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--help") == 0) {
+            printf("Usage: %s [options]\n", argv[0]);
+            printf("Options:\n");
+            printf("  --conns N         Client connections (default 4, max %d)\n", MAX_CONNS);
+            printf("  --messages N      Messages per connection (default 200000)\n");
+            printf("  --rate N          Messages/s per connection, 0 = flood (default 0)\n");
+            printf("  --sizes SPEC      fixed:N | uniform:MIN-MAX | market (default market)\n");
+            printf("  --tls12           Cap the server at TLS 1.2 (exercises kTLS on older kernels)\n");
+            printf("  --cpu N           Pin the client event loop to CPU N\n");
+            printf("  --server-cpu N    Pin server threads to CPU N\n");
+            printf("  --uring           io_uring notifier backend\n");
+            printf("  --sqpoll          io_uring notifier with a kernel submission thread\n");
+            printf("  --async           Non-blocking connects (DNS, TCP, TLS and upgrade in parallel)\n");
+            printf("  --latency-first [BYTES]  Parse after every read of BYTES (default %d)\n", WS_RX_READ_BUDGET);
+            return 0;
+        } else {
+            fprintf(stderr, "Unknown option: %s (see --help)\n", argv[i]);
+            return 1;
+        }
+    }
+    if (cfg.num_conns < 1 || cfg.num_conns > MAX_CONNS || cfg.messages <= WARMUP_MESSAGES) {
+        fprintf(stderr, "--conns must be 1..%d and --messages > %d\n", MAX_CONNS, WARMUP_MESSAGES);
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("╔══════════════════════════════════════════════════════════════════╗\n");
+    printf("║              Loopback WebSocket Benchmark (TLS)                  ║\n");
+    printf("╚══════════════════════════════════════════════════════════════════╝\n\n");
+
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        samples[s] = (uint64_t *)malloc(sizeof(uint64_t) * MAX_SAMPLES);
+        if (!samples[s]) {
+            fprintf(stderr, "Failed to allocate sample buffers\n");
+            return 1;
+        }
+    }
+
+    bench_server_t server;
+    if (server_init(&server, &cfg) < 0) {
+        fprintf(stderr, "Failed to start loopback server\n");
+        return 1;
+    }
+    pthread_t accept_tid;
+    if (pthread_create(&accept_tid, NULL, server_accept_thread, &server) != 0) {
+        fprintf(stderr, "Failed to start accept thread\n");
+        return 1;
+    }
+
+    if (cfg.cpu >= 0 && os_set_thread_affinity(cfg.cpu) != 0) {
+        printf("⚠️  CPU affinity failed (continuing anyway)\n");
+    }
+
+    char url[64];
+    snprintf(url, sizeof(url), "wss://127.0.0.1:%d/", server.port);
+    num_clients = cfg.num_conns;
+    target_messages = cfg.messages * (uint64_t)cfg.num_conns;
+
+    ws_options_t ws_opts = {0};
+    ws_opts.async_connect = cfg.async_connect;
+    ws_opts.rx_mode = cfg.rx_read_budget ? WS_RX_LATENCY : WS_RX_THROUGHPUT;
+    ws_opts.rx_read_budget = cfg.rx_read_budget;
+    uint64_t connect_start = os_get_cpu_cycle();
+    for (int i = 0; i < num_clients; i++) {
+        clients[i].ws = ws_init_ex(url, &ws_opts);
+        if (!clients[i].ws) {
+            fprintf(stderr, "❌ ws_init failed for connection %d\n", i);
+            return 1;
+        }
+        ws_set_on_msg(clients[i].ws, on_message);
+        ws_set_on_status(clients[i].ws, on_status);
+    }
+
+    // Connect all contexts concurrently
+    uint64_t deadline = os_get_cpu_cycle();
+    int connected = 0;
+    while (connected < num_clients) {
+        connected = 0;
+        for (int i = 0; i < num_clients; i++) {
+            if (ws_get_state(clients[i].ws) == WS_STATE_CONNECTED) {
+                connected++;
+            } else if (ws_get_state(clients[i].ws) == WS_STATE_ERROR ||
+                       ws_get_state(clients[i].ws) == WS_STATE_CLOSED) {
+                fprintf(stderr, "❌ Connection %d failed during handshake\n", i);
+                return 1;
+            } else {
+                ws_update(clients[i].ws);
+            }
+        }
+        if (os_cycles_to_ns(os_get_cpu_cycle() - deadline) > 10e9) {
+            fprintf(stderr, "❌ Timed out connecting (%d/%d)\n", connected, num_clients);
+            return 1;
+        }
+    }
+    double connect_ms = os_cycles_to_ns(os_get_cpu_cycle() - connect_start) / 1e6;
+
+    ws_notifier_t *notifier = cfg.uring ? ws_notifier_init_ex(WS_NOTIFIER_BACKEND_IO_URING,
+                                                              cfg.uring == 2 ? WS_NOTIFIER_URING_SQPOLL : 0)
+                                        : ws_notifier_init();
+    if (!notifier) {
+        fprintf(stderr, "❌ Failed to create event notifier\n");
+        return 1;
+    }
+    ws_notifier_set_mode(notifier, WS_NOTIFIER_MODE_TIMEOUT, 1000000ULL, 0);  // 1ms
+    for (int i = 0; i < num_clients; i++) {
+        ws_set_notifier(clients[i].ws, notifier);
+        ws_notifier_add(notifier, ws_get_fd(clients[i].ws), WS_EVENT_READ, clients[i].ws);
+    }
+
+    char size_desc[96];
+    printf("=== Configuration ===\n");
+    printf("  Connections:   %d\n", cfg.num_conns);
+    printf("  Messages:      %" PRIu64 " per connection\n", cfg.messages);
+    if (cfg.rate > 0) {
+        printf("  Rate:          %" PRIu64 " msgs/s per connection\n", cfg.rate);
+    } else {
+        printf("  Rate:          flood (unpaced)\n");
+    }
+    printf("  Frame sizes:   %s\n", describe_sizes(&cfg.sizes, size_desc, sizeof(size_desc)));
+    printf("  SSL backend:   %s\n", ssl_get_backend_version());
+    printf("  Notifier:      %s\n", ws_notifier_get_backend(notifier) == WS_NOTIFIER_BACKEND_IO_URING ?
+           (cfg.uring == 2 ? "io_uring (SQPOLL)" : "io_uring") : "default");
+    printf("  Connect:       %d connections in %.1f ms (%s)\n", cfg.num_conns, connect_ms,
+           cfg.async_connect ? "async" : "blocking");
+    if (cfg.rx_read_budget) {
+        printf("  Receive:       latency-first, %zu bytes per read\n", cfg.rx_read_budget);
+    } else {
+        printf("  Receive:       throughput-first\n");
+    }
+    printf("  TLS mode:      %s\n", ws_get_tls_mode(clients[0].ws));
+    printf("  Cipher:        %s\n", ws_get_cipher_name(clients[0].ws));
+    printf("\n");
+
+    // Data phase: batched wait, sweep everything on timeout so edge-triggered
+    // readiness never strands buffered records
+    ws_notifier_event_t events[MAX_CONNS];
+    uint64_t run_start = os_get_cpu_cycle();
+    for (int i = 0; i < num_clients; i++) ws_update(clients[i].ws);
+
+    while (!all_received() && connections_lost == 0 && !__atomic_load_n(&server.failed, __ATOMIC_ACQUIRE)) {
+        int n = ws_notifier_wait_events(notifier, events, MAX_CONNS);
+        if (n > 0) {
+            for (int i = 0; i < n; i++) ws_update((websocket_context_t *)events[i].user_data);
+        } else {
+            for (int i = 0; i < num_clients; i++) ws_update(clients[i].ws);
+        }
+        if (os_cycles_to_ns(os_get_cpu_cycle() - run_start) > RUN_TIMEOUT_SEC * 1e9) {
+            fprintf(stderr, "⚠️  Run timed out after %d s\n", RUN_TIMEOUT_SEC);
+            break;
+        }
+    }
+
+    // Library-side counters and histograms, summed over connections
+    static ws_stats_t total, snap;
+    memset(&total, 0, sizeof(total));
+    for (int i = 0; i < num_clients; i++) {
+        ws_stats_snapshot(ws_get_stats(clients[i].ws), &snap);
+        if (snap.rx_ring_high_water > total.rx_ring_high_water) total.rx_ring_high_water = snap.rx_ring_high_water;
+        snap.rx_ring_high_water = 0;
+        uint64_t *dst = (uint64_t *)&total;
+        const uint64_t *src = (const uint64_t *)&snap;
+        for (size_t k = 0; k < sizeof(ws_stats_t) / sizeof(uint64_t); k++) dst[k] += src[k];
+    }
+
+    uint64_t errors = 0;
+    for (int i = 0; i < num_clients; i++) {
+        errors += clients[i].errors;
+        ws_close(clients[i].ws);
+    }
+    for (int k = 0; k < 100; k++) {
+        for (int i = 0; i < num_clients; i++) ws_update(clients[i].ws);
+    }
+    for (int i = 0; i < num_clients; i++) {
+        ws_free(clients[i].ws);
+    }
+    ws_notifier_free(notifier);
+
+    double elapsed_ns = os_cycles_to_ns(cycle_delta(last_msg_cycle, first_msg_cycle));
+    printf("=== Throughput ===\n");
+    printf("  Received:      %" PRIu64 " / %" PRIu64 " messages, %" PRIu64 " sequence errors\n",
+           total_received, target_messages, errors);
+    if (elapsed_ns > 0) {
+        printf("  Messages/s:    %.0f\n", (double)total_received * 1e9 / elapsed_ns);
+        printf("  Payload:       %.3f GB/s (avg %.0f bytes/msg)\n",
+               (double)total_bytes / elapsed_ns, (double)total_bytes / (double)total_received);
+    }
+    printf("\n");
+
+    if (sample_count > 0) {
+        print_stage_table();
+        printf("  (send stamps come from the server thread's TSC; requires invariant, synchronized TSC)\n");
+    }
+    printf("\n");
+
+    printf("=== Library Stats (ws_get_stats) ===\n");
+    printf("  Frames:        %" PRIu64 " in %" PRIu64 " reads (%" PRIu64 " extra ssl_pending reads, %" PRIu64 " ended mid-frame)\n",
+           total.frames_rx, total.reads, total.ssl_pending_loops, total.partial_reads);
+    printf("  RX high-water: %" PRIu64 " bytes\n", total.rx_ring_high_water);
+    static const char *LIB_STAGES[WS_STAT_STAGE_COUNT] = {
+        "event -> recv start", "SSL_read (decrypt)", "recv end -> parsed", "parse + callbacks"
+    };
+    printf("  %-22s %10s %10s %10s %10s\n", "Stage (per batch, ns)", "mean", "p50", "p99.9", "max");
+    for (int s = 0; s < WS_STAT_STAGE_COUNT; s++) {
+        const ws_histogram_t *h = &total.stages[s];
+        printf("  %-22s %10.0f %10.0f %10.0f %10.0f\n", LIB_STAGES[s],
+               os_cycles_to_ns((uint64_t)ws_hist_mean(h)),
+               os_cycles_to_ns(ws_hist_percentile(h, 50.0)),
+               os_cycles_to_ns(ws_hist_percentile(h, 99.9)),
+               os_cycles_to_ns(ws_hist_percentile(h, 100.0)));
+    }
+    const ws_histogram_t *ct = &total.connect_time;
+    printf("  %-22s %10.0f %10.0f %10.0f %10.0f  (us)\n", "connect + upgrade",
+           os_cycles_to_ns((uint64_t)ws_hist_mean(ct)) / 1e3, os_cycles_to_ns(ws_hist_percentile(ct, 50.0)) / 1e3,
+           os_cycles_to_ns(ws_hist_percentile(ct, 99.9)) / 1e3, os_cycles_to_ns(ws_hist_percentile(ct, 100.0)) / 1e3);
+    printf("\n");
+
+    close(server.listen_fd);
+    SSL_CTX_free(server.ctx);
+    for (int s = 0; s < STAGE_COUNT; s++) free(samples[s]);
+
+    int ok = total_received >= target_messages && errors == 0 && connections_lost == 0;
+    printf("%s\n", ok ? "✓ Benchmark complete" : "✗ Benchmark incomplete (lost messages or connections)");
+    return ok ? 0 : 1;
+}
@@ -1,11 +1,31 @@
 #include "../ws.h"
 #include "../ringbuffer.h"
+#include "../ws_trace.h"
+#include "../ws_pool.h"
+#include "../ws_notifier.h"
+#include "../ws_resolver.h"
+#include "../ws_redundant.h"
+#include "../ws_timer.h"
+#include "../ws_router.h"
+#include "../ws_shm.h"
+#include "../ws_transport.h"
+#include "../ws_deflate.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include <unistd.h>
 #include <inttypes.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#ifdef WS_HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 // Test counters
 static int test_count = 0;
@@ -173,6 +193,16 @@ void test_send_message() {
         
         // Should fail because not connected
         TEST("Send message fails when not connected", result == -1);
+
+        TEST("Send reserve fails when not connected", ws_send_reserve(ws, 64) == NULL);
+        TEST("Send commit without reservation fails", ws_send_commit(ws, 0) == -1);
+
+        struct iovec iov[2];
+        iov[0].iov_base = (void *)"prefix:";
+        iov[0].iov_len = 7;
+        iov[1].iov_base = (void *)test_msg;
+        iov[1].iov_len = strlen(test_msg);
+        TEST("Gathered send fails when not connected", ws_sendv(ws, iov, 2) == -1);
         
         ws_free(ws);
     }
@@ -190,6 +220,2150 @@ void test_cpu_cycles() {
     TEST("CPU cycles increase over time", (cycle2 - cycle1) > 0);
 }
 
+// Test statistics histograms and snapshots
+void test_stats() {
+    printf("\n=== Testing Statistics ===\n");
+
+    // Exact below 32, bucket bounds stay within ~3% above
+    int index_ok = 1;
+    for (uint64_t v = 0; v < 5000000; v = v < 64 ? v + 1 : v + v / 7) {
+        uint64_t upper = ws_hist_bucket_upper(ws_hist_bucket_index(v));
+        if (upper < v || (v >= 32 && (double)(upper - v) > (double)v * 0.032) || (v < 32 && upper != v)) {
+            index_ok = 0;
+        }
+    }
+    TEST("Histogram bucket bounds within 3.2%", index_ok);
+    TEST("Huge values clamp to last bucket", ws_hist_bucket_index(UINT64_MAX) == WS_HIST_BUCKETS - 1);
+
+    static ws_histogram_t h;
+    memset(&h, 0, sizeof(h));
+    for (uint64_t v = 1; v <= 100000; v++) ws_hist_record(&h, v);
+    uint64_t p50 = ws_hist_percentile(&h, 50.0);
+    uint64_t p999 = ws_hist_percentile(&h, 99.9);
+    TEST("p50 of 1..100000 within 3.2%", p50 >= 50000 && p50 <= 51600);
+    TEST("p99.9 of 1..100000 within 3.2%", p999 >= 99900 && p999 <= 103100);
+    TEST("p100 covers the maximum", ws_hist_percentile(&h, 100.0) >= 100000);
+    TEST("Mean is exact", ws_hist_mean(&h) == 50000.5);
+
+    websocket_context_t *ws = ws_init("ws://localhost:8080/");
+    TEST("Create context for stats tests", ws != NULL);
+    if (ws) {
+        static ws_stats_t before, now, delta;
+        ws_stats_snapshot(ws_get_stats(ws), &before);
+        TEST("Fresh context has zeroed stats", before.frames_rx == 0 && before.bytes_rx == 0 &&
+             before.stages[WS_STAT_SSL_READ].count == 0);
+
+        // Windowed view: delta of two snapshots only contains the newer samples
+        memcpy(&now, &before, sizeof(now));
+        now.frames_rx = 10;
+        ws_hist_record(&now.stages[WS_STAT_DISPATCH], 1000);
+        ws_stats_delta(&now, &before, &delta);
+        TEST("Delta counters", delta.frames_rx == 10);
+        TEST("Delta histogram", delta.stages[WS_STAT_DISPATCH].count == 1 &&
+             ws_hist_percentile(&delta.stages[WS_STAT_DISPATCH], 99.9) >= 1000);
+        ws_free(ws);
+    }
+    TEST("ws_get_stats(NULL) returns NULL", ws_get_stats(NULL) == NULL);
+}
+
+// Test the mmap trace ring
+void test_trace() {
+    printf("\n=== Testing Trace Ring ===\n");
+
+    char path[] = "/tmp/ws_test_trace_XXXXXX";
+    int fd = mkstemp(path);
+    TEST("Create temporary trace path", fd >= 0);
+    if (fd < 0) return;
+    close(fd);
+
+    ws_trace_t *t = ws_trace_open(path, 100, 5000, "localhost:8080/");
+    TEST("Open trace file", t != NULL);
+    if (!t) {
+        unlink(path);
+        return;
+    }
+    TEST("Capacities rounded to powers of two", t->hdr->record_capacity == 128 &&
+         t->hdr->stream_capacity == 8192);
+
+    // Overfill: the ring keeps the newest capacity records
+    const int n = 100000;
+    uint64_t start = os_get_cpu_cycle();
+    for (int i = 0; i < n; i++) {
+        ws_trace_record_t *r = ws_trace_next(t);
+        r->parsed_cycle = os_get_cpu_cycle();
+        r->payload_len = (uint32_t)i;
+        ws_trace_commit(t);
+    }
+    double ns_per_record = os_cycles_to_ns(os_get_cpu_cycle() - start) / (double)n;
+    printf("Trace: %.1f ns per record\n", ns_per_record);
+    TEST("Record head counts every record", t->hdr->record_head == (uint64_t)n);
+    TEST("Newest record in slot head-1", t->records[(n - 1) & t->record_mask].payload_len == (uint32_t)(n - 1));
+
+    // Stream capture wraps byte-exact
+    uint8_t chunk[3000];
+    for (size_t i = 0; i < sizeof(chunk); i++) chunk[i] = (uint8_t)i;
+    for (int i = 0; i < 3; i++) ws_trace_capture(t, chunk, sizeof(chunk));
+    TEST("Stream head counts captured bytes", t->hdr->stream_head == 9000);
+    TEST("Wrapped stream bytes land at head mod capacity", t->stream[(9000 - 1) & t->stream_mask] == chunk[2999] &&
+         t->stream[8191] == chunk[8191 - 6000] && t->stream[0] == chunk[8192 - 6000]);
+    ws_trace_close(t);
+
+    // The mapping was MAP_SHARED: the file holds the data after close
+    FILE *f = fopen(path, "rb");
+    ws_trace_header_t hdr;
+    int read_ok = f && fread(&hdr, sizeof(hdr), 1, f) == 1;
+    if (f) fclose(f);
+    TEST("Trace file persists header", read_ok && memcmp(hdr.magic, WS_TRACE_MAGIC, 8) == 0 &&
+         hdr.record_head == (uint64_t)n && hdr.ns_per_cycle > 0.0);
+    unlink(path);
+
+    websocket_context_t *ws = ws_init("ws://localhost:8080/");
+    if (ws) {
+        TEST("ws_set_trace(NULL path) disables tracing", ws_set_trace(ws, NULL, 0, 0) == 0);
+        TEST("ws_set_trace on bad path fails", ws_set_trace(ws, "/nonexistent/dir/trace", 16, 0) == -1);
+        ws_free(ws);
+    }
+}
+
+// Test offline replay from a raw capture and from a trace file recorded during replay
+void test_replay() {
+    printf("\n=== Testing Replay ===\n");
+
+    // TEXT "hello", fragmented BINARY "abc"+"def" with a PING in between, TEXT "bye"
+    static const uint8_t stream[] = {
+        0x81, 0x05, 'h', 'e', 'l', 'l', 'o',
+        0x02, 0x03, 'a', 'b', 'c',
+        0x89, 0x01, 'p',
+        0x80, 0x03, 'd', 'e', 'f',
+        0x81, 0x03, 'b', 'y', 'e',
+    };
+    char raw_path[] = "/tmp/ws_test_replay_XXXXXX";
+    char trace_path[] = "/tmp/ws_test_replay_trace_XXXXXX";
+    int fd = mkstemp(raw_path);
+    int tfd = mkstemp(trace_path);
+    TEST("Create temporary capture paths", fd >= 0 && tfd >= 0);
+    if (fd < 0 || tfd < 0) return;
+    int write_ok = write(fd, stream, sizeof(stream)) == (ssize_t)sizeof(stream);
+    close(fd);
+    close(tfd);
+    TEST("Write raw capture", write_ok);
+
+    TEST("Missing capture returns NULL", ws_init_replay("/nonexistent/capture", 0.0) == NULL);
+
+    websocket_context_t *ws = ws_init_replay(raw_path, 0.0);
+    TEST("Create replay context from raw stream", ws != NULL);
+    if (ws) {
+        TEST("Replay context starts connected", ws_get_state(ws) == WS_STATE_CONNECTED);
+        TEST("Trace the replay with stream capture", ws_set_trace(ws, trace_path, 16, 4096) == 0);
+        ws_set_on_msg(ws, test_on_msg);
+        message_count = 0;
+        TEST("Send on replay context is accepted", ws_send(ws, (const uint8_t *)"x", 1) == 1);
+        for (int i = 0; i < 10 && ws_get_state(ws) == WS_STATE_CONNECTED; i++) ws_update(ws);
+        TEST("Queued frames are discarded", ws_wants_write(ws) == 0);
+        TEST("Raw replay delivers 4 messages (PING included)", message_count == 4);
+        TEST("Last message is 'bye'", last_message_len == 3 && memcmp(last_message, "bye", 3) == 0);
+        TEST("Replay ends CLOSED", ws_get_state(ws) == WS_STATE_CLOSED);
+        TEST("Replay counts frames", ws_get_stats(ws)->frames_rx == 5);
+        ws_free(ws);  // Closes the trace file
+    }
+
+    ws = ws_init_replay(trace_path, 0.0);
+    TEST("Create replay context from trace file", ws != NULL);
+    if (ws) {
+        ws_set_on_msg(ws, test_on_msg);
+        message_count = 0;
+        for (int i = 0; i < 10 && ws_get_state(ws) == WS_STATE_CONNECTED; i++) ws_update(ws);
+        TEST("Trace replay delivers the same messages", message_count == 4 &&
+             last_message_len == 3 && memcmp(last_message, "bye", 3) == 0);
+        TEST("Trace replay ends CLOSED", ws_get_state(ws) == WS_STATE_CLOSED);
+        ws_free(ws);
+    }
+
+    unlink(raw_path);
+    unlink(trace_path);
+}
+
+#ifdef WS_HAVE_ZLIB
+// Compress one message as a server would: sync flush with the 00 00 FF FF tail stripped,
+// or ending with a BFINAL block (final = 1). Returns the compressed length
+static size_t deflate_message(z_stream *zs, const uint8_t *in, size_t in_len, uint8_t *out, size_t out_cap, int final) {
+    zs->next_in = (Bytef *)in;
+    zs->avail_in = (uInt)in_len;
+    zs->next_out = out;
+    zs->avail_out = (uInt)out_cap;
+    deflate(zs, final ? Z_FINISH : Z_SYNC_FLUSH);
+    size_t n = out_cap - zs->avail_out;
+    if (!final && n >= 4) n -= 4;
+    return n;
+}
+#endif
+
+// Test permessage-deflate inflation: sync-flush and BFINAL messages, context takeover, corruption
+void test_inflate() {
+    printf("\n=== Testing permessage-deflate Inflate ===\n");
+#ifdef WS_HAVE_ZLIB
+    static uint8_t text[100000];
+    for (size_t i = 0; i < sizeof(text); i++) text[i] = (uint8_t)("bid ask trade "[i % 14] + (i / 997) % 3);
+    static uint8_t comp[sizeof(text) + 1024];
+    size_t out_len = 0;
+    const uint8_t *out;
+
+    ws_inflater_t *inf = ws_inflater_create(4096, 0);
+    TEST("Create inflater", inf != NULL);
+    if (!inf) return;
+
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    size_t n = deflate_message(&zs, text, 500, comp, sizeof(comp), 0);
+    out = ws_inflater_message(inf, comp, n, &out_len);
+    TEST("Sync-flush message inflates", out && out_len == 500 && memcmp(out, text, 500) == 0);
+    n = deflate_message(&zs, text, 500, comp, sizeof(comp), 0);
+    out = ws_inflater_message(inf, comp, n, &out_len);
+    TEST("Second message references the kept window", out && out_len == 500 && memcmp(out, text, 500) == 0 && n < 32);
+    deflateEnd(&zs);
+
+    // RFC 7692 Section 7.2.3.4: a message may end with a BFINAL=1 block
+    memset(&zs, 0, sizeof(zs));
+    deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    n = deflate_message(&zs, text, sizeof(text), comp, sizeof(comp), 1);
+    deflateEnd(&zs);
+    out = ws_inflater_message(inf, comp, n, &out_len);
+    TEST("BFINAL message inflates (arena grows)", out && out_len == sizeof(text) && memcmp(out, text, sizeof(text)) == 0 &&
+         ws_inflater_arena_size(inf) >= sizeof(text));
+
+    memset(&zs, 0, sizeof(zs));
+    deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    n = deflate_message(&zs, text + 1000, 300, comp, sizeof(comp), 0);
+    deflateEnd(&zs);
+    out = ws_inflater_message(inf, comp, n, &out_len);
+    TEST("Next message after BFINAL starts a new stream", out && out_len == 300 && memcmp(out, text + 1000, 300) == 0);
+
+    static const uint8_t garbage[] = {0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x12};
+    TEST("Corrupt message rejected", ws_inflater_message(inf, garbage, sizeof(garbage), &out_len) == NULL);
+    ws_inflater_free(inf);
+
+    // Through the parser: compressed TEXT frames (RSV1), one per form
+    static const char *msgs[2] = { "final block message", "sync flush message" };
+    uint8_t stream[256];
+    size_t len = 0;
+    for (int i = 0; i < 2; i++) {
+        memset(&zs, 0, sizeof(zs));
+        deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+        n = deflate_message(&zs, (const uint8_t *)msgs[i], strlen(msgs[i]), comp, sizeof(comp), i == 0);
+        deflateEnd(&zs);
+        stream[len++] = 0xC1;  // FIN | RSV1 | TEXT
+        stream[len++] = (uint8_t)n;
+        memcpy(stream + len, comp, n);
+        len += n;
+    }
+    char path[] = "/tmp/ws_test_inflate_XXXXXX";
+    int fd = mkstemp(path);
+    int write_ok = fd >= 0 && write(fd, stream, len) == (ssize_t)len;
+    if (fd >= 0) close(fd);
+    TEST("Write compressed capture", write_ok);
+    websocket_context_t *ws = write_ok ? ws_init_replay(path, 0.0) : NULL;
+    if (ws) {
+        ws_set_on_msg(ws, test_on_msg);
+        message_count = 0;
+        TEST("Enable inflate on the replay", ws_set_permessage_deflate(ws, 1, WS_DEFLATE_SERVER_NO_CONTEXT_TAKEOVER) == 0);
+        for (int i = 0; i < 10 && ws_get_state(ws) == WS_STATE_CONNECTED; i++) ws_update(ws);
+        TEST("BFINAL and sync-flush messages both delivered", message_count == 2 &&
+             ws_get_stats(ws)->messages_rx == 2 && strcmp(last_message, msgs[1]) == 0);
+        ws_free(ws);
+    }
+    if (fd >= 0) unlink(path);
+#else
+    printf("Skipped: built without zlib\n");
+#endif
+}
+
+// Parser profiles: sums what was delivered so every profile can be compared on one stream
+static size_t profile_msgs = 0;
+static uint64_t profile_sum = 0;
+
+static void profile_on_msg(websocket_context_t *ws __attribute__((unused)), const uint8_t *payload_ptr,
+                           size_t payload_len, uint8_t opcode) {
+    profile_msgs++;
+    profile_sum += payload_len * 31 + opcode;
+    for (size_t i = 0; i < payload_len; i += 97) profile_sum += payload_ptr[i];
+}
+
+// Replay a stream under one profile; returns the final state
+static ws_state_t replay_profile(const char *path, ws_parser_profile_t profile) {
+    profile_msgs = 0;
+    profile_sum = 0;
+    websocket_context_t *ws = ws_init_replay(path, 0.0);
+    if (!ws) return WS_STATE_CONNECTING;
+    ws_set_on_msg(ws, profile_on_msg);
+    ws_set_parser_profile(ws, profile);
+    for (int i = 0; i < 100 && ws_get_state(ws) == WS_STATE_CONNECTED; i++) ws_update(ws);
+    ws_state_t state = ws_get_state(ws);
+    ws_free(ws);
+    return state;
+}
+
+// Test that every parser profile delivers exactly what the generic parser does
+void test_parser_profiles() {
+    printf("\n=== Testing Parser Profiles ===\n");
+
+    // One frame of each length encoding, a fragmented message and a PING, so every
+    // profile sees frames on and off its fast path
+    static uint8_t stream[2 + 5 + 4 + 300 + 10 + 70000 + 5 + 5 + 3 + 5];
+    size_t n = 0;
+    stream[n++] = 0x81; stream[n++] = 5;
+    memcpy(stream + n, "small", 5); n += 5;
+    stream[n++] = 0x82; stream[n++] = 126; stream[n++] = 300 >> 8; stream[n++] = 300 & 0xFF;
+    for (int i = 0; i < 300; i++) stream[n++] = (uint8_t)i;
+    stream[n++] = 0x81; stream[n++] = 127;
+    for (int b = 0; b < 8; b++) stream[n++] = (uint8_t)((uint64_t)70000 >> (56 - 8 * b));
+    for (int i = 0; i < 70000; i++) stream[n++] = (uint8_t)('a' + i % 26);
+    stream[n++] = 0x01; stream[n++] = 3; memcpy(stream + n, "abc", 3); n += 3;
+    stream[n++] = 0x89; stream[n++] = 3; memcpy(stream + n, "png", 3); n += 3;
+    stream[n++] = 0x80; stream[n++] = 1; stream[n++] = 'd';
+    stream[n++] = 0x81; stream[n++] = 3; memcpy(stream + n, "end", 3); n += 3;
+
+    // Masked frame after a valid one: a protocol violation whatever the profile
+    static const uint8_t bad[] = { 0x81, 0x02, 'o', 'k', 0x81, 0x82, 1, 2, 3, 4, 'x', 'y' };
+
+    char path[] = "/tmp/ws_test_profiles_XXXXXX";
+    char bad_path[] = "/tmp/ws_test_profiles_bad_XXXXXX";
+    int fd = mkstemp(path);
+    int bfd = mkstemp(bad_path);
+    TEST("Create temporary capture paths", fd >= 0 && bfd >= 0);
+    if (fd < 0 || bfd < 0) return;
+    int write_ok = write(fd, stream, n) == (ssize_t)n && write(bfd, bad, sizeof(bad)) == (ssize_t)sizeof(bad);
+    close(fd);
+    close(bfd);
+    TEST("Write profile captures", write_ok && n == sizeof(stream));
+
+    TEST("Generic profile replays the stream", replay_profile(path, WS_PARSER_GENERIC) == WS_STATE_CLOSED &&
+         profile_msgs == 6);
+    size_t msgs = profile_msgs;
+    uint64_t sum = profile_sum;
+    int same = 1, rejected = 1;
+    for (int p = WS_PARSER_SMALL; p < WS_PARSER_PROFILES; p++) {
+        replay_profile(path, (ws_parser_profile_t)p);
+        if (profile_msgs != msgs || profile_sum != sum) same = 0;
+    }
+    TEST("Every profile delivers the generic parser's messages", same);
+    for (int p = WS_PARSER_GENERIC; p < WS_PARSER_PROFILES; p++) {
+        replay_profile(bad_path, (ws_parser_profile_t)p);
+        if (profile_msgs != 1) rejected = 0;
+    }
+    TEST("Every profile rejects a masked server frame", rejected);
+
+    websocket_context_t *ws = ws_init_replay(path, 0.0);
+    if (ws) {
+        TEST("Build default profile in effect", ws_get_parser_profile(ws) == WS_DEFAULT_PARSER_PROFILE);
+        TEST("Select small profile", ws_set_parser_profile(ws, WS_PARSER_SMALL) == 0 &&
+             ws_get_parser_profile(ws) == WS_PARSER_SMALL);
+        TEST("Unknown profile rejected", ws_set_parser_profile(ws, WS_PARSER_PROFILES) == -1 &&
+             ws_get_parser_profile(ws) == WS_PARSER_SMALL);
+#ifdef WS_HAVE_ZLIB
+        TEST("permessage-deflate parses with the generic stage",
+             ws_set_permessage_deflate(ws, 1, 0) == 0 && ws_get_parser_profile(ws) == WS_PARSER_GENERIC);
+#endif
+        ws_free(ws);
+    }
+    ws_options_t opts = {0};
+    opts.parser_profile = WS_PARSER_PROFILES;
+    TEST("ws_init_ex rejects an unknown profile", ws_init_ex("wss://localhost/", &opts) == NULL);
+
+    unlink(path);
+    unlink(bad_path);
+}
+
+// Pipeline consumer: checks sequence numbers and descriptor timestamps
+static uint32_t pipe_expected = 0;
+static int pipe_order_ok = 1;
+static int pipe_stamps_ok = 1;
+
+static void pipe_on_msg(websocket_context_t *ws, const uint8_t *payload_ptr, size_t payload_len,
+                        uint8_t opcode __attribute__((unused))) {
+    uint32_t seq = 0;
+    if (payload_len >= 4) memcpy(&seq, payload_ptr, 4);
+    if (payload_len < 4 || seq != pipe_expected) pipe_order_ok = 0;
+    pipe_expected++;
+    const ws_msg_desc_t *d = ws_pipeline_current(ws);
+    if (!d || d->payload != payload_ptr || d->enqueue_cycle < d->parsed_cycle) pipe_stamps_ok = 0;
+}
+
+static volatile int pipe_stop = 0;
+
+static void *pipe_consumer(void *arg) {
+    websocket_context_t *ws = (websocket_context_t *)arg;
+    while (!__atomic_load_n(&pipe_stop, __ATOMIC_ACQUIRE) || ws_pipeline_backlog(ws) > 0) {
+        if (ws_pipeline_poll(ws, 0) == 0) sched_yield();
+    }
+    return NULL;
+}
+
+// Test pipeline mode: parse on one thread, deliver on another through the SPSC queue
+void test_pipeline() {
+    printf("\n=== Testing Pipeline ===\n");
+
+    static const uint8_t stream[] = {
+        0x81, 0x05, 'h', 'e', 'l', 'l', 'o',
+        0x02, 0x03, 'a', 'b', 'c',
+        0x89, 0x01, 'p',
+        0x80, 0x03, 'd', 'e', 'f',
+        0x81, 0x03, 'b', 'y', 'e',
+    };
+    char path[] = "/tmp/ws_test_pipeline_XXXXXX";
+    int fd = mkstemp(path);
+    TEST("Create temporary capture", fd >= 0);
+    if (fd < 0) return;
+    int write_ok = write(fd, stream, sizeof(stream)) == (ssize_t)sizeof(stream);
+    close(fd);
+    TEST("Write capture", write_ok);
+
+    // Single thread, tiny queue: parsing pauses until the consumer drains
+    websocket_context_t *ws = ws_init_replay(path, 0.0);
+    if (ws && ws_get_rx_buffer_is_mirrored(ws)) {
+        ws_set_on_msg(ws, test_on_msg);
+        message_count = 0;
+        TEST("Enable pipeline", ws_set_pipeline(ws, 2) == 0);
+        TEST("Pipeline refuses permessage-deflate", ws_set_permessage_deflate(ws, 1, 0) == -1);
+        ws_update(ws);
+        TEST("IO thread does not call on_msg", message_count == 0);
+        TEST("Full queue pauses parsing", ws_pipeline_backlog(ws) == 2 && ws_get_stats(ws)->pipeline_full > 0);
+        TEST("Cannot disable with messages queued", ws_set_pipeline(ws, 0) == -1);
+        TEST("Consumer delivers the queued messages", ws_pipeline_poll(ws, 0) == 2 && message_count == 2 &&
+             last_message_len == 6 && memcmp(last_message, "abcdef", 6) == 0);
+        for (int i = 0; i < 10 && ws_get_state(ws) == WS_STATE_CONNECTED; i++) {
+            ws_update(ws);
+            ws_pipeline_poll(ws, 0);
+        }
+        TEST("Control frame inside a held message is not forwarded", message_count == 3 &&
+             last_message_len == 3 && memcmp(last_message, "bye", 3) == 0);
+        TEST("Pipeline replay ends CLOSED", ws_get_state(ws) == WS_STATE_CLOSED);
+        TEST("Disable once drained", ws_set_pipeline(ws, 0) == 0 && ws_pipeline_poll(ws, 0) == -1);
+    } else if (ws) {
+        printf("  (skipped: RX ring not mirrored)\n");
+    }
+    ws_free(ws);
+
+    // Two threads, a long stream through a queue much smaller than the stream
+    const int frames = 50000;
+    FILE *f = fopen(path, "wb");
+    for (int i = 0; f && i < frames; i++) {
+        uint8_t frame[2 + 4 + 32];
+        size_t len = 4 + (size_t)(i % 32);
+        frame[0] = 0x82;
+        frame[1] = (uint8_t)len;
+        uint32_t seq = (uint32_t)i;
+        memcpy(frame + 2, &seq, 4);
+        memset(frame + 6, 'x', len - 4);
+        fwrite(frame, 1, 2 + len, f);
+    }
+    if (f) fclose(f);
+
+    ws = ws_init_replay(path, 0.0);
+    if (ws && ws_set_pipeline(ws, 64) == 0) {
+        ws_set_on_msg(ws, pipe_on_msg);
+        pipe_expected = 0;
+        pipe_stop = 0;
+        pthread_t consumer;
+        int started = pthread_create(&consumer, NULL, pipe_consumer, ws) == 0;
+        TEST("Start consumer thread", started);
+        if (started) {
+            while (ws_get_state(ws) == WS_STATE_CONNECTED) ws_update(ws);
+            __atomic_store_n(&pipe_stop, 1, __ATOMIC_RELEASE);
+            pthread_join(consumer, NULL);
+            TEST("Consumer sees every message in order", pipe_expected == (uint32_t)frames && pipe_order_ok);
+            TEST("Descriptors carry payload and timestamps", pipe_stamps_ok);
+        }
+    }
+    ws_free(ws);
+    unlink(path);
+}
+
+// Test pull mode: bursts land in the caller's array, ring space held until released
+void test_poll_frames() {
+    printf("\n=== Testing Pull Mode ===\n");
+
+    static const uint8_t stream[] = {
+        0x81, 0x05, 'h', 'e', 'l', 'l', 'o',
+        0x02, 0x03, 'a', 'b', 'c',
+        0x89, 0x01, 'p',
+        0x80, 0x03, 'd', 'e', 'f',
+        0x81, 0x03, 'b', 'y', 'e',
+    };
+    char path[] = "/tmp/ws_test_poll_XXXXXX";
+    int fd = mkstemp(path);
+    TEST("Create temporary capture", fd >= 0);
+    if (fd < 0) return;
+    int write_ok = write(fd, stream, sizeof(stream)) == (ssize_t)sizeof(stream);
+    close(fd);
+    TEST("Write capture", write_ok);
+
+    websocket_context_t *ws = ws_init_replay(path, 0.0);
+    if (ws && ws_get_rx_buffer_is_mirrored(ws)) {
+        ws_set_on_msg(ws, test_on_msg);
+        message_count = 0;
+        ws_frame_t out[2];
+        TEST("Release before the first poll fails", ws_release_frames(ws) == -1);
+        int n = ws_poll_frames(ws, out, 2);
+        TEST("Poll fills the array", n == 2 && message_count == 0);
+        TEST("Frames in order, fragments reassembled", n == 2 &&
+             out[0].len == 5 && memcmp(out[0].payload, "hello", 5) == 0 && out[0].opcode == WS_FRAME_TEXT &&
+             out[1].len == 6 && memcmp(out[1].payload, "abcdef", 6) == 0 && out[1].opcode == WS_FRAME_BINARY);
+        TEST("Frames carry the parse timestamp", n == 2 && out[0].parsed_cycle != 0 &&
+             out[1].parsed_cycle >= out[0].parsed_cycle);
+        const uint8_t *held = out[0].payload;
+        TEST("Pull mode refuses pipeline and permessage-deflate",
+             ws_set_pipeline(ws, 4) == -1 && ws_set_permessage_deflate(ws, 1, 0) == -1);
+
+        n = ws_poll_frames(ws, out, 2);
+        TEST("Next poll continues after the held frames", n == 1 && out[0].len == 3 &&
+             memcmp(out[0].payload, "bye", 3) == 0);
+        TEST("Unreleased payloads stay valid", memcmp(held, "hello", 5) == 0);
+        TEST("Release frames", ws_release_frames(ws) == 0 && ws_get_stats(ws)->messages_rx == 3);
+        for (int i = 0; i < 10 && ws_get_state(ws) == WS_STATE_CONNECTED; i++) ws_poll_frames(ws, out, 2);
+        TEST("Pull replay ends CLOSED", ws_get_state(ws) == WS_STATE_CLOSED && ws_poll_frames(ws, out, 2) == -1);
+    } else if (ws) {
+        printf("  (skipped: RX ring not mirrored)\n");
+    }
+    ws_free(ws);
+
+    // A long stream through small batches: order and ring reuse across releases
+    const int frames = 50000;
+    FILE *f = fopen(path, "wb");
+    for (int i = 0; f && i < frames; i++) {
+        uint8_t frame[2 + 4 + 32];
+        size_t len = 4 + (size_t)(i % 32);
+        frame[0] = 0x82;
+        frame[1] = (uint8_t)len;
+        uint32_t seq = (uint32_t)i;
+        memcpy(frame + 2, &seq, 4);
+        memset(frame + 6, 'x', len - 4);
+        fwrite(frame, 1, 2 + len, f);
+    }
+    if (f) fclose(f);
+
+    ws = ws_init_replay(path, 0.0);
+    if (ws && ws_get_rx_buffer_is_mirrored(ws)) {
+        ws_frame_t batch[64];
+        uint32_t expected = 0;
+        int order_ok = 1;
+        while (ws_get_state(ws) == WS_STATE_CONNECTED) {
+            int n = ws_poll_frames(ws, batch, 64);
+            for (int i = 0; i < n; i++) {
+                uint32_t seq = 0;
+                if (batch[i].len >= 4) memcpy(&seq, batch[i].payload, 4);
+                if (batch[i].len != 4 + (seq % 32) || seq != expected) order_ok = 0;
+                expected++;
+            }
+            ws_release_frames(ws);
+        }
+        TEST("Every message polled in order", expected == (uint32_t)frames && order_ok);
+    }
+    ws_free(ws);
+    unlink(path);
+}
+
+// One notifier backend against a socketpair: READ, WRITE via mod, del, stale events
+static void check_notifier_backend(ws_notifier_backend_t backend, const char *name) {
+    ws_notifier_t *n = ws_notifier_init_ex(backend, 0);
+    int sv[2];
+    if (!n || socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+        TEST("Create notifier and socketpair", 0);
+        ws_notifier_free(n);
+        return;
+    }
+    printf("  Backend: %s%s\n", name, ws_notifier_get_backend(n) == backend ? "" : " (fallback)");
+    ws_notifier_set_mode(n, WS_NOTIFIER_MODE_TIMEOUT, 10000000ULL, 0);  // 10ms
+    int tag = 0;
+    ws_notifier_event_t ev[4];
+
+    TEST("Register fd", ws_notifier_add(n, sv[0], WS_EVENT_READ, &tag) == 0);
+    TEST("Idle fd times out", ws_notifier_wait_events(n, ev, 4) == 0);
+    TEST("Write wakes READ", write(sv[1], "x", 1) == 1 && ws_notifier_wait_events(n, ev, 4) == 1 &&
+         ev[0].user_data == &tag && (ev[0].events & WS_EVENT_READ));
+    char c;
+    TEST("Drain the byte", read(sv[0], &c, 1) == 1);
+    TEST("Mod adds WRITE", ws_notifier_mod(n, sv[0], WS_EVENT_READ | WS_EVENT_WRITE) == 0 &&
+         ws_notifier_wait_events(n, ev, 4) == 1 && ev[0].user_data == &tag && (ev[0].events & WS_EVENT_WRITE));
+    TEST("Mod back to READ", ws_notifier_mod(n, sv[0], WS_EVENT_READ) == 0);
+    TEST("Del stops events", ws_notifier_del(n, sv[0]) == 0 && write(sv[1], "y", 1) == 1 &&
+         ws_notifier_wait_events(n, ev, 4) == 0);
+    TEST("Busy-poll wait returns immediately", ws_notifier_set_mode(n, WS_NOTIFIER_MODE_TIMEOUT, 0, 0) == 0 &&
+         ws_notifier_wait_events(n, ev, 4) == 0);
+
+    close(sv[0]);
+    close(sv[1]);
+    ws_notifier_free(n);
+}
+
+// Test notifier backends (io_uring falls back to epoll where unavailable)
+void test_notifier() {
+    printf("\n=== Testing Notifier Backends ===\n");
+    check_notifier_backend(WS_NOTIFIER_BACKEND_DEFAULT, "default");
+    check_notifier_backend(WS_NOTIFIER_BACKEND_IO_URING, "io_uring");
+}
+
+// Timing wheel: fired timers record their order; one reschedules itself once
+static int timer_fired[4];
+static int timer_fire_count = 0;
+static ws_timer_t timers[4];
+
+static void on_timer(ws_timer_t *timer, uint64_t now) {
+    int id = (int)(timer - timers);
+    timer_fired[timer_fire_count++ & 3] = id;
+    if (id == 2 && timer_fire_count == 1) ws_timer_schedule(timer->wheel, timer, now + 1);  // Re-arm from the callback
+}
+
+void test_timer_wheel() {
+    printf("\n=== Testing Timing Wheel ===\n");
+
+    ws_timer_wheel_t *w = ws_timer_wheel_create(1000000);  // 1 ms ticks
+    TEST("Create wheel", w != NULL);
+    if (!w) return;
+
+    double ns_per_cycle = os_cycles_to_ns(1ULL << 30) / (double)(1ULL << 30);
+    uint64_t ms = (uint64_t)(1e6 / ns_per_cycle);
+    uint64_t base = os_get_cpu_cycle();
+    for (int i = 0; i < 4; i++) ws_timer_init(&timers[i], on_timer);
+    timer_fire_count = 0;
+
+    TEST("Empty wheel has no deadline", ws_timer_wheel_next(w) == WS_TIMER_NEVER);
+    ws_timer_schedule(w, &timers[0], base + 5 * ms);
+    ws_timer_schedule(w, &timers[1], base + 2 * ms);
+    ws_timer_schedule(w, &timers[2], base + 3 * ms);
+    ws_timer_schedule(w, &timers[3], base + 1000 * ms);  // Several rotations out
+    TEST("Four timers pending", ws_timer_wheel_count(w) == 4 && ws_timer_pending(&timers[3]));
+    TEST("Deadline bounds the earliest timer", ws_timer_wheel_next(w) <= base + 2 * ms);
+
+    ws_timer_schedule(w, &timers[1], base + 4 * ms);  // Reschedule moves it
+    ws_timer_cancel(&timers[0]);
+    TEST("Cancel unlinks", !ws_timer_pending(&timers[0]) && ws_timer_wheel_count(w) == 3);
+    ws_timer_cancel(&timers[0]);  // Twice is a no-op
+    TEST("Double cancel is harmless", ws_timer_wheel_count(w) == 3);
+
+    TEST("Nothing due before the earliest", ws_timer_wheel_advance(w, base + ms) == 0);
+    TEST("Due timer fires", ws_timer_wheel_advance(w, base + 3 * ms + ms / 2) == 1 && timer_fired[0] == 2);
+    TEST("Rescheduled from its callback", ws_timer_pending(&timers[2]));
+    TEST("Fires in a later pass", ws_timer_wheel_advance(w, base + 6 * ms) == 2 && timer_fire_count == 3);
+    TEST("Far timer survives rotations", ws_timer_wheel_advance(w, base + 600 * ms) == 0 && ws_timer_pending(&timers[3]));
+    TEST("Far timer fires when due", ws_timer_wheel_advance(w, base + 1001 * ms) == 1 && timer_fired[3] == 3);
+    TEST("Wheel empty again", ws_timer_wheel_count(w) == 0 && ws_timer_wheel_next(w) == WS_TIMER_NEVER);
+
+    ws_timer_schedule(w, &timers[0], base);  // Already past: next advance
+    ws_timer_wheel_free(w);
+    TEST("Free unlinks pending timers", !ws_timer_pending(&timers[0]));
+}
+
+// Heartbeat driven by the notifier wheel on an idle context
+static int hb_stale = 0;
+
+static void hb_on_status(websocket_context_t *ws __attribute__((unused)), int status) {
+    if (status == WS_STATUS_STALE) hb_stale++;
+}
+
+void test_heartbeat() {
+    printf("\n=== Testing Heartbeat ===\n");
+
+    websocket_context_t *ws = ws_init_replay("/dev/null", 0.0);  // Connected, never sends anything
+    ws_notifier_t *n = ws_notifier_init();
+    TEST("Create idle context and notifier", ws && n);
+    if (ws && n) {
+        ws_set_on_status(ws, hb_on_status);
+        hb_stale = 0;
+        TEST("Enable heartbeat", ws_set_heartbeat(ws, 5, 20) == 0);
+        ws_set_notifier(ws, n);
+        TEST("Deadline moved into the notifier wheel", ws_timer_wheel_count(ws_notifier_timers(n)) == 1);
+
+        // 1 s wait timeout: only the wheel deadline can end the waits early
+        ws_notifier_set_mode(n, WS_NOTIFIER_MODE_TIMEOUT, 1000000000ULL, 0);
+        ws_notifier_event_t events[4];
+        uint64_t start = os_get_cpu_cycle();
+        while (hb_stale == 0 && os_cycles_to_ns(os_get_cpu_cycle() - start) < 2e9) {
+            ws_notifier_wait_events(n, events, 4);
+        }
+        double elapsed_ms = os_cycles_to_ns(os_get_cpu_cycle() - start) / 1e6;
+        TEST("Stale feed reported from the wait", hb_stale == 1 && ws_get_stats(ws)->stale_timeouts == 1);
+        TEST("Waits are cut short by the deadline", elapsed_ms < 500.0);
+        TEST("PINGs sent while idle", ws_get_stats(ws)->pings_tx >= 2);
+        TEST("Still connected without auto_reconnect", ws_get_state(ws) == WS_STATE_CONNECTED);
+
+        ws_set_notifier(ws, NULL);
+        TEST("Unbinding takes the deadline back", ws_timer_wheel_count(ws_notifier_timers(n)) == 0);
+        TEST("Disable heartbeat", ws_set_heartbeat(ws, 0, 0) == 0);
+        ws_set_notifier(ws, n);
+        TEST("Nothing scheduled when off", ws_timer_wheel_count(ws_notifier_timers(n)) == 0);
+        ws_set_notifier(ws, NULL);
+    }
+    ws_free(ws);
+    ws_notifier_free(n);
+}
+
+// Pool workers: count messages and check they run off the main thread
+static uint64_t pool_messages = 0;
+static int pool_on_main = 0;
+static pthread_t pool_main_thread;
+
+static void pool_on_msg(websocket_context_t *ws __attribute__((unused)), const uint8_t *payload_ptr __attribute__((unused)),
+                        size_t payload_len __attribute__((unused)), uint8_t opcode __attribute__((unused))) {
+    __atomic_fetch_add(&pool_messages, 1, __ATOMIC_RELAXED);
+    if (pthread_equal(pthread_self(), pool_main_thread)) __atomic_store_n(&pool_on_main, 1, __ATOMIC_RELAXED);
+}
+
+// Test the sharded connection manager with replay contexts (no fd: workers poll them)
+void test_pool() {
+    printf("\n=== Testing Connection Pool ===\n");
+
+    const int frames = 20000;
+    char path[] = "/tmp/ws_test_pool_XXXXXX";
+    int fd = mkstemp(path);
+    TEST("Create temporary capture", fd >= 0);
+    if (fd < 0) return;
+    close(fd);
+    FILE *f = fopen(path, "wb");
+    for (int i = 0; f && i < frames; i++) {
+        static const uint8_t frame[] = { 0x81, 0x04, 't', 'i', 'c', 'k' };
+        fwrite(frame, 1, sizeof(frame), f);
+    }
+    if (f) fclose(f);
+
+    TEST("Reject zero workers", ws_pool_create(&(ws_pool_options_t){ .workers = 0 }) == NULL);
+    ws_pool_options_t opts = { .workers = 2 };
+    ws_pool_t *pool = ws_pool_create(&opts);
+    TEST("Create pool with 2 workers", pool != NULL && ws_pool_workers(pool) == 2);
+    if (!pool) {
+        unlink(path);
+        return;
+    }
+
+    pool_main_thread = pthread_self();
+    pool_messages = 0;
+    pool_on_main = 0;
+    websocket_context_t *ws[4] = { NULL, NULL, NULL, NULL };
+    for (int i = 0; i < 4; i++) {
+        ws[i] = ws_init_replay(path, 0.0);
+        if (ws[i]) ws_set_on_msg(ws[i], pool_on_msg);
+    }
+    TEST("Create replay contexts", ws[0] && ws[1] && ws[2] && ws[3]);
+    if (ws[0] && ws[1] && ws[2] && ws[3]) {
+        TEST("Explicit placement", ws_pool_add(pool, ws[0], NULL, 1) == 1 && ws_pool_shard_of(pool, ws[0]) == 1);
+        TEST("Adding twice fails", ws_pool_add(pool, ws[0], NULL, 0) == -1);
+        TEST("Least loaded placement", ws_pool_add(pool, ws[1], NULL, -1) == 0);
+        int shard = ws_pool_add(pool, ws[2], "btcusdt@trade", -1);
+        TEST("Hash placement is stable", shard >= 0 && shard < 2 && shard == ws_pool_shard_of(pool, ws[2]));
+        TEST("Out of range shard fails", ws_pool_add(pool, ws[3], NULL, 2) == -1);
+        TEST("Add fourth context", ws_pool_add(pool, ws[3], NULL, -1) >= 0);
+
+        uint64_t expected = 4 * (uint64_t)frames;
+        uint64_t start = os_get_cpu_cycle();
+        while (__atomic_load_n(&pool_messages, __ATOMIC_RELAXED) < expected &&
+               os_cycles_to_ns(os_get_cpu_cycle() - start) < 10e9) {
+            usleep(1000);
+        }
+        TEST("Workers deliver every message", __atomic_load_n(&pool_messages, __ATOMIC_RELAXED) == expected);
+        TEST("Callbacks run on worker threads", pool_on_main == 0);
+
+        ws_pool_shard_stats_t s0, s1;
+        ws_pool_get_shard_stats(pool, 0, &s0);
+        ws_pool_get_shard_stats(pool, 1, &s1);
+        TEST("Shard stats count connections and updates", s0.connections + s1.connections == 4 &&
+             s0.updates > 0 && s1.updates > 0 && s0.busy_cycles > 0);
+
+        TEST("First rebalance only takes a snapshot", ws_pool_rebalance(pool, 0.2) == 0);
+        TEST("Move to another worker", ws_pool_move(pool, ws[0], 0) == 0 && ws_pool_shard_of(pool, ws[0]) == 0);
+        TEST("Move to invalid shard fails", ws_pool_move(pool, ws[0], 5) == -1);
+        TEST("Remove hands the context back", ws_pool_remove(pool, ws[0]) == 0 && ws_pool_shard_of(pool, ws[0]) == -1);
+        TEST("Removing twice fails", ws_pool_remove(pool, ws[0]) == -1);
+    }
+    ws_pool_destroy(pool);  // Detaches the rest
+    for (int i = 0; i < 4; i++) ws_free(ws[i]);
+    unlink(path);
+}
+
+// Loopback listener on an ephemeral port; returns the fd, port in *port
+// Redundant feed: payloads "seq=N" carry the sequence number, anything else is unsequenced
+static int redundant_msgs = 0;
+static int redundant_controls = 0;
+static uint64_t redundant_seen = 0;     // Bit N: seq N delivered
+static int redundant_repeats = 0;
+
+static int redundant_seq(const uint8_t *payload, size_t len, uint8_t opcode __attribute__((unused)),
+                         uint64_t *seq, void *arg __attribute__((unused))) {
+    if (len < 5 || memcmp(payload, "seq=", 4) != 0) return -1;
+    uint64_t n = 0;
+    for (size_t i = 4; i < len && payload[i] >= '0' && payload[i] <= '9'; i++) n = n * 10 + (payload[i] - '0');
+    *seq = n;
+    return 0;
+}
+
+static void redundant_on_msg(websocket_context_t *ws __attribute__((unused)), const uint8_t *payload_ptr, size_t payload_len,
+                             uint8_t opcode) {
+    if (opcode >= WS_FRAME_CLOSE) {
+        redundant_controls++;
+        return;
+    }
+    redundant_msgs++;
+    uint64_t seq;
+    if (redundant_seq(payload_ptr, payload_len, opcode, &seq, NULL) == 0 && seq < 64) {
+        if (redundant_seen & (1ULL << seq)) redundant_repeats++;
+        redundant_seen |= 1ULL << seq;
+    }
+}
+
+// Text frames for the listed payloads ("PING" writes a PING frame)
+static int write_frames(char *path, const char *const *payloads, int n) {
+    int fd = mkstemp(path);
+    if (fd < 0) return -1;
+    int ok = 1;
+    for (int i = 0; i < n; i++) {
+        uint8_t frame[2 + 125];
+        size_t len = strlen(payloads[i]);
+        if (len > 125) return -1;
+        int ping = strcmp(payloads[i], "PING") == 0;
+        frame[0] = ping ? 0x89 : 0x81;
+        frame[1] = (uint8_t)len;
+        memcpy(frame + 2, payloads[i], len);
+        ok &= write(fd, frame, 2 + len) == (ssize_t)(2 + len);
+    }
+    close(fd);
+    return ok ? 0 : -1;
+}
+
+void test_redundant() {
+    printf("\n=== Testing Redundant Feed ===\n");
+
+    // Each leg misses messages the other one has
+    static const char *const leg_a[] = { "seq=1", "seq=2", "ok", "seq=3", "PING", "seq=5", "seq=6" };
+    static const char *const leg_b[] = { "seq=1", "seq=2", "seq=4", "seq=5", "seq=7" };
+    char path_a[] = "/tmp/ws_test_redundant_a_XXXXXX";
+    char path_b[] = "/tmp/ws_test_redundant_b_XXXXXX";
+    TEST("Write leg captures", write_frames(path_a, leg_a, 7) == 0 && write_frames(path_b, leg_b, 5) == 0);
+
+    websocket_context_t *legs[2] = { ws_init_replay(path_a, 0.0), ws_init_replay(path_b, 0.0) };
+    ws_redundant_options_t opts = { .seq = redundant_seq };
+    TEST("Reject group without extractor", ws_redundant_create(legs, 2, &(ws_redundant_options_t){ 0 }) == NULL);
+    TEST("Reject the same leg twice", ws_redundant_create((websocket_context_t *[]){ legs[0], legs[0] }, 2, &opts) == NULL);
+
+    ws_redundant_t *r = ws_redundant_create(legs, 2, &opts);
+    TEST("Create group of two replay legs", r != NULL && ws_redundant_legs(r) == 2 && ws_redundant_leg(r, 1) == legs[1]);
+    if (r) {
+        ws_redundant_set_on_msg(r, redundant_on_msg);
+        redundant_msgs = redundant_controls = redundant_repeats = 0;
+        redundant_seen = 0;
+        for (int i = 0; i < 20 && ws_redundant_update(r) > 0; i++) {}
+
+        ws_redundant_leg_stats_t a, b;
+        ws_redundant_get_leg_stats(r, 0, &a);
+        ws_redundant_get_leg_stats(r, 1, &b);
+        TEST("Every sequence number delivered exactly once", redundant_seen == 0xFE && redundant_repeats == 0);
+        TEST("Unsequenced and control frames pass through", redundant_msgs == 8 && redundant_controls == 1);
+        TEST("Leg stats split wins and duplicates", a.wins + b.wins == 7 && a.duplicates + b.duplicates == 3 &&
+             a.messages == 6 && b.messages == 5);
+        TEST("Newest sequence number", ws_redundant_last_seq(r) == 7);
+        ws_redundant_destroy(r);
+        TEST("Destroy detaches the legs", ws_get_user_data(legs[0]) == NULL);
+    }
+    ws_free(legs[0]);
+    ws_free(legs[1]);
+    unlink(path_a);
+    unlink(path_b);
+
+    // Beyond the window an old number is dropped, inside it fills a gap once
+    static const char *const leg_c[] = { "seq=100", "seq=20", "seq=100", "seq=99", "seq=99" };
+    char path_c[] = "/tmp/ws_test_redundant_c_XXXXXX";
+    TEST("Write window capture", write_frames(path_c, leg_c, 5) == 0);
+    websocket_context_t *leg = ws_init_replay(path_c, 0.0);
+    r = leg ? ws_redundant_create(&leg, 1, &opts) : NULL;
+    if (r) {
+        ws_redundant_set_on_msg(r, redundant_on_msg);
+        redundant_msgs = 0;
+        for (int i = 0; i < 20 && ws_redundant_update(r) > 0; i++) {}
+        ws_redundant_leg_stats_t c;
+        ws_redundant_get_leg_stats(r, 0, &c);
+        TEST("Window drops too old and repeated numbers", redundant_msgs == 2 && c.wins == 2 && c.duplicates == 3);
+        ws_redundant_destroy(r);
+    }
+    ws_free(leg);
+    unlink(path_c);
+}
+
+static int route_hits[1000];
+static int route_default_hits = 0;
+
+static void route_on_msg(websocket_context_t *ws __attribute__((unused)), const uint8_t *payload __attribute__((unused)),
+                         size_t len __attribute__((unused)), uint8_t opcode __attribute__((unused)), void *arg) {
+    route_hits[(int)(intptr_t)arg]++;
+}
+
+static void route_on_default(websocket_context_t *ws __attribute__((unused)), const uint8_t *payload __attribute__((unused)),
+                             size_t len __attribute__((unused)), uint8_t opcode __attribute__((unused)),
+                             void *arg __attribute__((unused))) {
+    route_default_hits++;
+}
+
+static void route_json(ws_router_t *r, const char *json) {
+    ws_router_dispatch(r, NULL, (const uint8_t *)json, strlen(json), WS_FRAME_TEXT);
+}
+
+void test_router() {
+    printf("\n=== Testing Router ===\n");
+
+    TEST("Reject JSON mode without a field", ws_router_create(&(ws_router_options_t){ .mode = WS_ROUTE_JSON_FIELD }) == NULL);
+    TEST("Reject prefix mode without a length", ws_router_create(&(ws_router_options_t){ .mode = WS_ROUTE_PREFIX }) == NULL);
+
+    ws_router_options_t opts = { .mode = WS_ROUTE_JSON_FIELD, .field = "stream" };
+    ws_router_t *r = ws_router_create(&opts);
+    TEST("Create JSON router", r != NULL);
+    if (!r) return;
+    ws_router_set_default(r, route_on_default, NULL);
+
+    int added = 1;
+    for (int i = 0; i < 1000; i++) {
+        char key[32];
+        int n = snprintf(key, sizeof(key), "sym%d@depth", i);
+        added &= ws_router_add(r, key, (size_t)n, route_on_msg, (void *)(intptr_t)i) == 0;
+    }
+    TEST("Perfect hash over 1000 keys", added && ws_router_routes(r) == 1000);
+    TEST("Duplicate key rejected", ws_router_add(r, "sym7@depth", 10, route_on_msg, NULL) == -1);
+
+    memset(route_hits, 0, sizeof(route_hits));
+    route_default_hits = 0;
+    int all_ok = 1;
+    for (int i = 0; i < 1000; i++) {
+        char json[96];
+        snprintf(json, sizeof(json), "{\"stream\":\"sym%d@depth\",\"data\":{\"u\":%d}}", i, i);
+        route_json(r, json);
+        if (route_hits[i] != 1) all_ok = 0;
+    }
+    TEST("Every key reaches its handler", all_ok && route_default_hits == 0);
+
+    memset(route_hits, 0, sizeof(route_hits));
+    route_json(r, "{\"e\":\"depthUpdate\",\"E\":1700000000000,\"stream\":\"sym42@depth\"}");
+    TEST("Field past the first SIMD block", route_hits[42] == 1);
+    route_json(r, "{ \"stream\" :  \"sym43@depth\" }");
+    TEST("Whitespace around the colon", route_hits[43] == 1);
+    route_json(r, "{\"data\":{\"stream\":\"sym1@depth\"},\"stream\":\"sym44@depth\"}");
+    TEST("Nested field with the same name is skipped", route_hits[44] == 1 && route_hits[1] == 0);
+    route_json(r, "{\"note\":\"\\\"stream\\\":\\\"sym2@depth\\\"\",\"stream\":\"sym45@depth\"}");
+    TEST("Field name inside a string value is skipped", route_hits[45] == 1 && route_hits[2] == 0);
+
+    route_json(r, "{\"stream\":\"nosuch@depth\"}");
+    route_json(r, "{\"result\":null,\"id\":1}");
+    ws_router_dispatch(r, NULL, (const uint8_t *)"p", 1, WS_FRAME_PING);
+    ws_router_stats_t st;
+    ws_router_get_stats(r, &st);
+    TEST("Unknown keys and control frames go to the default", route_default_hits == 3 &&
+         st.unmatched == 2 && st.control == 1 && st.routed == 1004);
+
+    TEST("Remove a route", ws_router_remove(r, "sym42@depth", 11) == 0 && ws_router_routes(r) == 999 &&
+         ws_router_remove(r, "sym42@depth", 11) == -1);
+    route_json(r, "{\"stream\":\"sym42@depth\"}");
+    route_json(r, "{\"stream\":\"sym999@depth\"}");
+    TEST("Removed key is unmatched, others still route", route_default_hits == 4 && route_hits[999] == 1);
+    ws_router_free(r);
+
+    // Fixed-offset prefix, attached to a replay context
+    ws_router_options_t popts = { .mode = WS_ROUTE_PREFIX, .offset = 2, .key_len = 4 };
+    r = ws_router_create(&popts);
+    TEST("Create prefix router", r != NULL);
+    if (!r) return;
+    ws_router_set_default(r, route_on_default, NULL);
+    TEST("Prefix key of the wrong length rejected", ws_router_add(r, "BTC", 3, route_on_msg, NULL) == -1);
+    TEST("Add prefix routes", ws_router_add(r, "BTCU", 4, route_on_msg, (void *)(intptr_t)1) == 0 &&
+         ws_router_add(r, "ETHU", 4, route_on_msg, (void *)(intptr_t)2) == 0);
+
+    static const char *const feed[] = { "T:BTCU 1", "T:ETHU 2", "T:BTCU 3", "T:", "T:XRPU 4" };
+    char path[] = "/tmp/ws_test_router_XXXXXX";
+    TEST("Write prefix capture", write_frames(path, feed, 5) == 0);
+    memset(route_hits, 0, sizeof(route_hits));
+    route_default_hits = 0;
+    websocket_context_t *ws = ws_init_replay(path, 0.0);
+    if (ws) {
+        TEST("Attach router", ws_router_attach(r, ws) == 0);
+        for (int i = 0; i < 10 && ws_get_state(ws) == WS_STATE_CONNECTED; i++) ws_update(ws);
+        TEST("Replay routed by prefix", route_hits[1] == 2 && route_hits[2] == 1 && route_default_hits == 2);
+    }
+    ws_free(ws);
+    ws_router_free(r);
+    unlink(path);
+}
+
+static int listen_loopback(int *port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_in sin;
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(sin);
+    if (bind(fd, (struct sockaddr *)&sin, sizeof(sin)) < 0 || listen(fd, 8) < 0 ||
+        getsockname(fd, (struct sockaddr *)&sin, &len) < 0) {
+        close(fd);
+        return -1;
+    }
+    *port = ntohs(sin.sin_port);
+    return fd;
+}
+
+// Reader in another process: sees every message of the fan-out in order
+static int shm_child(const char *name, int ready_fd, int count) {
+    ws_shm_reader_t *r = ws_shm_open(name);
+    char c = r ? 1 : 0;
+    if (write(ready_fd, &c, 1) != 1 || !r) return 1;
+    close(ready_fd);
+
+    ws_shm_frame_t f;
+    int got = 0;
+    uint64_t first_seq = 0;
+    uint64_t start = os_get_cpu_cycle();
+    while (got < count && os_cycles_to_ns_u64(os_get_cpu_cycle() - start) < 5000000000ULL) {
+        int ret = ws_shm_read(r, &f);
+        if (ret < 0) return 2;
+        if (ret == 0) continue;
+        uint32_t seq = 0;
+        if (got == 0) first_seq = f.seq;
+        if (f.len != 64 || (memcpy(&seq, f.payload, 4), seq) != (uint32_t)got || f.seq != first_seq + (uint64_t)got ||
+            !ws_shm_read_valid(r)) {
+            return 3;
+        }
+        got++;
+    }
+    ws_shm_close(r);
+    return got == count ? 0 : 4;
+}
+
+// Test shared-memory fan-out: publisher context, in-process and forked readers, overruns
+void test_shm() {
+    printf("\n=== Testing Shared-Memory Fan-out ===\n");
+
+    char name[64];
+    snprintf(name, sizeof(name), "/ws_test_shm_%d", (int)getpid());
+    TEST("Open of a missing segment returns NULL", ws_shm_open(name) == NULL);
+    ws_shm_publisher_t *pub = ws_shm_create(name, WS_SHM_MIN_CAPACITY);
+    TEST("Create publisher", pub != NULL);
+    if (!pub) return;
+    TEST("Second publisher on a live name refused", ws_shm_create(name, 0) == NULL);
+    ws_shm_reader_t *r = ws_shm_open(name);
+    TEST("Open reader", r != NULL && ws_shm_publisher_alive(r) && ws_shm_backlog(r) == 0);
+    if (!r) {
+        ws_shm_destroy(pub);
+        return;
+    }
+
+    // Frames parsed by a (replay) context go straight to the segment
+    char path[] = "/tmp/ws_test_shm_XXXXXX";
+    static const char *const feed[] = { "alpha", "beta", "PING", "gamma", "delta" };
+    TEST("Write capture", write_frames(path, feed, 5) == 0);
+    websocket_context_t *ws = ws_init_replay(path, 0.0);
+    if (ws) {
+        TEST("Attach publisher", ws_shm_attach(pub, ws) == 0);
+        for (int i = 0; i < 10 && ws_get_state(ws) == WS_STATE_CONNECTED; i++) ws_update(ws);
+        ws_free(ws);
+    }
+    unlink(path);
+
+    ws_shm_frame_t f;
+    int in_order = 1, stamps_ok = 1, n = 0;
+    while (ws_shm_read(r, &f) == 1) {
+        const char *want = feed[n];
+        if (f.seq != (uint64_t)n + 1 || f.len != strlen(want) || memcmp(f.payload, want, f.len) != 0 ||
+            f.opcode != (strcmp(want, "PING") == 0 ? WS_FRAME_PING : WS_FRAME_TEXT)) {
+            in_order = 0;
+        }
+        if (!f.parsed_cycle || f.publish_cycle < f.parsed_cycle) stamps_ok = 0;
+        n++;
+    }
+    TEST("Reader sees every frame in order", n == 5 && in_order);
+    TEST("Stage timestamps travel with the frame", stamps_ok && ws_shm_read_valid(r));
+
+    // Another process reading the same segment
+    int pipefd[2];
+    TEST("Create sync pipe", pipe(pipefd) == 0);
+    pid_t child = fork();
+    if (child == 0) {
+        close(pipefd[0]);
+        _exit(shm_child(name, pipefd[1], 1000));
+    }
+    close(pipefd[1]);
+    char ready = 0;
+    int synced = child > 0 && read(pipefd[0], &ready, 1) == 1 && ready == 1;
+    close(pipefd[0]);
+    uint8_t msg[64] = {0};
+    for (uint32_t i = 0; synced && i < 1000; i++) {
+        memcpy(msg, &i, 4);
+        ws_shm_publish(pub, NULL, msg, sizeof(msg), WS_FRAME_BINARY);
+        if ((i & 31) == 31) usleep(100);  // Stay well inside one ring of 64 KB
+    }
+    int status = -1;
+    if (child > 0) waitpid(child, &status, 0);
+    TEST("Forked reader receives 1000 messages in order", synced && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    // Lapped reader: detected, resumes at the newest message, counts what it lost
+    // (this one also fell behind while the child read)
+    ws_shm_reader_stats_t rs, rs0;
+    while (ws_shm_read(r, &f) != 0) {}
+    ws_shm_publish(pub, NULL, msg, sizeof(msg), WS_FRAME_BINARY);
+    TEST("Read before lapping", ws_shm_read(r, &f) == 1 && ws_shm_read_valid(r));
+    ws_shm_reader_get_stats(r, &rs0);
+    for (int i = 0; i < 1000; i++) ws_shm_publish(pub, NULL, msg, sizeof(msg), WS_FRAME_BINARY);
+    TEST("Lapped payload reported invalid", ws_shm_read_valid(r) == 0);
+    TEST("Overrun detected", ws_shm_read(r, &f) == -1 && ws_shm_read(r, &f) == 0);
+    ws_shm_publish(pub, NULL, msg, sizeof(msg), WS_FRAME_BINARY);
+    TEST("Reader resumes after overrun", ws_shm_read(r, &f) == 1);
+    ws_shm_reader_get_stats(r, &rs);
+    TEST("Lost messages counted", rs.overruns == rs0.overruns + 1 && rs.lost == rs0.lost + 1000);
+
+    static uint8_t big[WS_SHM_MIN_CAPACITY];
+    ws_shm_publisher_stats_t ps;
+    TEST("Message larger than the ring rejected", ws_shm_publish(pub, NULL, big, sizeof(big), WS_FRAME_BINARY) == -1);
+    ws_shm_publisher_get_stats(pub, &ps);
+    TEST("Publisher stats", ps.messages == 5 + 1000 + 1 + 1000 + 1 && ps.oversize == 1);
+
+    ws_shm_destroy(pub);
+    TEST("Reader sees the publisher gone", ws_shm_publisher_alive(r) == 0);
+    ws_shm_close(r);
+    TEST("Name unlinked on destroy", ws_shm_open(name) == NULL);
+}
+
+// Test the resolver cache, Happy Eyeballs fallback and reconnect with backoff
+void test_async_connect() {
+    printf("\n=== Testing Async Connect and Reconnect ===\n");
+
+    ws_resolved_t r;
+    TEST("Literal IPv4 needs no lookup", ws_resolver_lookup("127.0.0.1", 443, &r) == 1 && r.count == 1 &&
+         r.addrs[0].ss_family == AF_INET && ntohs(((struct sockaddr_in *)&r.addrs[0])->sin_port) == 443);
+    TEST("Literal IPv6 needs no lookup", ws_resolver_lookup("::1", 80, &r) == 1 && r.addrs[0].ss_family == AF_INET6);
+    TEST("Pin rejects non-literal address", ws_resolver_pin("feed.test", "not-an-ip") == -1);
+    TEST("Pin IPv6 then IPv4", ws_resolver_pin("feed.test", "::1") == 0 && ws_resolver_pin("feed.test", "127.0.0.1") == 0);
+    TEST("Pinned host resolves in order", ws_resolver_lookup("feed.test", 9, &r) == 1 && r.count == 2 &&
+         r.addrs[0].ss_family == AF_INET6 && r.addrs[1].ss_family == AF_INET);
+
+    int ret = ws_resolver_lookup("localhost", 443, &r);
+    TEST("First lookup of a name does not block", ret == 0 || ret == 1);
+    for (int i = 0; i < 2000 && ret == 0; i++) {
+        usleep(1000);
+        ret = ws_resolver_lookup("localhost", 443, &r);
+    }
+    TEST("Background lookup completes", ret == 1 && r.count >= 1);
+
+    int port = 0;
+    int lfd = listen_loopback(&port);
+    TEST("Loopback listener", lfd >= 0);
+    if (lfd < 0) {
+        ws_resolver_flush();
+        return;
+    }
+
+    // feed.test: ::1 has no listener (refused, or no IPv6 at all), 127.0.0.1 does
+    char url[64];
+    snprintf(url, sizeof(url), "wss://feed.test:%d/", port);
+    ws_options_t opts = {0};
+    opts.async_connect = 1;
+    opts.auto_reconnect = 1;
+    opts.reconnect_base_ms = 1;
+    opts.reconnect_max_ms = 4;
+    websocket_context_t *ws = ws_init_ex(url, &opts);
+    TEST("Async init returns before connecting", ws != NULL && ws_get_fd(ws) < 0 &&
+         ws_get_state(ws) == WS_STATE_CONNECTING);
+    if (!ws) {
+        close(lfd);
+        ws_resolver_flush();
+        return;
+    }
+
+    for (int i = 0; i < 2000 && ws_get_fd(ws) < 0; i++) {
+        ws_update(ws);
+        usleep(500);
+    }
+    TEST("Falls back to the IPv4 candidate", ws_get_fd(ws) >= 0);
+
+    // Listener hangs up instead of speaking TLS: the attempt fails and a reconnect follows
+    int afd = accept(lfd, NULL, NULL);
+    TEST("Listener saw the connection", afd >= 0);
+    if (afd >= 0) close(afd);
+    const ws_stats_t *stats = ws_get_stats(ws);
+    for (int i = 0; i < 4000 && stats->reconnects == 0; i++) {
+        ws_update(ws);
+        usleep(500);
+    }
+    TEST("Failed handshake is counted", stats->connect_failures >= 1);
+    TEST("Reconnect started after backoff", stats->reconnects >= 1);
+    TEST("Reconnecting context reports CONNECTING", ws_get_state(ws) == WS_STATE_CONNECTING);
+    TEST("Connect time not recorded without an upgrade", stats->connect_time.count == 0);
+    TEST("No TLS session resumed without a handshake", ws_get_session_reused(ws) == 0 && stats->tls_resumptions == 0);
+
+    ws_close(ws);
+    uint64_t reconnects = stats->reconnects;
+    for (int i = 0; i < 20; i++) {
+        ws_update(ws);
+        usleep(500);
+    }
+    TEST("ws_close stops reconnecting", ws_get_state(ws) == WS_STATE_CLOSED && stats->reconnects == reconnects);
+    ws_free(ws);
+
+    websocket_context_t *replay = ws_init_replay("/dev/null", 0.0);
+    TEST("Replay contexts cannot reconnect", replay == NULL || ws_reconnect(replay) == -1);
+    ws_free(replay);
+
+    close(lfd);
+    ws_resolver_flush();
+    TEST("Flush drops pinned entries", ws_resolver_lookup("feed.test", 9, &r) != 1);
+}
+
+// Counting wrapper around the plain TCP backend: a custom transport table
+static int custom_sends = 0;
+static int counting_send(void *conn, const uint8_t *data, size_t len) {
+    custom_sends++;
+    return ws_transport_tcp.send(conn, data, len);
+}
+
+// Read from fd until the end of the HTTP header block (or buffer full / timeout)
+static int read_http_request(int fd, char *buf, size_t size) {
+    size_t len = 0;
+    for (int i = 0; i < 2000 && len + 1 < size; i++) {
+        ssize_t n = recv(fd, buf + len, size - 1 - len, MSG_DONTWAIT);
+        if (n > 0) {
+            len += (size_t)n;
+            buf[len] = '\0';
+            if (strstr(buf, "\r\n\r\n")) return (int)len;
+        } else {
+            usleep(500);
+        }
+    }
+    return -1;
+}
+
+// ws:// over the plain TCP transport against a loopback server
+void test_plain_transport() {
+    printf("\n=== Testing Plain ws:// Transport ===\n");
+
+    int port = 0;
+    int lfd = listen_loopback(&port);
+    TEST("Loopback listener", lfd >= 0);
+    if (lfd < 0) return;
+
+    char url[64];
+    snprintf(url, sizeof(url), "ws://127.0.0.1:%d/feed", port);
+    ws_transport_t counting = ws_transport_tcp;
+    counting.send = counting_send;
+    ws_options_t opts = {0};
+    opts.async_connect = 1;
+    opts.transport = &counting;
+    websocket_context_t *ws = ws_init_ex(url, &opts);
+    TEST("ws:// context created", ws != NULL);
+    if (!ws) {
+        close(lfd);
+        return;
+    }
+    ws_set_on_msg(ws, test_on_msg);
+    message_count = 0;
+
+    for (int i = 0; i < 2000 && ws_get_fd(ws) < 0; i++) {
+        ws_update(ws);
+        usleep(500);
+    }
+    int afd = accept(lfd, NULL, NULL);
+    TEST("Server accepted the connection", afd >= 0);
+    if (afd < 0) {
+        ws_free(ws);
+        close(lfd);
+        return;
+    }
+
+    char req[2048];
+    char host[64];
+    snprintf(host, sizeof(host), "Host: 127.0.0.1:%d\r\n", port);
+    TEST("Upgrade request sent in clear", read_http_request(afd, req, sizeof(req)) > 0 &&
+         strncmp(req, "GET /feed HTTP/1.1\r\n", 20) == 0 && strstr(req, host) != NULL);
+    TEST("Custom transport table carried the request", custom_sends >= 1);
+
+    const char *resp = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n\r\n";
+    TEST("Server sent the 101", send(afd, resp, strlen(resp), 0) == (ssize_t)strlen(resp));
+    for (int i = 0; i < 2000 && ws_get_state(ws) != WS_STATE_CONNECTED; i++) {
+        ws_update(ws);
+        usleep(500);
+    }
+    TEST("Upgrade completes over TCP", ws_get_state(ws) == WS_STATE_CONNECTED);
+    TEST("No TLS on a ws:// connection", ws_get_cipher_name(ws) == NULL && ws_get_session_reused(ws) == 0 &&
+         strcmp(ws_get_tls_mode(ws), "None (Plain TCP)") == 0);
+
+    // Two frames in one segment: both parsed from a single recv()
+    const uint8_t frames[] = {0x81, 0x05, 'h', 'e', 'l', 'l', 'o', 0x82, 0x03, 1, 2, 3};
+    TEST("Server sent two frames", send(afd, frames, sizeof(frames), 0) == (ssize_t)sizeof(frames));
+    for (int i = 0; i < 2000 && message_count < 2; i++) {
+        ws_update(ws);
+        usleep(500);
+    }
+    TEST("Both frames delivered", message_count == 2 && last_opcode == WS_FRAME_BINARY && last_message_len == 3);
+
+    // Client frame arrives masked on the wire
+    TEST("ws_send over TCP", ws_send(ws, (const uint8_t *)"ping", 4) >= 0);
+    for (int i = 0; i < 10; i++) ws_update(ws);
+    uint8_t out[16];
+    size_t got = 0;
+    for (int i = 0; i < 2000 && got < 10; i++) {
+        ssize_t n = recv(afd, out + got, sizeof(out) - got, MSG_DONTWAIT);
+        if (n > 0) got += (size_t)n;
+        else usleep(500);
+    }
+    int unmasked = got == 10 && out[0] == 0x81 && out[1] == (0x80 | 4);
+    for (int i = 0; unmasked && i < 4; i++) {
+        if ((out[6 + i] ^ out[2 + i]) != (uint8_t)"ping"[i]) unmasked = 0;
+    }
+    TEST("Server reads the masked frame", unmasked);
+
+    // Peer hangs up: EOF on recv() drops the connection
+    close(afd);
+    const ws_stats_t *stats = ws_get_stats(ws);
+    for (int i = 0; i < 2000 && stats->disconnects == 0; i++) {
+        ws_update(ws);
+        usleep(500);
+    }
+    TEST("EOF detected as a disconnect", stats->disconnects == 1 && ws_get_state(ws) != WS_STATE_CONNECTED);
+    ws_free(ws);
+
+    // Blocking connect: returns with the socket up (the listener backlog accepts it)
+    snprintf(url, sizeof(url), "ws://127.0.0.1:%d", port);
+    ws = ws_init(url);
+    TEST("Blocking ws:// connect", ws != NULL && ws_get_fd(ws) >= 0);
+    ws_free(ws);
+    close(lfd);
+}
+
+// Stream bytes seen by each message's callback (latency vs throughput scheduling)
+static uint64_t rx_mode_bytes[8];
+static uint64_t rx_mode_recv_end[8];
+static int rx_mode_count = 0;
+static void rx_mode_on_msg(websocket_context_t *ws, const uint8_t *payload_ptr __attribute__((unused)),
+                           size_t payload_len __attribute__((unused)), uint8_t opcode __attribute__((unused))) {
+    if (rx_mode_count < 8) {
+        rx_mode_bytes[rx_mode_count] = ws_get_stats(ws)->bytes_rx;
+        rx_mode_recv_end[rx_mode_count] = ws_get_recv_end_timestamp(ws);
+    }
+    rx_mode_count++;
+}
+
+// Connect ws to a loopback listener and complete the upgrade; returns the server socket
+static int plain_upgrade(websocket_context_t *ws, int lfd) {
+    for (int i = 0; i < 2000 && ws_get_fd(ws) < 0; i++) {
+        ws_update(ws);
+        usleep(500);
+    }
+    int afd = accept(lfd, NULL, NULL);
+    char req[2048];
+    const char *resp = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n\r\n";
+    if (afd < 0 || read_http_request(afd, req, sizeof(req)) < 0 ||
+        send(afd, resp, strlen(resp), 0) != (ssize_t)strlen(resp)) {
+        if (afd >= 0) close(afd);
+        return -1;
+    }
+    for (int i = 0; i < 2000 && ws_get_state(ws) != WS_STATE_CONNECTED; i++) {
+        ws_update(ws);
+        usleep(500);
+    }
+    return afd;
+}
+
+// Three 7-byte frames arriving together: latency mode reads and dispatches them one by one
+void test_rx_latency_mode() {
+    printf("\n=== Testing Latency-First Receive ===\n");
+
+    int port = 0;
+    int lfd = listen_loopback(&port);
+    TEST("Loopback listener", lfd >= 0);
+    if (lfd < 0) return;
+
+    char url[64];
+    snprintf(url, sizeof(url), "ws://127.0.0.1:%d/", port);
+    ws_options_t bad = {0};
+    bad.rx_mode = (ws_rx_mode_t)7;
+    TEST("Unknown receive mode rejected", ws_init_ex(url, &bad) == NULL);
+
+    const uint8_t frames[] = {0x81, 0x05, 'a', 'a', 'a', 'a', 'a',
+                              0x81, 0x05, 'b', 'b', 'b', 'b', 'b',
+                              0x81, 0x05, 'c', 'c', 'c', 'c', 'c'};
+    for (int mode = 0; mode < 2; mode++) {
+        ws_options_t opts = {0};
+        opts.async_connect = 1;
+        opts.rx_mode = mode ? WS_RX_LATENCY : WS_RX_THROUGHPUT;
+        opts.rx_read_budget = 7;
+        websocket_context_t *ws = ws_init_ex(url, &opts);
+        int afd = ws ? plain_upgrade(ws, lfd) : -1;
+        if (afd < 0) {
+            TEST("Loopback upgrade", 0);
+            ws_free(ws);
+            continue;
+        }
+        ws_set_on_msg(ws, rx_mode_on_msg);
+        rx_mode_count = 0;
+        uint64_t base = ws_get_stats(ws)->bytes_rx;
+        uint64_t reads = ws_get_stats(ws)->reads;
+
+        int sent = send(afd, frames, sizeof(frames), 0) == (ssize_t)sizeof(frames);
+        usleep(2000);  // All three frames queued in the socket before the update
+        for (int i = 0; i < 2000 && rx_mode_count < 3; i++) {
+            ws_update(ws);
+            usleep(500);
+        }
+        if (mode) {
+            TEST("Latency mode: every frame delivered", sent && rx_mode_count == 3);
+            TEST("Latency mode: each frame before the next read",
+                 rx_mode_bytes[0] - base == 7 && rx_mode_bytes[1] - base == 14 && rx_mode_bytes[2] - base == 21);
+            TEST("Latency mode: recv timestamps per read",
+                 rx_mode_recv_end[0] < rx_mode_recv_end[1] && rx_mode_recv_end[1] < rx_mode_recv_end[2]);
+            TEST("Latency mode: one update drained the burst",
+                 ws_get_stats(ws)->reads - reads == 1 && ws_get_stats(ws)->ssl_pending_loops >= 2);
+            TEST("Switch back to throughput", ws_set_rx_mode(ws, WS_RX_THROUGHPUT, 0) == 0 &&
+                 ws_set_rx_mode(ws, (ws_rx_mode_t)7, 0) == -1);
+        } else {
+            TEST("Throughput mode: batch parsed after the read",
+                 sent && rx_mode_count == 3 && rx_mode_bytes[0] - base == 21 && rx_mode_bytes[2] - base == 21);
+        }
+        close(afd);
+        ws_free(ws);
+    }
+    close(lfd);
+}
+
+// Server side: read exactly n bytes from fd, driving ws in between
+static int urgent_read(websocket_context_t *ws, int fd, uint8_t *buf, size_t n) {
+    size_t got = 0;
+    for (int i = 0; i < 4000 && got < n; i++) {
+        ws_update(ws);
+        ssize_t r = recv(fd, buf + got, n - got, MSG_DONTWAIT);
+        if (r > 0) got += (size_t)r;
+        else usleep(250);
+    }
+    return got == n ? 0 : -1;
+}
+
+// Unmask a short client frame in place; returns its opcode, -1 if it is not a masked short frame
+static int urgent_frame(uint8_t *frame, size_t payload_len) {
+    if ((frame[1] & 0x80) == 0 || (frame[1] & 0x7F) != payload_len) return -1;
+    for (size_t i = 0; i < payload_len; i++) frame[6 + i] ^= frame[2 + (i & 3)];
+    return frame[0] & 0x0F;
+}
+
+// Control frames and ws_send_urgent() go out ahead of a full (or corked) TX ring
+void test_urgent_lane() {
+    printf("\n=== Testing Urgent TX Lane ===\n");
+
+    int port = 0;
+    int lfd = listen_loopback(&port);
+    TEST("Loopback listener", lfd >= 0);
+    if (lfd < 0) return;
+
+    char url[64];
+    snprintf(url, sizeof(url), "ws://127.0.0.1:%d/", port);
+    ws_options_t opts = {0};
+    opts.async_connect = 1;
+    opts.tx_ring_size = 16 * 1024;
+    websocket_context_t *ws = ws_init_ex(url, &opts);
+    int afd = ws ? plain_upgrade(ws, lfd) : -1;
+    TEST("Loopback upgrade", afd >= 0 && ws_get_state(ws) == WS_STATE_CONNECTED);
+    if (afd < 0) {
+        ws_free(ws);
+        close(lfd);
+        return;
+    }
+
+    uint8_t bulk[1000];
+    memset(bulk, 'o', sizeof(bulk));
+    uint8_t buf[64];
+
+    // Without cork: an urgent frame queued after data frames still leaves first
+    int queued = ws_send_ex(ws, bulk, sizeof(bulk), WS_FRAME_BINARY, 1) == (int)sizeof(bulk) &&
+                 ws_send_ex(ws, bulk, sizeof(bulk), WS_FRAME_BINARY, 1) == (int)sizeof(bulk);
+    TEST("Urgent frame accepted", queued && ws_send_urgent(ws, (const uint8_t *)"cxl", 3, WS_FRAME_TEXT) == 3);
+    TEST("Flush", ws_flush_tx(ws) == 0);
+    TEST("Urgent frame first on the wire", urgent_read(ws, afd, buf, 9) == 0 &&
+         urgent_frame(buf, 3) == WS_FRAME_TEXT && memcmp(buf + 6, "cxl", 3) == 0);
+    static uint8_t sink[32 * 1024];
+    TEST("Queued data frames follow", urgent_read(ws, afd, sink, 2 * (8 + sizeof(bulk))) == 0 &&
+         sink[0] == 0x82 && sink[8 + sizeof(bulk)] == 0x82);
+
+    // Corked with the TX ring full: the PONG is neither dropped nor held back
+    ws_cork(ws);
+    int frames = 0;
+    while (ws_send_ex(ws, bulk, sizeof(bulk), WS_FRAME_BINARY, 1) > 0) frames++;
+    TEST("TX ring filled", frames > 0);
+    const uint8_t ping[] = {0x89, 0x02, 'h', 'b'};
+    TEST("Server PING sent", send(afd, ping, sizeof(ping), 0) == (ssize_t)sizeof(ping));
+    TEST("PONG answered over a full, corked ring", urgent_read(ws, afd, buf, 8) == 0 &&
+         urgent_frame(buf, 2) == WS_FRAME_PONG && memcmp(buf + 6, "hb", 2) == 0);
+    TEST("Corked data frames stay queued", recv(afd, buf, sizeof(buf), MSG_DONTWAIT) < 0 && ws_wants_write(ws));
+    TEST("Urgent lane counted", ws_get_stats(ws)->urgent_tx == 2 && ws_get_stats(ws)->urgent_dropped == 0);
+
+    TEST("CONTINUATION and CLOSE rejected",
+         ws_send_urgent(ws, bulk, 1, WS_FRAME_CONTINUATION) == -1 && ws_send_urgent(ws, bulk, 2, WS_FRAME_CLOSE) == -1);
+    TEST("Oversized urgent frame rejected", ws_send_urgent(ws, bulk, WS_TX_URGENT_LANE, WS_FRAME_BINARY) == -1);
+
+    TEST("Uncork", ws_uncork(ws) == 0);
+    size_t bulk_bytes = (size_t)frames * (8 + sizeof(bulk));
+    TEST("Corked data frames sent after uncork", urgent_read(ws, afd, sink, bulk_bytes) == 0 && sink[0] == 0x82);
+
+    // Server CLOSE while the ring is full again: the CLOSE response goes out, data not yet sent is dropped
+    while (ws_send_ex(ws, bulk, sizeof(bulk), WS_FRAME_BINARY, 1) > 0) {}
+    ws_cork(ws);  // Keep the data queued until the CLOSE arrives
+    const uint8_t close_frame[] = {0x88, 0x02, 0x03, 0xE8};
+    TEST("Server CLOSE sent", send(afd, close_frame, sizeof(close_frame), 0) == (ssize_t)sizeof(close_frame));
+    TEST("CLOSE response not stuck behind the ring", urgent_read(ws, afd, buf, 8) == 0 &&
+         urgent_frame(buf, 2) == WS_FRAME_CLOSE && buf[6] == 0x03 && buf[7] == 0xE8);
+    for (int i = 0; i < 10; i++) ws_update(ws);
+    TEST("Nothing sent after the CLOSE", recv(afd, buf, sizeof(buf), MSG_DONTWAIT) < 0 &&
+         ws_get_state(ws) == WS_STATE_CLOSED);
+
+    close(afd);
+    ws_free(ws);
+    close(lfd);
+}
+
+// Fragment reassembly through the arena: what a message is delivered from, per on_msg call
+#define ARENA_MSGS 8
+#define ARENA_CHUNK 1020                    // Loopback fragment payload (1 KB with its header), one fill byte each
+#define ARENA_CAP (64u * 1024u * 1024u)     // WS_FRAG_ARENA_MAX in ws.c
+static int arena_count;
+static uint8_t arena_opcode[ARENA_MSGS];
+static size_t arena_len[ARENA_MSGS];
+static uintptr_t arena_addr[ARENA_MSGS];
+static int arena_ok[ARENA_MSGS];
+
+static void arena_on_msg(websocket_context_t *ws __attribute__((unused)), const uint8_t *payload_ptr,
+                         size_t payload_len, uint8_t opcode) {
+    if (arena_count >= ARENA_MSGS) return;
+    int ok = 1;
+    for (size_t i = 0; i < payload_len && payload_len >= ARENA_CHUNK && payload_len < ARENA_CAP; i++) {
+        ok &= payload_ptr[i] == (uint8_t)(payload_ptr[0] + i / ARENA_CHUNK);
+    }
+    arena_opcode[arena_count] = opcode;
+    arena_len[arena_count] = payload_len;
+    arena_addr[arena_count] = (uintptr_t)payload_ptr;
+    arena_ok[arena_count] = ok;
+    arena_count++;
+}
+
+// Unmasked server frame with payload_len bytes of fill; returns bytes written
+static size_t arena_frame(uint8_t *dst, uint8_t first_byte, size_t payload_len, uint8_t fill) {
+    size_t header_len = 2;
+    dst[0] = first_byte;
+    if (payload_len <= 125) {
+        dst[1] = (uint8_t)payload_len;
+    } else if (payload_len <= 65535) {
+        dst[1] = 126;
+        dst[2] = (payload_len >> 8) & 0xFF;
+        dst[3] = payload_len & 0xFF;
+        header_len = 4;
+    } else {
+        dst[1] = 127;
+        for (int i = 0; i < 8; i++) dst[2 + i] = ((uint64_t)payload_len >> (56 - 8 * i)) & 0xFF;
+        header_len = 10;
+    }
+    memset(dst + header_len, fill, payload_len);
+    return header_len + payload_len;
+}
+
+// Fragmented message of n 1 MB frames (plus extra bytes in the first) into a capture file
+static int arena_write_message(int fd, uint8_t *frame, int n, size_t extra) {
+    for (int i = 0; i < n; i++) {
+        uint8_t first_byte = (i == 0 ? WS_FRAME_BINARY : WS_FRAME_CONTINUATION) | (i == n - 1 ? 0x80 : 0);
+        size_t len = arena_frame(frame, first_byte, (1u << 20) + (i == 0 ? extra : 0), 'm');
+        if (write(fd, frame, len) != (ssize_t)len) return -1;
+    }
+    return 0;
+}
+
+// Send n bytes and drive ws until it has read all of them
+static int arena_send(websocket_context_t *ws, int fd, const uint8_t *buf, size_t n) {
+    uint64_t target = ws_get_stats(ws)->bytes_rx + n;
+    if (send(fd, buf, n, 0) != (ssize_t)n) return -1;
+    for (int i = 0; i < 4000 && ws_get_stats(ws)->bytes_rx < target; i++) {
+        ws_update(ws);
+        if (ws_get_stats(ws)->bytes_rx < target) usleep(250);
+    }
+    return ws_get_stats(ws)->bytes_rx == target ? 0 : -1;
+}
+
+// Small (4 KB) RX ring: a fragmented message is held in place until the ring is three
+// quarters full, then spills to the arena; PINGs in between are answered either way
+void test_fragment_arena() {
+    printf("\n=== Testing Fragment Reassembly Arena ===\n");
+
+    int port = 0;
+    int lfd = listen_loopback(&port);
+    TEST("Loopback listener", lfd >= 0);
+    if (lfd < 0) return;
+
+    char url[64];
+    snprintf(url, sizeof(url), "ws://127.0.0.1:%d/", port);
+    ws_options_t opts = {0};
+    opts.async_connect = 1;
+    opts.rx_ring_size = 4096;
+    websocket_context_t *ws = ws_init_ex(url, &opts);
+    int afd = ws ? plain_upgrade(ws, lfd) : -1;
+    TEST("Loopback upgrade", afd >= 0 && ws_get_state(ws) == WS_STATE_CONNECTED);
+    if (afd < 0) {
+        ws_free(ws);
+        close(lfd);
+        return;
+    }
+    ws_set_on_msg(ws, arena_on_msg);
+    arena_count = 0;
+
+    // "x" marks the ring, then two held fragments (2052 bytes, half the ring) and the last one
+    static uint8_t stream[16 * 1024];
+    size_t n = arena_frame(stream, 0x81, 1, 'x');
+    n += arena_frame(stream + n, WS_FRAME_BINARY, ARENA_CHUNK, 'a');
+    n += arena_frame(stream + n, 0x89, 2, '1');
+    n += arena_frame(stream + n, WS_FRAME_CONTINUATION, ARENA_CHUNK, 'b');
+    int sent = arena_send(ws, afd, stream, n) == 0;
+    n = arena_frame(stream, 0x80, ARENA_CHUNK, 'c');
+    sent &= arena_send(ws, afd, stream, n) == 0;
+
+    // Three held fragments (3072 bytes) leave 1023 free, one under a quarter: spill, so the
+    // short last fragment, which would still fit, is appended to the arena
+    n = 0;
+    for (int i = 0; i < 3; i++) {
+        n += arena_frame(stream + n, i == 0 ? WS_FRAME_BINARY : WS_FRAME_CONTINUATION, ARENA_CHUNK, (uint8_t)('d' + i));
+    }
+    sent &= arena_send(ws, afd, stream, n) == 0;
+    n = arena_frame(stream, 0x80, 100, 'g');
+    sent &= arena_send(ws, afd, stream, n) == 0;
+
+    // Ten fragments (2.5x the ring) with a PING after the spill, then "y"
+    n = 0;
+    for (int i = 0; i < 10; i++) {
+        uint8_t first_byte = (i == 0 ? WS_FRAME_BINARY : WS_FRAME_CONTINUATION) | (i == 9 ? 0x80 : 0);
+        n += arena_frame(stream + n, first_byte, ARENA_CHUNK, (uint8_t)('h' + i));
+        if (i == 5) n += arena_frame(stream + n, 0x89, 2, '2');
+    }
+    n += arena_frame(stream + n, 0x81, 1, 'y');
+    sent &= arena_send(ws, afd, stream, n) == 0;
+    TEST("Server frames sent and read", sent);
+
+    TEST("Every message and PING delivered in order", arena_count == 7 &&
+         arena_opcode[0] == WS_FRAME_TEXT && arena_opcode[1] == WS_FRAME_PING &&
+         arena_opcode[2] == WS_FRAME_BINARY && arena_opcode[3] == WS_FRAME_BINARY &&
+         arena_opcode[4] == WS_FRAME_PING && arena_opcode[5] == WS_FRAME_BINARY &&
+         arena_opcode[6] == WS_FRAME_TEXT);
+    size_t dist[ARENA_MSGS];
+    for (int i = 0; i < ARENA_MSGS; i++) {
+        dist[i] = arena_addr[i] > arena_addr[0] ? arena_addr[i] - arena_addr[0] : arena_addr[0] - arena_addr[i];
+    }
+    TEST("Below the threshold: reassembled in the ring", arena_len[2] == 3 * ARENA_CHUNK && arena_ok[2] &&
+         (dist[2] < 2 * 4096) == ws_get_rx_buffer_is_mirrored(ws));
+    TEST("Three quarters full: spilled to the arena", arena_len[3] == 3 * ARENA_CHUNK + 100 && arena_ok[3] &&
+         dist[3] >= 2 * 4096);
+    TEST("Larger than the ring: reassembled in the arena", arena_len[5] == 10 * ARENA_CHUNK && arena_ok[5] &&
+         dist[5] >= 2 * 4096);
+    uint8_t pongs[16];
+    TEST("PINGs inside fragmented messages answered", urgent_read(ws, afd, pongs, sizeof(pongs)) == 0 &&
+         urgent_frame(pongs, 2) == WS_FRAME_PONG && pongs[6] == '1' &&
+         urgent_frame(pongs + 8, 2) == WS_FRAME_PONG && pongs[14] == '2');
+    TEST("Connection stays up", ws_get_state(ws) == WS_STATE_CONNECTED);
+    close(afd);
+    ws_free(ws);
+    close(lfd);
+
+    // Arena cap: a message of exactly 64 MB is delivered, one byte more closes the
+    // connection (the TEXT after it never arrives)
+    char path[] = "/tmp/ws_test_arena_XXXXXX";
+    int fd = mkstemp(path);
+    uint8_t *frame = (uint8_t *)malloc((1u << 20) + 16);
+    TEST("Create arena capture", fd >= 0 && frame != NULL);
+    if (fd < 0 || !frame) {
+        if (fd >= 0) close(fd);
+        free(frame);
+        return;
+    }
+    uint8_t tail[3];
+    size_t tail_len = arena_frame(tail, 0x81, 1, 'z');
+    int write_ok = arena_write_message(fd, frame, 64, 0) == 0 && arena_write_message(fd, frame, 64, 1) == 0 &&
+                   write(fd, tail, tail_len) == (ssize_t)tail_len;
+    close(fd);
+    free(frame);
+    TEST("Write arena capture", write_ok);
+
+    ws = ws_init_replay(path, 0.0);
+    TEST("Create replay context", ws != NULL);
+    if (ws) {
+        ws_set_on_msg(ws, arena_on_msg);
+        arena_count = 0;
+        for (int i = 0; i < 100000 && ws_get_state(ws) == WS_STATE_CONNECTED; i++) ws_update(ws);
+        TEST("64 MB message delivered through the arena", arena_count >= 1 && arena_len[0] == ARENA_CAP);
+        TEST("Message past the cap rejected", arena_count == 1 && ws_get_state(ws) == WS_STATE_CLOSED);
+        ws_free(ws);
+    }
+    unlink(path);
+}
+
+// io_uring data path: messages and bytes seen by the bound context
+static int uring_msgs;
+static size_t uring_bytes;
+
+static void uring_on_msg(websocket_context_t *ws __attribute__((unused)), const uint8_t *payload_ptr __attribute__((unused)),
+                         size_t payload_len, uint8_t opcode) {
+    if (opcode == WS_FRAME_PING) return;
+    uring_msgs++;
+    uring_bytes += payload_len;
+}
+
+// One notifier wait, then ws_update() for every context it reported
+static void uring_pump(ws_notifier_t *n) {
+    ws_notifier_event_t ev[4];
+    int k = ws_notifier_wait_events(n, ev, 4);
+    for (int i = 0; i < k; i++) ws_update((websocket_context_t *)ev[i].user_data);
+}
+
+// Server side: read exactly len bytes from fd while the notifier drives the client
+static int uring_read(ws_notifier_t *n, int fd, uint8_t *buf, size_t len) {
+    size_t got = 0;
+    for (int i = 0; i < 4000 && got < len; i++) {
+        uring_pump(n);
+        ssize_t r = recv(fd, buf + got, len - got, MSG_DONTWAIT);
+        if (r > 0) got += (size_t)r;
+    }
+    return got == len ? 0 : -1;
+}
+
+// Reads and writes of a bound ws:// context as RECV/SEND completions, driven by
+// notifier events only; detaching hands completed bytes back and returns to the transport
+void test_uring_io() {
+    printf("\n=== Testing io_uring Data Path ===\n");
+
+    ws_notifier_t *n = ws_notifier_init_ex(WS_NOTIFIER_BACKEND_IO_URING, WS_NOTIFIER_URING_IO);
+    int sv[2];
+    if (!n || socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+        TEST("Create notifier and socketpair", 0);
+        ws_notifier_free(n);
+        return;
+    }
+    int tag = 0;
+    if (ws_notifier_add(n, sv[0], WS_EVENT_READ, &tag) < 0 || ws_notifier_io_attach(n, sv[0]) < 0) {
+        printf("  Skipped: io_uring data path unavailable\n");
+        close(sv[0]);
+        close(sv[1]);
+        ws_notifier_free(n);
+        return;
+    }
+    ws_notifier_set_mode(n, WS_NOTIFIER_MODE_TIMEOUT, 1000000ULL, 0);  // 1ms
+    ws_notifier_event_t ev[4];
+
+    // Raw API on a socketpair
+    uint8_t buf[16] = {0};
+    TEST("RECV queued", ws_notifier_io_recv(n, sv[0], buf, sizeof(buf)) == 0 &&
+         ws_notifier_io_recv(n, sv[0], buf, sizeof(buf)) == 0);
+    TEST("Completion is the READ event", write(sv[1], "abc", 3) == 3 && ws_notifier_wait_events(n, ev, 4) == 1 &&
+         ev[0].user_data == &tag && (ev[0].events & WS_EVENT_READ));
+    TEST("Bytes already in the buffer", ws_notifier_io_recv(n, sv[0], buf, sizeof(buf)) == 3 && memcmp(buf, "abc", 3) == 0);
+    TEST("SEND completes as WRITE", ws_notifier_io_send(n, sv[0], (const uint8_t *)"xy", 2) == 0 &&
+         ws_notifier_io_send(n, sv[0], (const uint8_t *)"zz", 2) == 0 &&  // One in flight: not queued
+         ws_notifier_wait_events(n, ev, 4) == 1 && (ev[0].events & WS_EVENT_WRITE) &&
+         ws_notifier_io_sent(n, sv[0]) == 2 && read(sv[1], buf, sizeof(buf)) == 2 && memcmp(buf, "xy", 2) == 0);
+    TEST("New WRITE interest wakes the loop", ws_notifier_mod(n, sv[0], WS_EVENT_READ | WS_EVENT_WRITE) == 0 &&
+         ws_notifier_wait_events(n, ev, 4) == 1 && (ev[0].events & WS_EVENT_WRITE) &&
+         ws_notifier_mod(n, sv[0], WS_EVENT_READ) == 0);
+    int rx = -1;
+    int tx = -1;
+    TEST("Detach returns an uncollected RECV", ws_notifier_io_recv(n, sv[0], buf, sizeof(buf)) == 0 &&
+         write(sv[1], "def", 3) == 3 && ws_notifier_wait_events(n, ev, 4) == 1 &&
+         ws_notifier_io_detach(n, sv[0], &rx, &tx) == 0 && rx == 3 && tx == 0 && memcmp(buf, "def", 3) == 0);
+    TEST("Detached fd is polled again", ws_notifier_io_sent(n, sv[0]) == -1 && write(sv[1], "g", 1) == 1 &&
+         ws_notifier_wait_events(n, ev, 4) == 1 && (ev[0].events & WS_EVENT_READ) && read(sv[0], buf, 1) == 1);
+    TEST("Detach cancels a RECV in flight", ws_notifier_io_attach(n, sv[0]) == 0 &&
+         ws_notifier_io_recv(n, sv[0], buf, sizeof(buf)) == 0 && ws_notifier_io_detach(n, sv[0], &rx, NULL) == 0 &&
+         rx == 0 && write(sv[1], "h", 1) == 1 && read(sv[0], buf, 1) == 1 && buf[0] == 'h');
+    ws_notifier_del(n, sv[0]);
+    close(sv[0]);
+    close(sv[1]);
+
+    // A ws:// context bound to the notifier
+    int port = 0;
+    int lfd = listen_loopback(&port);
+    TEST("Loopback listener", lfd >= 0);
+    if (lfd < 0) {
+        ws_notifier_free(n);
+        return;
+    }
+    char url[64];
+    snprintf(url, sizeof(url), "ws://127.0.0.1:%d/", port);
+    ws_options_t opts = {0};
+    opts.async_connect = 1;
+    opts.tx_ring_size = 16 * 1024;  // Bulk sends below take many SENDs
+    websocket_context_t *ws = ws_init_ex(url, &opts);
+    int afd = ws ? plain_upgrade(ws, lfd) : -1;
+    int fd = ws ? ws_get_fd(ws) : -1;
+    TEST("Loopback upgrade", afd >= 0 && ws_get_state(ws) == WS_STATE_CONNECTED);
+    if (afd < 0) {
+        ws_free(ws);
+        close(lfd);
+        ws_notifier_free(n);
+        return;
+    }
+    ws_set_on_msg(ws, uring_on_msg);
+    uring_msgs = 0;
+    uring_bytes = 0;
+    TEST("Bound context moves onto the data path", ws_notifier_add(n, fd, WS_EVENT_READ, ws) == 0 &&
+         (ws_set_notifier(ws, n), ws_notifier_io_sent(n, fd) == 0));
+
+    static uint8_t stream[4096];
+    size_t len = arena_frame(stream, 0x81, 3, 'o');
+    len += arena_frame(stream + len, 0x89, 2, 'p');
+    len += arena_frame(stream + len, 0x82, 1000, 'b');
+    TEST("Server frames sent", send(afd, stream, len, 0) == (ssize_t)len);
+    for (int i = 0; i < 2000 && uring_msgs < 2; i++) uring_pump(n);
+    TEST("Messages received through RECV completions", uring_msgs == 2 && uring_bytes == 1003);
+    uint8_t pong[8];
+    TEST("PONG sent through a SEND", uring_read(n, afd, pong, sizeof(pong)) == 0 &&
+         urgent_frame(pong, 2) == WS_FRAME_PONG && pong[6] == 'p');
+
+    // 100 KB through a 16 KB TX ring
+    uint8_t payload[1000];
+    memset(payload, 'u', sizeof(payload));
+    size_t want = 100 * (8 + sizeof(payload));
+    uint64_t tx_before = ws_get_stats(ws)->bytes_tx;
+    static uint8_t sink[64 * 1024];
+    size_t got = 0;
+    int queued = 0;
+    for (int i = 0; i < 20000 && got < want; i++) {
+        while (queued < 100 && ws_send_ex(ws, payload, sizeof(payload), WS_FRAME_BINARY, 1) > 0) queued++;
+        uring_pump(n);
+        ssize_t r = recv(afd, sink, sizeof(sink), MSG_DONTWAIT);
+        if (r > 0) got += (size_t)r;
+    }
+    TEST("Bulk frames leave in order through SENDs", queued == 100 && got == want &&
+         ws_get_stats(ws)->bytes_tx - tx_before == want && !ws_wants_write(ws));
+
+    // Detach with a RECV in flight, then the transport reads again
+    ws_set_notifier(ws, NULL);
+    TEST("Unbinding leaves the data path", ws_notifier_io_sent(n, fd) == -1);
+    len = arena_frame(stream, 0x81, 3, 't');
+    TEST("Server frame sent", send(afd, stream, len, 0) == (ssize_t)len);
+    for (int i = 0; i < 2000 && uring_msgs < 3; i++) {
+        ws_update(ws);
+        usleep(250);
+    }
+    TEST("Transport reads after the detach", uring_msgs == 3);
+
+    // Bound again: EOF arrives as a RECV completion
+    ws_set_notifier(ws, n);
+    TEST("Rebinding attaches again", ws_notifier_io_sent(n, fd) == 0);
+    close(afd);
+    for (int i = 0; i < 2000 && ws_get_state(ws) == WS_STATE_CONNECTED; i++) uring_pump(n);
+    TEST("Peer close ends the connection", ws_get_state(ws) == WS_STATE_CLOSED);
+
+    ws_set_notifier(ws, NULL);
+    ws_notifier_del(n, fd);
+    ws_free(ws);
+    close(lfd);
+    ws_notifier_free(n);
+}
+
+// Client frames the peer received, unmasked in place: ring BINARY frames carry their
+// index in every byte, PONGs the PING counter in their first two bytes
+static int uring_lane_check(uint8_t *p, size_t len, int *binary, int *pongs) {
+    int next_pong = -1;
+    *binary = 0;
+    *pongs = 0;
+    size_t off = 0;
+    while (off < len) {
+        if (len - off < 6 || !(p[off + 1] & 0x80)) return -1;
+        size_t plen = p[off + 1] & 0x7F;
+        size_t hdr = 6;
+        if (plen == 126) {
+            if (len - off < 8) return -1;
+            plen = ((size_t)p[off + 2] << 8) | p[off + 3];
+            hdr = 8;
+        } else if (plen == 127) {
+            return -1;
+        }
+        if (len - off < hdr + plen) return -1;
+        uint8_t *mask = p + off + hdr - 4;
+        uint8_t *payload = p + off + hdr;
+        for (size_t i = 0; i < plen; i++) payload[i] ^= mask[i & 3];
+        if (p[off] == 0x82) {
+            if (plen != 1000) return -1;
+            for (size_t i = 0; i < plen; i++) {
+                if (payload[i] != (uint8_t)*binary) return -1;
+            }
+            (*binary)++;
+        } else if (p[off] == 0x8A) {
+            int counter = (payload[0] << 8) | payload[1];
+            if (plen != 125 || counter <= next_pong) return -1;
+            for (size_t i = 2; i < plen; i++) {
+                if (payload[i] != 'p') return -1;
+            }
+            next_pong = counter;
+            (*pongs)++;
+        } else {
+            return -1;
+        }
+        off += hdr + plen;
+    }
+    return 0;
+}
+
+// Data path with both TX lanes: a slow peer keeps SENDs in flight while PINGs fill the
+// urgent lane with PONGs, so the lane reaches its end with a SEND reading it; unbinding
+// then cancels a SEND and the transport finishes. The peer must see intact frames in order
+void test_uring_urgent_lane() {
+    printf("\n=== Testing io_uring Data Path with the Urgent Lane ===\n");
+
+    ws_notifier_t *n = ws_notifier_init_ex(WS_NOTIFIER_BACKEND_IO_URING, WS_NOTIFIER_URING_IO);
+    int port = 0;
+    int lfd = listen_loopback(&port);
+    TEST("Loopback listener", lfd >= 0);
+    if (!n || lfd < 0) {
+        ws_notifier_free(n);
+        if (lfd >= 0) close(lfd);
+        return;
+    }
+    ws_notifier_set_mode(n, WS_NOTIFIER_MODE_TIMEOUT, 1000000ULL, 0);  // 1ms
+    int small = 4096;
+    setsockopt(lfd, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));  // Inherited by the peer
+
+    char url[64];
+    snprintf(url, sizeof(url), "ws://127.0.0.1:%d/", port);
+    ws_options_t opts = {0};
+    opts.async_connect = 1;
+    opts.tx_ring_size = 64 * 1024;
+    websocket_context_t *ws = ws_init_ex(url, &opts);
+    int afd = ws ? plain_upgrade(ws, lfd) : -1;
+    int fd = ws ? ws_get_fd(ws) : -1;
+    TEST("Loopback upgrade", afd >= 0 && ws_get_state(ws) == WS_STATE_CONNECTED);
+    if (afd < 0) {
+        ws_free(ws);
+        close(lfd);
+        ws_notifier_free(n);
+        return;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &small, sizeof(small));
+    ws_notifier_add(n, fd, WS_EVENT_READ, ws);
+    ws_set_notifier(ws, n);
+    if (ws_notifier_get_backend(n) != WS_NOTIFIER_BACKEND_IO_URING || ws_notifier_io_sent(n, fd) != 0) {
+        printf("  Skipped: io_uring data path unavailable\n");
+        ws_set_notifier(ws, NULL);
+        ws_notifier_del(n, fd);
+        ws_free(ws);
+        close(afd);
+        close(lfd);
+        ws_notifier_free(n);
+        return;
+    }
+
+    uint8_t payload[1000];
+    int queued = 0;
+    for (;;) {
+        memset(payload, queued, sizeof(payload));
+        if (ws_send_ex(ws, payload, sizeof(payload), WS_FRAME_BINARY, 1) <= 0) break;
+        queued++;
+    }
+    TEST("TX ring filled", queued > 32);
+
+    // Three PINGs per round against 256 bytes read: the lane fills and keeps wrapping
+    static uint8_t got[256 * 1024];
+    size_t got_len = 0;
+    uint8_t ping[127];
+    int pings = 0;
+    uint64_t urgent_before = ws_get_stats(ws)->urgent_tx;
+    for (int round = 0; round < 150; round++) {
+        for (int k = 0; k < 3; k++) {
+            size_t len = arena_frame(ping, 0x89, 125, 'p');
+            ping[2] = (uint8_t)(pings >> 8);
+            ping[3] = (uint8_t)pings;
+            if (send(afd, ping, len, 0) == (ssize_t)len) pings++;
+        }
+        uring_pump(n);
+        uring_pump(n);
+        ssize_t r = recv(afd, got + got_len, 256, MSG_DONTWAIT);
+        if (r > 0) got_len += (size_t)r;
+    }
+    TEST("PONGs queued behind SENDs in flight", ws_get_stats(ws)->urgent_tx - urgent_before >= 32 &&
+         ws_get_stats(ws)->urgent_dropped > 0);
+    TEST("TX still owed to the peer", ws_wants_write(ws));
+
+    // Unbind with a SEND in flight: the transport takes over mid-stream
+    ws_set_notifier(ws, NULL);
+    TEST("Unbinding leaves the data path", ws_notifier_io_sent(n, fd) == -1);
+    for (int i = 0; i < 20000 && got_len < sizeof(got); i++) {
+        ws_update(ws);
+        ssize_t r = recv(afd, got + got_len, sizeof(got) - got_len, MSG_DONTWAIT);
+        if (r > 0) {
+            got_len += (size_t)r;
+        } else if (!ws_wants_write(ws)) {
+            break;
+        } else {
+            usleep(100);
+        }
+    }
+    int binary = 0;
+    int pongs = 0;
+    TEST("Peer stream intact and in order", uring_lane_check(got, got_len, &binary, &pongs) == 0);
+    TEST("Every ring frame sent", binary == queued);
+    TEST("Every queued PONG sent", (uint64_t)pongs == ws_get_stats(ws)->urgent_tx - urgent_before &&
+         (uint64_t)pongs + ws_get_stats(ws)->urgent_dropped == (uint64_t)pings);
+
+    ws_notifier_del(n, fd);
+    ws_free(ws);
+    close(afd);
+    close(lfd);
+    ws_notifier_free(n);
+}
+
+// Test runtime ring sizing, lazy TX and the shared ring pool
+void test_ring_options() {
+    printf("\n=== Testing Ring Options ===\n");
+
+    ringbuffer_t rb __attribute__((aligned(CACHE_LINE_SIZE)));
+    TEST("Sized ring init", ringbuffer_init_size(&rb, 100000, NULL) == 0);
+    TEST("Size rounded up to a power of two", ringbuffer_size(&rb) == 131072);
+    TEST("Free space is size - 1", ringbuffer_available_write(&rb) == 131071);
+    ringbuffer_free(&rb);
+    TEST("Tiny size clamps to the minimum", ringbuffer_init_size(&rb, 1, NULL) == 0 &&
+         ringbuffer_size(&rb) == RINGBUFFER_MIN_SIZE);
+    ringbuffer_free(&rb);
+
+    ws_options_t opts = {0};
+    opts.rx_ring_size = 64 * 1024;
+    opts.tx_ring_size = 4096;
+    opts.lazy_tx = 1;
+    websocket_context_t *ws = ws_init_ex("ws://localhost:8080/", &opts);
+    TEST("ws_init_ex with small rings", ws != NULL);
+    if (ws) {
+        TEST("Lazy TX ring not allocated yet", ws_get_tx_buffer_is_mirrored(ws) == 0 &&
+             ws_get_tx_buffer_is_mmap(ws) == 0);
+        ws_free(ws);
+    }
+
+    ringbuffer_pool_t *pool = ringbuffer_pool_create(8 * 1024 * 1024);
+    TEST("Create ring pool", pool != NULL);
+    if (pool) {
+        size_t per_ring = ringbuffer_pool_is_hugepage(pool) ? 2 * 1024 * 1024 : 256 * 1024;
+        ringbuffer_t a __attribute__((aligned(CACHE_LINE_SIZE)));
+        ringbuffer_t b __attribute__((aligned(CACHE_LINE_SIZE)));
+        TEST("Carve two rings", ringbuffer_init_size(&a, 256 * 1024, pool) == 0 &&
+             ringbuffer_init_size(&b, 256 * 1024, pool) == 0);
+        TEST("Pool accounts for both rings", ringbuffer_pool_used(pool) == 2 * per_ring);
+        TEST("Pooled rings are distinct", a.pulled_data != b.pulled_data);
+
+        // Wrap across the end: mirrored rings still hand out one contiguous region
+        size_t size = ringbuffer_size(&a);
+        uint8_t *w = NULL;
+        size_t len = 0;
+        ringbuffer_get_write_ptr(&a, &w, &len);
+        ringbuffer_commit_write(&a, size - 10);
+        ringbuffer_advance_read(&a, size - 10);
+        ringbuffer_get_write_ptr(&a, &w, &len);
+        memset(w, 0xAB, 20);
+        ringbuffer_commit_write(&a, 20);
+        uint8_t *r = NULL;
+        ringbuffer_peek_read(&a, &r, &len);
+        int wrap_ok = len == 20 && r[0] == 0xAB && r[19] == 0xAB;
+        if (ringbuffer_is_mirrored(&a)) wrap_ok = wrap_ok && a.pulled_data[9] == 0xAB;
+        TEST("Pooled ring wraps correctly", wrap_ok);
+
+        ringbuffer_free(&a);
+        TEST("Freed slot returns to the pool", ringbuffer_pool_used(pool) == per_ring);
+        TEST("Freed slot is reused", ringbuffer_init_size(&a, 256 * 1024, pool) == 0 &&
+             ringbuffer_pool_used(pool) == 2 * per_ring);
+        ringbuffer_free(&a);
+        ringbuffer_free(&b);
+
+        opts.pool = pool;
+        ws = ws_init_ex("ws://localhost:8080/", &opts);
+        TEST("ws_init_ex from pool", ws != NULL && ws_get_rx_buffer_is_mirrored(ws));
+        ws_free(ws);
+        ringbuffer_pool_destroy(pool);
+    }
+}
+
+static long minor_faults(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_minflt;
+}
+
+// Test NUMA binding, pre-faulting and mlock of ring memory
+void test_ring_memory() {
+    printf("\n=== Testing Ring Memory Preparation ===\n");
+
+    ringbuffer_t rb __attribute__((aligned(CACHE_LINE_SIZE)));
+    TEST("Init 1 MB ring", ringbuffer_init_size(&rb, 1 << 20, NULL) == 0);
+    int done = ringbuffer_prepare(&rb, RINGBUFFER_MEM_PREFAULT, 0);
+    TEST("Prefault always succeeds", done == RINGBUFFER_MEM_PREFAULT && ringbuffer_mem_status(&rb) == done);
+
+    // Writing the whole ring (both mirror halves) takes no further page faults
+    long before = minor_faults();
+    memset(rb.pulled_data, 1, rb.is_mirrored ? 2u << 20 : 1u << 20);
+    long faults = minor_faults() - before;
+    printf("Faults touching prefaulted ring: %ld\n", faults);
+    TEST("No page faults after prefault", faults < 8);
+    ringbuffer_free(&rb);
+
+    // NUMA and mlock depend on the machine: only check the status reports the truth
+    ws_options_t opts = {0};
+    opts.rx_ring_size = 256 * 1024;
+    opts.ring_mem_flags = WS_RING_NUMA_BIND | WS_RING_PREFAULT | WS_RING_MLOCK;
+    opts.numa_node = -1;
+    opts.lazy_tx = 1;
+    websocket_context_t *ws = ws_init_ex("ws://localhost:8080/", &opts);
+    TEST("ws_init_ex with ring memory flags", ws != NULL);
+    if (ws) {
+        int status = ws_get_rx_buffer_mem_status(ws);
+        printf("RX ring: numa=%d prefault=%d mlock=%d\n", !!(status & WS_RING_NUMA_BIND),
+               !!(status & WS_RING_PREFAULT), !!(status & WS_RING_MLOCK));
+        TEST("RX status includes prefault", (status & WS_RING_PREFAULT) != 0);
+        TEST("Lazy TX not prepared yet", ws_get_tx_buffer_mem_status(ws) == 0);
+        ws_free(ws);
+    }
+    TEST("Status getter with NULL context", ws_get_rx_buffer_mem_status(NULL) == 0);
+}
+
+static int prewarm_msgs = 0;
+static void prewarm_on_msg(websocket_context_t *ws, const uint8_t *payload, size_t len, uint8_t opcode) {
+    (void)ws; (void)payload; (void)len; (void)opcode;
+    prewarm_msgs++;
+}
+
+// Test ws_library_prewarm / ws_prewarm: timed steps, no trace of the synthetic frames
+void test_prewarm() {
+    printf("\n=== Testing Pre-warm ===\n");
+
+    ws_prewarm_report_t r;
+    TEST("Library prewarm", ws_library_prewarm(&r) == 0);
+    printf("Library prewarm: total=%.2f ms clock=%.2f ms tls=%.2f ms parser=%.2f ms (%llu frames)\n",
+           r.total_ns / 1e6, r.clock_ns / 1e6, r.transport_ns / 1e6, r.parser_ns / 1e6,
+           (unsigned long long)r.frames);
+    TEST("Library prewarm parses synthetic frames", r.frames >= 4096 && r.parser_ns > 0);
+    TEST("Library prewarm total covers the steps",
+         r.total_ns >= r.clock_ns + r.mask_ns + r.transport_ns + r.parser_ns);
+    TEST("Library prewarm again (idempotent)", ws_library_prewarm(NULL) == 0);
+
+    static const uint8_t stream[] = { 0x81, 0x02, 'h', 'i', 0x81, 0x03, 'b', 'y', 'e' };
+    char path[] = "/tmp/ws_test_prewarm_XXXXXX";
+    int fd = mkstemp(path);
+    TEST("Create temporary capture path", fd >= 0);
+    if (fd < 0) return;
+    int write_ok = write(fd, stream, sizeof(stream)) == (ssize_t)sizeof(stream);
+    close(fd);
+    TEST("Write capture", write_ok);
+
+    websocket_context_t *ws = ws_init_replay(path, 0.0);
+    TEST("Replay context", ws != NULL);
+    if (ws) {
+        ws_set_on_msg(ws, prewarm_on_msg);
+        prewarm_msgs = 0;
+        TEST("Context prewarm", ws_prewarm(ws, &r) == 0 && r.frames >= 4096 && r.rings_ns > 0);
+        TEST("Synthetic frames never reach on_msg or the stats",
+             prewarm_msgs == 0 && ws_get_stats(ws)->messages_rx == 0 && ws_get_stats(ws)->bytes_rx == 0);
+        TEST("Empty rings pre-faulted", (ws_get_rx_buffer_mem_status(ws) & WS_RING_PREFAULT) &&
+             (ws_get_tx_buffer_mem_status(ws) & WS_RING_PREFAULT));
+        for (int i = 0; i < 10 && ws_get_state(ws) != WS_STATE_CLOSED; i++) ws_update(ws);
+        TEST("Capture still delivered after prewarm", prewarm_msgs == 2);
+        ws_free(ws);
+    }
+    TEST("Prewarm with NULL context", ws_prewarm(NULL, NULL) == -1);
+    unlink(path);
+}
+
 // Test WebSocket state management
 void test_state_management() {
     printf("\n=== Testing State Management ===\n");
@@ -297,6 +2471,30 @@ int main() {
     test_close_frame();
     test_send_message();
     test_cpu_cycles();
+    test_stats();
+    test_trace();
+    test_replay();
+    test_inflate();
+    test_parser_profiles();
+    test_pipeline();
+    test_poll_frames();
+    test_notifier();
+    test_timer_wheel();
+    test_heartbeat();
+    test_pool();
+    test_redundant();
+    test_router();
+    test_shm();
+    test_async_connect();
+    test_plain_transport();
+    test_rx_latency_mode();
+    test_urgent_lane();
+    test_fragment_arena();
+    test_uring_io();
+    test_uring_urgent_lane();
+    test_ring_options();
+    test_ring_memory();
+    test_prewarm();
     test_state_management();
     test_error_handling();
     test_performance();
@@ -0,0 +1,188 @@
+// Trace Decoder
+// Prints a trace file written by ws_set_trace() (see ws_trace.h), oldest record first
+//
+// Usage: ./ws_trace_dump [--csv] [--raw OUT] TRACE_FILE
+//   --csv      One comma-separated line per record (for spreadsheets / pandas)
+//   --raw OUT  Write the captured RX byte stream to OUT (input for replay)
+
+#include "../ws_trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char *opcode_name(uint8_t op) {
+    switch (op) {
+        case 0x0: return "CONT";
+        case 0x1: return "TEXT";
+        case 0x2: return "BIN";
+        case 0x8: return "CLOSE";
+        case 0x9: return "PING";
+        case 0xA: return "PONG";
+        default:  return "?";
+    }
+}
+
+static void print_prefix(const ws_trace_record_t *r) {
+    size_t n = r->payload_len < 8 ? r->payload_len : 8;
+    for (size_t i = 0; i < n; i++) {
+        uint8_t c = r->prefix[i];
+        putchar(c >= 0x20 && c < 0x7f && c != ',' ? c : '.');
+    }
+}
+
+static double cycles_ns(const ws_trace_header_t *h, uint64_t from, uint64_t to) {
+    if (from == 0 || to < from) return 0.0;
+    return (double)(to - from) * h->ns_per_cycle;
+}
+
+static int export_stream(const ws_trace_header_t *h, const uint8_t *stream, const char *out_path) {
+    if (h->stream_capacity == 0) {
+        fprintf(stderr, "Trace has no stream capture (ws_set_trace stream_bytes = 0)\n");
+        return -1;
+    }
+
+    uint64_t head = h->stream_head;
+    uint64_t len = head < h->stream_capacity ? head : h->stream_capacity;
+    uint64_t start = head - len;
+    if (start > 0) {
+        fprintf(stderr, "Warning: stream ring wrapped, first %llu bytes lost; "
+                "the export may start mid-frame\n", (unsigned long long)start);
+    }
+
+    FILE *f = fopen(out_path, "wb");
+    if (!f) {
+        fprintf(stderr, "Cannot create %s\n", out_path);
+        return -1;
+    }
+
+    uint64_t mask = h->stream_capacity - 1;
+    size_t pos = (size_t)(start & mask);
+    size_t first = (size_t)(h->stream_capacity - pos) < len ? (size_t)(h->stream_capacity - pos) : (size_t)len;
+    int ok = fwrite(stream + pos, 1, first, f) == first &&
+             fwrite(stream, 1, (size_t)len - first, f) == (size_t)len - first;
+    fclose(f);
+    if (!ok) {
+        fprintf(stderr, "Short write to %s\n", out_path);
+        return -1;
+    }
+
+    fprintf(stderr, "Exported %llu stream bytes (offset %llu) to %s\n",
+            (unsigned long long)len, (unsigned long long)start, out_path);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int csv = 0;
+    const char *raw_path = NULL;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--csv") == 0) {
+            csv = 1;
+        } else if (strcmp(argv[i], "--raw") == 0 && i + 1 < argc) {
+            raw_path = argv[++i];
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "Usage: %s [--csv] [--raw OUT] TRACE_FILE\n", argv[0]);
+            return 1;
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "Usage: %s [--csv] [--raw OUT] TRACE_FILE\n", argv[0]);
+        return 1;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < WS_TRACE_HEADER_SIZE) {
+        fprintf(stderr, "%s: too small for a trace file\n", path);
+        close(fd);
+        return 1;
+    }
+    uint8_t *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Cannot map %s\n", path);
+        return 1;
+    }
+
+    const ws_trace_header_t *h = (const ws_trace_header_t *)map;
+    if (memcmp(h->magic, WS_TRACE_MAGIC, sizeof(h->magic)) != 0 ||
+        h->version != WS_TRACE_VERSION || h->record_size != sizeof(ws_trace_record_t)) {
+        fprintf(stderr, "%s: not a version %d trace file\n", path, WS_TRACE_VERSION);
+        munmap(map, (size_t)st.st_size);
+        return 1;
+    }
+    uint64_t records_end = WS_TRACE_HEADER_SIZE + h->record_capacity * sizeof(ws_trace_record_t);
+    if (records_end + h->stream_capacity > (uint64_t)st.st_size ||
+        (h->stream_capacity && h->stream_file_offset != records_end)) {
+        fprintf(stderr, "%s: truncated trace file\n", path);
+        munmap(map, (size_t)st.st_size);
+        return 1;
+    }
+
+    const ws_trace_record_t *records = (const ws_trace_record_t *)(map + WS_TRACE_HEADER_SIZE);
+    uint64_t head = __atomic_load_n(&h->record_head, __ATOMIC_ACQUIRE);
+    uint64_t count = head < h->record_capacity ? head : h->record_capacity;
+    uint64_t first = head - count;
+
+    int rc = 0;
+    if (raw_path) {
+        rc = export_stream(h, map + h->stream_file_offset, raw_path) < 0 ? 1 : 0;
+    }
+
+    if (csv) {
+        printf("seq,parsed_ns,hw_timestamp_ns,event_to_recv_ns,ssl_read_ns,recv_to_parse_ns,"
+               "opcode,fin,rsv1,header_len,payload_len,stream_offset,prefix\n");
+    } else {
+        printf("Trace:    %s\n", path);
+        printf("URL:      %s\n", h->url);
+        printf("Records:  %llu written, %llu kept (capacity %llu)\n",
+               (unsigned long long)head, (unsigned long long)count,
+               (unsigned long long)h->record_capacity);
+        printf("Stream:   %llu bytes captured (capacity %llu)\n",
+               (unsigned long long)h->stream_head, (unsigned long long)h->stream_capacity);
+        printf("Clock:    %.6f ns/cycle, opened at realtime %llu ns\n\n",
+               h->ns_per_cycle, (unsigned long long)h->start_realtime_ns);
+        printf("%10s %16s %10s %10s %10s %-5s %3s %10s %12s  %s\n",
+               "seq", "parsed_ns", "ev->recv", "ssl_read", "recv->parse",
+               "op", "fin", "len", "offset", "prefix");
+    }
+
+    for (uint64_t seq = first; seq < head; seq++) {
+        const ws_trace_record_t *r = &records[seq & (h->record_capacity - 1)];
+        // Nanoseconds since open on the writer's TSC calibration
+        double parsed_ns = cycles_ns(h, h->start_cycle, r->parsed_cycle);
+        double ev_recv = cycles_ns(h, r->event_cycle, r->recv_start_cycle);
+        double ssl_read = cycles_ns(h, r->recv_start_cycle, r->recv_end_cycle);
+        double recv_parse = cycles_ns(h, r->recv_end_cycle, r->parsed_cycle);
+        int fin = (r->flags & WS_TRACE_FLAG_FIN) != 0;
+        int rsv1 = (r->flags & WS_TRACE_FLAG_RSV1) != 0;
+
+        if (csv) {
+            printf("%llu,%.0f,%llu,%.1f,%.1f,%.1f,%u,%d,%d,%u,%u,%llu,",
+                   (unsigned long long)seq, parsed_ns, (unsigned long long)r->hw_timestamp_ns,
+                   ev_recv, ssl_read, recv_parse, r->opcode, fin, rsv1, r->header_len,
+                   r->payload_len, (unsigned long long)r->stream_offset);
+        } else {
+            printf("%10llu %16.0f %10.1f %10.1f %10.1f %-5s %3s %10u %12llu  ",
+                   (unsigned long long)seq, parsed_ns, ev_recv, ssl_read, recv_parse,
+                   opcode_name(r->opcode), fin ? (rsv1 ? "F+Z" : "F") : (rsv1 ? "Z" : "-"),
+                   r->payload_len, (unsigned long long)r->stream_offset);
+        }
+        print_prefix(r);
+        putchar('\n');
+    }
+
+    munmap(map, (size_t)st.st_size);
+    return rc;
+}
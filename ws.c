@@ -1,16 +1,26 @@
 #include "ws.h"
-#include "ssl.h"
+#include "ws_transport.h"
 #include "ringbuffer.h"
 #include "os.h"
 #include "ws_notifier.h"
+#include "ws_mask.h"
+#include "ws_deflate.h"
+#include "ws_trace.h"
+#include "ws_replay.h"
+#include "ws_spsc.h"
+#include "ws_resolver.h"
+#include "ws_timer.h"
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <limits.h>
 #include <unistd.h>
 #include <errno.h>
 #include <time.h>
 #include <fcntl.h>
+#include <sys/socket.h>
 
 // Platform-specific random number generation
 #ifdef __linux__
@@ -18,9 +28,33 @@
 #include <sys/random.h>
 #endif
 
+// ws.h mirrors the ringbuffer flags so callers need not include ringbuffer.h
+_Static_assert(WS_RING_NUMA_BIND == RINGBUFFER_MEM_NUMA_BIND && WS_RING_PREFAULT == RINGBUFFER_MEM_PREFAULT &&
+               WS_RING_MLOCK == RINGBUFFER_MEM_MLOCK, "WS_RING_* must match RINGBUFFER_MEM_*");
+
 // #define WS_DEBUG 1
 #define WS_HTTP_BUFFER_SIZE 4096
 
+// Initial inflate arena (grows to the largest inflated message, then reused)
+#define WS_INFLATE_ARENA_INITIAL (64u * 1024u)
+
+// Largest reassembled message accepted into the fragment arena (non-mirrored RX or spill)
+#define WS_FRAG_ARENA_MAX (64u * 1024u * 1024u)
+#define WS_FRAG_ARENA_MIN 4096
+
+// Reconnect backoff defaults (ws_options_t.reconnect_base_ms / reconnect_max_ms)
+#define WS_RECONNECT_BASE_MS 100
+#define WS_RECONNECT_MAX_MS 10000
+
+// Urgent lane space ws_send_urgent() and heartbeat PINGs leave to PONGs and the CLOSE,
+// and PONGs leave to the CLOSE (a masked client CLOSE with status code is 8 bytes)
+#define WS_URGENT_CONTROL_ROOM 256
+#define WS_URGENT_CLOSE_ROOM 8
+
+// RX timestamps remembered per context (one per read, power of two): a frame takes the
+// stamp of the read that completed it
+#define WS_RX_STAMPS 16
+
 // Helper: Safe environment variable parsing (returns 1 if valid "1", 0 otherwise)
 static inline int env_is_enabled(const char *value) {
     if (!value) return 0;
@@ -32,15 +66,6 @@ static inline int env_is_enabled(const char *value) {
     return (val == 1);
 }
 
-typedef enum {
-    WS_FRAME_CONTINUATION = 0x0,
-    WS_FRAME_TEXT = 0x1,
-    WS_FRAME_BINARY = 0x2,
-    WS_FRAME_CLOSE = 0x8,
-    WS_FRAME_PING = 0x9,
-    WS_FRAME_PONG = 0xA
-} ws_frame_opcode_t;
-
 // Fast userspace PRNG for masking key generation (xoshiro128+ variant)
 typedef struct {
     uint32_t s[4];  // 128-bit state
@@ -63,14 +88,22 @@ static inline uint32_t ws_prng_next(ws_prng_t *prng) {
 }
 
 struct websocket_context {
-    ssl_context_t *ssl;
+    const ws_transport_t *transport;  // TLS for wss://, plain TCP for ws://, or ws_options_t.transport
+    void *conn;                  // The transport's connection, NULL without one
     ringbuffer_t rx_buffer;
     ringbuffer_t tx_buffer;
     ws_on_msg_t on_msg;          // Zero-copy callback
+    int (*parse_stage)(websocket_context_t *ws);  // handle_ws_stage specialized for parser_profile
     ws_prng_t prng;              // Fast PRNG for masking keys (seeded once)
     int prng_seeded;             // Flag: 1 if PRNG has been seeded
     ws_on_status_t on_status;    // Connection status callback (called once on connect)
     ws_notifier_t *notifier;     // Optional event loop notifier (for auto WRITE event management)
+    void *user_data;             // ws_set_user_data()
+
+    // io_uring data path of the notifier (WS_NOTIFIER_URING_IO): reads and writes complete in its ring
+    uint8_t ring_io;
+    int ring_io_fd;
+    const uint8_t *ring_io_tx;   // Urgent lane or TX ring bytes of the SEND in flight, NULL = none
 
     // Connection state: 0 = connecting, 1 = connected
     int connected;
@@ -80,6 +113,7 @@ struct websocket_context {
     char *hostname;
     int port;
     char *path;
+    uint8_t secure;              // wss:// (default port 443), else ws:// (80)
 
     // HTTP state (used only during initial handshake)
     uint8_t http_buffer[WS_HTTP_BUFFER_SIZE];
@@ -100,12 +134,126 @@ struct websocket_context {
     // Stage 1: Hardware NIC timestamp (nanoseconds)
     uint64_t hw_timestamp_ns;              // Hardware NIC timestamp in nanoseconds (0 if unavailable)
     int hw_timestamping_available;
+    // Per-read stamps keyed by the RX stream offset just past the read's last byte
+    struct {
+        uint64_t end;
+        uint64_t ts_ns;
+    } rx_stamps[WS_RX_STAMPS];
+    uint32_t rx_stamp_head;                // Next slot written
+    uint32_t rx_stamp_tail;                // Oldest slot a later frame can still need
 #endif
 
+    // Opt-in binary trace ring (ws_set_trace), NULL when off
+    ws_trace_t *trace;
+
+    // Offline replay source (ws_init_replay), NULL for live connections: conn is NULL then
+    ws_replay_t *replay;
+
+    // Pipeline mode (ws_set_pipeline): descriptors to the consumer thread, NULL when off
+    // rx_parse_off is the IO thread's parse position; rx_buffer.read_offset then belongs
+    // to the consumer and trails it by the messages still queued
+    ws_spsc_t *pipeline;
+    size_t rx_parse_off;
+    uint8_t pipe_pending;        // Descriptor claimed for the current frame, not yet published
+    uint8_t rx_deferred;         // Pipeline or pull mode: parse from rx_parse_off
+
+    // Pull mode (ws_poll_frames): frames fill the caller's array; read_offset is held at the
+    // last release like the pipeline consumer's until ws_release_frames()
+    uint8_t poll_mode;
+    uint8_t poll_held;           // Frames returned and not yet released
+    ws_frame_t *poll_out;        // Caller's array, only during ws_poll_frames()
+    size_t poll_max;
+    size_t poll_n;
+    size_t poll_release_off;     // RX ring position after the last frame returned
+
+    // Reconnect (ws_reconnect, ws_options_t.auto_reconnect): conn is NULL while the backoff runs
+    uint8_t auto_reconnect;
+    uint8_t user_closed;              // ws_close() was called: stay closed
+    uint32_t reconnect_attempt;       // Attempts since the last delivered message (backoff exponent)
+    uint32_t reconnect_base_ms;
+    uint32_t reconnect_max_ms;
+    uint64_t reconnect_sched_cycle;   // Backoff start
+    uint64_t reconnect_delay_ns;      // Backoff length (jittered)
+    uint64_t reconnect_lost_cycle;    // Connection lost, 0 = not reconnecting (first message closes the outage)
+    uint64_t reconnect_msg_mark;      // messages_rx when the outage began
+    uint64_t connect_start_cycle;     // Current attempt started
+
+    // Heartbeat (ws_set_heartbeat), cycles; 0 = off
+    uint64_t ping_cycles;
+    uint64_t stale_cycles;
+    uint64_t last_ping_cycle;         // Also the PING payload: the echoed PONG gives the RTT
+    uint64_t last_data_cycle;         // recv_end_timestamp of the last data message
+    uint64_t hb_next_cycle;           // Unbound: ws_update() runs the heartbeat once event_timestamp passes it
+    ws_timer_t hb_timer;              // Bound: deadline kept in the notifier's wheel
+
+    // TX ring parameters kept for lazy creation (ws_options_t.lazy_tx)
+    size_t tx_ring_size;
+    ringbuffer_pool_t *ring_pool;
+    int ring_mem_flags;
+    int numa_node;
+
     // Optimization #8: Flag to avoid checking tx_buffer when empty (receive-only workload)
     uint8_t has_pending_tx;
+    uint8_t tx_corked;           // ws_cork(): queue frames without flushing until ws_uncork()
+    size_t tx_flush_budget;      // Max bytes per flush pass (0 = drain everything)
+
+    // Urgent lane (tx_urgent: ws_send_urgent, PONG, CLOSE, heartbeat PING): sent ahead of the
+    // TX ring at its next frame boundary; tx_frame_left = bytes of the ring frame on the wire unsent
+    size_t tx_urgent_head;       // Sent up to here
+    size_t tx_urgent_tail;       // Queued up to here
+    uint16_t tx_urgent_data;     // Data frames on the lane: they wait while tx_wire_frag is set
+    uint8_t tx_wire_frag;        // The ring's frames on the wire are inside a fragmented message
+    size_t tx_frame_left;
+    size_t tx_retry_len;         // Ring chunk that would block: the retry offers at least as much
+
+    // Fragmented message reassembly (RFC 6455 Section 5.4)
+    // In-place: fragments stay in the mirrored RX ring, payloads compacted to frag_base_off
+    //           and read_offset held until FIN; rx_scan = bytes past read_offset already parsed
+    // Arena:    non-mirrored RX (or spill when the ring fills) copies payloads into frag_arena
+    uint8_t frag_active;
+    uint8_t frag_inplace;
+    uint8_t frag_opcode;
+    size_t frag_len;
+    size_t frag_base_off;
+    size_t rx_scan;
+    uint8_t frag_compressed;     // RSV1 set on the first fragment (permessage-deflate)
+    uint8_t *frag_arena;
+    size_t frag_arena_cap;
+
+    // permessage-deflate (RFC 7692): offered in the handshake when requested,
+    // inflater created once the server accepts
+    uint8_t deflate_offer;
+    uint8_t deflate_flags;       // WS_DEFLATE_* request parameters
+    uint8_t deflate_active;
+    ws_inflater_t *inflater;
+
+    uint8_t parser_profile;      // ws_parser_profile_t requested (parse_stage follows it)
+    uint8_t rx_latency;          // WS_RX_LATENCY: parse after every read (ws_set_rx_mode)
+    size_t rx_read_budget;       // Latency mode bytes per read
+
+    // Outstanding ws_send_reserve() (at most one): frame start, header room and payload capacity
+    uint8_t tx_reserved;
+    uint8_t tx_reserve_header_len;
+    uint8_t *tx_reserve_ptr;
+    size_t tx_reserve_len;
+
+    // Urgent lane storage, pre-allocated with the context
+    uint8_t tx_urgent[WS_TX_URGENT_LANE];
+
+    // Written by the pipeline consumer thread only: own cache line
+    const ws_msg_desc_t *pipeline_current __attribute__((aligned(CACHE_LINE_SIZE)));
+
+    // Always-on counters and per-stage histograms (single writer, see ws_stats.h)
+    // Kept last: large and touched a few cache lines per batch
+    ws_stats_t stats;
 };
 
+// Points parse_stage at the stage for parser_profile (defined with the stages)
+static void ws_select_parse_stage(websocket_context_t *ws);
+
+// Leaves the notifier's io_uring data path (defined with the receive path)
+static void ws_ring_io_stop(websocket_context_t *ws);
+
 // Generate masking key using PRNG (seeds on first call)
 // RFC 6455 requires unpredictable masking for all client-to-server frames
 static inline uint32_t get_masking_key(websocket_context_t *ws) {
@@ -159,6 +307,329 @@ static inline uint32_t get_masking_key(websocket_context_t *ws) {
     return ws_prng_next(&ws->prng);
 }
 
+// Auto-register WRITE event if notifier is set (Option 3)
+// While corked, WRITE stays unregistered so frames accumulate until ws_uncork()
+// (the urgent lane is not corked)
+static inline void ws_tx_arm_write(websocket_context_t *ws) {
+    if (ws->notifier && (!ws->tx_corked || ws->tx_urgent_tail != ws->tx_urgent_head)) {
+        int fd = ws_get_fd(ws);
+        if (fd >= 0) {
+            ws_notifier_mod(ws->notifier, fd, WS_EVENT_READ | WS_EVENT_WRITE);
+        }
+    }
+}
+
+// Mark one newly queued frame as pending TX
+static inline void ws_tx_pending(websocket_context_t *ws) {
+    ws->has_pending_tx = 1;
+    WS_STAT_ADD(ws->stats.frames_tx, 1);
+    ws_tx_arm_write(ws);
+}
+
+// Drop every queued frame on both lanes (replay, reconnect)
+static void ws_tx_discard(websocket_context_t *ws) {
+    ringbuffer_advance_read(&ws->tx_buffer, ringbuffer_available_read(&ws->tx_buffer));
+    ws->tx_urgent_head = 0;
+    ws->tx_urgent_tail = 0;
+    ws->tx_urgent_data = 0;
+    ws->tx_wire_frag = 0;
+    ws->tx_frame_left = 0;
+    ws->tx_retry_len = 0;
+    ws->has_pending_tx = 0;
+}
+
+// Length of the client frame starting at hdr (frames never wrap in the TX ring)
+static inline size_t ws_tx_frame_total(const uint8_t *hdr) {
+    size_t len = hdr[1] & 0x7F;
+    if (len == 126) return 8 + ((size_t)hdr[2] << 8 | hdr[3]);
+    if (len == 127) {
+        uint64_t len64 = 0;
+        for (int i = 0; i < 8; i++) len64 = len64 << 8 | hdr[2 + i];
+        return 14 + (size_t)len64;
+    }
+    return 6 + len;
+}
+
+// Follow the ring's frame boundaries across n bytes just sent from p
+static inline void ws_tx_track_frames(websocket_context_t *ws, const uint8_t *p, size_t n) {
+    while (n) {
+        if (ws->tx_frame_left == 0) {
+            ws->tx_frame_left = ws_tx_frame_total(p);
+            if (!(p[0] & 0x8)) ws->tx_wire_frag = !(p[0] & 0x80);  // Data frame: FIN ends the message
+        }
+        size_t step = n < ws->tx_frame_left ? n : ws->tx_frame_left;
+        ws->tx_frame_left -= step;
+        p += step;
+        n -= step;
+    }
+}
+
+// n bytes of the urgent lane sent: once it is empty it starts over at the front
+static inline void ws_tx_urgent_sent(websocket_context_t *ws, size_t n) {
+    ws->tx_urgent_head += n;
+    WS_STAT_ADD(ws->stats.bytes_tx, n);
+    if (ws->tx_urgent_head == ws->tx_urgent_tail) {
+        ws->tx_urgent_head = 0;
+        ws->tx_urgent_tail = 0;
+        ws->tx_urgent_data = 0;
+    }
+}
+
+// n bytes sent from p, the TX ring's read position
+static inline void ws_tx_ring_sent(websocket_context_t *ws, const uint8_t *p, size_t n) {
+    ws->tx_retry_len = 0;
+    ws_tx_track_frames(ws, p, n);
+    ringbuffer_advance_read(&ws->tx_buffer, n);
+    WS_STAT_ADD(ws->stats.bytes_tx, n);
+}
+
+// Data path SEND came back: credit the lane its bytes were taken from
+static inline void ws_tx_ring_io_done(websocket_context_t *ws, size_t n) {
+    const uint8_t *p = ws->ring_io_tx;
+    ws->ring_io_tx = NULL;
+    if (p >= ws->tx_urgent && p < ws->tx_urgent + WS_TX_URGENT_LANE) {
+        ws_tx_urgent_sent(ws, n);
+    } else {
+        ws_tx_ring_sent(ws, p, n);
+    }
+}
+
+// Transport send, or on the data path a SEND queued for the next notifier wait: it is
+// counted once collected (ws_tx_drain), so here it always reports "would block"
+static inline int ws_conn_send(websocket_context_t *ws, const uint8_t *data, size_t len) {
+    if (__builtin_expect(ws->ring_io, 0)) {
+        if (ws_notifier_io_send(ws->notifier, ws->ring_io_fd, data, len) < 0) return -1;
+        ws->ring_io_tx = data;
+        return 0;
+    }
+    return ws->transport->send(ws->conn, data, len);
+}
+
+// The urgent lane may go next: the ring sits between frames with no retry owed to the
+// transport, and its data frames would not land inside a fragmented ring message
+static inline int ws_tx_urgent_ready(const websocket_context_t *ws) {
+    return ws->tx_frame_left == 0 && ws->tx_retry_len == 0 &&
+           (!ws->tx_wire_frag || !ws->tx_urgent_data || ws->closed);
+}
+
+// Drain in one pass: the urgent lane first, then every contiguous ring region up to the flush
+// budget, handing over to the urgent lane at the next frame boundary when it has frames queued
+// ring = 0 (corked): the ring only finishes the frame already on the wire
+// Once closed, ring frames not yet started are dropped so the CLOSE is the last frame sent
+// Stops early when the socket is full; unregisters WRITE once nothing is left to send
+// Returns bytes sent, -1 on error
+static int ws_tx_drain(websocket_context_t *ws, int ring) {
+    if (__builtin_expect(!ws->conn, 0)) return -1;  // Reconnect backoff or replay: no peer
+    size_t budget = ws->tx_flush_budget ? ws->tx_flush_budget : SIZE_MAX;
+    size_t total = 0;
+
+    // Data path: collect the SEND in flight before anything else goes out
+    if (__builtin_expect(ws->ring_io_tx != NULL, 0)) {
+        int sent = ws_notifier_io_sent(ws->notifier, ws->ring_io_fd);
+        if (__builtin_expect(sent < 0, 0)) return -1;
+        if (sent > 0) {
+            ws_tx_ring_io_done(ws, (size_t)sent);
+            total += (size_t)sent;
+        }
+    }
+
+    while (total < budget && !ws->ring_io_tx) {  // Data path: one SEND on the wire at a time
+        size_t urgent = ws->tx_urgent_tail - ws->tx_urgent_head;
+        if (__builtin_expect(urgent != 0, 0) && ws_tx_urgent_ready(ws)) {
+            int sent = ws_conn_send(ws, ws->tx_urgent + ws->tx_urgent_head, urgent);
+            if (__builtin_expect(sent < 0, 0)) return -1;
+            if (sent == 0) break;  // Would block: the lane is retried first
+
+            ws_tx_urgent_sent(ws, (size_t)sent);
+            total += (size_t)sent;
+            if ((size_t)sent < urgent) break;  // Socket send buffer full
+            continue;
+        }
+
+        uint8_t *read_ptr = NULL;
+        size_t read_len = 0;
+        ringbuffer_next_read(&ws->tx_buffer, &read_ptr, &read_len);
+        if (read_len == 0) break;
+
+        int between = ws->tx_frame_left == 0 && ws->tx_retry_len == 0;
+        if (__builtin_expect(ws->closed, 0) && between) {
+            ringbuffer_advance_read(&ws->tx_buffer, ringbuffer_available_read(&ws->tx_buffer));
+            continue;
+        }
+        if (!ring && between) break;
+
+        // Stop at the end of the frame on the wire when the urgent lane waits for it
+        size_t chunk = read_len;
+        if (urgent || !ring) {
+            size_t frame = ws->tx_frame_left ? ws->tx_frame_left : ws_tx_frame_total(read_ptr);
+            if (chunk > frame) chunk = frame;
+        }
+        if (chunk > budget - total) chunk = budget - total;
+
+        // Retries after WANT_WRITE always offer at least the previous length (OpenSSL requirement)
+        if (chunk < ws->tx_retry_len) chunk = ws->tx_retry_len;
+
+        int sent = ws_conn_send(ws, read_ptr, chunk);
+        if (__builtin_expect(sent < 0, 0)) {
+            return -1;  // Error occurred
+        }
+        if (sent == 0) {  // Would block
+            ws->tx_retry_len = chunk;
+            break;
+        }
+
+        ws_tx_ring_sent(ws, read_ptr, (size_t)sent);
+        total += (size_t)sent;
+        if ((size_t)sent < chunk) break;  // Socket send buffer full
+    }
+
+    // Clear flag once both lanes are empty
+    int urgent_left = ws->tx_urgent_tail != ws->tx_urgent_head;
+    int ring_left = ringbuffer_available_read(&ws->tx_buffer) != 0;
+    if (!urgent_left && !ring_left) ws->has_pending_tx = 0;
+
+    // Auto-unregister WRITE event if notifier is set (Option 3): nothing left, or only
+    // corked frames that wait for ws_uncork()
+    if (ws->notifier && !urgent_left && (!ring_left || !ring)) {
+        int fd = ws_get_fd(ws);
+        if (fd >= 0) {
+            // Unregister WRITE, keep only READ event
+            ws_notifier_mod(ws->notifier, fd, WS_EVENT_READ);
+        }
+    }
+
+    return (int)(total > INT_MAX ? INT_MAX : total);
+}
+
+// RFC 6455 Section 5.5: control frames must not be fragmented and carry <= 125 bytes
+// Reserved opcodes (0x3-0x7, 0xB-0xF) are rejected
+static inline int ws_frame_valid(uint8_t opcode, int fin, size_t payload_len) {
+    if (opcode & 0x8) {
+        return opcode <= WS_FRAME_PONG && fin && payload_len <= 125;
+    }
+    return opcode <= WS_FRAME_BINARY;
+}
+
+static inline uint8_t ws_frame_first_byte(uint8_t opcode, int fin) {
+    return (uint8_t)((fin ? 0x80 : 0x00) | opcode);
+}
+
+// Client frame header length (RFC 6455 Section 5.2): base + extended length + 4-byte mask
+static inline size_t ws_frame_header_len(size_t payload_len) {
+    if (payload_len <= 125) return 6;
+    if (payload_len <= 65535) return 8;
+    return 14;
+}
+
+// Write masked client frame header, returns header length (6, 8 or 14 bytes)
+static inline size_t ws_write_frame_header(uint8_t *hdr, uint8_t first_byte, size_t payload_len, uint32_t mask_word) {
+    size_t header_len = 2;
+
+    hdr[0] = first_byte;
+
+    // Set length field with MASK bit (bit 7)
+    if (payload_len <= 125) {
+        hdr[1] = 0x80 | (payload_len & 0x7F);  // MASK=1 | length
+    } else if (payload_len <= 65535) {
+        hdr[1] = 0x80 | 126;  // MASK=1 | 126 (extended payload)
+        hdr[2] = (payload_len >> 8) & 0xFF;
+        hdr[3] = payload_len & 0xFF;
+        header_len = 4;
+    } else {
+        hdr[1] = 0x80 | 127;  // MASK=1 | 127 (64-bit length, big-endian)
+        uint64_t len64 = (uint64_t)payload_len;
+        for (int i = 0; i < 8; i++) {
+            hdr[2 + i] = (len64 >> (56 - 8 * i)) & 0xFF;
+        }
+        header_len = 10;
+    }
+
+    // Masking key in wire order (byte i = bits 8i..8i+7, matches ws_mask_apply)
+    hdr[header_len + 0] = (mask_word >> 0) & 0xFF;
+    hdr[header_len + 1] = (mask_word >> 8) & 0xFF;
+    hdr[header_len + 2] = (mask_word >> 16) & 0xFF;
+    hdr[header_len + 3] = (mask_word >> 24) & 0xFF;
+
+    return header_len + 4;
+}
+
+// Create the TX ring on first use (lazy_tx contexts start without one)
+// Returns 0 if the ring exists, -1 if it cannot be allocated
+static int ws_tx_create(websocket_context_t *ws) {
+    if (ws->tx_buffer.pulled_data) return 0;
+    if (ringbuffer_init_size(&ws->tx_buffer, ws->tx_ring_size, ws->ring_pool) < 0) return -1;
+    if (ws->ring_mem_flags) ringbuffer_prepare(&ws->tx_buffer, ws->ring_mem_flags, ws->numa_node);
+    return 0;
+}
+
+// Reserve contiguous TX space for one complete frame (nothing is committed)
+// Mirrored rings always provide contiguous free space; plain rings may not near the end
+static inline uint8_t *ws_tx_frame_space(websocket_context_t *ws, size_t payload_len, size_t *header_len) {
+    size_t hdr = ws_frame_header_len(payload_len);
+    size_t total_size;
+    if (__builtin_expect(__builtin_add_overflow(hdr, payload_len, &total_size), 0)) {
+        return NULL;  // Overflow: message size exceeds SIZE_MAX - invalid length
+    }
+
+    if (__builtin_expect(!ws->tx_buffer.pulled_data, 0) && ws_tx_create(ws) < 0) {
+        return NULL;
+    }
+
+    uint8_t *write_ptr = NULL;
+    size_t available = 0;
+    ringbuffer_get_write_ptr(&ws->tx_buffer, &write_ptr, &available);
+    if (__builtin_expect(available < total_size, 0)) {
+        return NULL;
+    }
+
+    *header_len = hdr;
+    return write_ptr;
+}
+
+// Data path: a SEND reads the lane in place until it is collected, so the lane may only move
+// once none does. A completed SEND is collected; one still queued or on the wire holds the
+// lane, except for a CLOSE, which ends the connection anyway and finishes on the transport
+// Returns 0 when the lane may move, -1 if it is held
+static int ws_urgent_release(websocket_context_t *ws, uint8_t opcode) {
+    const uint8_t *p = ws->ring_io_tx;
+    if (!p || p < ws->tx_urgent || p >= ws->tx_urgent + WS_TX_URGENT_LANE) return 0;
+    int sent = ws_notifier_io_sent(ws->notifier, ws->ring_io_fd);
+    if (sent > 0) {
+        ws_tx_ring_io_done(ws, (size_t)sent);
+        return 0;
+    }
+    if (opcode != WS_FRAME_CLOSE) return -1;
+    ws_ring_io_stop(ws);  // Cancels the SEND or credits what it sent
+    return 0;
+}
+
+// Queue one complete frame on the urgent lane, leaving room bytes free for what may follow
+// Unsent bytes slide to the front when the end is reached (transports accept a moved retry
+// buffer; a data path SEND does not, see ws_urgent_release)
+// Returns 0, -1 if the lane is full
+static int ws_urgent_queue(websocket_context_t *ws, uint8_t opcode, const uint8_t *payload, size_t len, size_t room) {
+    size_t total = ws_frame_header_len(len) + len;
+    if (ws->tx_urgent_tail + total + room > WS_TX_URGENT_LANE) {
+        if (__builtin_expect(ws_urgent_release(ws, opcode) < 0, 0)) return -1;
+        size_t pending = ws->tx_urgent_tail - ws->tx_urgent_head;
+        if (pending + total + room > WS_TX_URGENT_LANE) return -1;
+        memmove(ws->tx_urgent, ws->tx_urgent + ws->tx_urgent_head, pending);
+        ws->tx_urgent_head = 0;
+        ws->tx_urgent_tail = pending;
+    }
+
+    uint8_t *frame = ws->tx_urgent + ws->tx_urgent_tail;
+    uint32_t mask_word = get_masking_key(ws);
+    size_t header_len = ws_write_frame_header(frame, ws_frame_first_byte(opcode, 1), len, mask_word);
+    ws_mask_apply(frame + header_len, payload, len, mask_word);
+    ws->tx_urgent_tail += total;
+    if (!(opcode & 0x8)) ws->tx_urgent_data++;
+
+    WS_STAT_ADD(ws->stats.urgent_tx, 1);
+    ws_tx_pending(ws);
+    return 0;
+}
+
 uint64_t ws_get_hw_timestamp(websocket_context_t *ws) {
     if (!ws) return 0;
 #ifdef __linux__
@@ -188,6 +659,14 @@ uint64_t ws_get_frame_parsed_timestamp(websocket_context_t *ws) {
     return ws->frame_parsed_timestamp;
 }
 
+#ifdef __linux__
+// NIC timestamps need both optional transport entries
+static int ws_conn_hw_timestamping(websocket_context_t *ws) {
+    if (!ws->transport->hw_timestamping_enabled || !ws->transport->hw_timestamp) return 0;
+    return ws->transport->hw_timestamping_enabled(ws->conn);
+}
+#endif
+
 int ws_has_hw_timestamping(websocket_context_t *ws) {
     if (!ws) return 0;
 #ifdef __linux__
@@ -198,18 +677,27 @@ int ws_has_hw_timestamping(websocket_context_t *ws) {
 }
 
 int ws_get_fd(websocket_context_t *ws) {
-    if (!ws || !ws->ssl) return -1;
-    return ssl_get_fd(ws->ssl);
+    if (!ws || !ws->conn) return -1;
+    return ws->transport->get_fd(ws->conn);
+}
+
+int ws_get_session_reused(websocket_context_t *ws) {
+    if (!ws || !ws->conn || !ws->transport->session_reused) return 0;
+    return ws->transport->session_reused(ws->conn);
 }
 
 const char* ws_get_cipher_name(websocket_context_t *ws) {
-    if (!ws || !ws->ssl) return NULL;
-    return ssl_get_cipher_name(ws->ssl);
+    if (!ws || !ws->conn || !ws->transport->cipher_name) return NULL;
+    return ws->transport->cipher_name(ws->conn);
 }
 
 const char* ws_get_tls_mode(websocket_context_t *ws) {
-    if (!ws || !ws->ssl) return "Unknown";
-    return ssl_get_tls_mode(ws->ssl);
+    if (!ws || !ws->conn || !ws->transport->mode) return "Unknown";
+    return ws->transport->mode(ws->conn);
+}
+
+const ws_stats_t *ws_get_stats(websocket_context_t *ws) {
+    return ws ? &ws->stats : NULL;
 }
 
 int ws_get_rx_buffer_is_mirrored(websocket_context_t *ws) {
@@ -227,6 +715,16 @@ int ws_get_tx_buffer_is_mirrored(websocket_context_t *ws) {
     return ringbuffer_is_mirrored(&ws->tx_buffer);
 }
 
+int ws_get_rx_buffer_mem_status(websocket_context_t *ws) {
+    if (!ws) return 0;
+    return ringbuffer_mem_status(&ws->rx_buffer);
+}
+
+int ws_get_tx_buffer_mem_status(websocket_context_t *ws) {
+    if (!ws) return 0;
+    return ringbuffer_mem_status(&ws->tx_buffer);
+}
+
 int ws_get_tx_buffer_is_mmap(websocket_context_t *ws) {
     if (!ws) return 0;
     return ringbuffer_is_mmap(&ws->tx_buffer);
@@ -285,7 +783,8 @@ static void generate_ws_key(char *key) {
 }
 
 // Parse URL
-static int parse_url(const char *url, char **hostname, int *port, char **path) {
+// *secure: 1 for wss:// (TLS transport), 0 for ws:// (plain TCP)
+static int parse_url(const char *url, char **hostname, int *port, char **path, int *secure) {
     // Initialize outputs to NULL for cleanup on failure
     *hostname = NULL;
     *path = NULL;
@@ -297,9 +796,11 @@ static int parse_url(const char *url, char **hostname, int *port, char **path) {
     if (strncmp(url, "wss://", 6) == 0) {
         url += 6;
         default_port = 443;
+        *secure = 1;
     } else if (strncmp(url, "ws://", 5) == 0) {
         url += 5;
         default_port = 80;
+        *secure = 0;
     } else {
         return -1;
     }
@@ -370,7 +871,79 @@ static int parse_url(const char *url, char **hostname, int *port, char **path) {
     return 0;
 }
 
+static uint64_t ws_ms_to_cycles(uint32_t ms) {
+    return ms ? os_ns_to_cycles((uint64_t)ms * 1000000ULL) : 0;
+}
+
+// Earliest heartbeat deadline (cycles), UINT64_MAX with both checks off
+static uint64_t ws_heartbeat_deadline(const websocket_context_t *ws) {
+    uint64_t next = UINT64_MAX;
+    if (ws->ping_cycles) next = ws->last_ping_cycle + ws->ping_cycles;
+    if (ws->stale_cycles && ws->last_data_cycle + ws->stale_cycles < next) next = ws->last_data_cycle + ws->stale_cycles;
+    return next;
+}
+
+// Deadline goes into the bound notifier's wheel, otherwise ws_update() compares against it
+static void ws_heartbeat_arm(websocket_context_t *ws) {
+    ws_timer_cancel(&ws->hb_timer);
+    ws->hb_next_cycle = UINT64_MAX;
+    if (!ws->connected) return;
+
+    uint64_t next = ws_heartbeat_deadline(ws);
+    if (next == UINT64_MAX) return;
+    ws_timer_wheel_t *wheel = ws->notifier ? ws_notifier_timers(ws->notifier) : NULL;
+    if (wheel) {
+        ws_timer_schedule(wheel, &ws->hb_timer, next);
+    } else {
+        ws->hb_next_cycle = next;
+    }
+}
+
+static void ws_heartbeat_start(websocket_context_t *ws) {
+    ws->last_ping_cycle = ws->last_data_cycle = os_get_cpu_cycle();
+    ws_heartbeat_arm(ws);
+}
+
+// A deadline passed: send the PING that is due, report a stale feed, re-arm
+static void ws_heartbeat_run(websocket_context_t *ws, uint64_t now) {
+    if (!ws->connected) return;
+
+    // Signed: now may be the batch start, older than this batch's receive timestamps
+    if (ws->ping_cycles && (int64_t)(now - ws->last_ping_cycle) >= (int64_t)ws->ping_cycles) {
+        ws->last_ping_cycle = now;
+        if (ws_urgent_queue(ws, WS_FRAME_PING, (const uint8_t *)&now, sizeof(now), WS_URGENT_CONTROL_ROOM) == 0) {
+            WS_STAT_ADD(ws->stats.pings_tx, 1);
+        }
+    }
+    if (ws->stale_cycles && (int64_t)(now - ws->last_data_cycle) >= (int64_t)ws->stale_cycles) {
+        ws->last_data_cycle = now;  // Reported again after another silent period
+        WS_STAT_ADD(ws->stats.stale_timeouts, 1);
+        if (ws->on_status) ws->on_status(ws, WS_STATUS_STALE);
+        // Tear the socket down instead of reconnecting here: the EOF reaches the next ws_update()
+        // through the notifier like any dropped connection (and so does the owner, e.g. ws_pool)
+        if (ws->connected && ws->auto_reconnect && !ws->user_closed) {
+            int fd = ws_get_fd(ws);
+            if (fd >= 0) shutdown(fd, SHUT_RDWR);
+        }
+    }
+    ws_heartbeat_arm(ws);  // No-op if on_status closed or reconnected
+}
+
+static void ws_heartbeat_timer(ws_timer_t *timer, uint64_t now) {
+    websocket_context_t *ws = (websocket_context_t *)((char *)timer - offsetof(websocket_context_t, hb_timer));
+    ws_heartbeat_run(ws, now);
+}
+
 websocket_context_t *ws_init(const char *url) {
+    return ws_init_ex(url, NULL);
+}
+
+websocket_context_t *ws_init_ex(const char *url, const ws_options_t *opts) {
+    static const ws_options_t defaults = {0};
+    if (!opts) opts = &defaults;
+    if ((unsigned)opts->parser_profile >= WS_PARSER_PROFILES) return NULL;
+    if (opts->rx_mode != WS_RX_THROUGHPUT && opts->rx_mode != WS_RX_LATENCY) return NULL;
+
     // Allocate with cache-line alignment for optimal performance
     websocket_context_t *ws = NULL;
     // Check both return value and pointer
@@ -379,23 +952,35 @@ websocket_context_t *ws_init(const char *url) {
     }
 
     memset(ws, 0, sizeof(websocket_context_t));
+    ws->hb_next_cycle = UINT64_MAX;
+    ws_timer_init(&ws->hb_timer, ws_heartbeat_timer);
 
     // Parse URL
     // parse_url handles cleanup internally on failure
-    if (parse_url(url, &ws->hostname, &ws->port, &ws->path) < 0) {
+    int secure = 1;
+    if (parse_url(url, &ws->hostname, &ws->port, &ws->path, &secure) < 0) {
         free(ws);
         return NULL;
     }
+    ws->secure = (uint8_t)secure;
+    ws->transport = opts->transport ? opts->transport : (secure ? &ws_transport_tls : &ws_transport_tcp);
     
-    // Initialize buffers
-    if (ringbuffer_init(&ws->rx_buffer) < 0) {
+    // Initialize buffers (TX may be deferred until the first frame is queued)
+    ws->tx_ring_size = opts->tx_ring_size ? opts->tx_ring_size : RINGBUFFER_SIZE;
+    ws->ring_pool = opts->pool;
+    ws->ring_mem_flags = opts->ring_mem_flags;
+    ws->numa_node = opts->numa_node;
+    if (ringbuffer_init_size(&ws->rx_buffer, opts->rx_ring_size ? opts->rx_ring_size : RINGBUFFER_SIZE,
+                             opts->pool) < 0) {
         free(ws->hostname);
         free(ws->path);
         free(ws);
         return NULL;
     }
     
-    if (ringbuffer_init(&ws->tx_buffer) < 0) {
+    if (ws->ring_mem_flags) ringbuffer_prepare(&ws->rx_buffer, ws->ring_mem_flags, ws->numa_node);
+    
+    if (!opts->lazy_tx && ws_tx_create(ws) < 0) {
         ringbuffer_free(&ws->rx_buffer);
         free(ws->hostname);
         free(ws->path);
@@ -403,8 +988,18 @@ websocket_context_t *ws_init(const char *url) {
         return NULL;
     }
     
-    ws->ssl = ssl_init(ws->hostname, ws->port);
-    if (!ws->ssl) {
+    ws->auto_reconnect = opts->auto_reconnect ? 1 : 0;
+    ws->reconnect_base_ms = opts->reconnect_base_ms;
+    ws->reconnect_max_ms = opts->reconnect_max_ms;
+    ws->ping_cycles = ws_ms_to_cycles(opts->ping_interval_ms);
+    ws->stale_cycles = ws_ms_to_cycles(opts->stale_timeout_ms);
+    ws->parser_profile = opts->parser_profile ? opts->parser_profile : WS_DEFAULT_PARSER_PROFILE;
+    ws_set_rx_mode(ws, opts->rx_mode, opts->rx_read_budget);
+    ws_select_parse_stage(ws);
+    ws->connect_start_cycle = os_get_cpu_cycle();
+    ws->conn = opts->async_connect ? ws->transport->open_async(ws->hostname, ws->port)
+                                   : ws->transport->open(ws->hostname, ws->port);
+    if (!ws->conn) {
         ringbuffer_free(&ws->rx_buffer);
         ringbuffer_free(&ws->tx_buffer);
         free(ws->hostname);
@@ -417,13 +1012,50 @@ websocket_context_t *ws_init(const char *url) {
     ws->handshake_sent = 0;
 
 #ifdef __linux__
-    ws->hw_timestamping_available = ssl_hw_timestamping_enabled(ws->ssl);
+    ws->hw_timestamping_available = ws_conn_hw_timestamping(ws);
     ws->hw_timestamp_ns = 0;
 #endif
 
     return ws;
 }
 
+websocket_context_t *ws_init_replay(const char *path, double speed) {
+    websocket_context_t *ws = NULL;
+    if (posix_memalign((void**)&ws, CACHE_LINE_SIZE, sizeof(websocket_context_t)) != 0 || ws == NULL) {
+        return NULL;
+    }
+    memset(ws, 0, sizeof(websocket_context_t));
+    ws->hb_next_cycle = UINT64_MAX;
+    ws_timer_init(&ws->hb_timer, ws_heartbeat_timer);
+
+    ws->replay = ws_replay_open(path);
+    if (!ws->replay) {
+        free(ws);
+        return NULL;
+    }
+    ws->replay->speed = speed > 0.0 ? speed : 0.0;
+    ws->tx_ring_size = RINGBUFFER_SIZE;
+    ws->parser_profile = WS_DEFAULT_PARSER_PROFILE;
+    ws_select_parse_stage(ws);
+
+    if (ringbuffer_init(&ws->rx_buffer) < 0) {
+        ws_replay_free(ws->replay);
+        free(ws);
+        return NULL;
+    }
+    if (ringbuffer_init(&ws->tx_buffer) < 0) {
+        ringbuffer_free(&ws->rx_buffer);
+        ws_replay_free(ws->replay);
+        free(ws);
+        return NULL;
+    }
+
+    // No socket or handshake: frames flow from the first ws_update()
+    ws->connected = 1;
+    ws->handshake_sent = 1;
+    return ws;
+}
+
 void ws_free(websocket_context_t *ws) {
     if (!ws) return;
 
@@ -435,9 +1067,16 @@ void ws_free(websocket_context_t *ws) {
         prng_ptr[i] = 0;
     }
 
-    ssl_free(ws->ssl);
+    ws_timer_cancel(&ws->hb_timer);
+    ws_ring_io_stop(ws);  // The kernel must be done with the rings before they go
+    if (ws->conn) ws->transport->close(ws->conn);
     ringbuffer_free(&ws->rx_buffer);
     ringbuffer_free(&ws->tx_buffer);
+    free(ws->frag_arena);
+    ws_inflater_free(ws->inflater);
+    ws_trace_close(ws->trace);
+    ws_replay_free(ws->replay);
+    ws_spsc_free(ws->pipeline);
 
     if (ws->hostname) free(ws->hostname);
     if (ws->path) free(ws->path);
@@ -453,6 +1092,144 @@ void ws_set_on_status(websocket_context_t *ws, ws_on_status_t callback) {
     if (ws) ws->on_status = callback;
 }
 
+void ws_set_user_data(websocket_context_t *ws, void *user_data) {
+    if (ws) ws->user_data = user_data;
+}
+
+void *ws_get_user_data(websocket_context_t *ws) {
+    return ws ? ws->user_data : NULL;
+}
+
+int ws_set_permessage_deflate(websocket_context_t *ws, int enable, int flags) {
+#ifndef WS_HAVE_ZLIB
+    if (enable) return -1;  // Built without zlib
+#endif
+    if (ws && ws->replay) {
+        if (enable && ws->rx_deferred) return -1;
+        // Replay has no handshake: the capture came from a negotiated connection
+        if (!enable || ws->inflater) return 0;
+        ws->inflater = ws_inflater_create(WS_INFLATE_ARENA_INITIAL,
+                                          (flags & WS_DEFLATE_SERVER_NO_CONTEXT_TAKEOVER) != 0);
+        if (!ws->inflater) return -1;
+        ws->deflate_active = 1;
+        ws_select_parse_stage(ws);
+        return 0;
+    }
+    if (!ws || ws->handshake_sent) return -1;  // Must be set before the upgrade request
+    if (enable && ws->rx_deferred) return -1;  // Inflate arena is reused per message
+    ws->deflate_offer = enable ? 1 : 0;
+    ws->deflate_flags = (uint8_t)flags;
+    return 0;
+}
+
+int ws_get_permessage_deflate(websocket_context_t *ws) {
+    return ws ? ws->deflate_active : 0;
+}
+
+int ws_set_pipeline(websocket_context_t *ws, size_t queue_depth) {
+    if (!ws) return -1;
+
+    if (queue_depth == 0) {
+        if (!ws->pipeline) return 0;
+        if (ws_spsc_size(ws->pipeline) != 0) return -1;  // Consumer still owns ring data
+        ws_spsc_free(ws->pipeline);
+        ws->pipeline = NULL;
+        ws->rx_deferred = 0;
+        return 0;
+    }
+
+    // Messages must be contiguous in the ring and outlive the IO thread's next step
+    if (ws->rx_deferred || !ringbuffer_is_mirrored(&ws->rx_buffer) || ws->deflate_offer || ws->deflate_active) {
+        return -1;
+    }
+    ws->pipeline = ws_spsc_create(queue_depth);
+    if (!ws->pipeline) return -1;
+    ws->rx_parse_off = ws->rx_buffer.read_offset;
+    ws->rx_deferred = 1;
+    return 0;
+}
+
+int ws_pipeline_poll(websocket_context_t *ws, int max_msgs) {
+    if (!ws || !ws->pipeline) return -1;
+
+    int n = 0;
+    const ws_msg_desc_t *d;
+    while ((max_msgs <= 0 || n < max_msgs) && (d = ws_spsc_peek(ws->pipeline)) != NULL) {
+        ws->pipeline_current = d;
+        if (__builtin_expect(ws->on_msg != NULL, 1)) {
+            ws->on_msg(ws, d->payload, d->len, d->opcode);
+        }
+        // Ring space first, then the slot (the producer may reuse it right after the pop)
+        ringbuffer_release_to(&ws->rx_buffer, d->release_off);
+        ws_spsc_pop(ws->pipeline);
+        n++;
+    }
+    ws->pipeline_current = NULL;
+    return n;
+}
+
+const ws_msg_desc_t *ws_pipeline_current(websocket_context_t *ws) {
+    return ws ? ws->pipeline_current : NULL;
+}
+
+size_t ws_pipeline_backlog(websocket_context_t *ws) {
+    if (!ws || !ws->pipeline) return 0;
+    return ws_spsc_size(ws->pipeline);
+}
+
+int ws_poll_frames(websocket_context_t *ws, ws_frame_t *out, size_t max) {
+    if (!ws || (!out && max > 0)) return -1;
+
+    if (__builtin_expect(!ws->poll_mode, 0)) {
+        // Same constraints as the pipeline: frames contiguous and alive until released
+        if (ws->pipeline || !ringbuffer_is_mirrored(&ws->rx_buffer) || ws->deflate_offer || ws->deflate_active) {
+            return -1;
+        }
+        ws->rx_parse_off = ws->rx_buffer.read_offset;
+        ws->poll_release_off = ws->rx_parse_off;
+        ws->rx_deferred = 1;
+        ws->poll_mode = 1;
+    }
+
+    ws->poll_out = out;
+    ws->poll_max = max;
+    ws->poll_n = 0;
+    int ret = ws_update(ws);
+    ws->poll_out = NULL;
+    ws->poll_max = 0;
+
+    if (__builtin_expect(ws->poll_n > 0, 1)) return (int)ws->poll_n;
+    return ret < 0 ? -1 : 0;
+}
+
+int ws_release_frames(websocket_context_t *ws) {
+    if (!ws || !ws->poll_mode) return -1;
+    if (ws->poll_held) {
+        ringbuffer_release_to(&ws->rx_buffer, ws->poll_release_off);
+        ws->poll_held = 0;
+    }
+    return 0;
+}
+
+int ws_set_trace(websocket_context_t *ws, const char *path, size_t records, size_t stream_bytes) {
+    if (!ws) return -1;
+
+    ws_trace_close(ws->trace);
+    ws->trace = NULL;
+    if (!path) return 0;  // Tracing off
+
+    char url[256];
+    snprintf(url, sizeof(url), "%s:%d%s", ws->hostname ? ws->hostname : "",
+             ws->port, ws->path ? ws->path : "");
+    ws_trace_t *t = ws_trace_open(path, records, stream_bytes, url);
+    if (!t) return -1;
+
+    // Stream offsets count from here; bytes still unparsed in the ring were not captured
+    t->stream_base = ws->stats.bytes_rx;
+    ws->trace = t;
+    return 0;
+}
+
 // Send HTTP handshake
 static int send_handshake(websocket_context_t *ws) {
     // Key buffer must be >= BASE64_ENCODE_SIZE(16) = 25 bytes
@@ -462,14 +1239,24 @@ static int send_handshake(websocket_context_t *ws) {
                    "key buffer too small for base64-encoded 16-byte random");
     generate_ws_key(key);
 
-    // Build Host header with port if non-standard (RFC 6455 requires port for non-443)
+    // Build Host header with port if not the scheme's default (RFC 6455 Section 4.1)
     char host_header[256];
-    if (ws->port != 443) {
+    if (ws->port != (ws->secure ? 443 : 80)) {
         snprintf(host_header, sizeof(host_header), "%s:%d", ws->hostname, ws->port);
     } else {
         snprintf(host_header, sizeof(host_header), "%s", ws->hostname);
     }
 
+    // RFC 7692 permessage-deflate offer (we never compress outbound, so only the
+    // server-side parameters matter; client_max_window_bits signals we accept any)
+    char extensions[160] = "";
+    if (ws->deflate_offer) {
+        snprintf(extensions, sizeof(extensions),
+            "Sec-WebSocket-Extensions: permessage-deflate; client_max_window_bits%s%s\r\n",
+            (ws->deflate_flags & WS_DEFLATE_SERVER_NO_CONTEXT_TAKEOVER) ? "; server_no_context_takeover" : "",
+            (ws->deflate_flags & WS_DEFLATE_CLIENT_NO_CONTEXT_TAKEOVER) ? "; client_no_context_takeover" : "");
+    }
+
     char handshake[1024];
     // Check snprintf return value for truncation
     int len = snprintf(handshake, sizeof(handshake),
@@ -479,15 +1266,55 @@ static int send_handshake(websocket_context_t *ws) {
         "Connection: Upgrade\r\n"
         "Sec-WebSocket-Key: %s\r\n"
         "Sec-WebSocket-Version: 13\r\n"
+        "%s"
         "\r\n",
-        ws->path, host_header, key);
+        ws->path, host_header, key, extensions);
 
     if (len < 0 || len >= (int)sizeof(handshake)) {
         // Handshake too large or encoding error
         return -1;
     }
 
-    return ssl_send(ws->ssl, (const uint8_t *)handshake, len);
+    return ws->transport->send(ws->conn, (const uint8_t *)handshake, len);
+}
+
+// Case-insensitive search for token within [start, end)
+static int http_line_has_token(const char *start, const char *end, const char *token) {
+    size_t tlen = strlen(token);
+    for (const char *p = start; p + tlen <= end; p++) {
+        if (strncasecmp(p, token, tlen) == 0) return 1;
+    }
+    return 0;
+}
+
+// Apply the server's Sec-WebSocket-Extensions answer (RFC 7692 Section 5)
+// Returns 0 on success, -1 if the server accepted something we did not offer
+static int http_negotiate_extensions(websocket_context_t *ws) {
+    static const char name[] = "\r\nSec-WebSocket-Extensions:";
+    const char *buf = (const char *)ws->http_buffer;
+    const char *headers_end = strstr(buf, "\r\n\r\n");
+    if (!headers_end) headers_end = buf + ws->http_len;
+
+    for (const char *line = strstr(buf, "\r\n"); line && line < headers_end; line = strstr(line + 2, "\r\n")) {
+        if (strncasecmp(line, name, sizeof(name) - 1) != 0) continue;
+
+        const char *value = line + sizeof(name) - 1;
+        const char *eol = strstr(value, "\r\n");
+        if (!eol) eol = headers_end;
+        if (!http_line_has_token(value, eol, "permessage-deflate")) continue;
+
+        if (!ws->deflate_offer) return -1;  // Unsolicited extension
+
+        // Server may add server_no_context_takeover on its own; window bits need no
+        // handling since a 15-bit inflate window accepts any smaller server window
+        int no_context_takeover = http_line_has_token(value, eol, "server_no_context_takeover");
+        ws->inflater = ws_inflater_create(WS_INFLATE_ARENA_INITIAL, no_context_takeover);
+        if (!ws->inflater) return -1;
+        ws->deflate_active = 1;
+        return 0;
+    }
+
+    return 0;  // Extension declined: plain frames only
 }
 
 // Parse HTTP response
@@ -500,6 +1327,11 @@ static int parse_http_response(websocket_context_t *ws) {
         return -1;
     }
 
+    // Headers may span several reads - wait for the complete header block
+    if (strstr((char *)ws->http_buffer, "\r\n\r\n") == NULL) {
+        return 0;
+    }
+
     char *status = strstr((char *)ws->http_buffer, " 200 ");
     if (!status) {
         // Check for 101 Switching Protocols
@@ -515,28 +1347,36 @@ static int parse_http_response(websocket_context_t *ws) {
         return -1;
     }
 
+    if (http_negotiate_extensions(ws) < 0) {
+        return -1;
+    }
+
     return 1;  // Handshake complete
 }
 
-// Zero-copy WebSocket frame parser - HFT simplified version
-// Assumes: well-formed frames, FIN=1, no masking, complete frames in buffer
-// Optimization #7: Accept cached available to avoid redundant ringbuffer_available_read()
-static int parse_ws_frame_zero_copy(websocket_context_t *ws, size_t available, uint8_t **payload_ptr, size_t *payload_len, uint8_t *opcode) {
-    if (__builtin_expect(available < 2, 0)) return 0;  // Expect enough data available
-
-    // Get direct pointer to ringbuffer data (zero-copy)
-    uint8_t *data_ptr = NULL;
-    size_t data_len = 0;
-    ringbuffer_peek_read(&ws->rx_buffer, &data_ptr, &data_len);
-    if (__builtin_expect(data_len < 2, 0)) return 0;  // Expect valid peek
-
-    // Parse frame header - assume FIN=1, well-formed
-    *opcode = data_ptr[0] & 0x0F;
+// Decoded server frame header (RFC 6455 Section 5.2)
+typedef struct {
+    size_t header_len;
+    size_t payload_len;
+    size_t frame_len;    // header_len + payload_len
+    uint8_t opcode;
+    uint8_t fin;
+    uint8_t rsv;         // RSV1-3 bits as in byte 0 (0x70 mask)
+} ws_frame_info_t;
+
+// Pure header decode - no side effects on the context
+// Returns 1 if a complete frame is available, 0 if more data is needed, -1 on protocol violation
+// max_frame: largest frame the RX ring can ever hold (ring size - 1)
+static inline int decode_frame_header(const uint8_t *data_ptr, size_t data_len, size_t max_frame, ws_frame_info_t *f) {
+    if (__builtin_expect(data_len < 2, 0)) return 0;
+
+    f->opcode = data_ptr[0] & 0x0F;
+    f->fin = data_ptr[0] >> 7;
+    f->rsv = data_ptr[0] & 0x70;
 
     // RFC 6455 Section 5.1: Server MUST NOT mask frames sent to client
     // Bit 7 of byte 1 is the MASK bit - must be 0 for server-to-client frames
-    uint8_t mask_bit = data_ptr[1] & 0x80;
-    if (__builtin_expect(mask_bit != 0, 0)) {
+    if (__builtin_expect(data_ptr[1] & 0x80, 0)) {
         return -1;  // Protocol violation: server frames must not be masked
     }
 
@@ -568,40 +1408,236 @@ static int parse_ws_frame_zero_copy(websocket_context_t *ws, size_t available, u
         }
     }
 
-    // Check for integer overflow in frame size calculation
+    // RFC 6455 Section 5.5: control frames are never fragmented and carry <= 125 bytes
+    if (__builtin_expect(f->opcode & 0x8, 0)) {
+        if (f->opcode > WS_FRAME_PONG || !f->fin || payload_len_raw > 125) {
+            return -1;
+        }
+    } else if (__builtin_expect(f->opcode > WS_FRAME_BINARY, 0)) {
+        return -1;  // Reserved non-control opcode
+    }
+
+    // Check for integer overflow in frame size calculation, and frames that can never
+    // fit in the RX ring (would otherwise stall forever waiting for the rest)
     size_t total_frame_size;
-    if (__builtin_expect(__builtin_add_overflow(header_len, payload_len_raw, &total_frame_size), 0)) {
-        // Overflow: frame size exceeds SIZE_MAX - protocol violation, close connection
-        ws->closed = 1;
+    if (__builtin_expect(__builtin_add_overflow(header_len, payload_len_raw, &total_frame_size), 0) ||
+        __builtin_expect(total_frame_size > max_frame, 0)) {
         return -1;
     }
 
+    f->header_len = header_len;
+    f->payload_len = (size_t)payload_len_raw;
+    f->frame_len = total_frame_size;
+
     // Check if complete frame is available - expect complete frame ready
-    if (__builtin_expect(data_len < total_frame_size, 0)) return 0;
-
-    // Return direct pointer to payload (zero-copy)
-    *payload_ptr = data_ptr + header_len;
-    *payload_len = payload_len_raw;
-
-    // Prefetch payload data for large messages
-    // Market data often exceeds cache line size, so expect prefetch needed
-    if (__builtin_expect(payload_len_raw > CACHE_LINE_SIZE, 1)) {
-        __builtin_prefetch(*payload_ptr + CACHE_LINE_SIZE, 0, 2);
-        if (__builtin_expect(payload_len_raw > 512, 0)) {
-            __builtin_prefetch(*payload_ptr + 256, 0, 1);
-            __builtin_prefetch(*payload_ptr + 512, 0, 0);
+    return data_len >= total_frame_size;
+}
+
+// Prefetch payload data for large messages
+// Market data often exceeds cache line size, so expect prefetch needed
+static inline void prefetch_payload(const uint8_t *payload_ptr, size_t payload_len) {
+    if (__builtin_expect(payload_len > CACHE_LINE_SIZE, 1)) {
+        __builtin_prefetch(payload_ptr + CACHE_LINE_SIZE, 0, 2);
+        if (__builtin_expect(payload_len > 512, 0)) {
+            __builtin_prefetch(payload_ptr + 256, 0, 1);
+            __builtin_prefetch(payload_ptr + 512, 0, 0);
         }
     }
+}
 
-    // Advance ringbuffer past the frame
-    ringbuffer_advance_read(&ws->rx_buffer, total_frame_size);
+// Header decode specialized for a parser profile (a constant once inlined into its stage)
+// Fast path: FIN + TEXT/BINARY without RSV bits and the profile's length encoding, already
+// valid by construction; anything else goes through decode_frame_header unchanged
+static inline __attribute__((always_inline))
+int decode_frame_profile(const uint8_t *data_ptr, size_t data_len, size_t max_frame,
+                         ws_frame_info_t *f, const int profile) {
+    if (profile == WS_PARSER_GENERIC) return decode_frame_header(data_ptr, data_len, max_frame, f);
+
+    uint64_t payload_len;
+    size_t header_len;
+    if (__builtin_expect((uint8_t)(data_ptr[0] - 0x81) > 1, 0)) goto generic;  // Not 0x81 / 0x82
+
+    if (profile == WS_PARSER_SMALL) {
+        if (__builtin_expect(data_ptr[1] > 125, 0)) goto generic;
+        payload_len = data_ptr[1];
+        header_len = 2;
+    } else if (profile == WS_PARSER_MEDIUM) {
+        if (__builtin_expect(data_ptr[1] != 126 || data_len < 4, 0)) goto generic;
+        payload_len = ((uint64_t)data_ptr[2] << 8) | data_ptr[3];
+        if (__builtin_expect(payload_len <= 125, 0)) goto generic;
+        header_len = 4;
+    } else {
+        if (__builtin_expect(data_ptr[1] != 127 || data_len < 10, 0)) goto generic;
+        uint64_t be;
+        memcpy(&be, data_ptr + 2, sizeof(be));
+        payload_len = __builtin_bswap64(be);
+        if (__builtin_expect(payload_len <= 65535, 0)) goto generic;
+        header_len = 10;
+    }
+    // header_len + payload_len cannot wrap once payload_len is checked against the ring
+    if (__builtin_expect(payload_len > max_frame - header_len, 0)) goto generic;
+
+    f->opcode = data_ptr[0] & 0x0F;
+    f->fin = 1;
+    f->rsv = 0;
+    f->header_len = header_len;
+    f->payload_len = (size_t)payload_len;
+    f->frame_len = header_len + (size_t)payload_len;
+    return data_len >= f->frame_len;
+
+generic:
+    return decode_frame_header(data_ptr, data_len, max_frame, f);
+}
+
+// Prefetch layout per profile: small payloads span two lines at most, large ones always
+// want the stream ahead warmed
+static inline __attribute__((always_inline))
+void prefetch_payload_profile(const uint8_t *payload_ptr, size_t payload_len, const int profile) {
+    if (profile == WS_PARSER_SMALL) {
+        if (payload_len > CACHE_LINE_SIZE) __builtin_prefetch(payload_ptr + CACHE_LINE_SIZE, 0, 2);
+    } else if (profile == WS_PARSER_LARGE) {
+        __builtin_prefetch(payload_ptr + CACHE_LINE_SIZE, 0, 2);
+        __builtin_prefetch(payload_ptr + 256, 0, 1);
+        __builtin_prefetch(payload_ptr + 512, 0, 0);
+    } else {
+        prefetch_payload(payload_ptr, payload_len);
+    }
+}
+
+// Append fragment payload to the reassembly arena (grows to the high-water mark, never shrinks)
+// Returns 0 on success, -1 if the message exceeds WS_FRAG_ARENA_MAX or allocation fails
+static int frag_arena_append(websocket_context_t *ws, const uint8_t *data, size_t len) {
+    size_t need;
+    if (__builtin_add_overflow(ws->frag_len, len, &need) || need > WS_FRAG_ARENA_MAX) {
+        return -1;
+    }
 
-    // Return actual bytes consumed - check INT_MAX for safe cast
-    if (__builtin_expect(total_frame_size > INT_MAX, 0)) {
-        // Frame exceeds 2GB - very rare, but return INT_MAX to prevent truncation
-        return INT_MAX;
+    if (need > ws->frag_arena_cap) {
+        size_t new_cap = ws->frag_arena_cap ? ws->frag_arena_cap : WS_FRAG_ARENA_MIN;
+        while (new_cap < need) new_cap *= 2;
+        uint8_t *grown = (uint8_t *)realloc(ws->frag_arena, new_cap);
+        if (!grown) return -1;
+        ws->frag_arena = grown;
+        ws->frag_arena_cap = new_cap;
+    }
+
+    memcpy(ws->frag_arena + ws->frag_len, data, len);
+    ws->frag_len = need;
+    return 0;
+}
+
+#ifdef __linux__
+static inline void rx_stamp_push(websocket_context_t *ws, uint64_t end, uint64_t ts_ns) {
+    if (ws->rx_stamp_head - ws->rx_stamp_tail == WS_RX_STAMPS) ws->rx_stamp_tail++;  // Oldest goes
+    uint32_t i = ws->rx_stamp_head++ & (WS_RX_STAMPS - 1);
+    ws->rx_stamps[i].end = end;
+    ws->rx_stamps[i].ts_ns = ts_ns;
+}
+
+// Stamp of the read that completed the frame ending at stream offset end (frames come
+// in stream order, so stamps of reads wholly before it are dropped for good)
+static inline void rx_stamp_frame(websocket_context_t *ws, uint64_t end) {
+    while (ws->rx_stamp_tail != ws->rx_stamp_head) {
+        uint32_t i = ws->rx_stamp_tail & (WS_RX_STAMPS - 1);
+        if (ws->rx_stamps[i].end >= end) {
+            ws->hw_timestamp_ns = ws->rx_stamps[i].ts_ns;
+            return;
+        }
+        ws->rx_stamp_tail++;
+    }
+}
+#endif
+
+// Bookkeeping of one successful read: NIC stamp, trace capture, commit into the ring
+// offset: bytes already read in this ws_update() (not yet counted in stats.bytes_rx)
+static inline void rx_commit_read(websocket_context_t *ws, uint8_t *write_ptr, int ret, uint64_t offset,
+                                  int first) {
+#ifdef __linux__
+    // Stage 1: hardware NIC timestamp of this read from the transport (if available);
+    // the batch keeps the first one, each frame later picks the read that ended it
+    if (ws->hw_timestamping_available) {
+        uint64_t hw_ts = ws->transport->hw_timestamp(ws->conn);
+        if (hw_ts != 0) {
+            if (first) ws->hw_timestamp_ns = hw_ts;
+            rx_stamp_push(ws, ws->stats.bytes_rx + offset + (uint64_t)ret, hw_ts);
+        }
+    }
+#else
+    (void)offset;
+    (void)first;
+#endif
+    if (__builtin_expect(ws->trace != NULL, 0)) {
+        ws_trace_capture(ws->trace, write_ptr, (size_t)ret);
+    }
+    ringbuffer_commit_write(&ws->rx_buffer, ret);
+}
+
+// A read returned nothing: drained (WANT_READ) is the common case; EOF or a socket error
+// drops the connection
+static inline void rx_read_ended(websocket_context_t *ws, int ret) {
+    int failed = __builtin_expect(ws->ring_io, 0) ? ret < 0 : ws->transport->read_failed(ws->conn, ret);
+    if (__builtin_expect(failed, 0)) {
+        ws->connected = 0;
+        ws->closed = 1;
+        WS_STAT_ADD(ws->stats.disconnects, 1);
+        if (ws->on_status) ws->on_status(ws, -1);
+    }
+}
+
+// Transport read, or on the data path the RECV that completed into buf (0 while in flight)
+static inline int ws_conn_read(websocket_context_t *ws, uint8_t *buf, size_t len) {
+    if (__builtin_expect(ws->ring_io, 0)) return ws_notifier_io_recv(ws->notifier, ws->ring_io_fd, buf, len);
+    return ws->transport->read_into(ws->conn, buf, len);
+}
+
+// Data path: the next RECV lands at the ring's write position, sent with the next wait
+// (process_recv collected the last one: the write position only moves on a completion)
+static inline void ws_ring_io_rx_arm(websocket_context_t *ws) {
+    uint8_t *write_ptr = NULL;
+    size_t write_len = 0;
+    ringbuffer_get_write_ptr(&ws->rx_buffer, &write_ptr, &write_len);
+    if (ws->rx_latency && write_len > ws->rx_read_budget) write_len = ws->rx_read_budget;
+    int ret = ws_notifier_io_recv(ws->notifier, ws->ring_io_fd, write_ptr, write_len);
+    if (__builtin_expect(ret < 0, 0)) rx_read_ended(ws, ret);
+}
+
+// Move a connected ws:// context onto the bound notifier's io_uring data path, if it has
+// one; readiness stays for TLS (OpenSSL owns the records) and for NIC RX timestamps (cmsgs)
+static void ws_ring_io_start(websocket_context_t *ws) {
+    if (ws->ring_io || !ws->notifier || !ws->connected || ws->closed || ws->replay ||
+        ws->transport != &ws_transport_tcp || ws->hw_timestamping_available) {
+        return;
+    }
+    int fd = ws_get_fd(ws);
+    if (fd < 0 || ws_notifier_io_attach(ws->notifier, fd) < 0) return;
+    ws->ring_io = 1;
+    ws->ring_io_fd = fd;
+    ws->ring_io_tx = NULL;
+    ws_ring_io_rx_arm(ws);
+}
+
+// Back to the transport (before the socket closes or the notifier changes); a RECV or SEND
+// that completed meanwhile still counts
+static void ws_ring_io_stop(websocket_context_t *ws) {
+    if (!ws->ring_io) return;
+    int rx = 0;
+    int tx = 0;
+    ws_notifier_io_detach(ws->notifier, ws->ring_io_fd, &rx, &tx);
+    ws->ring_io = 0;
+    if (rx > 0) {
+        uint8_t *write_ptr = NULL;
+        size_t write_len = 0;
+        ringbuffer_get_write_ptr(&ws->rx_buffer, &write_ptr, &write_len);
+        rx_commit_read(ws, write_ptr, rx, 0, 1);  // Parsed by the next ws_update()
+        WS_STAT_ADD(ws->stats.reads, 1);
+        WS_STAT_ADD(ws->stats.bytes_rx, rx);
+    }
+    if (tx > 0) {
+        ws_tx_ring_io_done(ws, (size_t)tx);
+    } else if (ws->ring_io_tx) {
+        ws->ring_io_tx = NULL;  // Cancelled: offered again through the transport
+        ws->tx_retry_len = 0;
     }
-    return (int)total_frame_size;
 }
 
 // Process incoming data - zero-copy from SSL to ring buffer
@@ -614,8 +1650,9 @@ static inline int process_recv(websocket_context_t *ws) {
     size_t write_len = 0;
     int total_read = 0;
     int first_read = 1;  // Track first read to capture recv start/end timestamps
+    int reads = 0;
 
-    // Optimization: Use do-while to save one ssl_pending() call
+    // Optimization: Use do-while to save one pending() call
     // Since we're called when event notifier reports data available,
     // we know there's data to read, so do at least one attempt
     do {
@@ -627,40 +1664,70 @@ static inline int process_recv(websocket_context_t *ws) {
             ws->recv_start_timestamp = os_get_cpu_cycle();
         }
 
-        int ret = ssl_read_into(ws->ssl, write_ptr, write_len);
+        int ret = ws_conn_read(ws, write_ptr, write_len);
         if (__builtin_expect(ret > 0, 1)) {  // Expect successful read
             // Stage 4: Capture timestamp after first successful SSL_read (data decrypted)
             if (__builtin_expect(first_read, 1)) {  // Expect first read
                 ws->recv_end_timestamp = os_get_cpu_cycle();
-
-#ifdef __linux__
-                // Stage 1: Capture hardware NIC timestamp from BIO storage (if available)
-                if (ws->hw_timestamping_available) {
-                    bio_timestamp_t *bio_ts = ssl_get_timestamp_storage(ws->ssl);
-                    if (bio_ts && bio_ts->hw_timestamp_ns != 0) {
-                        ws->hw_timestamp_ns = bio_ts->hw_timestamp_ns;
-                    }
-                }
-#endif
                 first_read = 0;
             }
-            ringbuffer_commit_write(&ws->rx_buffer, ret);
+
+            rx_commit_read(ws, write_ptr, ret, (uint64_t)total_read, reads == 0);
             total_read += ret;
+            reads++;
         } else {
-            break;  // No more data available or error
+            rx_read_ended(ws, ret);
+            break;
         }
-    } while (ssl_pending(ws->ssl) > 0);  // Continue if SSL has buffered data
+    } while (ws->transport->pending(ws->conn) > 0);  // Continue if TLS has buffered data
+
+    if (__builtin_expect(total_read > 0, 1)) {
+        WS_STAT_ADD(ws->stats.reads, 1);
+        WS_STAT_ADD(ws->stats.bytes_rx, total_read);
+        WS_STAT_ADD(ws->stats.ssl_pending_loops, reads - 1);
+        WS_STAT_MAX(ws->stats.rx_ring_high_water, ringbuffer_available_read(&ws->rx_buffer));
+    }
 
     return total_read;
 }
 
+// Replay counterpart of process_recv: copies the next due batch of the capture into
+// the RX ring; frames queued for sending are dropped (there is no peer)
+static int replay_recv(websocket_context_t *ws) {
+    ws_replay_t *r = ws->replay;
+    if (ws->has_pending_tx) ws_tx_discard(ws);
+
+    ws->event_timestamp = os_get_cpu_cycle();
+    ws->recv_start_timestamp = ws->event_timestamp;
+
+    uint8_t *write_ptr = NULL;
+    size_t write_len = 0;
+    ringbuffer_get_write_ptr(&ws->rx_buffer, &write_ptr, &write_len);
+    size_t n = ws_replay_due(r, r->speed > 0.0 ? os_cycles_to_ns(ws->event_timestamp) : 0, write_len);
+    if (n == 0) return 0;
+
+    memcpy(write_ptr, r->data + r->pos, n);
+    ws_replay_consume(r, n);
+    ws->recv_end_timestamp = os_get_cpu_cycle();
+
+    if (__builtin_expect(ws->trace != NULL, 0)) {
+        ws_trace_capture(ws->trace, write_ptr, n);
+    }
+    ringbuffer_commit_write(&ws->rx_buffer, n);
+
+    WS_STAT_ADD(ws->stats.reads, 1);
+    WS_STAT_ADD(ws->stats.bytes_rx, n);
+    WS_STAT_MAX(ws->stats.rx_ring_high_water, ringbuffer_available_read(&ws->rx_buffer));
+    return (int)n;
+}
+
 // Handle HTTP handshake - simplified
 static inline void handle_http_stage(websocket_context_t *ws) {
     // Reserve 1 byte for null terminator
     size_t space_available = sizeof(ws->http_buffer) - ws->http_len - 1;
     if (space_available == 0) return;  // Buffer full (accounting for null terminator)
 
-    int ret = ssl_recv(ws->ssl, ws->http_buffer + ws->http_len, space_available);
+    int ret = ws->transport->read_into(ws->conn, ws->http_buffer + ws->http_len, space_available);
     if (ret > 0) {
         ws->http_len += ret;
         // Always null-terminate for safe string operations (strstr, etc.)
@@ -668,7 +1735,12 @@ static inline void handle_http_stage(websocket_context_t *ws) {
         int parse_result = parse_http_response(ws);
         if (parse_result == 1) {
             ws->connected = 1;
-            if (ws->on_status) ws->on_status(ws, 0);
+            ws_select_parse_stage(ws);  // Extensions are known now
+            WS_STAT_ADD(ws->stats.connects, 1);
+            ws_hist_record(&ws->stats.connect_time, os_get_cpu_cycle() - ws->connect_start_cycle);
+            ws_heartbeat_start(ws);
+            ws_ring_io_start(ws);  // Notifier bound while connecting
+            if (ws->on_status) ws->on_status(ws, WS_STATUS_CONNECTED);
         } else if (parse_result == -1) {
             // HTTP handshake failed (non-101 response)
             // Print the response for debugging
@@ -678,6 +1750,7 @@ static inline void handle_http_stage(websocket_context_t *ws) {
                         (int)ws->http_len, ws->http_buffer);
             }
             ws->closed = 1;  // Mark as closed to indicate error
+            WS_STAT_ADD(ws->stats.connect_failures, 1);
             if (ws->on_status) ws->on_status(ws, -1);
         }
     }
@@ -695,55 +1768,11 @@ static inline void send_pong_frame(websocket_context_t *ws, const uint8_t *ping_
         return;
     }
 
-    // PONG frame: FIN=1, opcode=0xA (PONG), MASKED (client-to-server)
-    // RFC 6455 Section 5.1: All client-to-server frames MUST be masked
-    uint8_t frame[6 + 125];  // 2-byte header + 4-byte mask + max control payload
-    size_t frame_len = 2;
-
-    frame[0] = 0x8A;  // FIN + PONG opcode
-    frame[1] = 0x80 | (ping_len & 0x7F);  // MASK=1 + payload length
-
-    // Generate unpredictable 4-byte masking key (RFC 6455 requirement)
-    uint32_t mask_word = get_masking_key(ws);
-    uint8_t mask[4];
-    mask[0] = (mask_word >> 0) & 0xFF;
-    mask[1] = (mask_word >> 8) & 0xFF;
-    mask[2] = (mask_word >> 16) & 0xFF;
-    mask[3] = (mask_word >> 24) & 0xFF;
-
-    memcpy(frame + 2, mask, 4);
-    frame_len += 4;
-
-    size_t total_size = frame_len + ping_len;
-
-    // Write to TX buffer
-    uint8_t *write_ptr = NULL;
-    size_t available = 0;
-    ringbuffer_get_write_ptr(&ws->tx_buffer, &write_ptr, &available);
-
-    if (available >= total_size) {
-        // Write frame header (includes masking key)
-        memcpy(write_ptr, frame, frame_len);
-
-        // Write masked payload (RFC 6455 Section 5.3: XOR with mask)
-        if (ping_len > 0) {
-            for (size_t i = 0; i < ping_len; i++) {
-                write_ptr[frame_len + i] = ping_payload[i] ^ mask[i & 3];
-            }
-        }
-
-        ringbuffer_commit_write(&ws->tx_buffer, total_size);
-        ws->has_pending_tx = 1;
-
-        // Auto-register WRITE event if notifier is set (Option 3)
-        if (ws->notifier) {
-            int fd = ws_get_fd(ws);
-            if (fd >= 0) {
-                ws_notifier_mod(ws->notifier, fd, WS_EVENT_READ | WS_EVENT_WRITE);
-            }
-        }
+    // Urgent lane: ahead of queued data frames, dropped only when the lane itself is full
+    // (the socket has been stalled for a while)
+    if (ws_urgent_queue(ws, WS_FRAME_PONG, ping_payload, ping_len, WS_URGENT_CLOSE_ROOM) < 0) {
+        WS_STAT_ADD(ws->stats.urgent_dropped, 1);
     }
-    // If no space, silently drop (control frames are best-effort in tight loops)
 }
 
 // Send CLOSE frame in response to server-initiated CLOSE (RFC 6455 Section 5.5.1)
@@ -764,111 +1793,649 @@ static inline void send_close_response(websocket_context_t *ws, const uint8_t *c
         return;
     }
 
-    // CLOSE frame: FIN=1, opcode=0x8 (CLOSE), masked
-    // Frame format: 2-byte header + 4-byte mask + payload (status code if present)
-    uint8_t frame[6 + 125];  // Header + mask + max control payload
-    size_t frame_len = 2;
-
-    frame[0] = 0x88;  // FIN + CLOSE opcode
+    // Echo the status code only, no reason text; the urgent lane always has room for it
+    ws_urgent_queue(ws, WS_FRAME_CLOSE, close_payload, close_len >= 2 ? 2 : 0, 0);
 
-    // Determine payload length (echo back status code if provided)
-    size_t response_len = (close_len >= 2) ? 2 : 0;  // Echo status code only, no reason text
-    frame[1] = 0x80 | (response_len & 0x7F);  // MASK=1 + length
+    // Mark connection as closed per RFC 6455 closing handshake
+    ws->connected = 0;
+    ws->closed = 1;
+    WS_STAT_ADD(ws->stats.disconnects, 1);
+}
 
-    // Generate unpredictable 4-byte masking key (RFC 6455 requirement)
-    uint32_t mask_word = get_masking_key(ws);
-    uint8_t mask[4];
-    mask[0] = (mask_word >> 0) & 0xFF;
-    mask[1] = (mask_word >> 8) & 0xFF;
-    mask[2] = (mask_word >> 16) & 0xFF;
-    mask[3] = (mask_word >> 24) & 0xFF;
+// Protocol violation detected - close connection immediately
+// This prevents infinite re-parse loop of malformed frames
+static void ws_protocol_error(websocket_context_t *ws) {
+    ws->connected = 0;
+    ws->closed = 1;
+    WS_STAT_ADD(ws->stats.disconnects, 1);
+    if (ws->on_status) ws->on_status(ws, -1);
+}
 
-    memcpy(frame + 2, mask, 4);
-    frame_len += 4;
+// Hand a message to the application: on_msg in place, or a descriptor for the pipeline
+// consumer (a free slot is guaranteed by handle_ws_stage, published after the frame)
+static inline void ws_emit(websocket_context_t *ws, const uint8_t *payload_ptr, size_t payload_len, uint8_t opcode) {
+    if (__builtin_expect(!ws->rx_deferred, 1)) {
+        if (__builtin_expect(ws->on_msg != NULL, 1)) {  // Expect callback set
+            ws->on_msg(ws, payload_ptr, payload_len, opcode);
+        }
+        return;
+    }
 
-    // Copy and mask status code if present
-    if (response_len >= 2) {
-        frame[6] = close_payload[0] ^ mask[0];
-        frame[7] = close_payload[1] ^ mask[1];
-        frame_len += 2;
+    if (ws->poll_mode) {
+        ws_frame_t *fr = &ws->poll_out[ws->poll_n];
+        fr->payload = payload_ptr;
+        fr->len = payload_len;
+        fr->parsed_cycle = ws->frame_parsed_timestamp;
+        fr->opcode = opcode;
+        ws->pipe_pending = 1;
+        return;
     }
 
-    size_t total_size = frame_len;
+    ws_msg_desc_t *d = ws_spsc_claim(ws->pipeline);
+    d->payload = payload_ptr;
+    d->len = payload_len;
+    d->opcode = opcode;
+    d->hw_timestamp_ns = ws_get_hw_timestamp(ws);
+    d->recv_end_cycle = ws->recv_end_timestamp;
+    d->parsed_cycle = ws->frame_parsed_timestamp;
+    ws->pipe_pending = 1;
+}
 
-    // Write to TX buffer
-    uint8_t *write_ptr = NULL;
-    size_t available = 0;
-    ringbuffer_get_write_ptr(&ws->tx_buffer, &write_ptr, &available);
+// Publish the descriptor of the frame just handled; the consumer releases up to release_off
+static inline void ws_pipe_publish(websocket_context_t *ws, size_t release_off) {
+    if (!ws->pipe_pending) return;
+    if (ws->poll_mode) {
+        ws->poll_release_off = release_off;
+        ws->poll_n++;
+        ws->poll_held = 1;
+        ws->pipe_pending = 0;
+        return;
+    }
+    ws_msg_desc_t *d = &ws->pipeline->slots[ws->pipeline->head & ws->pipeline->mask];
+    d->release_off = release_off;
+    d->enqueue_cycle = os_get_cpu_cycle();
+    ws_spsc_publish(ws->pipeline);
+    ws->pipe_pending = 0;
+}
 
-    if (available >= total_size) {
-        memcpy(write_ptr, frame, total_size);
-        ringbuffer_commit_write(&ws->tx_buffer, total_size);
-        ws->has_pending_tx = 1;
+// Deliver control frame immediately (also while a fragmented message is in progress)
+static inline void handle_control_frame(websocket_context_t *ws, const uint8_t *payload_ptr, size_t payload_len, uint8_t opcode) {
+    // Handle PING frames automatically (RFC 6455: MUST respond with PONG)
+    if (opcode == WS_FRAME_PING) {
+        WS_STAT_ADD(ws->stats.pings_rx, 1);
+        send_pong_frame(ws, payload_ptr, payload_len);
+    }
 
-        // Auto-register WRITE event if notifier is set (Option 3)
-        if (ws->notifier) {
-            int fd = ws_get_fd(ws);
-            if (fd >= 0) {
-                ws_notifier_mod(ws->notifier, fd, WS_EVENT_READ | WS_EVENT_WRITE);
-            }
+    // Echo of our heartbeat PING: round trip from the PING to the batch that carried the PONG
+    if (opcode == WS_FRAME_PONG && payload_len == sizeof(uint64_t)) {
+        uint64_t sent;
+        memcpy(&sent, payload_ptr, sizeof(sent));
+        if (sent == ws->last_ping_cycle && sent != 0) {
+            ws_hist_record(&ws->stats.ping_rtt, ws->recv_end_timestamp - sent);
         }
     }
 
-    // Mark connection as closed per RFC 6455 closing handshake
-    ws->connected = 0;
-    ws->closed = 1;
+    // Handle CLOSE frames automatically (RFC 6455 Section 5.5.1: MUST respond with CLOSE)
+    if (opcode == WS_FRAME_CLOSE) {
+        send_close_response(ws, payload_ptr, payload_len);
+    }
+
+    // Pipeline/pull: the next fragment is compacted over this payload before the consumer
+    // would read it, so control frames inside a held message are not forwarded
+    if (__builtin_expect(ws->rx_deferred, 0) && ws->frag_active && ws->frag_inplace) return;
+
+    // Pass control frames to callback (application can see PINGs/PONGs/CLOSEs for monitoring)
+    ws_emit(ws, payload_ptr, payload_len, opcode);
+}
+
+// Append one trace record for a decoded frame (tracing enabled only)
+static inline void trace_frame(websocket_context_t *ws, const uint8_t *frame_ptr,
+                               const ws_frame_info_t *f, uint64_t stream_pos) {
+    ws_trace_record_t *r = ws_trace_next(ws->trace);
+    r->hw_timestamp_ns = ws_get_hw_timestamp(ws);
+    r->event_cycle = ws->event_timestamp;
+    r->recv_start_cycle = ws->recv_start_timestamp;
+    r->recv_end_cycle = ws->recv_end_timestamp;
+    r->parsed_cycle = os_get_cpu_cycle();
+    r->stream_offset = stream_pos - ws->trace->stream_base;
+    r->payload_len = (uint32_t)(f->payload_len > UINT32_MAX ? UINT32_MAX : f->payload_len);
+    r->opcode = f->opcode;
+    r->flags = (f->fin ? WS_TRACE_FLAG_FIN : 0) | ((f->rsv & 0x40) ? WS_TRACE_FLAG_RSV1 : 0);
+    r->header_len = (uint8_t)f->header_len;
+    r->reserved = 0;
+
+    uint64_t prefix = 0;
+    memcpy(&prefix, frame_ptr + f->header_len, f->payload_len < 8 ? f->payload_len : 8);
+    memcpy(r->prefix, &prefix, sizeof(prefix));
+    ws_trace_commit(ws->trace);
+}
+
+// Deliver a complete data message, inflating it first if it was compressed
+// Returns 0 on success, -1 on corrupt or oversized compressed payload
+static inline int deliver_message(websocket_context_t *ws, const uint8_t *payload_ptr, size_t payload_len,
+                                  uint8_t opcode, uint8_t compressed) {
+    if (__builtin_expect(compressed != 0, 0)) {
+        payload_ptr = ws_inflater_message(ws->inflater, payload_ptr, payload_len, &payload_len);
+        if (!payload_ptr) return -1;
+    }
+
+    WS_STAT_ADD(ws->stats.messages_rx, 1);
+    ws->last_data_cycle = ws->recv_end_timestamp;  // Stale-feed clock: no extra TSC read
+    ws_emit(ws, payload_ptr, payload_len, opcode);
+    return 0;
 }
 
 // Handle WebSocket data stage - HFT hot path (assume always connected)
-static inline void handle_ws_stage(websocket_context_t *ws) {
-    // Optimization #7: Cache available to avoid redundant ringbuffer_available_read() calls
-    size_t available = ringbuffer_available_read(&ws->rx_buffer);
+// Single-frame messages are delivered zero-copy from the RX ring. Fragmented messages are
+// reassembled in place (mirrored ring) or in the fragment arena, then delivered as one payload.
+// Instantiated once per parser profile: profile is a constant in each copy
+// Returns number of frames parsed
+static inline __attribute__((always_inline)) int handle_ws_stage_profile(websocket_context_t *ws, const int profile) {
+    uint8_t *data_ptr = NULL;
+    size_t data_len = 0;
+    if (__builtin_expect(!ws->rx_deferred, 1)) {
+        ringbuffer_peek_read(&ws->rx_buffer, &data_ptr, &data_len);
+    } else {
+        // Parse from our own cursor: read_offset trails it until the consumer catches up
+        data_ptr = ws->rx_buffer.pulled_data + ws->rx_parse_off;
+        data_len = (ws->rx_buffer.write_offset - ws->rx_parse_off) & ws->rx_buffer.mask;
+    }
 
     // Parse frames zero-copy
     int first_frame = 1;  // Track first frame to capture parsed timestamp
-    while (available >= 2) {
-        uint8_t *payload_ptr = NULL;
-        size_t payload_len = 0;
-        uint8_t opcode = 0;
-
-        int consumed = parse_ws_frame_zero_copy(ws, available, &payload_ptr, &payload_len, &opcode);
-        if (__builtin_expect(consumed > 0, 1)) {  // Expect successful parse
-            // Stage 5: Capture timestamp after first frame parsing completes
-            if (__builtin_expect(first_frame, 1)) {
-                ws->frame_parsed_timestamp = os_get_cpu_cycle();
-                first_frame = 0;
+    int frames = 0;
+    size_t scan = ws->rx_scan;  // Non-zero only while an in-place fragmented message is held
+
+    while (data_len - scan >= 2) {
+        // Pipeline/pull: each frame emits at most one descriptor, so one free slot is enough
+        if (__builtin_expect(ws->rx_deferred, 0)) {
+            if (ws->poll_mode) {
+                if (ws->poll_n >= ws->poll_max) break;  // Caller's array full (or no poll running)
+            } else if (!ws_spsc_claim(ws->pipeline)) {
+                WS_STAT_ADD(ws->stats.pipeline_full, 1);
+                break;
             }
+        }
+
+        ws_frame_info_t f;
+        uint8_t *frame_ptr = data_ptr + scan;
+        int ret = decode_frame_profile(frame_ptr, data_len - scan, ws->rx_buffer.mask, &f, profile);
+        if (ret == 0) break;  // Incomplete frame, wait for more data
+
+        // RSV1 marks a compressed message: only on the first frame of a data message,
+        // and only when permessage-deflate was negotiated; RSV2/RSV3 are never valid
+        uint8_t rsv_allowed = (ws->deflate_active && f.opcode != WS_FRAME_CONTINUATION && !(f.opcode & 0x8)) ? 0x40 : 0;
+        if (__builtin_expect(ret < 0 || (f.rsv & ~rsv_allowed) != 0, 0)) {
+            ws_protocol_error(ws);
+            return -1;
+        }
+
+        // Stage 5: Capture timestamp after first frame parsing completes
+        if (__builtin_expect(first_frame, 1)) {
+            ws->frame_parsed_timestamp = os_get_cpu_cycle();
+            first_frame = 0;
+        }
+        frames++;
 
-            // Handle PING frames automatically (RFC 6455: MUST respond with PONG)
-            // Expect TEXT/BINARY data frames, not control frames (rare)
-            if (__builtin_expect(opcode == WS_FRAME_PING, 0)) {
-                send_pong_frame(ws, payload_ptr, payload_len);
+        if (__builtin_expect(ws->trace != NULL, 0)) {
+            // Absolute RX stream position of this frame: everything read minus what is still ahead
+            trace_frame(ws, frame_ptr, &f, ws->stats.bytes_rx - (data_len - scan));
+        }
+
+#ifdef __linux__
+        if (ws->rx_stamp_tail != ws->rx_stamp_head) {  // Only with RX timestamps on
+            rx_stamp_frame(ws, ws->stats.bytes_rx - (data_len - scan) + f.frame_len);
+        }
+#endif
+
+        uint8_t *payload_ptr = frame_ptr + f.header_len;
+        size_t next = scan + f.frame_len;
+        prefetch_payload_profile(payload_ptr, f.payload_len, profile);
+
+        // Stage 6: Application callback invoked (timestamp captured by application)
+        // Expect TEXT/BINARY data frames, not control frames (rare)
+        if (__builtin_expect(f.opcode & 0x8, 0)) {
+            handle_control_frame(ws, payload_ptr, f.payload_len, f.opcode);
+        } else if (__builtin_expect(!ws->frag_active, 1)) {
+            if (__builtin_expect(f.opcode == WS_FRAME_CONTINUATION, 0)) {
+                ws_protocol_error(ws);  // CONTINUATION without a message in progress
+                return -1;
+            }
+            if (__builtin_expect(f.fin, 1)) {
+                // Common case: complete single-frame message, zero-copy
+                if (__builtin_expect(deliver_message(ws, payload_ptr, f.payload_len, f.opcode, f.rsv) < 0, 0)) {
+                    ws_protocol_error(ws);
+                    return -1;
+                }
+            } else {
+                // First fragment: hold it in place when the ring is mirrored
+                ws->frag_active = 1;
+                ws->frag_opcode = f.opcode;
+                ws->frag_compressed = f.rsv;
+                ws->frag_len = 0;
+                ws->frag_inplace = (uint8_t)ringbuffer_is_mirrored(&ws->rx_buffer);
+                if (ws->frag_inplace) {
+                    ws->frag_base_off = scan + f.header_len;
+                    ws->frag_len = f.payload_len;
+                } else if (frag_arena_append(ws, payload_ptr, f.payload_len) < 0) {
+                    ws_protocol_error(ws);
+                    return -1;
+                }
+            }
+        } else {
+            if (__builtin_expect(f.opcode != WS_FRAME_CONTINUATION, 0)) {
+                ws_protocol_error(ws);  // New data frame before the fragmented message finished
+                return -1;
             }
 
-            // Handle CLOSE frames automatically (RFC 6455 Section 5.5.1: MUST respond with CLOSE)
-            if (__builtin_expect(opcode == WS_FRAME_CLOSE, 0)) {
-                send_close_response(ws, payload_ptr, payload_len);
+            if (ws->frag_inplace) {
+                // Compact: slide this fragment's payload down over its header (and any
+                // control frames already delivered) so the message stays contiguous
+                uint8_t *dst = data_ptr + ws->frag_base_off + ws->frag_len;
+                if (dst != payload_ptr) {
+                    memmove(dst, payload_ptr, f.payload_len);
+                }
+                ws->frag_len += f.payload_len;
+            } else if (frag_arena_append(ws, payload_ptr, f.payload_len) < 0) {
+                ws_protocol_error(ws);
+                return -1;
             }
 
-            // Pass all frames to callback (application can see PINGs/PONGs/CLOSEs for monitoring)
-            // Stage 6: Application callback invoked (timestamp captured by application)
-            if (__builtin_expect(ws->on_msg != NULL, 1)) {  // Expect callback set
-                ws->on_msg(ws, payload_ptr, payload_len, opcode);
+            if (f.fin) {
+                const uint8_t *msg = ws->frag_inplace ? data_ptr + ws->frag_base_off : ws->frag_arena;
+                ws->frag_active = 0;
+                if (__builtin_expect(deliver_message(ws, msg, ws->frag_len, ws->frag_opcode, ws->frag_compressed) < 0, 0)) {
+                    ws_protocol_error(ws);
+                    return -1;
+                }
+                ws->frag_inplace = 0;
             }
+        }
 
-            // Update cached available by subtracting consumed bytes
-            available -= consumed;
-        } else if (consumed < 0) {
-            // Protocol violation detected - close connection immediately
-            // This prevents infinite re-parse loop of malformed frames
-            ws->connected = 0;
-            ws->closed = 1;
-            if (ws->on_status) ws->on_status(ws, -1);
-            break;
+        if (ws->frag_active && ws->frag_inplace) {
+            scan = next;  // Hold: fragments must stay behind read_offset
+            if (__builtin_expect(ws->rx_deferred, 0)) ws_pipe_publish(ws, ws->rx_parse_off);
         } else {
-            break;  // consumed == 0: Incomplete frame, wait for more data
+            // Release everything parsed so far
+            if (__builtin_expect(!ws->rx_deferred, 1)) {
+                ringbuffer_advance_read(&ws->rx_buffer, next);
+            } else {
+                ws->rx_parse_off = (ws->rx_parse_off + next) & ws->rx_buffer.mask;
+                ws_pipe_publish(ws, ws->rx_parse_off);  // Consumer releases the ring
+            }
+            data_ptr += next;
+            data_len -= next;
+            scan = 0;
+        }
+    }
+
+    // Pipeline/pull: no spill (the arena cannot cross threads or hold several messages),
+    // a message that large is an error
+    if (__builtin_expect(ws->rx_deferred, 0)) {
+        if (ws->frag_active && scan >= ringbuffer_size(&ws->rx_buffer) / 2) {
+            ws_protocol_error(ws);
+            return -1;
+        }
+    } else if (__builtin_expect(ws->frag_active && ws->frag_inplace, 0) &&
+        ringbuffer_available_write(&ws->rx_buffer) < ringbuffer_size(&ws->rx_buffer) / 4) {
+        size_t held = ws->frag_len;
+        ws->frag_len = 0;
+        if (frag_arena_append(ws, data_ptr + ws->frag_base_off, held) < 0) {
+            ws_protocol_error(ws);
+            return -1;
+        }
+        ws->frag_inplace = 0;
+        ringbuffer_advance_read(&ws->rx_buffer, scan);
+        scan = 0;
+    }
+
+    WS_STAT_ADD(ws->stats.frames_rx, frames);
+
+    ws->rx_scan = scan;
+    return frames;
+}
+
+#define WS_DEFINE_PARSE_STAGE(name, profile) \
+    static int handle_ws_stage_##name(websocket_context_t *ws) { return handle_ws_stage_profile(ws, profile); }
+
+WS_DEFINE_PARSE_STAGE(generic, WS_PARSER_GENERIC)
+WS_DEFINE_PARSE_STAGE(small, WS_PARSER_SMALL)
+WS_DEFINE_PARSE_STAGE(medium, WS_PARSER_MEDIUM)
+WS_DEFINE_PARSE_STAGE(large, WS_PARSER_LARGE)
+
+static int (*const ws_parse_stages[WS_PARSER_PROFILES])(websocket_context_t *ws) = {
+    [WS_PARSER_GENERIC] = handle_ws_stage_generic,
+    [WS_PARSER_SMALL] = handle_ws_stage_small,
+    [WS_PARSER_MEDIUM] = handle_ws_stage_medium,
+    [WS_PARSER_LARGE] = handle_ws_stage_large,
+};
+
+// One indirect call per receive batch, not per frame
+static inline int handle_ws_stage(websocket_context_t *ws) {
+    return ws->parse_stage(ws);
+}
+
+// Compressed data frames carry RSV1 and would miss every fast path
+static void ws_select_parse_stage(websocket_context_t *ws) {
+    ws->parse_stage = ws_parse_stages[ws->deflate_active ? WS_PARSER_GENERIC : ws->parser_profile];
+}
+
+int ws_set_parser_profile(websocket_context_t *ws, ws_parser_profile_t profile) {
+    if (!ws || (unsigned)profile >= WS_PARSER_PROFILES) return -1;
+    ws->parser_profile = (uint8_t)profile;
+    ws_select_parse_stage(ws);
+    return 0;
+}
+
+ws_parser_profile_t ws_get_parser_profile(websocket_context_t *ws) {
+    if (!ws || ws->deflate_active) return WS_PARSER_GENERIC;
+    return (ws_parser_profile_t)ws->parser_profile;
+}
+
+int ws_set_rx_mode(websocket_context_t *ws, ws_rx_mode_t mode, size_t read_budget) {
+    if (!ws || (mode != WS_RX_THROUGHPUT && mode != WS_RX_LATENCY)) return -1;
+    ws->rx_latency = mode == WS_RX_LATENCY;
+    ws->rx_read_budget = read_budget ? read_budget : WS_RX_READ_BUDGET;
+    return 0;
+}
+
+// Pre-warm (ws_prewarm, ws_library_prewarm): synthetic server frames through a scratch context
+#define WS_PREWARM_FRAMES 4096
+#define WS_PREWARM_RING (256u * 1024u)
+#define WS_PREWARM_LARGE 70000   // Past 64 KB: 64-bit length field
+
+// Monotonic ns: the TSC conversion may be the very thing being warmed
+static uint64_t ws_prewarm_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Touch the payload like an application would, never the user's callback
+static void ws_prewarm_on_msg(websocket_context_t *ws, const uint8_t *payload_ptr, size_t payload_len, uint8_t opcode) {
+    volatile uint8_t sink = payload_len ? payload_ptr[payload_len - 1] : opcode;
+    (void)sink;
+    (void)ws;
+}
+
+// Unmasked server frame header + filler payload, returns bytes written
+static size_t ws_prewarm_frame(uint8_t *dst, uint8_t first_byte, size_t payload_len) {
+    size_t header_len = 2;
+    dst[0] = first_byte;
+    if (payload_len <= 125) {
+        dst[1] = (uint8_t)payload_len;
+    } else if (payload_len <= 65535) {
+        dst[1] = 126;
+        dst[2] = (payload_len >> 8) & 0xFF;
+        dst[3] = payload_len & 0xFF;
+        header_len = 4;
+    } else {
+        dst[1] = 127;
+        for (int i = 0; i < 8; i++) {
+            dst[2 + i] = ((uint64_t)payload_len >> (56 - 8 * i)) & 0xFF;
         }
+        header_len = 10;
     }
+    memset(dst + header_len, 'w', payload_len);
+    return header_len + payload_len;
+}
+
+// Run about WS_PREWARM_FRAMES frames of every shape (small/medium/large, PING, fragmented)
+// through the parse stage of profile. Returns frames parsed, -1 if the scratch context fails
+static long ws_prewarm_parser(uint8_t profile) {
+    websocket_context_t *ws = NULL;
+    if (posix_memalign((void**)&ws, CACHE_LINE_SIZE, sizeof(websocket_context_t)) != 0 || ws == NULL) {
+        return -1;
+    }
+    memset(ws, 0, sizeof(websocket_context_t));
+    ws->hb_next_cycle = UINT64_MAX;
+    ws_timer_init(&ws->hb_timer, ws_heartbeat_timer);
+    ws->tx_ring_size = WS_PREWARM_RING;
+    if (ringbuffer_init_size(&ws->rx_buffer, WS_PREWARM_RING, NULL) < 0 || ws_tx_create(ws) < 0) {
+        ws_free(ws);
+        return -1;
+    }
+    ws->parser_profile = profile;
+    ws_select_parse_stage(ws);
+    ws->on_msg = ws_prewarm_on_msg;
+    ws->connected = 1;
+    ws->handshake_sent = 1;
+
+    long frames = 0;
+    for (int round = 0; frames < WS_PREWARM_FRAMES; round++) {
+        uint8_t *write_ptr = NULL;
+        size_t available = 0;
+        ringbuffer_get_write_ptr(&ws->rx_buffer, &write_ptr, &available);
+        if (available < WS_PREWARM_LARGE + 4096) break;  // Non-mirrored ring near its end
+
+        size_t n = 0;
+        for (int i = 0; i < 8; i++) n += ws_prewarm_frame(write_ptr + n, 0x81, 32);
+        n += ws_prewarm_frame(write_ptr + n, 0x82, 1000);
+        n += ws_prewarm_frame(write_ptr + n, 0x89, 8);   // PING: PONG queued on the scratch TX ring
+        n += ws_prewarm_frame(write_ptr + n, 0x01, 64);  // Fragmented TEXT
+        n += ws_prewarm_frame(write_ptr + n, 0x80, 64);
+        if ((round & 15) == 15) n += ws_prewarm_frame(write_ptr + n, 0x82, WS_PREWARM_LARGE);
+        ringbuffer_commit_write(&ws->rx_buffer, n);
+        ws->stats.bytes_rx += n;
+
+        int parsed = handle_ws_stage(ws);
+        if (parsed <= 0 || ringbuffer_available_read(&ws->rx_buffer) != 0) break;
+        frames += parsed;
+        ws_tx_discard(ws);
+    }
+
+    ws_free(ws);
+    return frames;
+}
+
+// Steps shared by both entry points: clock calibration, mask dispatch, transport setup
+static int ws_prewarm_library(const ws_transport_t *transport, ws_prewarm_report_t *r) {
+    uint64_t t0 = ws_prewarm_now_ns();
+    (void)os_cycles_to_ns(os_get_cpu_cycle());
+    uint64_t t1 = ws_prewarm_now_ns();
+    r->clock_ns = t1 - t0;
+
+    // Selects the SIMD kernel and warms its head/body/tail paths
+    static uint8_t mask_src[4096], mask_dst[4096];
+    for (size_t len = 1; len <= sizeof(mask_src); len = len * 2 + 3) {
+        ws_mask_apply(mask_dst, mask_src, len, 0x5A5A5A5Au ^ (uint32_t)len);
+    }
+    uint64_t t2 = ws_prewarm_now_ns();
+    r->mask_ns = t2 - t1;
+
+    int ret = 0;
+    if (transport && transport->prewarm && transport->prewarm() < 0) ret = -1;
+    r->transport_ns = ws_prewarm_now_ns() - t2;
+    return ret;
+}
+
+int ws_library_prewarm(ws_prewarm_report_t *out) {
+    ws_prewarm_report_t r = {0};
+    uint64_t start = ws_prewarm_now_ns();
+    int ret = ws_prewarm_library(&ws_transport_tls, &r);
+
+    uint64_t t = ws_prewarm_now_ns();
+    long frames = ws_prewarm_parser(WS_DEFAULT_PARSER_PROFILE);
+    if (frames < 0) ret = -1;
+    else r.frames = (uint64_t)frames;
+    r.parser_ns = ws_prewarm_now_ns() - t;
+
+    r.total_ns = ws_prewarm_now_ns() - start;
+    if (out) *out = r;
+    return ret;
+}
+
+int ws_prewarm(websocket_context_t *ws, ws_prewarm_report_t *out) {
+    if (!ws) return -1;
+    ws_prewarm_report_t r = {0};
+    uint64_t start = ws_prewarm_now_ns();
+    int ret = ws_prewarm_library(ws->transport, &r);
+
+    // Masking PRNG: the first frame sent would otherwise pay for getrandom()
+    uint64_t t = ws_prewarm_now_ns();
+    (void)get_masking_key(ws);
+
+    // Pre-fault rings still empty (both mirror halves); a ring holding data is left alone
+    if (ringbuffer_available_read(&ws->rx_buffer) == 0 && !ws->rx_deferred && !ws->frag_active) {
+        ringbuffer_prepare(&ws->rx_buffer, RINGBUFFER_MEM_PREFAULT, -1);
+    }
+    if (ws->tx_buffer.pulled_data && ringbuffer_available_read(&ws->tx_buffer) == 0 && !ws->tx_reserved) {
+        ringbuffer_prepare(&ws->tx_buffer, RINGBUFFER_MEM_PREFAULT, -1);
+    }
+    uint64_t t2 = ws_prewarm_now_ns();
+    r.rings_ns = t2 - t;
+
+    // Same parse stage as the context; its stats, callbacks and rings are untouched
+    long frames = ws_prewarm_parser(ws->deflate_active ? WS_PARSER_GENERIC : ws->parser_profile);
+    if (frames < 0) ret = -1;
+    else r.frames = (uint64_t)frames;
+    r.parser_ns = ws_prewarm_now_ns() - t2;
+
+    r.total_ns = ws_prewarm_now_ns() - start;
+    if (out) *out = r;
+    return ret;
+}
+
+// Forget the previous connection's protocol state (ring memory is kept)
+static void ws_reset_connection(websocket_context_t *ws) {
+    ws_timer_cancel(&ws->hb_timer);
+    ws->hb_next_cycle = UINT64_MAX;
+    ws->connected = 0;
+    ws->closed = 0;
+    ws->handshake_sent = 0;
+    ws->http_len = 0;
+
+    // RX: drop unparsed bytes; in pipeline/pull mode the consumer still owns what it was
+    // handed and its next release moves read_offset past the dropped tail
+    if (ws->rx_deferred) {
+        ws->rx_parse_off = ws->rx_buffer.write_offset;
+        ws->pipe_pending = 0;
+        // Pull mode with nothing handed out: the tail can go right away
+        if (ws->poll_mode && !ws->poll_held) ringbuffer_release_to(&ws->rx_buffer, ws->rx_parse_off);
+    } else {
+        ringbuffer_advance_read(&ws->rx_buffer, ringbuffer_available_read(&ws->rx_buffer));
+    }
+    ws->rx_scan = 0;
+    ws->frag_active = 0;
+    ws->frag_inplace = 0;
+    ws->frag_len = 0;
+    ws->frag_compressed = 0;
+#ifdef __linux__
+    ws->rx_stamp_tail = ws->rx_stamp_head;
+#endif
+
+    // TX: frames queued for the old connection must not reach the new one
+    ws_tx_discard(ws);
+    ws->tx_reserved = 0;
+
+    // permessage-deflate is negotiated again by the next upgrade
+    ws_inflater_free(ws->inflater);
+    ws->inflater = NULL;
+    ws->deflate_active = 0;
+    ws_select_parse_stage(ws);
+}
+
+int ws_reconnect(websocket_context_t *ws) {
+    if (!ws || ws->replay) return -1;
+
+    // Old fd leaves the notifier before it is closed (io_uring polls pin the file)
+    if (ws->notifier) {
+        ws_ring_io_stop(ws);
+        int fd = ws_get_fd(ws);
+        if (fd >= 0) ws_notifier_del(ws->notifier, fd);
+        ws->notifier = NULL;
+    }
+    if (ws->conn) ws->transport->close(ws->conn);
+    ws->conn = NULL;
+    ws_reset_connection(ws);
+    ws->user_closed = 0;
+
+    uint64_t now = os_get_cpu_cycle();
+    if (ws->reconnect_lost_cycle == 0) {
+        ws->reconnect_lost_cycle = now;
+        ws->reconnect_msg_mark = ws->stats.messages_rx;
+    }
+
+    // Jittered exponential backoff: uniform in [d/2, d]
+    uint64_t base = ws->reconnect_base_ms ? ws->reconnect_base_ms : WS_RECONNECT_BASE_MS;
+    uint64_t cap = ws->reconnect_max_ms ? ws->reconnect_max_ms : WS_RECONNECT_MAX_MS;
+    uint64_t d = base << (ws->reconnect_attempt < 20 ? ws->reconnect_attempt : 20);
+    if (d > cap) d = cap;
+    uint64_t delay_ms = (d - d / 2) + get_masking_key(ws) % (d / 2 + 1);
+    ws->reconnect_delay_ns = delay_ms * 1000000ULL;
+    ws->reconnect_sched_cycle = now;
+    ws->reconnect_attempt++;
+
+    // Refresh the address while the backoff runs
+    ws_resolver_prefetch(ws->hostname);
+    return 0;
+}
+
+// Outage ends with the first message on the new connection (backoff reset)
+static void ws_reconnect_first_msg(websocket_context_t *ws) {
+    if (ws->stats.messages_rx == ws->reconnect_msg_mark) return;  // Control frames only so far
+    ws_hist_record(&ws->stats.reconnect_to_first_msg, ws->frame_parsed_timestamp - ws->reconnect_lost_cycle);
+    ws->reconnect_lost_cycle = 0;
+    ws->reconnect_attempt = 0;
+}
+
+// Stage histograms of one read batch (stale timestamps from an earlier batch are skipped)
+static inline void rx_record_batch(websocket_context_t *ws, int frames) {
+    ws_hist_record(&ws->stats.stages[WS_STAT_EVENT_TO_RECV], ws->recv_start_timestamp - ws->event_timestamp);
+    ws_hist_record(&ws->stats.stages[WS_STAT_SSL_READ], ws->recv_end_timestamp - ws->recv_start_timestamp);
+    if (frames > 0) {
+        ws_hist_record(&ws->stats.stages[WS_STAT_PARSE], ws->frame_parsed_timestamp - ws->recv_end_timestamp);
+        ws_hist_record(&ws->stats.stages[WS_STAT_DISPATCH], os_get_cpu_cycle() - ws->frame_parsed_timestamp);
+        if (__builtin_expect(ws->reconnect_lost_cycle != 0, 0)) ws_reconnect_first_msg(ws);
+    }
+    // Unparsed bytes left in the ring: the read ended mid-frame
+    size_t unparsed = __builtin_expect(!ws->rx_deferred, 1) ? ringbuffer_available_read(&ws->rx_buffer)
+                    : ((ws->rx_buffer.write_offset - ws->rx_parse_off) & ws->rx_buffer.mask);
+    if (unparsed > ws->rx_scan) {
+        WS_STAT_ADD(ws->stats.partial_reads, 1);
+    }
+}
+
+// WS_RX_LATENCY counterpart of process_recv + handle_ws_stage: every read of at most
+// rx_read_budget bytes is parsed and dispatched before the next one, so stages 3-6 are
+// per read. Reads continue while the last one filled its budget or TLS holds more
+static int process_recv_latency(websocket_context_t *ws) {
+    ws->event_timestamp = os_get_cpu_cycle();
+
+    int total_read = 0;
+    int reads = 0;
+    for (;;) {
+        uint8_t *write_ptr = NULL;
+        size_t write_len = 0;
+        ringbuffer_get_write_ptr(&ws->rx_buffer, &write_ptr, &write_len);
+        if (__builtin_expect(write_len == 0, 0)) break;
+        if (write_len > ws->rx_read_budget) write_len = ws->rx_read_budget;
+
+        ws->recv_start_timestamp = os_get_cpu_cycle();
+        int ret = ws_conn_read(ws, write_ptr, write_len);
+        if (__builtin_expect(ret <= 0, 0)) {
+            rx_read_ended(ws, ret);
+            break;
+        }
+        ws->recv_end_timestamp = os_get_cpu_cycle();
+        rx_commit_read(ws, write_ptr, ret, 0, 1);
+        total_read += ret;
+        reads++;
+
+        // bytes_rx advances per read: the parser maps frames to NIC stamps by stream offset
+        WS_STAT_ADD(ws->stats.bytes_rx, ret);
+        int frames = handle_ws_stage(ws);
+        rx_record_batch(ws, frames);
+        if (__builtin_expect(!ws->connected || ws->closed, 0)) break;  // CLOSE frame or protocol error
+        if ((size_t)ret < write_len && ws->transport->pending(ws->conn) <= 0) break;  // Drained
+    }
+
+    if (__builtin_expect(reads > 0, 1)) {
+        WS_STAT_ADD(ws->stats.reads, 1);
+        WS_STAT_ADD(ws->stats.ssl_pending_loops, reads - 1);
+        WS_STAT_MAX(ws->stats.rx_ring_high_water, ringbuffer_available_read(&ws->rx_buffer));
+    }
+    return total_read;
 }
 
 // HFT simplified ws_update: minimal state machine
@@ -876,20 +2443,50 @@ int ws_update(websocket_context_t *ws) {
     if (!ws) return -1;
 
     if (__builtin_expect(!ws->connected, 0)) { // Once per connection
-        // Connection phase - do SSL handshake and WebSocket handshake
-        int ssl_status = ssl_handshake(ws->ssl);
-        if (ssl_status == 1) {
-            // SSL handshake complete, send WebSocket handshake
+        // Closing handshake: the CLOSE on the urgent lane leaves before any teardown
+        if (ws->closed && ws->has_pending_tx && ws->conn) ws_tx_drain(ws, 1);
+        if (ws->closed && ws->auto_reconnect && !ws->user_closed) {
+            ws_reconnect(ws);  // Tear down now, the first attempt runs once the backoff expired
+            return 0;
+        }
+        if (!ws->conn && !ws->replay) {
+            if (ws->closed) return 0;  // ws_close() during the backoff
+            // Reconnect backoff
+            if (os_cycles_to_ns_u64(os_get_cpu_cycle() - ws->reconnect_sched_cycle) < ws->reconnect_delay_ns) {
+                return 0;
+            }
+            WS_STAT_ADD(ws->stats.reconnects, 1);
+            ws->connect_start_cycle = os_get_cpu_cycle();
+            ws->conn = ws->transport->open_async(ws->hostname, ws->port);
+            if (!ws->conn) {
+                WS_STAT_ADD(ws->stats.connect_failures, 1);
+                ws->closed = 1;
+                if (ws->on_status) ws->on_status(ws, -1);
+                return -1;
+            }
+        }
+
+        if (__builtin_expect(ws->replay != NULL, 0)) return -1;  // Capture finished: stays CLOSED
+
+        // Connection phase - transport handshake (connect, TLS) and WebSocket handshake
+        int conn_status = ws->transport->handshake(ws->conn);
+        if (conn_status == 1) {
+            // Transport ready, send WebSocket handshake
             if (!ws->handshake_sent) {
+#ifdef __linux__
+                ws->hw_timestamping_available = ws_conn_hw_timestamping(ws);
+#endif
                 if (send_handshake(ws) > 0) {
                     ws->handshake_sent = 1;
+                    if (ws_get_session_reused(ws)) WS_STAT_ADD(ws->stats.tls_resumptions, 1);
                 }
             }
             if (ws->handshake_sent) {
                 handle_http_stage(ws);
             }
-        } else if (ssl_status == -1) {
-            // SSL handshake failed - mark as closed and notify application
+        } else if (conn_status == -1) {
+            // Connect or TLS handshake failed - mark as closed and notify application
+            if (!ws->closed) WS_STAT_ADD(ws->stats.connect_failures, 1);
             ws->closed = 1;
             if (ws->on_status) ws->on_status(ws, -1);
             return -1;
@@ -898,153 +2495,202 @@ int ws_update(websocket_context_t *ws) {
     }
 
     // Hot path
-    // Drain SSL
-    process_recv(ws);
-    handle_ws_stage(ws);
+    // Latency mode: reads and parsing interleave, the batch steps below are done per read
+    if (__builtin_expect(ws->rx_latency && ws->replay == NULL, 0)) {
+        process_recv_latency(ws);
+        goto tx;
+    }
 
-    // Optimization #8: Only check TX buffer if flag indicates pending data
-    if (__builtin_expect(ws->has_pending_tx, 0)) {
-        size_t tx_available = ringbuffer_available_read(&ws->tx_buffer);
-        if (tx_available > 0) {
-            uint8_t *read_ptr = NULL;
-            size_t read_len = 0;
-            ringbuffer_next_read(&ws->tx_buffer, &read_ptr, &read_len);
-            if (read_len > 0) {
-                if (read_len > 4096) read_len = 4096;
-                int sent = ssl_send(ws->ssl, read_ptr, read_len);
-                if (sent > 0) {
-                    ringbuffer_advance_read(&ws->tx_buffer, sent);
-                }
-            }
-        }
-        // Clear flag if TX buffer is now empty
-        if (ringbuffer_available_read(&ws->tx_buffer) == 0) {
-            ws->has_pending_tx = 0;
-
-            // Auto-unregister WRITE event if notifier is set (Option 3)
-            if (ws->notifier) {
-                int fd = ws_get_fd(ws);
-                if (fd >= 0) {
-                    // Unregister WRITE, keep only READ event
-                    ws_notifier_mod(ws->notifier, fd, WS_EVENT_READ);
-                }
-            }
+    // Drain SSL (or the capture when replaying)
+    int bytes_read;
+    if (__builtin_expect(ws->replay == NULL, 1)) {
+        bytes_read = process_recv(ws);
+    } else {
+        bytes_read = replay_recv(ws);
+        if (bytes_read == 0 && ws_replay_done(ws->replay)) {
+            // Pipeline: parsing may be paused on a full queue, finish once the consumer caught up
+            if (ws->pipeline && (ws_spsc_size(ws->pipeline) > 0 || handle_ws_stage(ws) > 0)) return 0;
+            // Pull: the caller's array may have filled before the capture's last frames
+            if (ws->poll_mode && handle_ws_stage(ws) > 0) return 0;
+            // Capture exhausted: every fed batch was already parsed (a trailing partial frame is dropped)
+            ws->connected = 0;
+            ws->closed = 1;
+            return 0;
         }
     }
+    int frames = handle_ws_stage(ws);
+
+    // Per-batch stage histograms
+    if (__builtin_expect(bytes_read > 0, 1)) rx_record_batch(ws, frames);
+
+tx:
+    if (__builtin_expect(ws->ring_io, 0) && ws->connected) ws_ring_io_rx_arm(ws);
+
+    // Optimization #8: Only check TX buffer if flag indicates pending data
+    // Corked: only the urgent lane goes out
+    if (__builtin_expect(ws->has_pending_tx, 0) &&
+        (!ws->tx_corked || ws->tx_urgent_tail != ws->tx_urgent_head)) {
+        ws_tx_drain(ws, !ws->tx_corked);
+    }
+
+    // Heartbeat of a context without a notifier timing wheel: one compare per update
+    if (__builtin_expect(ws->event_timestamp >= ws->hb_next_cycle, 0)) {
+        ws_heartbeat_run(ws, ws->event_timestamp);
+    }
 
     return 0;
 }
 
 int ws_send(websocket_context_t *ws, const uint8_t *data, size_t len) {
-    if (__builtin_expect(!ws || !ws->connected, 0)) return -1;  // Unlikely: validation
+    return ws_send_ex(ws, data, len, WS_FRAME_TEXT, 1);
+}
 
-    // Create WebSocket frame header with masking (RFC 6455 Section 5.1)
-    // Client-to-server frames MUST be masked
-    uint8_t frame[14];
-    size_t frame_len = 2;
+int ws_send_ex(websocket_context_t *ws, const uint8_t *data, size_t len, uint8_t opcode, int fin) {
+    if (__builtin_expect(!ws || !ws->connected || ws->tx_reserved, 0)) return -1;  // Unlikely: validation
+    if (__builtin_expect(!ws_frame_valid(opcode, fin, len), 0)) return -1;
 
-    frame[0] = 0x81;  // FIN + TEXT frame
+    // Zero-copy write: the whole frame must fit contiguously, otherwise nothing is committed
+    size_t header_len = 0;
+    uint8_t *write_ptr = ws_tx_frame_space(ws, len, &header_len);
+    if (__builtin_expect(!write_ptr, 0)) {
+        return -1;  // Not enough space
+    }
 
-    // Set length field with MASK bit (bit 7)
-    if (len <= 125) {
-        frame[1] = 0x80 | (len & 0x7F);  // MASK=1 | length
-        frame_len = 2;
-    } else if (len <= 65535) {
-        frame[1] = 0x80 | 126;  // MASK=1 | 126 (extended payload)
-        frame[2] = (len >> 8) & 0xFF;
-        frame[3] = len & 0xFF;
-        frame_len = 4;
-    } else {
-        frame[1] = 0x80 | 127;  // MASK=1 | 127 (64-bit length)
-        // Write 64-bit length (big-endian)
-        frame[2] = 0; frame[3] = 0; frame[4] = 0; frame[5] = 0;
-        frame[6] = (len >> 24) & 0xFF;
-        frame[7] = (len >> 16) & 0xFF;
-        frame[8] = (len >> 8) & 0xFF;
-        frame[9] = len & 0xFF;
-        frame_len = 10;
-    }
-
-    // Generate unpredictable masking key (RFC 6455 Section 5.3)
-    // Uses fast userspace PRNG seeded with strong entropy
+    // Create WebSocket frame header with masking (RFC 6455 Section 5.1)
+    // Client-to-server frames MUST be masked; key from fast userspace PRNG
     uint32_t mask_word = get_masking_key(ws);
-    uint8_t mask[4];
-    mask[0] = (mask_word >> 0) & 0xFF;
-    mask[1] = (mask_word >> 8) & 0xFF;
-    mask[2] = (mask_word >> 16) & 0xFF;
-    mask[3] = (mask_word >> 24) & 0xFF;
+    ws_write_frame_header(write_ptr, ws_frame_first_byte(opcode, fin), len, mask_word);
 
-    memcpy(frame + frame_len, mask, 4);
-    frame_len += 4;
+    // Apply masking to payload: masked_data[i] = data[i] XOR mask[i & 3]
+    ws_mask_apply(write_ptr + header_len, data, len, mask_word);
+    ringbuffer_commit_write(&ws->tx_buffer, header_len + len);
 
-    // Check for integer overflow in total size calculation
-    size_t total_size;
-    if (__builtin_expect(__builtin_add_overflow(frame_len, len, &total_size), 0)) {
-        // Overflow: message size exceeds SIZE_MAX - invalid length
+    // Optimization #8: Mark that we have pending TX data
+    ws_tx_pending(ws);
+
+    return (int)len;
+}
+
+int ws_send_urgent(websocket_context_t *ws, const uint8_t *data, size_t len, uint8_t opcode) {
+    if (__builtin_expect(!ws || !ws->connected, 0)) return -1;
+    // One complete frame: CONTINUATION would split a message, CLOSE goes through ws_close()
+    if (__builtin_expect(!ws_frame_valid(opcode, 1, len) || opcode == WS_FRAME_CONTINUATION ||
+                         opcode == WS_FRAME_CLOSE, 0)) {
         return -1;
     }
+    if (ws_urgent_queue(ws, opcode, data, len, WS_URGENT_CONTROL_ROOM) < 0) return -1;  // Lane full
+    return (int)len;
+}
 
-    // Zero-copy write: get direct pointer and write in one shot
-    uint8_t *write_ptr = NULL;
-    size_t available = 0;
+uint8_t *ws_send_reserve(websocket_context_t *ws, size_t max_len) {
+    if (__builtin_expect(!ws || !ws->connected || ws->tx_reserved, 0)) return NULL;
 
-    ringbuffer_get_write_ptr(&ws->tx_buffer, &write_ptr, &available);
+    // Header room is sized for max_len; commit moves the payload down if it needs less
+    size_t header_len = 0;
+    uint8_t *write_ptr = ws_tx_frame_space(ws, max_len, &header_len);
+    if (__builtin_expect(!write_ptr, 0)) {
+        return NULL;
+    }
 
-    // Unlikely: ringbuffer should have sufficient contiguous space
-    if (__builtin_expect(available < total_size, 0)) {
-        // Not enough contiguous space - need to handle wraparound or partial writes
-        // For simplicity, write in two parts if needed
-        // Likely: at least have space for frame header
-        if (__builtin_expect(available >= frame_len, 1)) {
-            // Write frame header (includes masking key)
-            memcpy(write_ptr, frame, frame_len);
-            ringbuffer_commit_write(&ws->tx_buffer, frame_len);
-
-            // Write masked payload
-            ringbuffer_get_write_ptr(&ws->tx_buffer, &write_ptr, &available);
-            // Unlikely: should have space for payload after wraparound
-            if (__builtin_expect(available < len, 0)) {
-                return -1;  // Not enough space for payload
-            }
-            // Apply masking: masked_data[i] = data[i] XOR mask[i & 3]
-            // Use bitwise AND instead of modulo for performance (i % 4 == i & 3)
-            for (size_t i = 0; i < len; i++) {
-                write_ptr[i] = data[i] ^ mask[i & 3];
-            }
-            ringbuffer_commit_write(&ws->tx_buffer, len);
-        } else {
-            return -1;  // Not enough space
-        }
-    } else {
-        // Likely: enough contiguous space - write both frame and data in one go
-        memcpy(write_ptr, frame, frame_len);
-        // Apply masking to payload: masked_data[i] = data[i] XOR mask[i & 3]
-        // Use bitwise AND instead of modulo for performance (i % 4 == i & 3)
-        for (size_t i = 0; i < len; i++) {
-            write_ptr[frame_len + i] = data[i] ^ mask[i & 3];
-        }
-        ringbuffer_commit_write(&ws->tx_buffer, total_size);
+    ws->tx_reserved = 1;
+    ws->tx_reserve_header_len = (uint8_t)header_len;
+    ws->tx_reserve_ptr = write_ptr;
+    ws->tx_reserve_len = max_len;
+
+    return write_ptr + header_len;
+}
+
+int ws_send_commit(websocket_context_t *ws, size_t len) {
+    return ws_send_commit_ex(ws, len, WS_FRAME_TEXT, 1);
+}
+
+int ws_send_commit_ex(websocket_context_t *ws, size_t len, uint8_t opcode, int fin) {
+    if (__builtin_expect(!ws || !ws->tx_reserved, 0)) return -1;
+
+    if (__builtin_expect(len > ws->tx_reserve_len || !ws_frame_valid(opcode, fin, len), 0)) {
+        ws->tx_reserved = 0;  // Caller overran the reservation or bad frame - drop it
+        return -1;
     }
 
-    // Optimization #8: Mark that we have pending TX data
-    ws->has_pending_tx = 1;
+    ws->tx_reserved = 0;
+    if (__builtin_expect(!ws->connected, 0)) return -1;
 
-    // Auto-register WRITE event if notifier is set (Option 3)
-    if (ws->notifier) {
-        int fd = ws_get_fd(ws);
-        if (fd >= 0) {
-            // Register both READ and WRITE events
-            ws_notifier_mod(ws->notifier, fd, WS_EVENT_READ | WS_EVENT_WRITE);
+    uint8_t *frame = ws->tx_reserve_ptr;
+    uint8_t *payload = frame + ws->tx_reserve_header_len;
+    size_t header_len = ws_frame_header_len(len);
+    uint32_t mask_word = get_masking_key(ws);
+
+    // Mask in place, or mask while sliding down when the final header is shorter
+    // (forward overlap with dst < src is safe for ws_mask_apply)
+    ws_mask_apply(frame + header_len, payload, len, mask_word);
+    ws_write_frame_header(frame, ws_frame_first_byte(opcode, fin), len, mask_word);
+    ringbuffer_commit_write(&ws->tx_buffer, header_len + len);
+
+    ws_tx_pending(ws);
+
+    return (int)len;
+}
+
+void ws_send_cancel(websocket_context_t *ws) {
+    if (!ws) return;
+    ws->tx_reserved = 0;
+}
+
+int ws_sendv(websocket_context_t *ws, const struct iovec *iov, int iovcnt) {
+    return ws_sendv_ex(ws, iov, iovcnt, WS_FRAME_TEXT, 1);
+}
+
+int ws_sendv_ex(websocket_context_t *ws, const struct iovec *iov, int iovcnt, uint8_t opcode, int fin) {
+    if (__builtin_expect(!ws || !ws->connected || ws->tx_reserved || iovcnt < 0, 0)) return -1;
+    if (__builtin_expect(iovcnt > 0 && !iov, 0)) return -1;
+
+    size_t len = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (__builtin_expect(__builtin_add_overflow(len, iov[i].iov_len, &len), 0)) {
+            return -1;
         }
     }
 
-    return len;
+    if (__builtin_expect(!ws_frame_valid(opcode, fin, len), 0)) return -1;
+
+    size_t header_len = 0;
+    uint8_t *write_ptr = ws_tx_frame_space(ws, len, &header_len);
+    if (__builtin_expect(!write_ptr, 0)) {
+        return -1;
+    }
+
+    uint32_t mask_word = get_masking_key(ws);
+    ws_write_frame_header(write_ptr, ws_frame_first_byte(opcode, fin), len, mask_word);
+
+    // Gather and mask each segment; key phase continues across segment boundaries
+    size_t offset = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        ws_mask_apply(write_ptr + header_len + offset, (const uint8_t *)iov[i].iov_base,
+                      iov[i].iov_len, ws_mask_rotate(mask_word, offset));
+        offset += iov[i].iov_len;
+    }
+    ringbuffer_commit_write(&ws->tx_buffer, header_len + len);
+
+    ws_tx_pending(ws);
+
+    return (int)len;
 }
 
 // Connect websocket context to event loop notifier for automatic WRITE event management
 void ws_set_notifier(websocket_context_t *ws, ws_notifier_t *notifier) {
     if (!ws) return;
+    if (ws->notifier != notifier) ws_ring_io_stop(ws);
     ws->notifier = notifier;
+    ws_ring_io_start(ws);
+    ws_heartbeat_arm(ws);  // Deadline moves into (or out of) the notifier's wheel
+}
+
+int ws_set_heartbeat(websocket_context_t *ws, uint32_t ping_interval_ms, uint32_t stale_timeout_ms) {
+    if (!ws) return -1;
+    ws->ping_cycles = ws_ms_to_cycles(ping_interval_ms);
+    ws->stale_cycles = ws_ms_to_cycles(stale_timeout_ms);
+    if (ws->connected) ws_heartbeat_start(ws);
+    return 0;
 }
 
 // Query if TX buffer has pending data (for manual event management)
@@ -1054,89 +2700,52 @@ int ws_wants_write(websocket_context_t *ws) {
 }
 
 // Flush TX buffer immediately without waiting for event loop (Option 3)
+// Sends even while corked (explicit flush)
 // Returns 0 on success, -1 on error
 int ws_flush_tx(websocket_context_t *ws) {
-    if (!ws || !ws->connected) return -1;
+    if (!ws || (!ws->connected && !ws->closed)) return -1;  // Closing: the CLOSE may still be queued
 
     // Only flush if we have pending data
     if (!ws->has_pending_tx) return 0;
 
-    size_t tx_available = ringbuffer_available_read(&ws->tx_buffer);
-    if (tx_available > 0) {
-        uint8_t *read_ptr = NULL;
-        size_t read_len = 0;
-        ringbuffer_next_read(&ws->tx_buffer, &read_ptr, &read_len);
-        if (read_len > 0) {
-            if (read_len > 4096) read_len = 4096;
-            int sent = ssl_send(ws->ssl, read_ptr, read_len);
-            if (sent > 0) {
-                ringbuffer_advance_read(&ws->tx_buffer, sent);
-            } else if (sent < 0) {
-                return -1;  // Error occurred
-            }
-        }
-    }
+    return ws_tx_drain(ws, 1) < 0 ? -1 : 0;
+}
 
-    // Clear flag if TX buffer is now empty
-    if (ringbuffer_available_read(&ws->tx_buffer) == 0) {
-        ws->has_pending_tx = 0;
+void ws_cork(websocket_context_t *ws) {
+    if (!ws) return;
+    ws->tx_corked = 1;
+}
 
-        // Auto-unregister WRITE event if notifier is set (Option 3)
-        if (ws->notifier) {
-            int fd = ws_get_fd(ws);
-            if (fd >= 0) {
-                ws_notifier_mod(ws->notifier, fd, WS_EVENT_READ);
-            }
-        }
-    }
+int ws_uncork(websocket_context_t *ws) {
+    if (!ws) return -1;
+    ws->tx_corked = 0;
+
+    // Everything queued while corked leaves in one pass (one TLS record per SSL_write)
+    if (!ws->has_pending_tx || !ws->connected) return 0;
+    if (ws_tx_drain(ws, 1) < 0) return -1;
 
+    // Remainder (socket full): let the event loop finish it
+    if (ws->has_pending_tx) {
+        ws_tx_arm_write(ws);
+    }
     return 0;
 }
 
+void ws_set_tx_flush_budget(websocket_context_t *ws, size_t max_bytes) {
+    if (!ws) return;
+    ws->tx_flush_budget = max_bytes;
+}
+
 void ws_close(websocket_context_t *ws) {
-    if (!ws || ws->closed) return;
+    if (!ws) return;
+    ws->user_closed = 1;  // Also stops a pending auto-reconnect
+    if (ws->closed) return;
 
-    // Send WebSocket CLOSE frame (RFC 6455 Section 5.5.1)
+    // Send WebSocket CLOSE frame (RFC 6455 Section 5.5.1), status 1000 = Normal Closure
     // This ensures proper closing handshake and avoids exchange penalties
-    uint8_t frame[8];  // 2-byte header + 4-byte mask + 2-byte status code
-    frame[0] = 0x88;   // FIN + CLOSE opcode
-    frame[1] = 0x80 | 2;  // MASK=1, length=2 (status code only)
-
-    // Generate unpredictable 4-byte masking key (RFC 6455 requirement)
-    uint32_t mask_word = get_masking_key(ws);
-    uint8_t mask[4];
-    mask[0] = (mask_word >> 0) & 0xFF;
-    mask[1] = (mask_word >> 8) & 0xFF;
-    mask[2] = (mask_word >> 16) & 0xFF;
-    mask[3] = (mask_word >> 24) & 0xFF;
-
-    memcpy(frame + 2, mask, 4);
-
-    // Status code 1000 = Normal Closure (big-endian), then apply mask
-    uint8_t status_bytes[2];
-    status_bytes[0] = (1000 >> 8) & 0xFF;
-    status_bytes[1] = 1000 & 0xFF;
-    frame[6] = status_bytes[0] ^ mask[0];
-    frame[7] = status_bytes[1] ^ mask[1];
-
-    // Write to TX buffer (best-effort, silent drop if full)
-    uint8_t *write_ptr = NULL;
-    size_t available = 0;
-    ringbuffer_get_write_ptr(&ws->tx_buffer, &write_ptr, &available);
-
-    if (available >= sizeof(frame)) {
-        memcpy(write_ptr, frame, sizeof(frame));
-        ringbuffer_commit_write(&ws->tx_buffer, sizeof(frame));
-        ws->has_pending_tx = 1;
-
-        // Auto-register WRITE event if notifier is set
-        if (ws->notifier) {
-            int fd = ws_get_fd(ws);
-            if (fd >= 0) {
-                ws_notifier_mod(ws->notifier, fd, WS_EVENT_READ | WS_EVENT_WRITE);
-            }
-        }
-    }
+    // Urgent lane: ws_update()/ws_flush_tx() still send it after the frame on the wire
+    static const uint8_t status[2] = { 1000 >> 8, 1000 & 0xFF };
+    if (ws->connected) ws_urgent_queue(ws, WS_FRAME_CLOSE, status, sizeof(status), 0);
 
     ws->connected = 0;
     ws->closed = 1;
@@ -1146,7 +2755,9 @@ void ws_close(websocket_context_t *ws) {
 
 ws_state_t ws_get_state(websocket_context_t *ws) {
     if (!ws) return WS_STATE_ERROR;
-    if (ws->closed) return WS_STATE_CLOSED;
+    if (ws->closed) {
+        return ws->auto_reconnect && !ws->user_closed && !ws->replay ? WS_STATE_CONNECTING : WS_STATE_CLOSED;
+    }
     if (!ws->connected) return WS_STATE_CONNECTING;
     return WS_STATE_CONNECTED;
 }
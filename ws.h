@@ -4,9 +4,13 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <sys/time.h>
+#include <sys/uio.h>
+#include "ws_stats.h"
 
 typedef struct websocket_context websocket_context_t;
 typedef struct ws_notifier ws_notifier_t;
+typedef struct ringbuffer_pool ringbuffer_pool_t;
+typedef struct ws_transport ws_transport_t;
 
 // Zero-copy message callback - receives direct memory pointer and length
 typedef void (*ws_on_msg_t)(websocket_context_t *ws, const uint8_t *payload_ptr, size_t payload_len, uint8_t opcode);
@@ -14,6 +18,21 @@ typedef void (*ws_on_msg_t)(websocket_context_t *ws, const uint8_t *payload_ptr,
 // Callback function type for connection status
 typedef void (*ws_on_status_t)(websocket_context_t *ws, int status);
 
+// on_status codes
+#define WS_STATUS_CONNECTED 0    // Upgrade complete (first connection and every reconnect)
+#define WS_STATUS_ERROR    -1    // Connect failed or connection lost
+#define WS_STATUS_STALE     1    // No data message for stale_timeout_ms, connection still up
+
+// WebSocket frame opcodes (RFC 6455 Section 5.2)
+typedef enum {
+    WS_FRAME_CONTINUATION = 0x0,
+    WS_FRAME_TEXT = 0x1,
+    WS_FRAME_BINARY = 0x2,
+    WS_FRAME_CLOSE = 0x8,
+    WS_FRAME_PING = 0x9,
+    WS_FRAME_PONG = 0xA
+} ws_frame_opcode_t;
+
 typedef enum {
     WS_STATE_CONNECTING,
     WS_STATE_HANDSHAKING,
@@ -22,9 +41,79 @@ typedef enum {
     WS_STATE_CLOSED
 } ws_state_t;
 
-// Initialize WebSocket context
+// Initialize WebSocket context (8 MB mirrored RX and TX rings)
 websocket_context_t *ws_init(const char *url);
 
+// Ring memory preparation (ws_options_t.ring_mem_flags), same values as RINGBUFFER_MEM_*
+#define WS_RING_NUMA_BIND 0x1   // Bind ring pages to ws_options_t.numa_node (Linux mbind)
+#define WS_RING_PREFAULT  0x2   // Touch every page at init instead of faulting on the hot path
+#define WS_RING_MLOCK     0x4   // mlock the rings (needs RLIMIT_MEMLOCK / CAP_IPC_LOCK)
+
+// Frame parser profiles: the frame shape a feed mostly carries gets a parse stage whose
+// header decode accepts it in one or two compares (FIN + TEXT/BINARY, no RSV bits, the
+// profile's length encoding). Every other frame falls through to the generic decoder, so a
+// profile changes speed only, never which frames are accepted.
+typedef enum {
+    WS_PARSER_GENERIC = 0,      // No assumption
+    WS_PARSER_SMALL,            // Payloads <= 125 bytes, 7-bit length (trades, tickers)
+    WS_PARSER_MEDIUM,           // 126..65535 bytes, 16-bit length (depth updates)
+    WS_PARSER_LARGE,            // Above 64 KB, 64-bit length (snapshots)
+    WS_PARSER_PROFILES
+} ws_parser_profile_t;
+
+// Build-time default for contexts that do not pick one (make PARSER_PROFILE=small|medium|large)
+#ifndef WS_DEFAULT_PARSER_PROFILE
+#define WS_DEFAULT_PARSER_PROFILE WS_PARSER_GENERIC
+#endif
+
+// Receive scheduling: how reads and parsing interleave inside ws_update()
+typedef enum {
+    WS_RX_THROUGHPUT = 0,       // Read everything the transport has buffered, then parse the batch
+    WS_RX_LATENCY               // Parse and dispatch after every read of at most rx_read_budget bytes:
+                                // the first frame of a burst is delivered before later TLS records
+                                // are decrypted, and the stage timestamps are taken per read
+} ws_rx_mode_t;
+
+#define WS_RX_READ_BUDGET 16384 // Default latency-mode read size: one TLS record of plaintext
+
+// Per-context options for ws_init_ex() (zero-initialize, then set what differs)
+typedef struct {
+    size_t rx_ring_size;        // RX ring bytes, 0 = RINGBUFFER_SIZE; rounded up to a power of two
+                                // Bounds the largest frame (and in-place fragmented message)
+    size_t tx_ring_size;        // TX ring bytes, 0 = RINGBUFFER_SIZE
+    int lazy_tx;                // 1 = allocate the TX ring on the first queued frame (receive-only feeds)
+    ringbuffer_pool_t *pool;    // Carve rings from a shared pre-faulted pool (ringbuffer_pool_create),
+                                // NULL = standalone mappings; the pool must outlive the context
+    int ring_mem_flags;         // WS_RING_* applied to both rings (lazy TX: when it is created)
+    int numa_node;              // Node for WS_RING_NUMA_BIND, -1 = node of the calling thread's CPU
+                                // (pin with os_set_thread_affinity() before ws_init_ex())
+    int async_connect;          // 1 = return before connecting: DNS (ws_resolver.h cache), TCP with Happy
+                                // Eyeballs across IPv4/IPv6, TLS and the upgrade all run non-blocking from
+                                // ws_update(), so many connections establish in parallel on one thread
+    int auto_reconnect;         // 1 = a dropped connection reconnects by itself (see ws_reconnect())
+    uint32_t reconnect_base_ms; // First reconnect backoff, 0 = 100 ms; doubles per failed attempt
+    uint32_t reconnect_max_ms;  // Backoff cap, 0 = 10 s
+    uint32_t ping_interval_ms;  // Heartbeat PING period, 0 = off (see ws_set_heartbeat())
+    uint32_t stale_timeout_ms;  // Report WS_STATUS_STALE after this long without data, 0 = off
+    ws_parser_profile_t parser_profile; // WS_PARSER_GENERIC = WS_DEFAULT_PARSER_PROFILE
+    ws_rx_mode_t rx_mode;       // WS_RX_THROUGHPUT by default (see ws_set_rx_mode())
+    size_t rx_read_budget;      // Latency mode: bytes per read, 0 = WS_RX_READ_BUDGET
+    const ws_transport_t *transport; // NULL = by scheme: TLS for wss://, plain TCP for ws:// (ws_transport.h);
+                                // set to plug in another backend (e.g. kernel-bypass sockets)
+} ws_options_t;
+
+// Initialize WebSocket context with explicit ring sizing; opts = NULL behaves like ws_init()
+websocket_context_t *ws_init_ex(const char *url, const ws_options_t *opts);
+
+// Offline replay: a context fed from a capture file instead of a TLS connection
+// path: raw RX stream (tools/ws_trace_dump --raw) or a ws_set_trace() file with stream capture
+// speed: 0 = as fast as possible, 1.0 = original timing (trace files only), 2.0 = twice as fast
+// The context starts CONNECTED; each ws_update() feeds the next receive batch through the
+// normal parser and on_msg, frames sent are discarded, and the state turns CLOSED at the end.
+// For captures of compressed connections call ws_set_permessage_deflate(ws, 1, flags) first.
+// Returns NULL if the capture cannot be loaded
+websocket_context_t *ws_init_replay(const char *path, double speed);
+
 // Free WebSocket context
 void ws_free(websocket_context_t *ws);
 
@@ -34,18 +123,93 @@ void ws_set_on_msg(websocket_context_t *ws, ws_on_msg_t callback);
 // Set status callback
 void ws_set_on_status(websocket_context_t *ws, ws_on_status_t callback);
 
+// Opaque application pointer carried by the context (NULL by default), e.g. for callbacks
+void ws_set_user_data(websocket_context_t *ws, void *user_data);
+void *ws_get_user_data(websocket_context_t *ws);
+
+// permessage-deflate (RFC 7692) request flags
+#define WS_DEFLATE_SERVER_NO_CONTEXT_TAKEOVER 0x1  // Ask server to reset its window per message
+#define WS_DEFLATE_CLIENT_NO_CONTEXT_TAKEOVER 0x2  // Advertise for servers that insist (we send uncompressed)
+
+// Offer permessage-deflate in the upgrade request (call before the first ws_update())
+// Compressed messages are inflated into a reusable per-connection arena before on_msg;
+// outbound frames are always sent uncompressed
+// Returns 0 on success, -1 if the handshake was already sent or built without zlib
+int ws_set_permessage_deflate(websocket_context_t *ws, int enable, int flags);
+
+// Returns 1 if the server accepted permessage-deflate
+int ws_get_permessage_deflate(websocket_context_t *ws);
+
+// Switch receive scheduling (any time outside on_msg, effective from the next ws_update())
+// read_budget: latency-mode bytes per read, 0 = WS_RX_READ_BUDGET. Replay contexts always parse per batch
+// Returns 0, -1 on an unknown mode
+int ws_set_rx_mode(websocket_context_t *ws, ws_rx_mode_t mode, size_t read_budget);
+
+// Select the parse stage profile (any time outside on_msg, effective from the next batch)
+// Compressed connections always parse with the generic stage: their data frames carry RSV1
+// Returns 0, -1 on an unknown profile
+int ws_set_parser_profile(websocket_context_t *ws, ws_parser_profile_t profile);
+
+// Profile in effect (WS_PARSER_GENERIC while permessage-deflate is active)
+ws_parser_profile_t ws_get_parser_profile(websocket_context_t *ws);
+
 // Update WebSocket (call in event loop)
 int ws_update(websocket_context_t *ws);
 
-// Send message
+// Send message (single TEXT frame)
 int ws_send(websocket_context_t *ws, const uint8_t *data, size_t len);
 
+// Send one frame with explicit opcode (ws_frame_opcode_t) and FIN flag
+// fin = 0 starts/continues a fragmented message (follow-ups use WS_FRAME_CONTINUATION)
+// Control frames must have fin = 1 and len <= 125
+// Returns bytes queued, -1 on error
+int ws_send_ex(websocket_context_t *ws, const uint8_t *data, size_t len, uint8_t opcode, int fin);
+
+// Urgent lane: a fixed WS_TX_URGENT_LANE bytes per context, allocated with it, that is sent
+// ahead of the TX ring at its next frame boundary (a frame already on the wire is finished first).
+// PONGs, the CLOSE and heartbeat PINGs always take it, so they neither queue behind a burst nor
+// get dropped because the TX ring is full; it is flushed by ws_update() even while corked.
+#define WS_TX_URGENT_LANE 4096
+
+// Queue one complete frame on the urgent lane (e.g. a cancel ahead of queued new orders)
+// Data frames keep their order among urgent frames and wait for a fragmented message already
+// on the wire to finish. 256 bytes of the lane are kept for PONGs and the CLOSE
+// Returns bytes queued, -1 if not connected, on CONTINUATION/CLOSE or an invalid frame, or
+// when the lane is full
+int ws_send_urgent(websocket_context_t *ws, const uint8_t *data, size_t len, uint8_t opcode);
+
+// Zero-copy send: serialize the payload directly into the TX ring
+// ws_send_reserve() returns a writable pointer for up to max_len payload bytes (NULL if no space)
+// ws_send_commit() writes the header for the final len (<= max_len), masks in place and queues the frame
+// Only one reservation may be outstanding; other sends fail and control frames are dropped until
+// it is committed or cancelled, so don't call ws_update() in between
+// Returns bytes committed, -1 on error (reservation is released either way)
+uint8_t *ws_send_reserve(websocket_context_t *ws, size_t max_len);
+int ws_send_commit(websocket_context_t *ws, size_t len);
+int ws_send_commit_ex(websocket_context_t *ws, size_t len, uint8_t opcode, int fin);
+void ws_send_cancel(websocket_context_t *ws);
+
+// Send one frame gathered from iovcnt segments (e.g. prefix + body) without joining them first
+// Returns total payload bytes queued, -1 on error
+int ws_sendv(websocket_context_t *ws, const struct iovec *iov, int iovcnt);
+int ws_sendv_ex(websocket_context_t *ws, const struct iovec *iov, int iovcnt, uint8_t opcode, int fin);
+
 // Close connection
 void ws_close(websocket_context_t *ws);
 
 // Get connection state
+// With auto_reconnect a dropped connection reports CONNECTING until it is back (CLOSED only after ws_close())
 ws_state_t ws_get_state(websocket_context_t *ws);
 
+// Drop the current connection (if any) and connect again after a jittered exponential backoff:
+// a random delay in [d/2, d] with d = reconnect_base_ms << failed attempts, capped at reconnect_max_ms,
+// so a venue-wide disconnect does not turn into a synchronized reconnect storm
+// The new attempt is always non-blocking (async_connect) and driven by ws_update(); unsent frames and
+// partial messages are discarded, on_status(ws, 0) fires again once upgraded. The old fd is removed from
+// the bound notifier (ws_set_notifier is cleared): register ws_get_fd() again from on_status
+// Returns 0, -1 for replay contexts
+int ws_reconnect(websocket_context_t *ws);
+
 // Granular timestamp collection (6 stages for detailed latency breakdown)
 // All timestamps use TSC cycles (os_get_cpu_cycle) except hw_timestamp which uses nanoseconds
 //
@@ -57,11 +221,14 @@ ws_state_t ws_get_state(websocket_context_t *ws);
 //   5. Frame parsed (cycles)      - WebSocket frame parsing complete
 //   6. Callback invoked           - Application on_msg callback called
 //
-// Use os_cycles_to_ns() to convert cycle timestamps to nanoseconds
+// Use os_cycles_to_ns() to convert cycle timestamps to nanoseconds, and
+// os_cycles_to_realtime_ns() to place them on the wall clock next to the NIC timestamp
+// (CLOCK_REALTIME domain; the NIC's PTP clock once phc2sys syncs it, see setup_ptp_sync.sh)
 
 // Stage 1: Get hardware NIC timestamp (Linux only, returns 0 if not available)
 // Timestamp in nanoseconds from hardware network card
-// Use this to measure true NIC-to-application latency
+// Use this to measure true NIC-to-application latency:
+//   os_cycles_to_realtime_ns(ws_get_event_timestamp(ws)) - ws_get_hw_timestamp(ws)
 uint64_t ws_get_hw_timestamp(websocket_context_t *ws);
 
 // Stage 2: Get timestamp when event loop received data (epoll_wait returns)
@@ -89,28 +256,159 @@ int ws_get_fd(websocket_context_t *ws);
 
 // Connect websocket context to event loop notifier for automatic WRITE event management
 // When set, ws_send() will auto-register WRITE events and ws_update() will auto-unregister when TX buffer drains
+// Register the fd with the context as user data so batched waits hand back the context directly:
+//   ws_notifier_add(notifier, ws_get_fd(ws), WS_EVENT_READ, ws);
 void ws_set_notifier(websocket_context_t *ws, ws_notifier_t *notifier);
 
+// Heartbeat: client PING every ping_interval_ms, on_status(ws, WS_STATUS_STALE) when no data
+// message arrived for stale_timeout_ms (0 = off; same as the ws_options_t fields). With
+// auto_reconnect a stale connection is also reconnected. Time comes from the TSC readings
+// ws_update() takes anyway: bound to a notifier (ws_set_notifier), the deadline sits in the
+// notifier's shared timing wheel and fires from the wait even when the socket is idle;
+// unbound, it is checked by every ws_update() call. PONGs echoing our PING feed stats.ping_rtt
+// Returns 0, -1 on error
+int ws_set_heartbeat(websocket_context_t *ws, uint32_t ping_interval_ms, uint32_t stale_timeout_ms);
+
 // Query if TX buffer has pending data (for manual event management)
 // Returns 1 if there is pending TX data, 0 otherwise
 int ws_wants_write(websocket_context_t *ws);
 
-// Flush TX buffer immediately without waiting for event loop
+// Flush TX buffer immediately without waiting for event loop (also while corked)
+// Drains the urgent lane, then the whole ring or up to the flush budget, in one pass.
+// After ws_close() or a server CLOSE it still sends the CLOSE; ring frames not yet started
+// are dropped then, so the CLOSE is the last frame on the wire
 // Returns 0 on success, -1 on error
 int ws_flush_tx(websocket_context_t *ws);
 
-// Get SSL cipher name (returns NULL if not connected)
+// Cork: queue frames without flushing (ws_update() skips TX, WRITE event not armed)
+// Uncork: flush everything queued in one pass so a burst shares TLS records/syscalls
+// ws_uncork returns 0 on success, -1 on error
+void ws_cork(websocket_context_t *ws);
+int ws_uncork(websocket_context_t *ws);
+
+// Limit bytes sent per flush pass in ws_update()/ws_flush_tx() (0 = drain everything, default)
+// Bounds time spent in TX before the next RX poll under heavy bursts
+void ws_set_tx_flush_budget(websocket_context_t *ws, size_t max_bytes);
+
+// Get SSL cipher name (returns NULL if not connected or on a ws:// connection)
 const char* ws_get_cipher_name(websocket_context_t *ws);
 
-// Get TLS processing mode (returns "kTLS (Kernel)" or "OpenSSL (Userspace)")
+// Returns 1 if the TLS handshake resumed a cached session (reconnects to the same host:port)
+int ws_get_session_reused(websocket_context_t *ws);
+
+// Get TLS processing mode (returns "kTLS (Kernel)", "OpenSSL (Userspace)" or, for ws://,
+// "None (Plain TCP)")
 const char* ws_get_tls_mode(websocket_context_t *ws);
 
+// Always-on statistics: frame/byte counters and per-stage latency histograms (see ws_stats.h)
+// Unlike the timestamp getters above, nothing is overwritten between batches
+// The pointer stays valid until ws_free(); a monitoring thread reads it lock-free:
+//   ws_stats_t now, delta;
+//   ws_stats_snapshot(ws_get_stats(ws), &now);
+//   ws_stats_delta(&now, &last_minute, &delta);
+//   p999_ns = os_cycles_to_ns(ws_hist_percentile(&delta.stages[WS_STAT_DISPATCH], 99.9));
+const ws_stats_t *ws_get_stats(websocket_context_t *ws);
+
+// Opt-in binary trace (see ws_trace.h): each received frame appends a 64-byte record
+// (stage timestamps, length, opcode, payload prefix) to an mmap'ed file ring at path
+// records: ring capacity, rounded up to a power of two (oldest records are overwritten)
+// stream_bytes: also capture the raw decrypted RX stream for exact replay (0 = off)
+// path = NULL stops tracing. Decode with tools/ws_trace_dump
+// Returns 0 on success, -1 if the file cannot be created or mapped
+int ws_set_trace(websocket_context_t *ws, const char *path, size_t records, size_t stream_bytes);
+
+// Pipeline mode: ws_update() (IO thread) keeps draining the socket and parsing, while
+// on_msg runs on a consumer thread calling ws_pipeline_poll(). Each message crosses as a
+// 64-byte descriptor through a lock-free SPSC queue; payloads stay zero-copy in the RX
+// ring, whose space is released only once the consumer has processed them.
+typedef struct {
+    const uint8_t *payload;      // Points into the RX ring, valid until on_msg returns
+    size_t len;
+    size_t release_off;          // RX ring position released after this message (internal)
+    uint8_t opcode;
+    uint64_t hw_timestamp_ns;    // Stage 1 (0 if unavailable)
+    uint64_t recv_end_cycle;     // Stage 4 of the batch that carried the message
+    uint64_t parsed_cycle;       // Stage 5: frame decoded on the IO thread
+    uint64_t enqueue_cycle;      // Descriptor published to the consumer
+} ws_msg_desc_t;
+
+// Enable with a queue of queue_depth descriptors (power of two), 0 = disable (queue must be empty)
+// Call on the IO thread before the consumer starts. Requires a mirrored RX ring and no
+// permessage-deflate (the inflate arena is reused per message). Sends stay on the IO thread.
+// When the queue is full parsing pauses (stats.pipeline_full) and resumes on a later
+// ws_update(), so keep calling it while ws_pipeline_backlog() > 0 even without socket events.
+// Control frames arriving inside a fragmented message are answered but not forwarded.
+// Returns 0 on success, -1 if the requirements are not met
+int ws_set_pipeline(websocket_context_t *ws, size_t queue_depth);
+
+// Consumer thread: run on_msg for up to max_msgs queued messages (0 = all), then release
+// their ring space. Returns messages delivered, -1 if pipeline mode is off
+int ws_pipeline_poll(websocket_context_t *ws, int max_msgs);
+
+// Inside on_msg on the consumer thread: descriptor of the current message (timestamps)
+const ws_msg_desc_t *ws_pipeline_current(websocket_context_t *ws);
+
+// Messages published but not yet consumed
+size_t ws_pipeline_backlog(websocket_context_t *ws);
+
+// Pull mode: ws_poll_frames() drives the connection like ws_update(), but instead of one
+// on_msg call per message it fills the caller's array with every complete message parsed
+// (up to max), so a burst can be processed in one loop, prefetched or handed to another
+// core. Payloads stay zero-copy in the RX ring, whose space is held until
+// ws_release_frames(): pointers stay valid across further polls, and the ring fills up if
+// nothing is released. Same requirements as pipeline mode (mirrored RX ring, no
+// permessage-deflate); the first call switches the context over for good, ws_update()
+// alone then parses nothing. Control frames are included (PINGs are still answered),
+// except those arriving inside a fragmented message.
+typedef struct {
+    const uint8_t *payload;      // Points into the RX ring, valid until ws_release_frames()
+    size_t len;
+    uint64_t parsed_cycle;       // Stage 5 of the batch that decoded it
+    uint8_t opcode;
+} ws_frame_t;
+
+// Returns messages stored in out (0..max), -1 on error, on a closed connection with nothing
+// left to return, or when the requirements are not met
+int ws_poll_frames(websocket_context_t *ws, ws_frame_t *out, size_t max);
+
+// Release the ring space of every message returned so far
+// Returns 0, -1 if the context is not in pull mode
+int ws_release_frames(websocket_context_t *ws);
+
 // Get ringbuffer status information
 int ws_get_rx_buffer_is_mirrored(websocket_context_t *ws);
 int ws_get_rx_buffer_is_mmap(websocket_context_t *ws);
 int ws_get_tx_buffer_is_mirrored(websocket_context_t *ws);
 int ws_get_tx_buffer_is_mmap(websocket_context_t *ws);
 
+// WS_RING_* steps that actually succeeded for each ring (0 if none requested or all failed)
+int ws_get_rx_buffer_mem_status(websocket_context_t *ws);
+int ws_get_tx_buffer_mem_status(websocket_context_t *ws);
+
+// Cold-start warm-up, timed per step in CLOCK_MONOTONIC nanoseconds
+typedef struct {
+    uint64_t total_ns;
+    uint64_t clock_ns;           // TSC calibration (os_get_cpu_cycle's first call sleeps for it)
+    uint64_t mask_ns;            // Mask kernel selection and a pass over every length class
+    uint64_t transport_ns;       // Transport library setup (TLS: OpenSSL and the shared SSL_CTX)
+    uint64_t rings_ns;           // PRNG seed and ring pre-faulting (ws_prewarm only)
+    uint64_t parser_ns;          // Synthetic frames through the parse stage
+    uint64_t frames;             // Synthetic frames parsed
+} ws_prewarm_report_t;
+
+// Pay the one-time costs of the first message at startup instead: calibrate the cycle clock,
+// select and run the mask kernels, initialize TLS, and parse a few thousand synthetic frames of
+// every shape (PING, fragmented, 64-bit length) with the default parser profile.
+// Process-wide, safe to call more than once. out may be NULL
+// Returns 0, -1 if a step failed (the others still ran)
+int ws_library_prewarm(ws_prewarm_report_t *out);
+
+// ws_library_prewarm() for one context before it carries traffic: also seeds its masking PRNG,
+// pre-faults its rings while they are empty and warms the parse stage of its own profile.
+// on_msg, the stats and the rings' contents are not touched. out may be NULL
+// Returns 0, -1 if a step failed
+int ws_prewarm(websocket_context_t *ws, ws_prewarm_report_t *out);
+
 // Include OS utilities for CPU affinity and real-time priority
 // Use os_* functions directly for thread configuration
 #include "os.h"
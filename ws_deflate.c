@@ -0,0 +1,173 @@
+#include "ws_deflate.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WS_HAVE_ZLIB
+#include <zlib.h>
+
+struct ws_inflater {
+    z_stream zs;
+    uint8_t *arena;
+    size_t arena_cap;
+    int no_context_takeover;
+};
+
+// RFC 7692 Section 7.2.2: sender strips the trailing empty stored block
+static const uint8_t DEFLATE_TAIL[4] = {0x00, 0x00, 0xFF, 0xFF};
+
+ws_inflater_t *ws_inflater_create(size_t initial_cap, int no_context_takeover) {
+    ws_inflater_t *inf = (ws_inflater_t *)calloc(1, sizeof(ws_inflater_t));
+    if (!inf) return NULL;
+
+    // Raw deflate (negative window bits); 15 accepts any server_max_window_bits
+    if (inflateInit2(&inf->zs, -15) != Z_OK) {
+        free(inf);
+        return NULL;
+    }
+
+    if (initial_cap < 4096) initial_cap = 4096;
+    inf->arena = (uint8_t *)malloc(initial_cap);
+    if (!inf->arena) {
+        inflateEnd(&inf->zs);
+        free(inf);
+        return NULL;
+    }
+    inf->arena_cap = initial_cap;
+    inf->no_context_takeover = no_context_takeover;
+
+    return inf;
+}
+
+void ws_inflater_free(ws_inflater_t *inf) {
+    if (!inf) return;
+    inflateEnd(&inf->zs);
+    free(inf->arena);
+    free(inf);
+}
+
+// Double the arena (bounded by WS_INFLATE_MAX_MESSAGE), keeping inflated bytes
+static int inflater_grow(ws_inflater_t *inf) {
+    if (inf->arena_cap >= WS_INFLATE_MAX_MESSAGE) return -1;
+
+    size_t new_cap = inf->arena_cap * 2;
+    if (new_cap > WS_INFLATE_MAX_MESSAGE) new_cap = WS_INFLATE_MAX_MESSAGE;
+
+    uint8_t *grown = (uint8_t *)realloc(inf->arena, new_cap);
+    if (!grown) return -1;
+    inf->arena = grown;
+    inf->arena_cap = new_cap;
+    return 0;
+}
+
+// Feed one input chunk, growing the arena whenever output space runs out
+// Returns 0, 1 if the message ended with a BFINAL block (rest of the input ignored), -1 on error
+static int inflater_feed(ws_inflater_t *inf, const uint8_t *in, size_t in_len, size_t *produced) {
+    inf->zs.next_in = (Bytef *)in;
+
+    while (in_len > 0 || inf->zs.avail_in > 0) {
+        // zlib counts in uInt - feed very large inputs in pieces
+        if (inf->zs.avail_in == 0) {
+            uInt chunk = in_len > 0x40000000u ? 0x40000000u : (uInt)in_len;
+            inf->zs.avail_in = chunk;
+            in_len -= chunk;
+        }
+
+        if (*produced == inf->arena_cap && inflater_grow(inf) < 0) {
+            return -1;
+        }
+        size_t space = inf->arena_cap - *produced;
+        inf->zs.next_out = inf->arena + *produced;
+        inf->zs.avail_out = space > 0x40000000u ? 0x40000000u : (uInt)space;
+        uInt before = inf->zs.avail_out;
+
+        int ret = inflate(&inf->zs, Z_SYNC_FLUSH);
+        *produced += before - inf->zs.avail_out;
+
+        if (ret == Z_STREAM_END) {
+            return 1;  // RFC 7692 Section 7.2.3.4: BFINAL=1 block, all output flushed
+        }
+        if (ret == Z_BUF_ERROR && inf->zs.avail_out > 0) {
+            break;  // No progress possible: input consumed
+        }
+        if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            return -1;  // Corrupt input
+        }
+    }
+
+    return 0;
+}
+
+const uint8_t *ws_inflater_message(ws_inflater_t *inf, const uint8_t *in, size_t in_len, size_t *out_len) {
+    if (!inf || !out_len) return NULL;
+
+    size_t produced = 0;
+    int ended = inflater_feed(inf, in, in_len, &produced);
+    if (ended == 0) ended = inflater_feed(inf, DEFLATE_TAIL, sizeof(DEFLATE_TAIL), &produced);
+    if (ended < 0) {
+        inflateReset(&inf->zs);
+        return NULL;
+    }
+
+    // Final block: the stream is over, the next message starts a new one
+    if (ended) {
+        inflateReset(&inf->zs);
+        *out_len = produced;
+        return inf->arena;
+    }
+
+    // Output may still be pending in zlib's window if the arena filled exactly
+    while (inf->zs.avail_out == 0) {
+        if (inflater_grow(inf) < 0) {
+            inflateReset(&inf->zs);
+            return NULL;
+        }
+        inf->zs.next_out = inf->arena + produced;
+        inf->zs.avail_out = (uInt)(inf->arena_cap - produced);
+        uInt before = inf->zs.avail_out;
+        int ret = inflate(&inf->zs, Z_SYNC_FLUSH);
+        produced += before - inf->zs.avail_out;
+        if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            inflateReset(&inf->zs);
+            return NULL;
+        }
+    }
+
+    // server_no_context_takeover: next message starts with an empty window
+    if (inf->no_context_takeover) {
+        inflateReset(&inf->zs);
+    }
+
+    *out_len = produced;
+    return inf->arena;
+}
+
+size_t ws_inflater_arena_size(const ws_inflater_t *inf) {
+    return inf ? inf->arena_cap : 0;
+}
+
+#else  // !WS_HAVE_ZLIB
+
+ws_inflater_t *ws_inflater_create(size_t initial_cap, int no_context_takeover) {
+    (void)initial_cap;
+    (void)no_context_takeover;
+    return NULL;
+}
+
+void ws_inflater_free(ws_inflater_t *inf) {
+    (void)inf;
+}
+
+const uint8_t *ws_inflater_message(ws_inflater_t *inf, const uint8_t *in, size_t in_len, size_t *out_len) {
+    (void)inf;
+    (void)in;
+    (void)in_len;
+    (void)out_len;
+    return NULL;
+}
+
+size_t ws_inflater_arena_size(const ws_inflater_t *inf) {
+    (void)inf;
+    return 0;
+}
+
+#endif // WS_HAVE_ZLIB
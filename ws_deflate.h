@@ -0,0 +1,39 @@
+#ifndef WS_DEFLATE_H
+#define WS_DEFLATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// permessage-deflate (RFC 7692) receive side
+//
+// Inflates complete messages into a per-connection output arena. The arena
+// grows to the largest inflated message seen and is reused afterwards, so
+// steady state has no per-message allocation.
+//
+// Built with zlib when WS_HAVE_ZLIB is defined (make WS_DEFLATE=1, default);
+// otherwise ws_inflater_create() returns NULL.
+
+typedef struct ws_inflater ws_inflater_t;
+
+// Upper bound for one inflated message (guards against decompression bombs)
+#define WS_INFLATE_MAX_MESSAGE (64u * 1024u * 1024u)
+
+// Create inflater with a pre-allocated arena of initial_cap bytes
+// no_context_takeover: 1 if the server resets its LZ77 window after each message
+// Returns NULL if zlib is unavailable or allocation fails
+ws_inflater_t *ws_inflater_create(size_t initial_cap, int no_context_takeover);
+
+// Free inflater and its arena
+void ws_inflater_free(ws_inflater_t *inf);
+
+// Inflate one complete compressed message (all fragments concatenated)
+// The 0x00 0x00 0xFF 0xFF tail removed by the sender is supplied internally; a message
+// ending with a BFINAL=1 block (RFC 7692 Section 7.2.3.4) is accepted and resets the window
+// Returns pointer into the arena (valid until the next call), NULL on corrupt
+// input or if the result exceeds WS_INFLATE_MAX_MESSAGE
+const uint8_t *ws_inflater_message(ws_inflater_t *inf, const uint8_t *in, size_t in_len, size_t *out_len);
+
+// Current arena capacity (high-water mark of inflated message size)
+size_t ws_inflater_arena_size(const ws_inflater_t *inf);
+
+#endif // WS_DEFLATE_H
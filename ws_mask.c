@@ -0,0 +1,211 @@
+#include "ws_mask.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define WS_MASK_X86 1
+#elif defined(__aarch64__) || defined(__arm64__)
+#include <arm_neon.h>
+#define WS_MASK_NEON 1
+#endif
+
+typedef void (*ws_mask_fn)(uint8_t *dst, const uint8_t *src, size_t len, uint32_t key);
+
+// Byte loop for heads, tails and short payloads
+static inline void mask_bytes(uint8_t *dst, const uint8_t *src, size_t len, uint32_t key) {
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = src[i] ^ (uint8_t)(key >> ((i & 3) * 8));
+    }
+}
+
+// Word pattern in memory byte order (endian-independent)
+static inline uint64_t mask_pattern64(uint32_t key) {
+    uint8_t bytes[8];
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = (uint8_t)(key >> ((i & 3) * 8));
+    }
+    uint64_t pattern;
+    memcpy(&pattern, bytes, sizeof(pattern));
+    return pattern;
+}
+
+void ws_mask_apply_scalar(uint8_t *dst, const uint8_t *src, size_t len, uint32_t key) {
+    uint64_t pattern = mask_pattern64(key);
+    size_t i = 0;
+
+    // 8 bytes per step (memcpy compiles to unaligned loads/stores)
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, src + i, 8);
+        word ^= pattern;
+        memcpy(dst + i, &word, 8);
+    }
+
+    // i is a multiple of 8 here, so the key phase is unchanged
+    mask_bytes(dst + i, src + i, len - i, key);
+}
+
+#ifdef WS_MASK_X86
+// x86 is little-endian: a 32-bit broadcast of key is the byte pattern in memory order
+
+__attribute__((target("sse2")))
+static void mask_sse2(uint8_t *dst, const uint8_t *src, size_t len, uint32_t key) {
+    __m128i pattern = _mm_set1_epi32((int)key);
+    size_t i = 0;
+
+    for (; i + 64 <= len; i += 64) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + i + 16));
+        __m128i c = _mm_loadu_si128((const __m128i *)(src + i + 32));
+        __m128i d = _mm_loadu_si128((const __m128i *)(src + i + 48));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(a, pattern));
+        _mm_storeu_si128((__m128i *)(dst + i + 16), _mm_xor_si128(b, pattern));
+        _mm_storeu_si128((__m128i *)(dst + i + 32), _mm_xor_si128(c, pattern));
+        _mm_storeu_si128((__m128i *)(dst + i + 48), _mm_xor_si128(d, pattern));
+    }
+    for (; i + 16 <= len; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(a, pattern));
+    }
+
+    ws_mask_apply_scalar(dst + i, src + i, len - i, key);
+}
+
+__attribute__((target("avx2")))
+static void mask_avx2(uint8_t *dst, const uint8_t *src, size_t len, uint32_t key) {
+    // Align stores to 32 bytes (split stores cost more than split loads)
+    size_t head = (size_t)(-(uintptr_t)dst & 31);
+    if (head > len) head = len;
+    mask_bytes(dst, src, head, key);
+    dst += head;
+    src += head;
+    len -= head;
+    key = ws_mask_rotate(key, head);
+
+    __m256i pattern = _mm256_set1_epi32((int)key);
+    size_t i = 0;
+
+    for (; i + 128 <= len; i += 128) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(src + i + 32));
+        __m256i c = _mm256_loadu_si256((const __m256i *)(src + i + 64));
+        __m256i d = _mm256_loadu_si256((const __m256i *)(src + i + 96));
+        _mm256_store_si256((__m256i *)(dst + i), _mm256_xor_si256(a, pattern));
+        _mm256_store_si256((__m256i *)(dst + i + 32), _mm256_xor_si256(b, pattern));
+        _mm256_store_si256((__m256i *)(dst + i + 64), _mm256_xor_si256(c, pattern));
+        _mm256_store_si256((__m256i *)(dst + i + 96), _mm256_xor_si256(d, pattern));
+    }
+    for (; i + 32 <= len; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_store_si256((__m256i *)(dst + i), _mm256_xor_si256(a, pattern));
+    }
+
+    ws_mask_apply_scalar(dst + i, src + i, len - i, key);
+}
+
+__attribute__((target("avx512f")))
+static void mask_avx512(uint8_t *dst, const uint8_t *src, size_t len, uint32_t key) {
+    size_t head = (size_t)(-(uintptr_t)dst & 63);
+    if (head > len) head = len;
+    mask_bytes(dst, src, head, key);
+    dst += head;
+    src += head;
+    len -= head;
+    key = ws_mask_rotate(key, head);
+
+    __m512i pattern = _mm512_set1_epi32((int)key);
+    size_t i = 0;
+
+    for (; i + 256 <= len; i += 256) {
+        __m512i a = _mm512_loadu_si512((const void *)(src + i));
+        __m512i b = _mm512_loadu_si512((const void *)(src + i + 64));
+        __m512i c = _mm512_loadu_si512((const void *)(src + i + 128));
+        __m512i d = _mm512_loadu_si512((const void *)(src + i + 192));
+        _mm512_store_si512((void *)(dst + i), _mm512_xor_si512(a, pattern));
+        _mm512_store_si512((void *)(dst + i + 64), _mm512_xor_si512(b, pattern));
+        _mm512_store_si512((void *)(dst + i + 128), _mm512_xor_si512(c, pattern));
+        _mm512_store_si512((void *)(dst + i + 192), _mm512_xor_si512(d, pattern));
+    }
+    for (; i + 64 <= len; i += 64) {
+        __m512i a = _mm512_loadu_si512((const void *)(src + i));
+        _mm512_store_si512((void *)(dst + i), _mm512_xor_si512(a, pattern));
+    }
+
+    ws_mask_apply_scalar(dst + i, src + i, len - i, key);
+}
+#endif // WS_MASK_X86
+
+#ifdef WS_MASK_NEON
+static void mask_neon(uint8_t *dst, const uint8_t *src, size_t len, uint32_t key) {
+    uint8x16_t pattern = vreinterpretq_u8_u64(vdupq_n_u64(mask_pattern64(key)));
+    size_t i = 0;
+
+    for (; i + 64 <= len; i += 64) {
+        uint8x16_t a = vld1q_u8(src + i);
+        uint8x16_t b = vld1q_u8(src + i + 16);
+        uint8x16_t c = vld1q_u8(src + i + 32);
+        uint8x16_t d = vld1q_u8(src + i + 48);
+        vst1q_u8(dst + i, veorq_u8(a, pattern));
+        vst1q_u8(dst + i + 16, veorq_u8(b, pattern));
+        vst1q_u8(dst + i + 32, veorq_u8(c, pattern));
+        vst1q_u8(dst + i + 48, veorq_u8(d, pattern));
+    }
+    for (; i + 16 <= len; i += 16) {
+        vst1q_u8(dst + i, veorq_u8(vld1q_u8(src + i), pattern));
+    }
+
+    ws_mask_apply_scalar(dst + i, src + i, len - i, key);
+}
+#endif // WS_MASK_NEON
+
+static ws_mask_fn g_mask_impl = NULL;
+static const char *g_mask_impl_name = "scalar";
+
+// Pick the widest implementation the CPU supports (first call only)
+// Racing initializers store identical values, so no synchronization is needed
+static ws_mask_fn mask_select(void) {
+    ws_mask_fn fn = ws_mask_apply_scalar;
+    const char *name = "scalar";
+
+#if defined(WS_MASK_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        fn = mask_avx512;
+        name = "avx512";
+    } else if (__builtin_cpu_supports("avx2")) {
+        fn = mask_avx2;
+        name = "avx2";
+    } else if (__builtin_cpu_supports("sse2")) {
+        fn = mask_sse2;
+        name = "sse2";
+    }
+#elif defined(WS_MASK_NEON)
+    fn = mask_neon;  // NEON is mandatory on ARMv8-A
+    name = "neon";
+#endif
+
+    g_mask_impl_name = name;
+    g_mask_impl = fn;
+    return fn;
+}
+
+void ws_mask_apply(uint8_t *dst, const uint8_t *src, size_t len, uint32_t key) {
+    // Control frames and small messages: byte loop beats any dispatch
+    if (len < WS_MASK_SIMD_MIN) {
+        mask_bytes(dst, src, len, key);
+        return;
+    }
+
+    ws_mask_fn fn = g_mask_impl;
+    if (__builtin_expect(fn == NULL, 0)) {
+        fn = mask_select();
+    }
+    fn(dst, src, len, key);
+}
+
+const char *ws_mask_get_impl_name(void) {
+    if (!g_mask_impl) {
+        mask_select();
+    }
+    return g_mask_impl_name;
+}
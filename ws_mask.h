@@ -0,0 +1,35 @@
+#ifndef WS_MASK_H
+#define WS_MASK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// WebSocket payload masking (RFC 6455 Section 5.3)
+//
+// dst[i] = src[i] ^ key_byte[i & 3], where key_byte[n] = (key >> (8 * n)) & 0xFF
+// (same byte order as the 4-byte masking key written into the frame header)
+//
+// Dispatches at runtime to AVX-512/AVX2/SSE2 on x86 and NEON on ARM64,
+// with a 64-bit word scalar path elsewhere and for short payloads.
+
+// Payloads shorter than this use the byte loop (vector setup not worth it)
+#define WS_MASK_SIMD_MIN 16
+
+// Mask len bytes from src into dst
+// In-place (dst == src) and forward overlap (dst < src) are allowed; dst > src overlap is not
+void ws_mask_apply(uint8_t *dst, const uint8_t *src, size_t len, uint32_t key);
+
+// Portable 64-bit word implementation (no SIMD) - exposed for benchmarking
+void ws_mask_apply_scalar(uint8_t *dst, const uint8_t *src, size_t len, uint32_t key);
+
+// Name of the implementation selected by ws_mask_apply() ("avx512", "avx2", "sse2", "neon", "scalar")
+const char *ws_mask_get_impl_name(void);
+
+// Rotate key so masking can continue at payload offset `offset`
+// Used when a payload is masked in several pieces (wraparound, scatter/gather)
+static inline uint32_t ws_mask_rotate(uint32_t key, size_t offset) {
+    unsigned shift = (unsigned)(offset & 3) * 8;
+    return shift ? (key >> shift) | (key << (32 - shift)) : key;
+}
+
+#endif // WS_MASK_H
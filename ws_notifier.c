@@ -1,26 +1,611 @@
 #include "ws_notifier.h"
+#include "ws_timer.h"
+#include "os.h"
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
 #include <stdio.h>
+#include <stdint.h>
 
 #ifdef __linux__
 #include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
+
+// epoll_pwait2() (glibc 2.35+, Linux 5.11+) accepts a timespec for sub-millisecond timeouts
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 35))
+#define WS_HAVE_EPOLL_PWAIT2 1
+#endif
+
+// Per-epoll busy poll parameters (Linux 6.9+); older headers lack the definition
+#ifndef EPIOCSPARAMS
+struct epoll_params {
+    uint32_t busy_poll_usecs;
+    uint16_t busy_poll_budget;
+    uint8_t prefer_busy_poll;
+    uint8_t __pad;
+};
+#define EPOLL_IOC_TYPE 0x8A
+#define EPIOCSPARAMS _IOW(EPOLL_IOC_TYPE, 0x01, struct epoll_params)
+#endif
+
+// io_uring backend: raw syscalls, only the kernel UAPI header is needed (no liburing)
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <poll.h>
+#if defined(__NR_io_uring_setup) && defined(IORING_FEAT_EXT_ARG)
+#define WS_HAVE_IO_URING 1
+#endif
+#endif
+#endif
 #elif defined(__APPLE__)
 #include <sys/event.h>
 #include <sys/time.h>
 #endif
 
+#ifdef WS_HAVE_IO_URING
+#define WS_URING_ENTRIES 256
+#define WS_URING_TAG_INTERNAL (1ULL << 63)  // Completions of POLL_REMOVE requests
+#define WS_URING_REARM 0x80                 // fd_events flag: poll ended, arm a new one
+
+// user_data: internal bit, 2-bit operation, 29-bit generation, fd
+#define WS_URING_OP_SHIFT 61
+#define WS_URING_OP_POLL 0u
+#define WS_URING_OP_RECV 1u                 // Data path (ws_notifier_io_*)
+#define WS_URING_OP_SEND 2u
+#define WS_URING_OP_WAKE 3u                 // NOP: WRITE interest with no SEND in flight
+#define WS_URING_GEN_MASK 0x1FFFFFFFu
+
+// Data path operation states
+#define WS_URING_IO_IDLE 0
+#define WS_URING_IO_INFLIGHT 1
+#define WS_URING_IO_DONE 2                  // Completed, result not collected yet
+
+// Per-fd data path: at most one RECV and one SEND in flight
+typedef struct {
+    uint8_t *rx_buf;             // Caller's buffer the RECV lands in
+    const uint8_t *tx_buf;
+    uint32_t rx_len;
+    uint32_t tx_len;
+    int rx_res;                  // CQE result once DONE
+    int tx_res;
+    uint8_t rx_state;            // WS_URING_IO_*
+    uint8_t tx_state;
+    uint8_t wake_queued;         // WAKE NOP submitted, not reaped yet
+    uint8_t on;                  // fd is on the data path (no readiness poll armed)
+} ws_uring_io_t;
+
+// Mapped SQ/CQ rings of one io_uring instance
+typedef struct {
+    int fd;
+    int sqpoll;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_flags;
+    unsigned *sq_array;
+    unsigned sq_entries;
+    unsigned sq_queued;          // Local tail: SQEs filled but not yet published
+    unsigned pending;            // Published but not yet submitted (non-SQPOLL)
+    struct io_uring_sqe *sqes;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+    void *sq_ring;
+    void *cq_ring;
+    size_t sq_ring_len;
+    size_t cq_ring_len;
+    size_t sqes_len;
+    int rearm;                   // A multishot poll ended, re-arm pass needed
+} ws_uring_t;
+#endif
+
 struct ws_notifier {
 #ifdef __linux__
-    int epoll_fd;
+    int epoll_fd;                // -1 with the io_uring backend
+    struct epoll_event ready[WS_NOTIFIER_MAX_EVENTS];  // Reused by every wait (no per-call allocation)
+#ifdef WS_HAVE_IO_URING
+    ws_uring_t *uring;           // NULL with the epoll backend
+    uint32_t *fd_gen;            // Poll generation per fd: stale CQEs after MOD/DEL are dropped
+    uint8_t *fd_events;          // Registered WS_EVENT_* mask (re-arm after a multishot ends)
+    ws_uring_io_t *fd_io;        // Data path state per fd (WS_NOTIFIER_URING_IO only)
+    int uring_io;                // WS_NOTIFIER_URING_IO requested and supported
+#endif
 #elif defined(__APPLE__)
     int kqueue_fd;
+    struct kevent ready[WS_NOTIFIER_MAX_EVENTS];       // Reused by every wait (no per-call allocation)
+#endif
+
+    // Per-fd user data registered via ws_notifier_add()
+    // Needed so ws_notifier_mod() can re-arm filters without losing data.ptr/udata
+    void **fd_data;
+    uint8_t *fd_registered;      // 1 if fd is currently registered (user_data may be NULL)
+    int fd_data_cap;
+
+    // Wait mode (see ws_notifier_set_mode)
+    ws_notifier_mode_t mode;
+    uint64_t timeout_ns;         // Blocking timeout (WS_NOTIFIER_NO_TIMEOUT = infinite)
+    uint64_t spin_cycles;        // ADAPTIVE: spin budget in os_get_cpu_cycle() units
+
+    ws_timer_wheel_t *timers;    // Heartbeats of bound contexts, created on first use
+
+    // Busy poll configuration (Linux only, 0 = disabled)
+    int busy_poll_usecs;
+    int busy_poll_budget;
+#ifdef WS_HAVE_EPOLL_PWAIT2
+    int no_pwait2;               // Set if kernel lacks epoll_pwait2 (ENOSYS)
 #endif
 };
 
+#ifdef __linux__
+// Apply SO_BUSY_POLL family of options to a socket (best effort, non-sockets ignored)
+static void notifier_apply_busy_poll(const ws_notifier_t *notifier, int fd) {
+    int usecs = notifier->busy_poll_usecs;
+    if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usecs, sizeof(usecs)) != 0 && errno != ENOTSOCK) {
+        fprintf(stderr, "Warning: Failed to set SO_BUSY_POLL: %s\n", strerror(errno));
+    }
+#ifdef SO_PREFER_BUSY_POLL
+    int prefer = usecs > 0;
+    setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof(prefer));
+#endif
+#ifdef SO_BUSY_POLL_BUDGET
+    if (notifier->busy_poll_budget > 0) {
+        int budget = notifier->busy_poll_budget;
+        setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL_BUDGET, &budget, sizeof(budget));
+    }
+#endif
+}
+#endif
+
+// Remember user data for fd (grows the fd-indexed table on demand)
+// Returns 0 on success, -1 on allocation failure
+static int notifier_store_user_data(ws_notifier_t *notifier, int fd, void *user_data) {
+    if (fd >= notifier->fd_data_cap) {
+        int new_cap = notifier->fd_data_cap ? notifier->fd_data_cap : 64;
+        while (new_cap <= fd) new_cap *= 2;
+
+        void **grown = (void**)realloc(notifier->fd_data, (size_t)new_cap * sizeof(void*));
+        if (!grown) {
+            return -1;
+        }
+        notifier->fd_data = grown;
+
+        uint8_t *grown_reg = (uint8_t*)realloc(notifier->fd_registered, (size_t)new_cap);
+        if (!grown_reg) {
+            return -1;
+        }
+        notifier->fd_registered = grown_reg;
+
+        memset(grown + notifier->fd_data_cap, 0,
+               (size_t)(new_cap - notifier->fd_data_cap) * sizeof(void*));
+        memset(grown_reg + notifier->fd_data_cap, 0, (size_t)(new_cap - notifier->fd_data_cap));
+
+#ifdef WS_HAVE_IO_URING
+        if (notifier->uring) {
+            uint32_t *grown_gen = (uint32_t*)realloc(notifier->fd_gen, (size_t)new_cap * sizeof(uint32_t));
+            if (!grown_gen) {
+                return -1;
+            }
+            notifier->fd_gen = grown_gen;
+            uint8_t *grown_ev = (uint8_t*)realloc(notifier->fd_events, (size_t)new_cap);
+            if (!grown_ev) {
+                return -1;
+            }
+            notifier->fd_events = grown_ev;
+            memset(grown_gen + notifier->fd_data_cap, 0,
+                   (size_t)(new_cap - notifier->fd_data_cap) * sizeof(uint32_t));
+            memset(grown_ev + notifier->fd_data_cap, 0, (size_t)(new_cap - notifier->fd_data_cap));
+            if (notifier->uring_io) {
+                // Only the CPU reads this table: the kernel holds the callers' buffers, not these entries
+                ws_uring_io_t *grown_io = (ws_uring_io_t*)realloc(notifier->fd_io, (size_t)new_cap * sizeof(ws_uring_io_t));
+                if (!grown_io) {
+                    return -1;
+                }
+                notifier->fd_io = grown_io;
+                memset(grown_io + notifier->fd_data_cap, 0,
+                       (size_t)(new_cap - notifier->fd_data_cap) * sizeof(ws_uring_io_t));
+            }
+        }
+#endif
+        notifier->fd_data_cap = new_cap;
+    }
+    notifier->fd_data[fd] = user_data;
+    notifier->fd_registered[fd] = 1;
+    return 0;
+}
+
+static inline void *notifier_user_data(const ws_notifier_t *notifier, int fd) {
+    return (fd < notifier->fd_data_cap) ? notifier->fd_data[fd] : NULL;
+}
+
+#ifdef WS_HAVE_IO_URING
+static inline int uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+                              const void *arg, size_t argsz) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+static void uring_free(ws_uring_t *r) {
+    if (!r) return;
+    if (r->sqes && r->sqes != MAP_FAILED) munmap(r->sqes, r->sqes_len);
+    if (r->cq_ring && r->cq_ring != MAP_FAILED && r->cq_ring != r->sq_ring) munmap(r->cq_ring, r->cq_ring_len);
+    if (r->sq_ring && r->sq_ring != MAP_FAILED) munmap(r->sq_ring, r->sq_ring_len);
+    if (r->fd >= 0) close(r->fd);
+    free(r);
+}
+
+static ws_uring_t *uring_create(int flags) {
+    ws_uring_t *r = (ws_uring_t*)calloc(1, sizeof(ws_uring_t));
+    if (!r) return NULL;
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    if (flags & WS_NOTIFIER_URING_SQPOLL) {
+        p.flags |= IORING_SETUP_SQPOLL;
+        p.sq_thread_idle = 1000;  // ms before the kernel thread sleeps and needs a wakeup
+    }
+    r->fd = (int)syscall(__NR_io_uring_setup, WS_URING_ENTRIES, &p);
+    if (r->fd < 0 && (flags & WS_NOTIFIER_URING_SQPOLL)) {
+        fprintf(stderr, "Warning: io_uring SQPOLL unavailable (%s), using plain io_uring\n", strerror(errno));
+        memset(&p, 0, sizeof(p));
+        r->fd = (int)syscall(__NR_io_uring_setup, WS_URING_ENTRIES, &p);
+    }
+    if (r->fd < 0) {
+        fprintf(stderr, "Warning: io_uring unavailable (%s)\n", strerror(errno));
+        free(r);
+        return NULL;
+    }
+    if (!(p.features & IORING_FEAT_EXT_ARG)) {
+        fprintf(stderr, "Warning: io_uring lacks timed waits (Linux 5.11+ required)\n");
+        close(r->fd);
+        free(r);
+        return NULL;
+    }
+    r->sqpoll = (p.flags & IORING_SETUP_SQPOLL) != 0;
+
+    r->sq_ring_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_ring_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    int single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single && r->cq_ring_len > r->sq_ring_len) r->sq_ring_len = r->cq_ring_len;
+
+    r->sq_ring = mmap(NULL, r->sq_ring_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+    r->cq_ring = single ? r->sq_ring
+               : mmap(NULL, r->cq_ring_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+    r->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = (struct io_uring_sqe*)mmap(NULL, r->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                         r->fd, IORING_OFF_SQES);
+    if (r->sq_ring == MAP_FAILED || r->cq_ring == MAP_FAILED || r->sqes == MAP_FAILED) {
+        fprintf(stderr, "Warning: io_uring ring mmap failed (%s)\n", strerror(errno));
+        uring_free(r);
+        return NULL;
+    }
+
+    uint8_t *sq = (uint8_t*)r->sq_ring;
+    uint8_t *cq = (uint8_t*)r->cq_ring;
+    r->sq_head = (unsigned*)(sq + p.sq_off.head);
+    r->sq_tail = (unsigned*)(sq + p.sq_off.tail);
+    r->sq_mask = (unsigned*)(sq + p.sq_off.ring_mask);
+    r->sq_flags = (unsigned*)(sq + p.sq_off.flags);
+    r->sq_array = (unsigned*)(sq + p.sq_off.array);
+    r->sq_entries = p.sq_entries;
+    r->sq_queued = *r->sq_tail;
+    r->cq_head = (unsigned*)(cq + p.cq_off.head);
+    r->cq_tail = (unsigned*)(cq + p.cq_off.tail);
+    r->cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+    return r;
+}
+
+// Hand published SQEs to the kernel (SQPOLL: only wake the thread if it went idle)
+static int uring_submit(ws_uring_t *r) {
+    if (r->sqpoll) {
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);  // Tail store before the NEED_WAKEUP check
+        if (__atomic_load_n(r->sq_flags, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP) {
+            uring_enter(r->fd, 0, 0, IORING_ENTER_SQ_WAKEUP, NULL, 0);
+        }
+        r->pending = 0;
+        return 0;
+    }
+    while (r->pending > 0) {
+        int ret = uring_enter(r->fd, r->pending, 0, 0, NULL, 0);
+        if (ret < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) return 0;  // Retried on the next wait
+            return -1;
+        }
+        r->pending -= (unsigned)ret;
+        if (ret == 0) break;
+    }
+    return 0;
+}
+
+// Next free SQE, zeroed; published by uring_publish() once filled
+static struct io_uring_sqe *uring_get_sqe(ws_uring_t *r) {
+    if (r->sq_queued - __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE) >= r->sq_entries) {
+        uring_submit(r);
+        if (r->sq_queued - __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE) >= r->sq_entries) return NULL;
+    }
+    unsigned idx = r->sq_queued & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    r->sq_array[idx] = idx;
+    return sqe;
+}
+
+static inline void uring_publish(ws_uring_t *r) {
+    r->sq_queued++;
+    __atomic_store_n(r->sq_tail, r->sq_queued, __ATOMIC_RELEASE);
+    r->pending++;
+}
+
+static inline uint64_t uring_tag(int fd, uint32_t gen) {
+    return ((uint64_t)(gen & WS_URING_GEN_MASK) << 32) | (uint32_t)fd;
+}
+
+static inline uint64_t uring_io_tag(int fd, uint32_t gen, unsigned op) {
+    return ((uint64_t)op << WS_URING_OP_SHIFT) | uring_tag(fd, gen);
+}
+
+// Arm a multishot poll for fd (edge-like: one CQE per wakeup, as EPOLLET)
+static int uring_arm(ws_notifier_t *notifier, int fd) {
+    struct io_uring_sqe *sqe = uring_get_sqe(notifier->uring);
+    if (!sqe) return -1;
+
+    uint32_t mask = POLLERR | POLLHUP;
+    if (notifier->fd_events[fd] & WS_EVENT_READ)  mask |= POLLIN;
+    if (notifier->fd_events[fd] & WS_EVENT_WRITE) mask |= POLLOUT;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    mask = __builtin_bswap32(mask);  // Kernel reads the halves swapped on big-endian
+#endif
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = mask;
+#ifdef IORING_POLL_ADD_MULTI
+    sqe->len = IORING_POLL_ADD_MULTI;  // Pre-5.13 kernels complete once: re-armed in uring_reap()
+#endif
+    sqe->user_data = uring_tag(fd, notifier->fd_gen[fd]);
+    uring_publish(notifier->uring);
+    return 0;
+}
+
+// Cancel the current poll of fd and bump its generation (CQEs already queued become stale)
+static int uring_disarm(ws_notifier_t *notifier, int fd) {
+    struct io_uring_sqe *sqe = uring_get_sqe(notifier->uring);
+    if (!sqe) return -1;
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = uring_tag(fd, notifier->fd_gen[fd]);
+    sqe->user_data = WS_URING_TAG_INTERNAL;
+    uring_publish(notifier->uring);
+    notifier->fd_gen[fd]++;
+    return 0;
+}
+
+// Data path state of fd, NULL unless it was attached with ws_notifier_io_attach()
+static inline ws_uring_io_t *uring_io_get(ws_notifier_t *notifier, int fd) {
+    if (!notifier || !notifier->uring_io || fd < 0 || fd >= notifier->fd_data_cap ||
+        !notifier->fd_registered[fd] || !notifier->fd_io[fd].on) {
+        return NULL;
+    }
+    return &notifier->fd_io[fd];
+}
+
+// Queue a RECV or SEND on buf (WAKE: a NOP that only produces a completion)
+static int uring_io_queue(ws_notifier_t *notifier, int fd, unsigned op, const uint8_t *buf, uint32_t len) {
+    struct io_uring_sqe *sqe = uring_get_sqe(notifier->uring);
+    if (!sqe) return -1;
+    if (op == WS_URING_OP_WAKE) {
+        sqe->opcode = IORING_OP_NOP;
+        sqe->fd = -1;
+    } else {
+        sqe->opcode = op == WS_URING_OP_RECV ? IORING_OP_RECV : IORING_OP_SEND;
+        sqe->fd = fd;
+        sqe->addr = (uint64_t)(uintptr_t)buf;
+        sqe->len = len;
+        if (op == WS_URING_OP_SEND) sqe->msg_flags = MSG_NOSIGNAL;  // As tcp_send()
+    }
+    sqe->user_data = uring_io_tag(fd, notifier->fd_gen[fd], op);
+    uring_publish(notifier->uring);
+    return 0;
+}
+
+// Record a data path completion; returns 1 if fd gets an event for it
+static int uring_io_complete(ws_notifier_t *notifier, int fd, unsigned op, int res) {
+    ws_uring_io_t *io = &notifier->fd_io[fd];
+    if (op == WS_URING_OP_WAKE) {
+        io->wake_queued = 0;
+        return (notifier->fd_events[fd] & WS_EVENT_WRITE) != 0;
+    }
+    if (op == WS_URING_OP_RECV) {
+        io->rx_res = res;
+        io->rx_state = WS_URING_IO_DONE;
+    } else {
+        io->tx_res = res;
+        io->tx_state = WS_URING_IO_DONE;
+    }
+    return 1;
+}
+
+// Take fd off the data path: cancel what is in flight and wait for it, so the buffers
+// are no longer the kernel's. Results that completed meanwhile stay DONE for the caller
+static void uring_io_stop(ws_notifier_t *notifier, int fd) {
+    ws_uring_t *r = notifier->uring;
+    ws_uring_io_t *io = &notifier->fd_io[fd];
+    if (io->rx_state == WS_URING_IO_INFLIGHT || io->tx_state == WS_URING_IO_INFLIGHT) {
+        // A cancel only finds requests the kernel has taken from the SQ
+        uring_submit(r);
+        while (r->sqpoll && __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE) != r->sq_queued) {
+            uring_enter(r->fd, 0, 0, IORING_ENTER_SQ_WAKEUP, NULL, 0);
+        }
+
+        // By user_data, not fd: the socket may already be closed
+        unsigned ops[2] = {WS_URING_OP_RECV, WS_URING_OP_SEND};
+        uint8_t states[2] = {io->rx_state, io->tx_state};
+        for (int i = 0; i < 2; i++) {
+            if (states[i] != WS_URING_IO_INFLIGHT) continue;
+            struct io_uring_sync_cancel_reg reg;
+            memset(&reg, 0, sizeof(reg));
+            reg.addr = uring_io_tag(fd, notifier->fd_gen[fd], ops[i]);
+            reg.timeout.tv_sec = -1;
+            reg.timeout.tv_nsec = -1;
+            syscall(__NR_io_uring_register, r->fd, IORING_REGISTER_SYNC_CANCEL, &reg, 1);  // ENOENT: already done
+        }
+
+        // Completions posted but not reaped yet (the wait would drop them as stale below)
+        unsigned head = *r->cq_head;
+        unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            const struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+            if (cqe->user_data == uring_io_tag(fd, notifier->fd_gen[fd], WS_URING_OP_RECV) ||
+                cqe->user_data == uring_io_tag(fd, notifier->fd_gen[fd], WS_URING_OP_SEND)) {
+                if (cqe->res != -ECANCELED) {
+                    uring_io_complete(notifier, fd, (unsigned)(cqe->user_data >> WS_URING_OP_SHIFT) & 3u, cqe->res);
+                }
+            }
+        }
+    }
+    notifier->fd_gen[fd]++;  // Every completion of this attachment is stale from here
+    if (io->rx_state == WS_URING_IO_INFLIGHT) io->rx_state = WS_URING_IO_IDLE;  // Cancelled
+    if (io->tx_state == WS_URING_IO_INFLIGHT) io->tx_state = WS_URING_IO_IDLE;
+    io->wake_queued = 0;
+    io->on = 0;
+}
+
+// RECV, SEND and sync cancel (Linux 6.0+)
+static int uring_io_supported(ws_uring_t *r) {
+    size_t len = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = (struct io_uring_probe*)calloc(1, len);
+    if (!probe) return 0;
+    int ok = syscall(__NR_io_uring_register, r->fd, IORING_REGISTER_PROBE, probe, 256) == 0 &&
+             probe->last_op >= IORING_OP_RECV &&
+             (probe->ops[IORING_OP_RECV].flags & IO_URING_OP_SUPPORTED) &&
+             (probe->ops[IORING_OP_SEND].flags & IO_URING_OP_SUPPORTED);
+    free(probe);
+
+    struct io_uring_sync_cancel_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.addr = WS_URING_TAG_INTERNAL;  // Matches nothing
+    reg.timeout.tv_sec = -1;
+    reg.timeout.tv_nsec = -1;
+    return ok && syscall(__NR_io_uring_register, r->fd, IORING_REGISTER_SYNC_CANCEL, &reg, 1) < 0 &&
+           errno == ENOENT;
+}
+
+// Convert ready CQEs into epoll_event entries in notifier->ready (POLL* == EPOLL* bits)
+static int uring_reap(ws_notifier_t *notifier, int max_events) {
+    ws_uring_t *r = notifier->uring;
+    unsigned head = *r->cq_head;
+    unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+    int n = 0;
+    int fds[WS_NOTIFIER_MAX_EVENTS];
+
+    while (head != tail && n < max_events) {
+        const struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+        head++;
+        if (cqe->user_data & WS_URING_TAG_INTERNAL) continue;
+
+        int fd = (int)(uint32_t)cqe->user_data;
+        uint32_t gen = (uint32_t)(cqe->user_data >> 32) & WS_URING_GEN_MASK;
+        unsigned op = (unsigned)(cqe->user_data >> WS_URING_OP_SHIFT) & 3u;
+        if (fd >= notifier->fd_data_cap || !notifier->fd_registered[fd] ||
+            gen != (notifier->fd_gen[fd] & WS_URING_GEN_MASK)) {
+            continue;  // Completion of a poll (or data path request) that was modified or removed since
+        }
+
+        uint32_t ev;
+        if (op != WS_URING_OP_POLL) {
+            if (!uring_io_complete(notifier, fd, op, cqe->res)) continue;
+            ev = op == WS_URING_OP_RECV ? EPOLLIN : EPOLLOUT;
+        } else {
+            if (!(cqe->flags & IORING_CQE_F_MORE)) {
+                notifier->fd_gen[fd]++;  // Poll ended: a fresh one is armed below
+                notifier->fd_events[fd] |= WS_URING_REARM;
+                r->rearm = 1;
+            }
+            if (cqe->res == -ECANCELED) continue;
+            ev = cqe->res < 0 ? (uint32_t)(EPOLLERR | EPOLLIN) : (uint32_t)cqe->res;
+        }
+        int merged = 0;
+        for (int j = 0; j < n; j++) {
+            if (fds[j] == fd) {
+                notifier->ready[j].events |= ev;
+                merged = 1;
+                break;
+            }
+        }
+        if (!merged) {
+            fds[n] = fd;
+            notifier->ready[n].events = ev;
+            notifier->ready[n].data.ptr = notifier->fd_data[fd];
+            n++;
+        }
+    }
+    __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+
+    if (__builtin_expect(r->rearm, 0)) {
+        r->rearm = 0;
+        for (int fd = 0; fd < notifier->fd_data_cap; fd++) {
+            if (notifier->fd_registered[fd] && (notifier->fd_events[fd] & WS_URING_REARM)) {
+                notifier->fd_events[fd] &= (uint8_t)~WS_URING_REARM;
+                if (notifier->uring_io && notifier->fd_io[fd].on) continue;  // Polls are off on the data path
+                uring_arm(notifier, fd);
+            }
+        }
+    }
+    return n;
+}
+
+// Backend wait: ready CQEs are consumed without a syscall
+static int uring_poll(ws_notifier_t *notifier, int max_events, uint64_t timeout_ns) {
+    ws_uring_t *r = notifier->uring;
+    if (r->pending > 0) uring_submit(r);
+
+    int n = uring_reap(notifier, max_events);
+    if (n > 0 || timeout_ns == 0) {
+        if (r->pending > 0) uring_submit(r);  // Re-arms queued by the reap
+        return n;
+    }
+
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    unsigned flags = IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+    if (timeout_ns != WS_NOTIFIER_NO_TIMEOUT) {
+        ts.tv_sec = (long long)(timeout_ns / 1000000000ULL);
+        ts.tv_nsec = (long long)(timeout_ns % 1000000000ULL);
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+    }
+    if (r->sqpoll && (__atomic_load_n(r->sq_flags, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP)) {
+        flags |= IORING_ENTER_SQ_WAKEUP;
+    }
+    unsigned to_submit = r->sqpoll ? 0 : r->pending;
+    int ret = uring_enter(r->fd, to_submit, 1, flags, &arg, sizeof(arg));
+    if (ret < 0 && errno != ETIME && errno != EINTR) {
+        return -1;
+    }
+    if (ret > 0 && !r->sqpoll) r->pending -= (unsigned)ret;
+    return uring_reap(notifier, max_events);
+}
+#endif
+
 ws_notifier_t* ws_notifier_init(void) {
+    return ws_notifier_init_ex(WS_NOTIFIER_BACKEND_DEFAULT, 0);
+}
+
+ws_notifier_backend_t ws_notifier_get_backend(const ws_notifier_t *notifier) {
+#ifdef WS_HAVE_IO_URING
+    if (notifier && notifier->uring) return WS_NOTIFIER_BACKEND_IO_URING;
+#else
+    (void)notifier;
+#endif
+    return WS_NOTIFIER_BACKEND_DEFAULT;
+}
+
+ws_notifier_t* ws_notifier_init_ex(ws_notifier_backend_t backend, int flags) {
     ws_notifier_t *notifier = (ws_notifier_t*)malloc(sizeof(ws_notifier_t));
     if (!notifier) {
         return NULL;
@@ -28,7 +613,31 @@ ws_notifier_t* ws_notifier_init(void) {
 
     memset(notifier, 0, sizeof(ws_notifier_t));
 
+    // Default mode preserves the historical fixed 100ms timeout
+    notifier->mode = WS_NOTIFIER_MODE_TIMEOUT;
+    notifier->timeout_ns = 100000000ULL;
+
 #ifdef __linux__
+    notifier->epoll_fd = -1;
+    if (backend == WS_NOTIFIER_BACKEND_IO_URING) {
+#ifdef WS_HAVE_IO_URING
+        notifier->uring = uring_create(flags);
+        if (notifier->uring) {
+            if (flags & WS_NOTIFIER_URING_IO) {
+                notifier->uring_io = uring_io_supported(notifier->uring);
+                if (!notifier->uring_io) {
+                    fprintf(stderr, "Warning: io_uring data path unavailable (Linux 6.0+ required), "
+                                    "sockets are read and written directly\n");
+                }
+            }
+            return notifier;
+        }
+#else
+        (void)flags;
+#endif
+        fprintf(stderr, "Warning: io_uring backend unavailable, falling back to epoll\n");
+    }
+
     // Create epoll instance
     notifier->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
     if (notifier->epoll_fd < 0) {
@@ -37,6 +646,11 @@ ws_notifier_t* ws_notifier_init(void) {
         return NULL;
     }
 #elif defined(__APPLE__)
+    (void)flags;
+    if (backend == WS_NOTIFIER_BACKEND_IO_URING) {
+        fprintf(stderr, "Warning: io_uring backend is Linux only, using kqueue\n");
+    }
+
     // Create kqueue instance
     notifier->kqueue_fd = kqueue();
     if (notifier->kqueue_fd < 0) {
@@ -45,6 +659,8 @@ ws_notifier_t* ws_notifier_init(void) {
         return NULL;
     }
 #else
+    (void)backend;
+    (void)flags;
     fprintf(stderr, "Event notifier not supported on this platform\n");
     free(notifier);
     return NULL;
@@ -60,25 +676,55 @@ void ws_notifier_free(ws_notifier_t *notifier) {
     if (notifier->epoll_fd >= 0) {
         close(notifier->epoll_fd);
     }
+#ifdef WS_HAVE_IO_URING
+    uring_free(notifier->uring);
+    free(notifier->fd_gen);
+    free(notifier->fd_events);
+    free(notifier->fd_io);
+#endif
 #elif defined(__APPLE__)
     if (notifier->kqueue_fd >= 0) {
         close(notifier->kqueue_fd);
     }
 #endif
 
+    ws_timer_wheel_free(notifier->timers);
+    free(notifier->fd_data);
+    free(notifier->fd_registered);
     free(notifier);
 }
 
-int ws_notifier_add(ws_notifier_t *notifier, int fd, int events) {
+int ws_notifier_add(ws_notifier_t *notifier, int fd, int events, void *user_data) {
     if (!notifier || fd < 0) {
         return -1;
     }
 
+    if (notifier_store_user_data(notifier, fd, user_data) < 0) {
+        return -1;
+    }
+
+#ifdef WS_HAVE_IO_URING
+    if (notifier->uring) {
+        notifier->fd_events[fd] = (uint8_t)(events & (WS_EVENT_READ | WS_EVENT_WRITE));
+        notifier->fd_gen[fd]++;  // Completions of an earlier registration of this fd are stale
+        if (notifier->uring_io) memset(&notifier->fd_io[fd], 0, sizeof(ws_uring_io_t));
+        if (uring_arm(notifier, fd) < 0) {
+            fprintf(stderr, "Warning: io_uring submission queue full\n");
+            notifier->fd_registered[fd] = 0;
+            return -1;
+        }
+        if (notifier->busy_poll_usecs > 0) {
+            notifier_apply_busy_poll(notifier, fd);
+        }
+        return 0;  // Submitted with the next wait
+    }
+#endif
+
 #ifdef __linux__
     struct epoll_event ev;
     memset(&ev, 0, sizeof(ev));
 
-    ev.data.fd = fd;
+    ev.data.ptr = user_data;
     ev.events = EPOLLET;  // Edge-triggered mode
 
     if (events & WS_EVENT_READ) {
@@ -90,9 +736,14 @@ int ws_notifier_add(ws_notifier_t *notifier, int fd, int events) {
 
     if (epoll_ctl(notifier->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
         perror("epoll_ctl ADD");
+        notifier->fd_registered[fd] = 0;
         return -1;
     }
 
+    if (notifier->busy_poll_usecs > 0) {
+        notifier_apply_busy_poll(notifier, fd);
+    }
+
     return 0;
 
 #elif defined(__APPLE__)
@@ -103,7 +754,7 @@ int ws_notifier_add(ws_notifier_t *notifier, int fd, int events) {
     if (events & WS_EVENT_READ) {
         EV_SET(&kev[n_changes], fd, EVFILT_READ,
                EV_ADD | EV_CLEAR,  // EV_CLEAR for edge-triggered behavior
-               0, 0, NULL);
+               0, 0, user_data);
         n_changes++;
     }
 
@@ -111,7 +762,7 @@ int ws_notifier_add(ws_notifier_t *notifier, int fd, int events) {
     if (events & WS_EVENT_WRITE) {
         EV_SET(&kev[n_changes], fd, EVFILT_WRITE,
                EV_ADD | EV_CLEAR,  // EV_CLEAR for edge-triggered behavior
-               0, 0, NULL);
+               0, 0, user_data);
         n_changes++;
     }
 
@@ -134,11 +785,33 @@ int ws_notifier_mod(ws_notifier_t *notifier, int fd, int events) {
         return -1;
     }
 
+    void *user_data = notifier_user_data(notifier, fd);
+
+#ifdef WS_HAVE_IO_URING
+    if (notifier->uring) {
+        if (fd >= notifier->fd_data_cap || !notifier->fd_registered[fd]) {
+            return -1;
+        }
+        int added = events & ~notifier->fd_events[fd];
+        notifier->fd_events[fd] = (uint8_t)(events & (WS_EVENT_READ | WS_EVENT_WRITE));
+        ws_uring_io_t *io = uring_io_get(notifier, fd);
+        if (io) {
+            // Data path: completions are the events, new WRITE interest gets one straight away
+            if ((added & WS_EVENT_WRITE) && io->tx_state == WS_URING_IO_IDLE && !io->wake_queued) {
+                if (uring_io_queue(notifier, fd, WS_URING_OP_WAKE, NULL, 0) < 0) return -1;
+                io->wake_queued = 1;
+            }
+            return 0;
+        }
+        return (uring_disarm(notifier, fd) == 0 && uring_arm(notifier, fd) == 0) ? 0 : -1;
+    }
+#endif
+
 #ifdef __linux__
     struct epoll_event ev;
     memset(&ev, 0, sizeof(ev));
 
-    ev.data.fd = fd;
+    ev.data.ptr = user_data;  // EPOLL_CTL_MOD replaces data, re-supply registered pointer
     ev.events = EPOLLET;  // Edge-triggered mode
 
     if (events & WS_EVENT_READ) {
@@ -163,7 +836,7 @@ int ws_notifier_mod(ws_notifier_t *notifier, int fd, int events) {
     if (events & WS_EVENT_READ) {
         EV_SET(&kev[n_changes], fd, EVFILT_READ,
                EV_ADD | EV_CLEAR,  // Modify (or add) with edge-triggered
-               0, 0, NULL);
+               0, 0, user_data);
         n_changes++;
     } else {
         // Remove read filter if not requested
@@ -177,7 +850,7 @@ int ws_notifier_mod(ws_notifier_t *notifier, int fd, int events) {
     if (events & WS_EVENT_WRITE) {
         EV_SET(&kev[n_changes], fd, EVFILT_WRITE,
                EV_ADD | EV_CLEAR,
-               0, 0, NULL);
+               0, 0, user_data);
         n_changes++;
     } else {
         // Remove write filter if not requested
@@ -200,6 +873,7 @@ int ws_notifier_mod(ws_notifier_t *notifier, int fd, int events) {
     return 0;
 #else
     (void)events;
+    (void)user_data;
     return -1;
 #endif
 }
@@ -209,6 +883,30 @@ int ws_notifier_del(ws_notifier_t *notifier, int fd) {
         return -1;
     }
 
+#ifdef WS_HAVE_IO_URING
+    if (notifier->uring) {
+        if (fd >= notifier->fd_data_cap || !notifier->fd_registered[fd]) {
+            return -1;
+        }
+        if (uring_io_get(notifier, fd)) {
+            uring_io_stop(notifier, fd);  // No poll armed; uncollected results are dropped
+            notifier->fd_data[fd] = NULL;
+            notifier->fd_registered[fd] = 0;
+            notifier->fd_events[fd] = 0;
+            return 0;
+        }
+        notifier->fd_data[fd] = NULL;
+        notifier->fd_registered[fd] = 0;
+        notifier->fd_events[fd] = 0;
+        return uring_disarm(notifier, fd);
+    }
+#endif
+
+    if (fd < notifier->fd_data_cap) {
+        notifier->fd_data[fd] = NULL;
+        notifier->fd_registered[fd] = 0;
+    }
+
 #ifdef __linux__
     if (epoll_ctl(notifier->epoll_fd, EPOLL_CTL_DEL, fd, NULL) < 0) {
         perror("epoll_ctl DEL");
@@ -239,20 +937,362 @@ int ws_notifier_del(ws_notifier_t *notifier, int fd) {
 #endif
 }
 
-void ws_notifier_wait(ws_notifier_t *notifier) {
+int ws_notifier_set_mode(ws_notifier_t *notifier, ws_notifier_mode_t mode,
+                         uint64_t timeout_ns, uint64_t spin_cycles) {
     if (!notifier) {
-        return;
+        return -1;
+    }
+
+    switch (mode) {
+    case WS_NOTIFIER_MODE_BLOCKING:
+        timeout_ns = WS_NOTIFIER_NO_TIMEOUT;
+        spin_cycles = 0;
+        break;
+    case WS_NOTIFIER_MODE_TIMEOUT:
+        spin_cycles = 0;
+        break;
+    case WS_NOTIFIER_MODE_ADAPTIVE:
+        break;
+    default:
+        return -1;
+    }
+
+    notifier->mode = mode;
+    notifier->timeout_ns = timeout_ns;
+    notifier->spin_cycles = spin_cycles;
+    return 0;
+}
+
+int ws_notifier_set_busy_poll(ws_notifier_t *notifier, int busy_poll_usecs, int budget) {
+    if (!notifier || busy_poll_usecs < 0 || budget < 0) {
+        return -1;
     }
 
 #ifdef __linux__
-    struct epoll_event events[1];
-    static const int TIMEOUT_MS = 100;  // Fixed 100ms timeout for HFT
-    epoll_wait(notifier->epoll_fd, events, 1, TIMEOUT_MS);
+    notifier->busy_poll_usecs = busy_poll_usecs;
+    notifier->busy_poll_budget = budget;
+
+#ifdef WS_HAVE_IO_URING
+    if (notifier->uring) {
+        // No epoll instance: per-socket SO_BUSY_POLL only
+        for (int fd = 0; fd < notifier->fd_data_cap; fd++) {
+            if (notifier->fd_registered[fd]) {
+                notifier_apply_busy_poll(notifier, fd);
+            }
+        }
+        return 0;
+    }
+#endif
+
+    // Per-epoll busy poll (Linux 6.9+): epoll_wait itself polls the NIC queues
+    // Older kernels return ENOTTY - per-socket SO_BUSY_POLL below still applies
+    struct epoll_params params;
+    memset(&params, 0, sizeof(params));
+    params.busy_poll_usecs = (uint32_t)busy_poll_usecs;
+    params.busy_poll_budget = (uint16_t)(budget > 0xFFFF ? 0xFFFF : budget);
+    params.prefer_busy_poll = busy_poll_usecs > 0;
+    int epoll_busy_poll = ioctl(notifier->epoll_fd, EPIOCSPARAMS, &params) == 0;
+
+    // Apply to every socket registered so far (future adds pick it up automatically)
+    for (int fd = 0; fd < notifier->fd_data_cap; fd++) {
+        if (notifier->fd_registered[fd]) {
+            notifier_apply_busy_poll(notifier, fd);
+        }
+    }
+
+    return epoll_busy_poll ? 1 : 0;
+#else
+    (void)budget;
+    return busy_poll_usecs == 0 ? 0 : -1;  // Busy poll is a Linux-only feature
+#endif
+}
+
+// Single wait on the backend with the given timeout
+// Results land in notifier->ready; returns raw backend count (-1 on error)
+static int notifier_poll(ws_notifier_t *notifier, int max_events, uint64_t timeout_ns) {
+#ifdef __linux__
+#ifdef WS_HAVE_IO_URING
+    if (notifier->uring) {
+        return uring_poll(notifier, max_events, timeout_ns);
+    }
+#endif
+    if (timeout_ns == 0) {
+        return epoll_wait(notifier->epoll_fd, notifier->ready, max_events, 0);
+    }
+    if (timeout_ns == WS_NOTIFIER_NO_TIMEOUT) {
+        return epoll_wait(notifier->epoll_fd, notifier->ready, max_events, -1);
+    }
+#ifdef WS_HAVE_EPOLL_PWAIT2
+    if (__builtin_expect(!notifier->no_pwait2, 1)) {
+        struct timespec ts;
+        ts.tv_sec = (time_t)(timeout_ns / 1000000000ULL);
+        ts.tv_nsec = (long)(timeout_ns % 1000000000ULL);
+        int n = epoll_pwait2(notifier->epoll_fd, notifier->ready, max_events, &ts, NULL);
+        if (__builtin_expect(n >= 0 || errno != ENOSYS, 1)) {
+            return n;
+        }
+        notifier->no_pwait2 = 1;  // Pre-5.11 kernel - use millisecond granularity from now on
+    }
+#endif
+    // Round up so short timeouts don't degrade into a busy loop
+    uint64_t timeout_ms = (timeout_ns + 999999ULL) / 1000000ULL;
+    if (timeout_ms > 0x7FFFFFFF) timeout_ms = 0x7FFFFFFF;
+    return epoll_wait(notifier->epoll_fd, notifier->ready, max_events, (int)timeout_ms);
 
 #elif defined(__APPLE__)
-    struct kevent events[1];
-    static const struct timespec TIMEOUT = {0, 100000000};  // Fixed 100ms timeout for HFT
-    kevent(notifier->kqueue_fd, NULL, 0, events, 1, &TIMEOUT);
+    if (timeout_ns == WS_NOTIFIER_NO_TIMEOUT) {
+        return kevent(notifier->kqueue_fd, NULL, 0, notifier->ready, max_events, NULL);
+    }
+    struct timespec ts;
+    ts.tv_sec = (time_t)(timeout_ns / 1000000000ULL);
+    ts.tv_nsec = (long)(timeout_ns % 1000000000ULL);
+    return kevent(notifier->kqueue_fd, NULL, 0, notifier->ready, max_events, &ts);
+
+#else
+    (void)notifier;
+    (void)max_events;
+    (void)timeout_ns;
+    return -1;
+#endif
+}
+
+// Shorten the wait so the earliest timer is not fired late
+static uint64_t notifier_timer_timeout(const ws_notifier_t *notifier, uint64_t timeout_ns) {
+    uint64_t next = ws_timer_wheel_next(notifier->timers);
+    if (next == WS_TIMER_NEVER || timeout_ns == 0) return timeout_ns;
+    uint64_t now = os_get_cpu_cycle();
+    if (next <= now) return 0;
+    uint64_t until_ns = os_cycles_to_ns_u64(next - now) + 1;
+    return until_ns < timeout_ns ? until_ns : timeout_ns;
+}
 
+// Wait according to the configured mode
+static int notifier_wait_mode(ws_notifier_t *notifier, int max_events) {
+    uint64_t timeout_ns = notifier->timeout_ns;
+    if (__builtin_expect(notifier->timers != NULL, 0)) {
+        timeout_ns = notifier_timer_timeout(notifier, timeout_ns);
+    }
+
+    if (__builtin_expect(notifier->mode == WS_NOTIFIER_MODE_ADAPTIVE, 0)) {
+        // Spin phase: zero-timeout polls separated by os_pause() until the cycle budget expires
+        uint64_t start = os_get_cpu_cycle();
+        do {
+            int n = notifier_poll(notifier, max_events, 0);
+            if (n != 0) {
+                return n;
+            }
+            os_pause();
+        } while (os_get_cpu_cycle() - start < notifier->spin_cycles);
+    }
+
+    return notifier_poll(notifier, max_events, timeout_ns);
+}
+
+// Fire due timers once the events are collected (one TSC read, no syscall)
+static inline void notifier_run_timers(ws_notifier_t *notifier) {
+    if (__builtin_expect(notifier->timers != NULL, 0)) {
+        ws_timer_wheel_advance(notifier->timers, os_get_cpu_cycle());
+    }
+}
+
+ws_timer_wheel_t *ws_notifier_timers(ws_notifier_t *notifier) {
+    if (!notifier) return NULL;
+    if (!notifier->timers) notifier->timers = ws_timer_wheel_create(0);
+    return notifier->timers;
+}
+
+int ws_notifier_wait(ws_notifier_t *notifier) {
+    if (!notifier) {
+        return -1;
+    }
+
+#if defined(__linux__) || defined(__APPLE__)
+    int n = notifier_wait_mode(notifier, 1);
+    notifier_run_timers(notifier);
+    return n;
+#else
+    return -1;
+#endif
+}
+int ws_notifier_wait_events(ws_notifier_t *notifier, ws_notifier_event_t *events, int max_events) {
+    if (!notifier || !events || max_events <= 0) {
+        return -1;
+    }
+    if (max_events > WS_NOTIFIER_MAX_EVENTS) {
+        max_events = WS_NOTIFIER_MAX_EVENTS;
+    }
+
+#ifdef __linux__
+    int n = notifier_wait_mode(notifier, max_events);
+    if (__builtin_expect(n < 0, 0)) {
+        if (errno != EINTR) return -1;
+        notifier_run_timers(notifier);
+        return 0;
+    }
+
+    for (int i = 0; i < n; i++) {
+        const struct epoll_event *ev = &notifier->ready[i];
+        int mask = 0;
+        if (ev->events & EPOLLIN)  mask |= WS_EVENT_READ;
+        if (ev->events & EPOLLOUT) mask |= WS_EVENT_WRITE;
+        if (__builtin_expect(ev->events & (EPOLLERR | EPOLLHUP), 0)) {
+            // Report READ too so ws_update() observes EOF/error through SSL_read
+            mask |= WS_EVENT_ERROR | WS_EVENT_READ;
+        }
+        events[i].user_data = ev->data.ptr;
+        events[i].events = mask;
+    }
+    notifier_run_timers(notifier);
+    return n;
+
+#elif defined(__APPLE__)
+    int n = notifier_wait_mode(notifier, max_events);
+    if (__builtin_expect(n < 0, 0)) {
+        if (errno != EINTR) return -1;
+        notifier_run_timers(notifier);
+        return 0;
+    }
+
+    // kqueue reports READ and WRITE filters separately - merge per fd
+    uintptr_t idents[WS_NOTIFIER_MAX_EVENTS];
+    int out = 0;
+    for (int i = 0; i < n; i++) {
+        const struct kevent *kev = &notifier->ready[i];
+        int mask = 0;
+        if (kev->filter == EVFILT_READ)  mask |= WS_EVENT_READ;
+        if (kev->filter == EVFILT_WRITE) mask |= WS_EVENT_WRITE;
+        if (__builtin_expect(kev->flags & (EV_ERROR | EV_EOF), 0)) {
+            mask |= WS_EVENT_ERROR | WS_EVENT_READ;
+        }
+
+        int merged = 0;
+        for (int j = 0; j < out; j++) {
+            if (idents[j] == kev->ident) {
+                events[j].events |= mask;
+                merged = 1;
+                break;
+            }
+        }
+        if (!merged) {
+            idents[out] = kev->ident;
+            events[out].user_data = kev->udata;
+            events[out].events = mask;
+            out++;
+        }
+    }
+    notifier_run_timers(notifier);
+    return out;
+
+#else
+    return -1;
+#endif
+}
+
+int ws_notifier_io_attach(ws_notifier_t *notifier, int fd) {
+#ifdef WS_HAVE_IO_URING
+    if (!notifier || !notifier->uring_io || fd < 0 || fd >= notifier->fd_data_cap || !notifier->fd_registered[fd]) {
+        return -1;
+    }
+    ws_uring_io_t *io = &notifier->fd_io[fd];
+    if (io->on) return 0;
+    if (uring_disarm(notifier, fd) < 0) return -1;  // Readiness poll off: completions take over
+    notifier->fd_events[fd] &= (uint8_t)~WS_URING_REARM;
+    memset(io, 0, sizeof(*io));
+    io->on = 1;
+    if (notifier->fd_events[fd] & WS_EVENT_WRITE) {
+        io->wake_queued = uring_io_queue(notifier, fd, WS_URING_OP_WAKE, NULL, 0) == 0;
+    }
+    return 0;
+#else
+    (void)notifier;
+    (void)fd;
+    return -1;
+#endif
+}
+
+int ws_notifier_io_recv(ws_notifier_t *notifier, int fd, uint8_t *buf, size_t len) {
+#ifdef WS_HAVE_IO_URING
+    ws_uring_io_t *io = uring_io_get(notifier, fd);
+    if (!io) return -1;
+    if (io->rx_state == WS_URING_IO_INFLIGHT) return 0;
+    if (io->rx_state == WS_URING_IO_DONE) {
+        io->rx_state = WS_URING_IO_IDLE;
+        if (io->rx_res != -EAGAIN) {
+            if (buf != io->rx_buf) return -1;  // The data landed in the previous buffer
+            return io->rx_res > 0 ? io->rx_res : -1;
+        }
+    }
+    if (len == 0) return 0;
+    if (len > INT32_MAX) len = INT32_MAX;
+    if (uring_io_queue(notifier, fd, WS_URING_OP_RECV, buf, (uint32_t)len) < 0) return 0;  // Retried by the next call
+    io->rx_buf = buf;
+    io->rx_len = (uint32_t)len;
+    io->rx_state = WS_URING_IO_INFLIGHT;
+    return 0;
+#else
+    (void)notifier;
+    (void)fd;
+    (void)buf;
+    (void)len;
+    return -1;
+#endif
+}
+
+int ws_notifier_io_send(ws_notifier_t *notifier, int fd, const uint8_t *buf, size_t len) {
+#ifdef WS_HAVE_IO_URING
+    ws_uring_io_t *io = uring_io_get(notifier, fd);
+    if (!io) return -1;
+    if (io->tx_state != WS_URING_IO_IDLE || len == 0) return 0;
+    if (len > INT32_MAX) len = INT32_MAX;
+    if (uring_io_queue(notifier, fd, WS_URING_OP_SEND, buf, (uint32_t)len) < 0) return 0;
+    io->tx_buf = buf;
+    io->tx_len = (uint32_t)len;
+    io->tx_state = WS_URING_IO_INFLIGHT;
+    return 0;
+#else
+    (void)notifier;
+    (void)fd;
+    (void)buf;
+    (void)len;
+    return -1;
+#endif
+}
+
+int ws_notifier_io_sent(ws_notifier_t *notifier, int fd) {
+#ifdef WS_HAVE_IO_URING
+    ws_uring_io_t *io = uring_io_get(notifier, fd);
+    if (!io) return -1;
+    if (io->tx_state != WS_URING_IO_DONE) return 0;
+    io->tx_state = WS_URING_IO_IDLE;
+    if (io->tx_res == -EAGAIN) {
+        // Same bytes again: the caller counts them only once they are sent
+        if (uring_io_queue(notifier, fd, WS_URING_OP_SEND, io->tx_buf, io->tx_len) == 0) {
+            io->tx_state = WS_URING_IO_INFLIGHT;
+        }
+        return 0;
+    }
+    return io->tx_res > 0 ? io->tx_res : -1;
+#else
+    (void)notifier;
+    (void)fd;
+    return -1;
+#endif
+}
+
+int ws_notifier_io_detach(ws_notifier_t *notifier, int fd, int *rx, int *tx) {
+    if (rx) *rx = 0;
+    if (tx) *tx = 0;
+#ifdef WS_HAVE_IO_URING
+    ws_uring_io_t *io = uring_io_get(notifier, fd);
+    if (!io) return -1;
+    uring_io_stop(notifier, fd);
+    if (rx && io->rx_state == WS_URING_IO_DONE && io->rx_res > 0) *rx = io->rx_res;
+    if (tx && io->tx_state == WS_URING_IO_DONE && io->tx_res > 0) *tx = io->tx_res;
+    memset(io, 0, sizeof(*io));
+    return uring_arm(notifier, fd);  // Back to readiness
+#else
+    (void)notifier;
+    (void)fd;
+    return -1;
 #endif
 }
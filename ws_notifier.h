@@ -1,8 +1,11 @@
 #ifndef WS_NOTIFIER_H
 #define WS_NOTIFIER_H
 
+#include <stdint.h>
+#include <stddef.h>
+
 // Unified event notification backend for WebSocket
-// Abstracts epoll (Linux) and kqueue (macOS)
+// Abstracts epoll (Linux), io_uring (Linux, opt-in) and kqueue (macOS)
 
 typedef struct ws_notifier ws_notifier_t;
 
@@ -11,20 +14,68 @@ typedef struct ws_notifier ws_notifier_t;
 #define WS_EVENT_WRITE (1 << 1)
 #define WS_EVENT_ERROR (1 << 2)
 
+// Maximum number of ready events returned by a single ws_notifier_wait_events() call
+// Larger max_events values are clamped to this limit
+#define WS_NOTIFIER_MAX_EVENTS 256
+
+// Wait modes (see ws_notifier_set_mode)
+typedef enum {
+    WS_NOTIFIER_MODE_BLOCKING,   // Block until an event arrives (no timeout)
+    WS_NOTIFIER_MODE_TIMEOUT,    // Block up to timeout_ns (0 = pure busy-poll, never sleeps)
+    WS_NOTIFIER_MODE_ADAPTIVE    // Spin with os_pause() for spin_cycles, then block up to timeout_ns
+} ws_notifier_mode_t;
+
+// Timeout sentinel: block indefinitely
+#define WS_NOTIFIER_NO_TIMEOUT UINT64_MAX
+
+// Ready event returned by ws_notifier_wait_events()
+// user_data is the pointer registered with ws_notifier_add() (typically the websocket_context_t)
+typedef struct {
+    void *user_data;  // Pointer registered with ws_notifier_add()
+    int events;       // Bitmask of WS_EVENT_* flags
+} ws_notifier_event_t;
+
+// Readiness backends (see ws_notifier_init_ex)
+typedef enum {
+    WS_NOTIFIER_BACKEND_DEFAULT,   // epoll on Linux, kqueue on macOS
+    WS_NOTIFIER_BACKEND_IO_URING   // Linux 5.11+: multishot poll, ready events read from the CQ ring
+} ws_notifier_backend_t;
+
+// io_uring flags
+#define WS_NOTIFIER_URING_SQPOLL (1 << 0)  // Kernel thread submits (needs CAP_SYS_NICE before 5.11)
+#define WS_NOTIFIER_URING_IO     (1 << 1)  // Data path (ws_notifier_io_*, Linux 6.0+): bound plain
+                                           // TCP contexts read and write through the ring
+
 // Initialize notifier
 // Returns NULL on failure
 ws_notifier_t* ws_notifier_init(void);
 
+// Initialize notifier with an explicit backend
+// io_uring: readiness arrives as CQEs in shared memory, so busy-poll waits (timeout 0,
+// ADAPTIVE spin) and registration changes (queued until the next wait) cost no syscall;
+// with SQPOLL blocking waits are the only syscalls left. Sockets are read and written
+// exactly as with epoll unless WS_NOTIFIER_URING_IO moves them onto the data path below.
+// Falls back to the default backend with a warning when io_uring is unavailable (old
+// kernel, io_uring_disabled, seccomp)
+// Returns NULL on failure
+ws_notifier_t* ws_notifier_init_ex(ws_notifier_backend_t backend, int flags);
+
+// Backend actually in use
+ws_notifier_backend_t ws_notifier_get_backend(const ws_notifier_t *notifier);
+
 // Free notifier
 void ws_notifier_free(ws_notifier_t *notifier);
 
 // Add file descriptor to notifier
 // events: bitmask of WS_EVENT_* flags
+// user_data: opaque pointer returned with every ready event for this fd (may be NULL)
+//            Stored in epoll_event.data.ptr / kevent.udata - no lookup on the hot path
 // Returns 0 on success, -1 on failure
-int ws_notifier_add(ws_notifier_t *notifier, int fd, int events);
+int ws_notifier_add(ws_notifier_t *notifier, int fd, int events, void *user_data);
 
 // Modify file descriptor events
 // events: bitmask of WS_EVENT_* flags
+// The user_data registered with ws_notifier_add() is preserved
 // Returns 0 on success, -1 on failure
 int ws_notifier_mod(ws_notifier_t *notifier, int fd, int events);
 
@@ -32,8 +83,72 @@ int ws_notifier_mod(ws_notifier_t *notifier, int fd, int events);
 // Returns 0 on success, -1 on failure
 int ws_notifier_del(ws_notifier_t *notifier, int fd);
 
-// Wait for events (fixed 100ms timeout for HFT use case)
+// Select how ws_notifier_wait()/ws_notifier_wait_events() wait (default: TIMEOUT, 100ms)
+//   BLOCKING: timeout_ns and spin_cycles ignored
+//   TIMEOUT:  timeout_ns = 0 polls without sleeping (isolated cores)
+//   ADAPTIVE: spin_cycles in os_get_cpu_cycle() units, then block up to timeout_ns
+//             (WS_NOTIFIER_NO_TIMEOUT to block indefinitely after the spin phase)
+// Returns 0 on success, -1 on invalid arguments
+int ws_notifier_set_mode(ws_notifier_t *notifier, ws_notifier_mode_t mode,
+                         uint64_t timeout_ns, uint64_t spin_cycles);
+
+// Enable kernel busy polling of the NIC receive queue (Linux only)
+// busy_poll_usecs: SO_BUSY_POLL value for every registered socket (0 disables)
+// budget: packets per busy-poll pass (0 = kernel default)
+// Also configures per-epoll busy polling (EPIOCSPARAMS) on Linux 6.9+
+// Values above net.core.busy_read may require CAP_NET_ADMIN
+// Returns 1 if epoll-level busy poll is active, 0 if only per-socket SO_BUSY_POLL, -1 on error
+int ws_notifier_set_busy_poll(ws_notifier_t *notifier, int busy_poll_usecs, int budget);
+
+// Wait for events using the configured mode (default: 100ms timeout)
 // Blocks until events are available (errors handled by callbacks)
-void ws_notifier_wait(ws_notifier_t *notifier);
+// Returns number of ready file descriptors (0 on timeout, -1 on error)
+int ws_notifier_wait(ws_notifier_t *notifier);
+
+// Batched wait: fill events[] with up to max_events ready (user_data, event-mask) pairs
+// Drive only the returned connections, e.g.:
+//   int n = ws_notifier_wait_events(notifier, events, 64);
+//   for (int i = 0; i < n; i++) ws_update(events[i].user_data);
+// Returns number of events written (0 on timeout or EINTR, -1 on error)
+int ws_notifier_wait_events(ws_notifier_t *notifier, ws_notifier_event_t *events, int max_events);
+
+// io_uring data path (WS_NOTIFIER_URING_IO): RECV and SEND requests replace readiness plus
+// recv()/send(), their completions are fd's events (READ for a RECV, WRITE for a SEND or
+// new WRITE interest). Submissions go out with the next wait, so a receive batch costs
+// one io_uring_enter instead of epoll_wait + recv + send (with SQPOLL only blocking
+// waits enter).
+// ws_set_notifier() attaches ws:// contexts without RX timestamps by itself (register
+// the fd first); TLS stays on readiness: OpenSSL reads the records, kTLS needs cmsgs.
+// One RECV and one SEND per fd in flight; their buffers belong to the kernel until the
+// result is collected or the fd is detached (ws_notifier_del() detaches too, dropping
+// uncollected results). Detach before closing the socket or freeing the notifier.
+
+// Move a registered fd onto the data path (its readiness poll is cancelled)
+// Returns 0, -1 if the notifier has no data path or fd is not registered
+int ws_notifier_io_attach(ws_notifier_t *notifier, int fd);
+
+// Receive into buf: bytes of the completed RECV (> 0), 0 if it is still in flight or was
+// just queued for up to len bytes, -1 on EOF or error. After a 0 the next call must pass
+// the same buf until it returns > 0
+int ws_notifier_io_recv(ws_notifier_t *notifier, int fd, uint8_t *buf, size_t len);
+
+// Queue a SEND of len bytes from buf, collected with ws_notifier_io_sent()
+// Returns 0 (queued, or a SEND is already in flight: nothing queued), -1 if not attached
+int ws_notifier_io_send(ws_notifier_t *notifier, int fd, const uint8_t *buf, size_t len);
+
+// Bytes the last SEND wrote (> 0, possibly short), 0 if none completed, -1 on error
+int ws_notifier_io_sent(ws_notifier_t *notifier, int fd);
+
+// Leave the data path: requests in flight are cancelled synchronously (their buffers are
+// free on return) and fd is polled for readiness again
+// rx/tx: bytes of a RECV/SEND that completed but was not collected (may be NULL)
+// Returns 0, -1 if fd is not attached
+int ws_notifier_io_detach(ws_notifier_t *notifier, int fd, int *rx, int *tx);
+
+// Timing wheel shared by every context bound with ws_set_notifier() (heartbeats, see
+// ws_set_heartbeat), created on first use. Both waits fire due timers after collecting
+// events and never block past the earliest one. Returns NULL on allocation failure
+typedef struct ws_timer_wheel ws_timer_wheel_t;
+ws_timer_wheel_t *ws_notifier_timers(ws_notifier_t *notifier);
 
 #endif // WS_NOTIFIER_H
@@ -0,0 +1,483 @@
+#include "ws_pool.h"
+#include "ws_stats.h"
+#include "ringbuffer.h"
+#include "os.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <pthread.h>
+
+#define WS_POOL_CMD_DEPTH 64   // Control -> worker commands in flight (power of two)
+#define WS_POOL_BATCH 64       // Ready events per notifier wait
+
+#define POOL_LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define POOL_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+enum { POOL_CMD_ADD = 1, POOL_CMD_REMOVE = 2 };
+
+typedef struct ws_pool_conn {
+    // === CONTROL-OWNED CACHE LINE ===
+    websocket_context_t *ws;
+    int shard;                   // Worker the control thread assigned
+    uint64_t busy_last;          // Rebalance snapshot of busy_cycles
+
+    // === WORKER-OWNED CACHE LINE ===
+    uint64_t busy_cycles __attribute__((aligned(CACHE_LINE_SIZE)));
+    int fd;                      // Registered with the notifier, -1 while polled
+    int closed;                  // Connection ended, no longer driven
+    uint32_t index;              // Slot in the worker's list
+    int detached;                // Release-stored by the worker once it let go
+} ws_pool_conn_t;
+
+typedef struct {
+    int op;
+    ws_pool_conn_t *conn;
+} ws_pool_cmd_t;
+
+typedef struct {
+    // === CONTROL-OWNED CACHE LINE ===
+    uint64_t cmd_head __attribute__((aligned(CACHE_LINE_SIZE)));
+    int stop;
+    uint32_t assigned;           // Connections placed here (placement view, ahead of the worker)
+    uint64_t busy_last;          // Rebalance snapshot of stats.busy_cycles
+
+    // === WORKER-OWNED CACHE LINE ===
+    uint64_t cmd_tail __attribute__((aligned(CACHE_LINE_SIZE)));
+    ws_pool_shard_stats_t stats;
+
+    // === WORKER-PRIVATE ===
+    ws_notifier_t *notifier __attribute__((aligned(CACHE_LINE_SIZE)));
+    ws_pool_conn_t **conns;
+    uint32_t count;
+    uint32_t cap;
+    uint32_t polled;             // Connections without a registered fd yet
+    int polling;                 // Notifier currently in busy-poll mode
+    int wake_rd;
+    int wake_wr;
+    int cpu;
+    int rt_priority;
+    ws_notifier_mode_t wait_mode;
+    uint64_t wait_timeout_ns;
+    uint64_t spin_cycles;
+    pthread_t thread;
+    int started;
+
+    // === COMMAND SLOTS (control writes, worker reads after the head release) ===
+    ws_pool_cmd_t cmds[WS_POOL_CMD_DEPTH] __attribute__((aligned(CACHE_LINE_SIZE)));
+} __attribute__((aligned(CACHE_LINE_SIZE))) ws_pool_worker_t;
+
+_Static_assert(sizeof(ws_pool_worker_t) % CACHE_LINE_SIZE == 0, "workers must not share cache lines");
+
+struct ws_pool {
+    ws_pool_worker_t *workers;
+    int nworkers;
+    ws_pool_hash_fn hash;
+    void *hash_arg;
+    ws_pool_conn_t **conns;      // Registry (control thread only)
+    size_t count;
+    size_t cap;
+    uint64_t rebalance_last;     // Cycle of the previous ws_pool_rebalance()
+};
+
+// FNV-1a
+static uint32_t pool_default_hash(const char *key, void *arg __attribute__((unused))) {
+    uint32_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)key; *p; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// ============================================================================
+// Worker side
+// ============================================================================
+
+static void worker_register(ws_pool_worker_t *w, ws_pool_conn_t *c) {
+    int fd = ws_get_fd(c->ws);
+    if (fd < 0 || ws_get_state(c->ws) != WS_STATE_CONNECTED) return;
+
+    int events = WS_EVENT_READ | (ws_wants_write(c->ws) ? WS_EVENT_WRITE : 0);
+    if (ws_notifier_add(w->notifier, fd, events, c) < 0) {
+        fprintf(stderr, "Warning: ws_pool cannot register fd %d, polling it instead\n", fd);
+        return;
+    }
+    ws_set_notifier(c->ws, w->notifier);
+    c->fd = fd;
+    w->polled--;
+}
+
+static inline void worker_update(ws_pool_worker_t *w, ws_pool_conn_t *c) {
+    uint64_t start = os_get_cpu_cycle();
+    ws_update(c->ws);
+    uint64_t cycles = os_get_cpu_cycle() - start;
+    WS_STAT_ADD(c->busy_cycles, cycles);
+    WS_STAT_ADD(w->stats.busy_cycles, cycles);
+    WS_STAT_ADD(w->stats.updates, 1);
+
+    ws_state_t state = ws_get_state(c->ws);
+    if (__builtin_expect(state == WS_STATE_CLOSED, 0)) {
+        if (c->fd >= 0) {
+            ws_notifier_del(w->notifier, c->fd);
+            ws_set_notifier(c->ws, NULL);
+            c->fd = -1;
+        } else {
+            w->polled--;
+        }
+        c->closed = 1;
+    } else if (__builtin_expect(c->fd >= 0 && state != WS_STATE_CONNECTED, 0)) {
+        // Reconnecting: ws_reconnect() removes the old fd from our notifier itself
+        c->fd = -1;
+        w->polled++;
+    } else if (__builtin_expect(c->fd < 0, 0)) {
+        worker_register(w, c);  // Handshake finished (fd-less contexts stay polled)
+    }
+}
+
+static void worker_attach(ws_pool_worker_t *w, ws_pool_conn_t *c) {
+    if (w->count == w->cap) {
+        uint32_t cap = w->cap ? w->cap * 2 : 16;
+        ws_pool_conn_t **conns = (ws_pool_conn_t **)realloc(w->conns, cap * sizeof(*conns));
+        if (!conns) {
+            fprintf(stderr, "Warning: ws_pool worker out of memory, connection not driven\n");
+            return;
+        }
+        w->conns = conns;
+        w->cap = cap;
+    }
+    c->index = w->count;
+    c->fd = -1;
+    c->closed = ws_get_state(c->ws) == WS_STATE_CLOSED;
+    w->conns[w->count++] = c;
+    WS_STAT_ADD(w->stats.connections, 1);
+    if (!c->closed) {
+        w->polled++;
+        worker_register(w, c);
+    }
+}
+
+static void worker_detach(ws_pool_worker_t *w, ws_pool_conn_t *c) {
+    if (c->index < w->count && w->conns[c->index] == c) {
+        if (c->fd >= 0) {
+            ws_notifier_del(w->notifier, c->fd);
+            ws_set_notifier(c->ws, NULL);
+            c->fd = -1;
+        } else if (!c->closed) {
+            w->polled--;
+        }
+        ws_pool_conn_t *last = w->conns[--w->count];
+        w->conns[c->index] = last;
+        last->index = c->index;
+        __atomic_store_n(&w->stats.connections, w->stats.connections - 1, __ATOMIC_RELAXED);
+    }
+    POOL_STORE_RELEASE(&c->detached, 1);  // Control thread owns c->ws again
+}
+
+static void worker_drain_commands(ws_pool_worker_t *w) {
+    uint64_t tail = w->cmd_tail;
+    uint64_t head = POOL_LOAD_ACQUIRE(&w->cmd_head);
+    while (tail != head) {
+        ws_pool_cmd_t cmd = w->cmds[tail & (WS_POOL_CMD_DEPTH - 1)];
+        POOL_STORE_RELEASE(&w->cmd_tail, ++tail);
+        if (cmd.op == POOL_CMD_ADD) {
+            worker_attach(w, cmd.conn);
+        } else {
+            worker_detach(w, cmd.conn);
+        }
+    }
+}
+
+static void worker_drain_wake(ws_pool_worker_t *w) {
+    char buf[64];
+    while (read(w->wake_rd, buf, sizeof(buf)) > 0) {}
+}
+
+static void *worker_main(void *arg) {
+    ws_pool_worker_t *w = (ws_pool_worker_t *)arg;
+
+    if (w->cpu >= 0 && os_set_thread_affinity(w->cpu) < 0) {
+        fprintf(stderr, "Warning: ws_pool cannot pin worker to CPU %d\n", w->cpu);
+    }
+    if (w->rt_priority > 0 && os_set_thread_realtime_priority(w->rt_priority) < 0) {
+        fprintf(stderr, "Warning: ws_pool cannot set RT priority %d (need CAP_SYS_NICE)\n", w->rt_priority);
+    }
+
+    ws_notifier_event_t events[WS_POOL_BATCH];
+    while (!POOL_LOAD_ACQUIRE(&w->stop)) {
+        worker_drain_commands(w);
+
+        // Busy-poll while some connection has no fd to wait on
+        int want_poll = w->polled > 0;
+        if (__builtin_expect(want_poll != w->polling, 0)) {
+            if (want_poll) {
+                ws_notifier_set_mode(w->notifier, WS_NOTIFIER_MODE_TIMEOUT, 0, 0);
+            } else {
+                ws_notifier_set_mode(w->notifier, w->wait_mode, w->wait_timeout_ns, w->spin_cycles);
+            }
+            w->polling = want_poll;
+        }
+
+        int n = ws_notifier_wait_events(w->notifier, events, WS_POOL_BATCH);
+        if (n > 0) WS_STAT_ADD(w->stats.wakeups, 1);
+        for (int i = 0; i < n; i++) {
+            if (__builtin_expect(events[i].user_data == w, 0)) {
+                worker_drain_wake(w);
+                continue;
+            }
+            worker_update(w, (ws_pool_conn_t *)events[i].user_data);
+        }
+
+        if (__builtin_expect(w->polled > 0, 0)) {
+            for (uint32_t i = 0; i < w->count; i++) {
+                ws_pool_conn_t *c = w->conns[i];
+                if (c->fd < 0 && !c->closed) worker_update(w, c);
+            }
+        }
+    }
+
+    // Hand every connection back before exiting
+    worker_drain_commands(w);
+    while (w->count > 0) worker_detach(w, w->conns[w->count - 1]);
+    return NULL;
+}
+
+// ============================================================================
+// Control side
+// ============================================================================
+
+static void post_command(ws_pool_worker_t *w, int op, ws_pool_conn_t *c) {
+    uint64_t head = w->cmd_head;
+    while (head - POOL_LOAD_ACQUIRE(&w->cmd_tail) >= WS_POOL_CMD_DEPTH) sched_yield();
+    w->cmds[head & (WS_POOL_CMD_DEPTH - 1)] = (ws_pool_cmd_t){ op, c };
+    POOL_STORE_RELEASE(&w->cmd_head, head + 1);
+
+    char b = 1;
+    if (write(w->wake_wr, &b, 1) < 0) {
+        // Pipe full: a wakeup is already pending
+    }
+}
+
+// Ask the owning worker to let go of c and wait until it did
+static void detach_sync(ws_pool_t *pool, ws_pool_conn_t *c) {
+    ws_pool_worker_t *w = &pool->workers[c->shard];
+    post_command(w, POOL_CMD_REMOVE, c);
+    while (!POOL_LOAD_ACQUIRE(&c->detached)) sched_yield();
+    c->detached = 0;
+    w->assigned--;
+}
+
+static void attach(ws_pool_t *pool, ws_pool_conn_t *c, int shard) {
+    c->shard = shard;
+    pool->workers[shard].assigned++;
+    post_command(&pool->workers[shard], POOL_CMD_ADD, c);
+}
+
+static ws_pool_conn_t *find_conn(const ws_pool_t *pool, websocket_context_t *ws, size_t *index) {
+    for (size_t i = 0; i < pool->count; i++) {
+        if (pool->conns[i]->ws == ws) {
+            if (index) *index = i;
+            return pool->conns[i];
+        }
+    }
+    return NULL;
+}
+
+static int set_nonblock(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags < 0 ? -1 : fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+ws_pool_t *ws_pool_create(const ws_pool_options_t *opts) {
+    if (!opts || opts->workers < 1 || opts->workers > WS_POOL_MAX_WORKERS) return NULL;
+
+    ws_pool_t *pool = (ws_pool_t *)calloc(1, sizeof(ws_pool_t));
+    if (!pool) return NULL;
+    if (posix_memalign((void **)&pool->workers, CACHE_LINE_SIZE,
+                       (size_t)opts->workers * sizeof(ws_pool_worker_t)) != 0) {
+        free(pool);
+        return NULL;
+    }
+    memset(pool->workers, 0, (size_t)opts->workers * sizeof(ws_pool_worker_t));
+    pool->hash = opts->hash ? opts->hash : pool_default_hash;
+    pool->hash_arg = opts->hash_arg;
+
+    int default_wait = opts->wait_mode == WS_NOTIFIER_MODE_BLOCKING && opts->wait_timeout_ns == 0 &&
+                       opts->spin_cycles == 0;
+    for (int i = 0; i < opts->workers; i++) {
+        ws_pool_worker_t *w = &pool->workers[i];
+        w->wake_rd = w->wake_wr = -1;
+        w->cpu = opts->cpus ? opts->cpus[i] : -1;
+        w->rt_priority = opts->rt_priority;
+        w->wait_mode = default_wait ? WS_NOTIFIER_MODE_TIMEOUT : opts->wait_mode;
+        w->wait_timeout_ns = default_wait ? 1000000ULL : opts->wait_timeout_ns;  // 1ms
+        w->spin_cycles = opts->spin_cycles;
+        pool->nworkers = i + 1;
+
+        int fds[2];
+        w->notifier = ws_notifier_init();
+        if (!w->notifier || pipe(fds) < 0) {
+            ws_pool_destroy(pool);
+            return NULL;
+        }
+        w->wake_rd = fds[0];
+        w->wake_wr = fds[1];
+        if (set_nonblock(w->wake_rd) < 0 || set_nonblock(w->wake_wr) < 0 ||
+            ws_notifier_add(w->notifier, w->wake_rd, WS_EVENT_READ, w) < 0 ||
+            ws_notifier_set_mode(w->notifier, w->wait_mode, w->wait_timeout_ns, w->spin_cycles) < 0) {
+            ws_pool_destroy(pool);
+            return NULL;
+        }
+
+        if (pthread_create(&w->thread, NULL, worker_main, w) != 0) {
+            ws_pool_destroy(pool);
+            return NULL;
+        }
+        w->started = 1;
+    }
+    return pool;
+}
+
+void ws_pool_destroy(ws_pool_t *pool) {
+    if (!pool) return;
+
+    for (int i = 0; i < pool->nworkers; i++) {
+        ws_pool_worker_t *w = &pool->workers[i];
+        if (w->started) {
+            POOL_STORE_RELEASE(&w->stop, 1);
+            char b = 1;
+            if (write(w->wake_wr, &b, 1) < 0) {
+                // Wakeup already pending
+            }
+            pthread_join(w->thread, NULL);
+        }
+        if (w->wake_rd >= 0) close(w->wake_rd);
+        if (w->wake_wr >= 0) close(w->wake_wr);
+        ws_notifier_free(w->notifier);
+        free(w->conns);
+    }
+    for (size_t i = 0; i < pool->count; i++) free(pool->conns[i]);
+    free(pool->conns);
+    free(pool->workers);
+    free(pool);
+}
+
+int ws_pool_workers(const ws_pool_t *pool) {
+    return pool ? pool->nworkers : 0;
+}
+
+int ws_pool_add(ws_pool_t *pool, websocket_context_t *ws, const char *key, int shard) {
+    if (!pool || !ws || shard >= pool->nworkers || find_conn(pool, ws, NULL)) return -1;
+
+    if (shard < 0) {
+        if (key) {
+            shard = (int)(pool->hash(key, pool->hash_arg) % (uint32_t)pool->nworkers);
+        } else {
+            shard = 0;
+            for (int i = 1; i < pool->nworkers; i++) {
+                if (pool->workers[i].assigned < pool->workers[shard].assigned) shard = i;
+            }
+        }
+    }
+
+    if (pool->count == pool->cap) {
+        size_t cap = pool->cap ? pool->cap * 2 : 16;
+        ws_pool_conn_t **conns = (ws_pool_conn_t **)realloc(pool->conns, cap * sizeof(*conns));
+        if (!conns) return -1;
+        pool->conns = conns;
+        pool->cap = cap;
+    }
+
+    ws_pool_conn_t *c = NULL;
+    if (posix_memalign((void **)&c, CACHE_LINE_SIZE, sizeof(ws_pool_conn_t)) != 0) return -1;
+    memset(c, 0, sizeof(*c));
+    c->ws = ws;
+    c->fd = -1;
+    pool->conns[pool->count++] = c;
+
+    attach(pool, c, shard);
+    return shard;
+}
+
+int ws_pool_remove(ws_pool_t *pool, websocket_context_t *ws) {
+    size_t index = 0;
+    ws_pool_conn_t *c = pool ? find_conn(pool, ws, &index) : NULL;
+    if (!c) return -1;
+
+    detach_sync(pool, c);
+    pool->conns[index] = pool->conns[--pool->count];
+    free(c);
+    return 0;
+}
+
+int ws_pool_move(ws_pool_t *pool, websocket_context_t *ws, int shard) {
+    ws_pool_conn_t *c = pool ? find_conn(pool, ws, NULL) : NULL;
+    if (!c || shard < 0 || shard >= pool->nworkers) return -1;
+    if (c->shard == shard) return 0;
+
+    detach_sync(pool, c);
+    attach(pool, c, shard);
+    return 0;
+}
+
+int ws_pool_shard_of(const ws_pool_t *pool, websocket_context_t *ws) {
+    ws_pool_conn_t *c = pool ? find_conn(pool, ws, NULL) : NULL;
+    return c ? c->shard : -1;
+}
+
+void ws_pool_get_shard_stats(const ws_pool_t *pool, int shard, ws_pool_shard_stats_t *out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!pool || shard < 0 || shard >= pool->nworkers) return;
+
+    const ws_pool_shard_stats_t *s = &pool->workers[shard].stats;
+    out->connections = __atomic_load_n(&s->connections, __ATOMIC_RELAXED);
+    out->updates = __atomic_load_n(&s->updates, __ATOMIC_RELAXED);
+    out->busy_cycles = __atomic_load_n(&s->busy_cycles, __ATOMIC_RELAXED);
+    out->wakeups = __atomic_load_n(&s->wakeups, __ATOMIC_RELAXED);
+}
+
+int ws_pool_rebalance(ws_pool_t *pool, double max_imbalance) {
+    if (!pool) return -1;
+
+    uint64_t now = os_get_cpu_cycle();
+    uint64_t window = now - pool->rebalance_last;
+    int first = pool->rebalance_last == 0;
+    pool->rebalance_last = now;
+
+    // Busy share of each worker and connection over the window, snapshots for the next one
+    int hot = 0, cold = 0;
+    double share_hot = -1.0, share_cold = 2.0;
+    for (int i = 0; i < pool->nworkers; i++) {
+        ws_pool_worker_t *w = &pool->workers[i];
+        uint64_t busy = __atomic_load_n(&w->stats.busy_cycles, __ATOMIC_RELAXED);
+        double share = window ? (double)(busy - w->busy_last) / (double)window : 0.0;
+        w->busy_last = busy;
+        if (share > share_hot) { share_hot = share; hot = i; }
+        if (share < share_cold) { share_cold = share; cold = i; }
+    }
+
+    double gap = share_hot - share_cold;
+    ws_pool_conn_t *pick = NULL;
+    double best = gap;
+    for (size_t i = 0; i < pool->count; i++) {
+        ws_pool_conn_t *c = pool->conns[i];
+        uint64_t busy = __atomic_load_n(&c->busy_cycles, __ATOMIC_RELAXED);
+        double share = window ? (double)(busy - c->busy_last) / (double)window : 0.0;
+        c->busy_last = busy;
+
+        // Moving a connection worth the whole gap or more would only swap the hot spot
+        if (c->shard != hot || share <= 0.0 || share >= gap) continue;
+        double miss = share > gap / 2 ? share - gap / 2 : gap / 2 - share;
+        if (miss < best) {
+            best = miss;
+            pick = c;
+        }
+    }
+
+    if (first || hot == cold || gap <= max_imbalance || !pick) return 0;
+    ws_pool_move(pool, pick->ws, cold);
+    return 1;
+}
@@ -0,0 +1,79 @@
+#ifndef WS_POOL_H
+#define WS_POOL_H
+
+#include "ws.h"
+#include "ws_notifier.h"
+#include <stdint.h>
+#include <stddef.h>
+
+// Sharded connection manager: N worker threads, each pinned to a core and owning one
+// ws_notifier plus the connections placed on it
+//
+// A connection is driven by exactly one worker at a time (on_msg/on_status run on that
+// worker's thread). Placement is explicit, by hash of a key, or onto the least loaded
+// shard; ws_pool_move()/ws_pool_rebalance() hand a connection to another worker between
+// two ws_update() calls. All ws_pool_* calls come from a single control thread; once
+// added, a context may only be touched from its callbacks (ws_send() included).
+//
+// Workers also drive connections that have no pollable fd yet (handshake or reconnect in progress)
+// or never will (replay contexts) by calling ws_update() every loop iteration.
+
+typedef struct ws_pool ws_pool_t;
+
+#define WS_POOL_MAX_WORKERS 256
+
+// Shard hash for ws_pool_add(): returns any value, taken modulo the worker count
+typedef uint32_t (*ws_pool_hash_fn)(const char *key, void *arg);
+
+typedef struct {
+    int workers;                 // Shard count (1..WS_POOL_MAX_WORKERS)
+    const int *cpus;             // Core per worker (NULL = unpinned, -1 entry = leave that worker unpinned)
+    int rt_priority;             // >0: os_set_thread_realtime_priority() on every worker (needs CAP_SYS_NICE)
+    ws_notifier_mode_t wait_mode;  // Worker wait, see ws_notifier_set_mode() (all 0 = TIMEOUT 1ms,
+                                   // BLOCKING needs wait_timeout_ns = WS_NOTIFIER_NO_TIMEOUT)
+    uint64_t wait_timeout_ns;
+    uint64_t spin_cycles;
+    ws_pool_hash_fn hash;        // NULL = FNV-1a of the key
+    void *hash_arg;
+} ws_pool_options_t;
+
+// Per-shard load counters (single writer: the worker; approximate when read live)
+typedef struct {
+    uint32_t connections;
+    uint64_t updates;            // ws_update() calls
+    uint64_t busy_cycles;        // Cycles spent inside ws_update()
+    uint64_t wakeups;            // Notifier waits that returned events
+} ws_pool_shard_stats_t;
+
+// Start the workers; returns NULL if a thread or notifier cannot be created
+// A failed pin or RT priority is a warning, the worker still runs
+ws_pool_t *ws_pool_create(const ws_pool_options_t *opts);
+
+// Stop and join the workers, detaching every connection (contexts are not freed)
+void ws_pool_destroy(ws_pool_t *pool);
+
+int ws_pool_workers(const ws_pool_t *pool);
+
+// Hand ws to a worker: shard >= 0 places explicitly, otherwise hash(key) when key is set,
+// otherwise the shard with the fewest connections. ws must not be driven by the caller
+// afterwards. Returns the shard, -1 on error
+int ws_pool_add(ws_pool_t *pool, websocket_context_t *ws, const char *key, int shard);
+
+// Take ws back (waits until its worker let go). Returns 0, -1 if ws is not in the pool
+int ws_pool_remove(ws_pool_t *pool, websocket_context_t *ws);
+
+// Move ws to another worker. Returns 0, -1 on error
+int ws_pool_move(ws_pool_t *pool, websocket_context_t *ws, int shard);
+
+// Shard currently driving ws, -1 if not in the pool
+int ws_pool_shard_of(const ws_pool_t *pool, websocket_context_t *ws);
+
+void ws_pool_get_shard_stats(const ws_pool_t *pool, int shard, ws_pool_shard_stats_t *out);
+
+// Move one connection off the hottest worker when its busy share since the previous call
+// exceeds the coolest worker's by more than max_imbalance (0.0-1.0, e.g. 0.2)
+// Picks the connection whose own busy share best halves the gap
+// Returns 1 if a connection moved, 0 if balanced, -1 on error
+int ws_pool_rebalance(ws_pool_t *pool, double max_imbalance);
+
+#endif // WS_POOL_H
@@ -0,0 +1,179 @@
+#include "ws_redundant.h"
+#include "os.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define WS_REDUNDANT_SILENCE_NS 2000000000ULL   // 2 s
+
+typedef struct {
+    ws_redundant_t *group;
+    websocket_context_t *ws;
+    ws_redundant_leg_stats_t stats;
+} ws_redundant_leg_t;
+
+struct ws_redundant {
+    ws_redundant_leg_t legs[WS_REDUNDANT_MAX_LEGS];
+    int nlegs;
+    ws_seq_fn seq;
+    void *seq_arg;
+    uint64_t silence_cycles;
+    ws_on_msg_t on_msg;
+    ws_on_status_t on_status;
+
+    // Dedup window: bit i set = last_seq - i was delivered
+    int started;
+    uint64_t last_seq;
+    uint64_t window;
+};
+
+// 1 if seq was not delivered yet (and marks it), 0 for a duplicate or one too old to tell
+static inline int first_arrival(ws_redundant_t *r, uint64_t seq) {
+    if (__builtin_expect(seq > r->last_seq || !r->started, 1)) {
+        uint64_t d = seq - r->last_seq;
+        r->window = (!r->started || d >= WS_REDUNDANT_WINDOW) ? 1 : (r->window << d) | 1;
+        r->last_seq = seq;
+        r->started = 1;
+        return 1;
+    }
+    uint64_t d = r->last_seq - seq;
+    if (d >= WS_REDUNDANT_WINDOW) return 0;
+    uint64_t bit = 1ULL << d;
+    if (r->window & bit) return 0;
+    r->window |= bit;  // Gap filled by the slower leg
+    return 1;
+}
+
+static void leg_on_msg(websocket_context_t *ws, const uint8_t *payload, size_t len, uint8_t opcode) {
+    ws_redundant_leg_t *leg = (ws_redundant_leg_t *)ws_get_user_data(ws);
+    ws_redundant_t *r = leg->group;
+
+    if (__builtin_expect(opcode < WS_FRAME_CLOSE, 1)) {
+        leg->stats.messages++;
+        leg->stats.last_msg_cycle = ws_get_frame_parsed_timestamp(ws);
+
+        uint64_t seq;
+        if (__builtin_expect(r->seq(payload, len, opcode, &seq, r->seq_arg) == 0, 1)) {
+            if (!first_arrival(r, seq)) {
+                leg->stats.duplicates++;
+                return;
+            }
+            leg->stats.wins++;
+        }
+    }
+    if (r->on_msg) r->on_msg(ws, payload, len, opcode);
+}
+
+static void leg_on_status(websocket_context_t *ws, int status) {
+    ws_redundant_leg_t *leg = (ws_redundant_leg_t *)ws_get_user_data(ws);
+    if (status == 0) leg->stats.last_msg_cycle = os_get_cpu_cycle();  // Silence counts from the connect
+    if (leg->group->on_status) leg->group->on_status(ws, status);
+}
+
+ws_redundant_t *ws_redundant_create(websocket_context_t *const *legs, int n, const ws_redundant_options_t *opts) {
+    if (!legs || n < 1 || n > WS_REDUNDANT_MAX_LEGS || !opts || !opts->seq) return NULL;
+    for (int i = 0; i < n; i++) {
+        if (!legs[i]) return NULL;
+        for (int j = 0; j < i; j++) {
+            if (legs[j] == legs[i]) return NULL;
+        }
+    }
+
+    ws_redundant_t *r = (ws_redundant_t *)calloc(1, sizeof(ws_redundant_t));
+    if (!r) return NULL;
+    r->nlegs = n;
+    r->seq = opts->seq;
+    r->seq_arg = opts->seq_arg;
+    uint64_t silence_ns = opts->silence_ns ? opts->silence_ns : WS_REDUNDANT_SILENCE_NS;
+    r->silence_cycles = os_ns_to_cycles(silence_ns);
+
+    uint64_t now = os_get_cpu_cycle();
+    for (int i = 0; i < n; i++) {
+        ws_redundant_leg_t *leg = &r->legs[i];
+        leg->group = r;
+        leg->ws = legs[i];
+        leg->stats.last_msg_cycle = now;
+        ws_set_user_data(legs[i], leg);
+        ws_set_on_msg(legs[i], leg_on_msg);
+        ws_set_on_status(legs[i], leg_on_status);
+    }
+    return r;
+}
+
+void ws_redundant_destroy(ws_redundant_t *r) {
+    if (!r) return;
+    for (int i = 0; i < r->nlegs; i++) {
+        ws_set_on_msg(r->legs[i].ws, NULL);
+        ws_set_on_status(r->legs[i].ws, NULL);
+        ws_set_user_data(r->legs[i].ws, NULL);
+    }
+    free(r);
+}
+
+void ws_redundant_set_on_msg(ws_redundant_t *r, ws_on_msg_t callback) {
+    if (r) r->on_msg = callback;
+}
+
+void ws_redundant_set_on_status(ws_redundant_t *r, ws_on_status_t callback) {
+    if (r) r->on_status = callback;
+}
+
+int ws_redundant_update(ws_redundant_t *r) {
+    if (!r) return -1;
+
+    int connected = 0;
+    uint64_t newest = 0;
+    for (int i = 0; i < r->nlegs; i++) {
+        ws_redundant_leg_t *leg = &r->legs[i];
+        ws_update(leg->ws);
+        if (ws_get_state(leg->ws) == WS_STATE_CONNECTED) {
+            connected++;
+            if (leg->stats.last_msg_cycle > newest) newest = leg->stats.last_msg_cycle;
+        }
+    }
+
+    // Silence is relative to the freshest leg: a quiet market does not reconnect everything
+    if (__builtin_expect(connected > 1, 1)) {
+        for (int i = 0; i < r->nlegs; i++) {
+            ws_redundant_leg_t *leg = &r->legs[i];
+            if (newest - leg->stats.last_msg_cycle <= r->silence_cycles) continue;
+            if (ws_get_state(leg->ws) != WS_STATE_CONNECTED) continue;
+            if (ws_reconnect(leg->ws) == 0) {
+                leg->stats.failovers++;
+                leg->stats.last_msg_cycle = newest;  // Not again until the new connection is overdue
+                connected--;
+            }
+        }
+    }
+    return connected;
+}
+
+int ws_redundant_send(ws_redundant_t *r, const uint8_t *data, size_t len) {
+    if (!r) return -1;
+    int sent = 0;
+    for (int i = 0; i < r->nlegs; i++) {
+        if (ws_get_state(r->legs[i].ws) == WS_STATE_CONNECTED && ws_send(r->legs[i].ws, data, len) >= 0) sent++;
+    }
+    return sent;
+}
+
+int ws_redundant_legs(const ws_redundant_t *r) {
+    return r ? r->nlegs : 0;
+}
+
+websocket_context_t *ws_redundant_leg(ws_redundant_t *r, int index) {
+    if (!r || index < 0 || index >= r->nlegs) return NULL;
+    return r->legs[index].ws;
+}
+
+void ws_redundant_get_leg_stats(const ws_redundant_t *r, int index, ws_redundant_leg_stats_t *out) {
+    if (!out) return;
+    if (!r || index < 0 || index >= r->nlegs) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    *out = r->legs[index].stats;
+}
+
+uint64_t ws_redundant_last_seq(const ws_redundant_t *r) {
+    return r ? r->last_seq : 0;
+}
@@ -0,0 +1,74 @@
+#ifndef WS_REDUNDANT_H
+#define WS_REDUNDANT_H
+
+#include "ws.h"
+#include <stdint.h>
+#include <stddef.h>
+
+// Redundant feed: N connections ("legs") to different endpoints of the same venue race
+// each other, and the first arrival of every sequence number reaches one on_msg
+//
+// Each leg is a normal context (create them with ws_init_ex() and auto_reconnect so a
+// dropped leg comes back by itself; replay contexts work too). Data messages carry a
+// sequence number pulled out by a user extractor; a 64-entry window behind the newest
+// number delivered fills gaps from a slower leg and drops everything seen before. A leg
+// whose data falls silent for longer than silence_ns while another leg keeps delivering
+// is reconnected in the background; the feed continues on the others without a gap.
+//
+// Single-threaded like a context: ws_redundant_update() drives every leg, and callbacks
+// run inside it. Legs use their user data slot (ws_set_user_data) for the group.
+
+typedef struct ws_redundant ws_redundant_t;
+
+#define WS_REDUNDANT_MAX_LEGS 8
+#define WS_REDUNDANT_WINDOW 64       // Sequence numbers behind the newest that can still fill a gap
+
+// Sequence number of a data message: returns 0 with *seq set, -1 if the message is not
+// sequenced (acks, heartbeats: delivered from every leg, e.g. to resubscribe per leg)
+typedef int (*ws_seq_fn)(const uint8_t *payload, size_t len, uint8_t opcode, uint64_t *seq, void *arg);
+
+typedef struct {
+    ws_seq_fn seq;                   // Required
+    void *seq_arg;
+    uint64_t silence_ns;             // Leg lag that triggers a reconnect, 0 = 2 s
+                                     // (a feed quiet on every leg is not treated as dead)
+} ws_redundant_options_t;
+
+typedef struct {
+    uint64_t messages;               // Data messages received (duplicates included)
+    uint64_t wins;                   // First arrivals delivered from this leg
+    uint64_t duplicates;             // Already delivered by another leg (or too old)
+    uint64_t failovers;              // Reconnects forced by silence
+    uint64_t last_msg_cycle;         // Last data message or (re)connect, TSC cycles
+} ws_redundant_leg_stats_t;
+
+// Race legs[0..n-1] (1..WS_REDUNDANT_MAX_LEGS). The group takes over each leg's on_msg,
+// on_status and user data; drive the legs through ws_redundant_update() only
+// Returns NULL on error
+ws_redundant_t *ws_redundant_create(websocket_context_t *const *legs, int n, const ws_redundant_options_t *opts);
+
+// Release the group (legs are detached, not freed)
+void ws_redundant_destroy(ws_redundant_t *r);
+
+// on_msg receives the winning leg's context (timestamp getters refer to that leg)
+// Control frames are forwarded from every leg
+void ws_redundant_set_on_msg(ws_redundant_t *r, ws_on_msg_t callback);
+
+// Forwarded per leg: on_status(leg, 0) after every (re)connect is where a leg subscribes
+void ws_redundant_set_on_status(ws_redundant_t *r, ws_on_status_t callback);
+
+// Drive every leg once and reconnect silent ones
+// Returns the number of connected legs
+int ws_redundant_update(ws_redundant_t *r);
+
+// Send one TEXT frame on every connected leg. Returns the number of legs it was queued on
+int ws_redundant_send(ws_redundant_t *r, const uint8_t *data, size_t len);
+
+int ws_redundant_legs(const ws_redundant_t *r);
+websocket_context_t *ws_redundant_leg(ws_redundant_t *r, int index);
+void ws_redundant_get_leg_stats(const ws_redundant_t *r, int index, ws_redundant_leg_stats_t *out);
+
+// Newest sequence number delivered (0 before the first)
+uint64_t ws_redundant_last_seq(const ws_redundant_t *r);
+
+#endif // WS_REDUNDANT_H
@@ -0,0 +1,159 @@
+#include "ws_replay.h"
+#include "ws_trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Read the whole file into memory
+static uint8_t *read_file(const char *path, size_t *len_out) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+
+    uint8_t *buf = NULL;
+    long size = -1;
+    if (fseek(f, 0, SEEK_END) == 0) size = ftell(f);
+    if (size >= 0 && fseek(f, 0, SEEK_SET) == 0) {
+        buf = (uint8_t *)malloc(size > 0 ? (size_t)size : 1);
+        if (buf && fread(buf, 1, (size_t)size, f) != (size_t)size) {
+            free(buf);
+            buf = NULL;
+        }
+    }
+    fclose(f);
+
+    *len_out = buf ? (size_t)size : 0;
+    return buf;
+}
+
+// Extract the stream ring (oldest byte first) and the receive batches from a trace file
+static int load_trace(ws_replay_t *r, const uint8_t *file, size_t file_len) {
+    const ws_trace_header_t *h = (const ws_trace_header_t *)file;
+    if (h->version != WS_TRACE_VERSION || h->record_size != sizeof(ws_trace_record_t) ||
+        h->record_capacity == 0 || (h->record_capacity & (h->record_capacity - 1)) != 0) {
+        fprintf(stderr, "Warning: unsupported trace file version\n");
+        return -1;
+    }
+    uint64_t records_end = WS_TRACE_HEADER_SIZE + h->record_capacity * sizeof(ws_trace_record_t);
+    if (h->stream_capacity == 0) {
+        fprintf(stderr, "Warning: trace has no stream capture, nothing to replay\n");
+        return -1;
+    }
+    if (h->stream_file_offset != records_end || records_end + h->stream_capacity > file_len) {
+        fprintf(stderr, "Warning: truncated trace file\n");
+        return -1;
+    }
+
+    // Stream bytes still in the ring: [stream_start, stream_head) in capture offsets
+    uint64_t stream_len = h->stream_head < h->stream_capacity ? h->stream_head : h->stream_capacity;
+    uint64_t stream_start = h->stream_head - stream_len;
+    uint64_t record_count = h->record_head < h->record_capacity ? h->record_head : h->record_capacity;
+    const ws_trace_record_t *records = (const ws_trace_record_t *)(file + WS_TRACE_HEADER_SIZE);
+
+    r->batches = (ws_replay_batch_t *)calloc(record_count ? (size_t)record_count : 1, sizeof(ws_replay_batch_t));
+    if (!r->batches) return -1;
+
+    // Start at the first recorded frame still fully captured (a wrapped ring begins mid-frame)
+    uint64_t feed_start = stream_start;
+    int have_start = 0;
+    uint64_t batch_cycle = 0;
+    uint64_t first_cycle = 0;
+    for (uint64_t seq = h->record_head - record_count; seq < h->record_head; seq++) {
+        const ws_trace_record_t *rec = &records[seq & (h->record_capacity - 1)];
+        uint64_t end = rec->stream_offset + rec->header_len + rec->payload_len;
+        if (rec->stream_offset < stream_start || end > h->stream_head || rec->payload_len == UINT32_MAX) {
+            continue;
+        }
+        if (!have_start) {
+            feed_start = rec->stream_offset;
+            first_cycle = rec->recv_end_cycle;
+            have_start = 1;
+        }
+
+        // Frames of one receive batch share its recv_end stamp
+        if (r->batch_count == 0 || rec->recv_end_cycle != batch_cycle) {
+            batch_cycle = rec->recv_end_cycle;
+            uint64_t delta = batch_cycle >= first_cycle ? batch_cycle - first_cycle : 0;
+            r->batches[r->batch_count].ns = (uint64_t)((double)delta * h->ns_per_cycle);
+            r->batch_count++;
+        }
+        r->batches[r->batch_count - 1].end = end - feed_start;
+    }
+    if (!have_start && stream_start > 0) {
+        fprintf(stderr, "Warning: stream ring wrapped and no frame start is known, replay may fail\n");
+    }
+
+    r->len = (size_t)(h->stream_head - feed_start);
+    r->data = (uint8_t *)malloc(r->len ? r->len : 1);
+    if (!r->data) return -1;
+
+    const uint8_t *ring = file + h->stream_file_offset;
+    uint64_t mask = h->stream_capacity - 1;
+    size_t pos = (size_t)(feed_start & mask);
+    size_t first = (size_t)(h->stream_capacity - pos) < r->len ? (size_t)(h->stream_capacity - pos) : r->len;
+    memcpy(r->data, ring + pos, first);
+    memcpy(r->data + first, ring, r->len - first);
+    return 0;
+}
+
+ws_replay_t *ws_replay_open(const char *path) {
+    if (!path) return NULL;
+
+    size_t file_len = 0;
+    uint8_t *file = read_file(path, &file_len);
+    if (!file) {
+        fprintf(stderr, "Warning: cannot read replay capture %s\n", path);
+        return NULL;
+    }
+
+    ws_replay_t *r = (ws_replay_t *)calloc(1, sizeof(ws_replay_t));
+    if (!r) {
+        free(file);
+        return NULL;
+    }
+
+    if (file_len >= WS_TRACE_HEADER_SIZE && memcmp(file, WS_TRACE_MAGIC, 8) == 0) {
+        int ret = load_trace(r, file, file_len);
+        free(file);
+        if (ret < 0) {
+            ws_replay_free(r);
+            return NULL;
+        }
+    } else {
+        // Raw stream: the file is the data
+        r->data = file;
+        r->len = file_len;
+    }
+
+    return r;
+}
+
+void ws_replay_free(ws_replay_t *r) {
+    if (!r) return;
+    free(r->data);
+    free(r->batches);
+    free(r);
+}
+
+size_t ws_replay_due(ws_replay_t *r, uint64_t now_ns, size_t max) {
+    if (r->pos >= r->len) return 0;
+
+    size_t end = r->len;  // Tail after the last recorded frame goes out in one piece
+    if (r->batches) {
+        if (r->next_batch < r->batch_count) {
+            const ws_replay_batch_t *b = &r->batches[r->next_batch];
+            if (r->speed > 0.0) {
+                if (!r->started) {
+                    r->start_ns = now_ns;
+                    r->started = 1;
+                }
+                if ((double)(now_ns - r->start_ns) * r->speed < (double)b->ns) return 0;  // Not due yet
+            }
+            end = (size_t)b->end;
+        }
+    } else if (r->len - r->pos > WS_REPLAY_RAW_CHUNK) {
+        end = r->pos + WS_REPLAY_RAW_CHUNK;
+    }
+
+    size_t n = end - r->pos;
+    return n < max ? n : max;
+}
@@ -0,0 +1,57 @@
+#ifndef WS_REPLAY_H
+#define WS_REPLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Offline capture source for ws_init_replay()
+//
+// Input is either a raw decrypted RX byte stream (ws_trace_dump --raw) or a trace file
+// written with stream capture on (ws_set_trace() stream_bytes > 0). Trace files also
+// carry the original receive batches: replay hands the parser the same byte ranges per
+// ws_update() as the live connection saw, optionally at the original pace.
+
+// Raw captures carry no batch boundaries: bytes are fed in TLS-record sized chunks
+#define WS_REPLAY_RAW_CHUNK 16384
+
+typedef struct {
+    uint64_t end;                // Stream offset where the batch ends (exclusive, last frame end)
+    uint64_t ns;                 // Arrival relative to the first batch
+} ws_replay_batch_t;
+
+typedef struct {
+    uint8_t *data;               // Whole stream in memory (copied out of the capture file)
+    size_t len;
+    size_t pos;                  // Next byte to feed
+    ws_replay_batch_t *batches;  // NULL for raw captures
+    size_t batch_count;
+    size_t next_batch;
+    double speed;                // 0 = as fast as possible, 1.0 = original pace, 2.0 = twice as fast
+    uint64_t start_ns;           // Replay clock origin, set on the first feed
+    int started;
+} ws_replay_t;
+
+// Load a capture file (format detected from the trace magic)
+// Returns NULL on I/O error or a trace without stream capture
+ws_replay_t *ws_replay_open(const char *path);
+
+void ws_replay_free(ws_replay_t *r);
+
+// Bytes that may be fed now (up to the end of the next due batch, capped at max)
+// now_ns: monotonic time; returns 0 while paced replay waits for the next batch
+size_t ws_replay_due(ws_replay_t *r, uint64_t now_ns, size_t max);
+
+// Consume n bytes returned by ws_replay_due()
+static inline void ws_replay_consume(ws_replay_t *r, size_t n) {
+    r->pos += n;
+    while (r->next_batch < r->batch_count && r->batches[r->next_batch].end <= r->pos) {
+        r->next_batch++;
+    }
+}
+
+// 1 once every byte has been fed
+static inline int ws_replay_done(const ws_replay_t *r) {
+    return r->pos >= r->len;
+}
+
+#endif // WS_REPLAY_H
@@ -0,0 +1,311 @@
+#include "ws_resolver.h"
+#include <pthread.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define RESOLVER_HOST_MAX 256
+#define RESOLVER_DEFAULT_TTL_NS 60000000000ULL   // 60 s
+#define RESOLVER_FAILURE_TTL_NS 1000000000ULL    // 1 s: a reconnect wave does not hammer a dead resolver
+
+typedef enum {
+    ENTRY_EMPTY,
+    ENTRY_PENDING,     // First lookup in flight, nothing to hand out yet
+    ENTRY_READY,
+    ENTRY_FAILED
+} entry_state_t;
+
+typedef struct {
+    char host[RESOLVER_HOST_MAX];
+    entry_state_t state;
+    int pinned;
+    int refreshing;            // Expired READY entry: answer still served while a lookup runs
+    uint32_t generation;       // Bumped on reuse/flush/pin: results of older lookups are dropped
+    uint64_t expires_ns;
+    uint64_t used_ns;          // Last lookup (eviction order)
+    ws_resolved_t result;      // Port 0, filled in per lookup
+} resolver_entry_t;
+
+typedef struct {
+    int slot;
+    uint32_t generation;
+    char host[RESOLVER_HOST_MAX];
+} resolver_job_t;
+
+static pthread_mutex_t resolver_lock = PTHREAD_MUTEX_INITIALIZER;
+static resolver_entry_t resolver_entries[WS_RESOLVER_MAX_HOSTS];
+static uint64_t resolver_ttl_ns = RESOLVER_DEFAULT_TTL_NS;
+
+static uint64_t resolver_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Literal IPv4/IPv6 address (port 0)
+static int parse_literal(const char *ip, struct sockaddr_storage *ss, socklen_t *len) {
+    memset(ss, 0, sizeof(*ss));
+    struct sockaddr_in *sin = (struct sockaddr_in *)ss;
+    if (inet_pton(AF_INET, ip, &sin->sin_addr) == 1) {
+        sin->sin_family = AF_INET;
+        *len = sizeof(*sin);
+        return 0;
+    }
+    struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *)ss;
+    if (inet_pton(AF_INET6, ip, &sin6->sin6_addr) == 1) {
+        sin6->sin6_family = AF_INET6;
+        *len = sizeof(*sin6);
+        return 0;
+    }
+    return -1;
+}
+
+static void append_addr(ws_resolved_t *r, const struct sockaddr *sa, socklen_t len) {
+    if (r->count >= WS_RESOLVER_MAX_ADDRS) return;
+    memset(&r->addrs[r->count], 0, sizeof(r->addrs[r->count]));
+    memcpy(&r->addrs[r->count], sa, len);
+    r->lens[r->count] = len;
+    r->count++;
+}
+
+// RFC 8305 Section 4: alternate families, starting with the first one getaddrinfo() returned
+// (its RFC 6724 ordering already prefers IPv6 when the host has a usable route)
+static void store_interleaved(ws_resolved_t *out, const struct addrinfo *list) {
+    const struct addrinfo *primary[WS_RESOLVER_MAX_ADDRS];
+    const struct addrinfo *secondary[WS_RESOLVER_MAX_ADDRS];
+    int np = 0, ns = 0;
+    int first_family = AF_UNSPEC;
+
+    for (const struct addrinfo *ai = list; ai; ai = ai->ai_next) {
+        if (ai->ai_family != AF_INET && ai->ai_family != AF_INET6) continue;
+        if (ai->ai_addrlen > sizeof(struct sockaddr_storage)) continue;
+        if (first_family == AF_UNSPEC) first_family = ai->ai_family;
+        if (ai->ai_family == first_family) {
+            if (np < WS_RESOLVER_MAX_ADDRS) primary[np++] = ai;
+        } else if (ns < WS_RESOLVER_MAX_ADDRS) {
+            secondary[ns++] = ai;
+        }
+    }
+
+    out->count = 0;
+    for (int i = 0; i < np || i < ns; i++) {
+        if (i < np) append_addr(out, primary[i]->ai_addr, primary[i]->ai_addrlen);
+        if (i < ns) append_addr(out, secondary[i]->ai_addr, secondary[i]->ai_addrlen);
+    }
+}
+
+static void copy_with_port(ws_resolved_t *out, const ws_resolved_t *in, int port) {
+    *out = *in;
+    for (int i = 0; i < out->count; i++) {
+        if (out->addrs[i].ss_family == AF_INET) {
+            ((struct sockaddr_in *)&out->addrs[i])->sin_port = htons((uint16_t)port);
+        } else {
+            ((struct sockaddr_in6 *)&out->addrs[i])->sin6_port = htons((uint16_t)port);
+        }
+    }
+}
+
+// Blocking getaddrinfo(), result stored if the entry still belongs to this lookup
+static void resolve_into(int slot, uint32_t generation, const char *host) {
+    struct addrinfo hints, *list = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_ADDRCONFIG;  // No AAAA candidates on IPv4-only hosts
+
+    ws_resolved_t result;
+    result.count = 0;
+    if (getaddrinfo(host, NULL, &hints, &list) == 0) {
+        store_interleaved(&result, list);
+        freeaddrinfo(list);
+    }
+
+    uint64_t now = resolver_now_ns();
+    pthread_mutex_lock(&resolver_lock);
+    resolver_entry_t *e = &resolver_entries[slot];
+    if (e->generation == generation) {
+        if (result.count > 0) {
+            e->result = result;
+            e->state = ENTRY_READY;
+            e->expires_ns = now + resolver_ttl_ns;
+        } else if (e->state == ENTRY_PENDING) {
+            e->state = ENTRY_FAILED;
+            e->expires_ns = now + RESOLVER_FAILURE_TTL_NS;
+        } else {
+            e->expires_ns = now + RESOLVER_FAILURE_TTL_NS;  // Refresh failed: keep the old answer a little longer
+        }
+        e->refreshing = 0;
+    }
+    pthread_mutex_unlock(&resolver_lock);
+}
+
+static void *resolver_thread(void *arg) {
+    resolver_job_t *job = (resolver_job_t *)arg;
+    resolve_into(job->slot, job->generation, job->host);
+    free(job);
+    return NULL;
+}
+
+// Run the lookup on a detached thread (synchronously if no thread can be started)
+static void resolver_launch(int slot, uint32_t generation, const char *host) {
+    resolver_job_t *job = (resolver_job_t *)malloc(sizeof(resolver_job_t));
+    if (job) {
+        job->slot = slot;
+        job->generation = generation;
+        memcpy(job->host, host, strlen(host) + 1);  // resolver_get() checked it fits
+
+        pthread_attr_t attr;
+        pthread_t thread;
+        int started = 0;
+        if (pthread_attr_init(&attr) == 0) {
+            pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+            started = pthread_create(&thread, &attr, resolver_thread, job) == 0;
+            pthread_attr_destroy(&attr);
+        }
+        if (started) return;
+        free(job);
+    }
+    resolve_into(slot, generation, host);
+}
+
+// Caller holds resolver_lock
+static resolver_entry_t *entry_find(const char *host) {
+    for (int i = 0; i < WS_RESOLVER_MAX_HOSTS; i++) {
+        resolver_entry_t *e = &resolver_entries[i];
+        if (e->state != ENTRY_EMPTY && strcmp(e->host, host) == 0) return e;
+    }
+    return NULL;
+}
+
+// Caller holds resolver_lock; empty slot, else the least recently used evictable entry
+static resolver_entry_t *entry_alloc(const char *host) {
+    resolver_entry_t *victim = NULL;
+    for (int i = 0; i < WS_RESOLVER_MAX_HOSTS; i++) {
+        resolver_entry_t *e = &resolver_entries[i];
+        if (e->state == ENTRY_EMPTY) {
+            victim = e;
+            break;
+        }
+        if (e->pinned || e->state == ENTRY_PENDING || e->refreshing) continue;
+        if (!victim || e->used_ns < victim->used_ns) victim = e;
+    }
+    if (!victim) return NULL;
+
+    victim->generation++;
+    strcpy(victim->host, host);
+    victim->state = ENTRY_EMPTY;
+    victim->pinned = 0;
+    victim->refreshing = 0;
+    victim->expires_ns = 0;
+    victim->result.count = 0;
+    return victim;
+}
+
+// Shared by lookup and prefetch (out = NULL)
+static int resolver_get(const char *host, int port, ws_resolved_t *out) {
+    if (!host || strlen(host) >= RESOLVER_HOST_MAX) return -1;
+
+    struct sockaddr_storage ss;
+    socklen_t len;
+    if (parse_literal(host, &ss, &len) == 0) {
+        if (out) {
+            ws_resolved_t literal;
+            literal.count = 0;
+            append_addr(&literal, (const struct sockaddr *)&ss, len);
+            copy_with_port(out, &literal, port);
+        }
+        return 1;
+    }
+
+    uint64_t now = resolver_now_ns();
+    int ret = 0, launch = 0, slot = 0;
+    uint32_t generation = 0;
+
+    pthread_mutex_lock(&resolver_lock);
+    resolver_entry_t *e = entry_find(host);
+    if (!e) e = entry_alloc(host);
+    if (!e) {
+        pthread_mutex_unlock(&resolver_lock);
+        return -1;
+    }
+    e->used_ns = now;
+
+    if (e->state == ENTRY_READY) {
+        if (out) copy_with_port(out, &e->result, port);
+        if (!e->pinned && !e->refreshing && now >= e->expires_ns) {
+            e->refreshing = 1;  // Stale-while-revalidate: never stall a reconnect on an expired TTL
+            launch = 1;
+        }
+        ret = 1;
+    } else if (e->state == ENTRY_FAILED && now < e->expires_ns) {
+        ret = -1;
+    } else if (e->state != ENTRY_PENDING) {
+        e->state = ENTRY_PENDING;
+        launch = 1;
+    }
+    if (launch) {
+        slot = (int)(e - resolver_entries);
+        generation = e->generation;
+    }
+    pthread_mutex_unlock(&resolver_lock);
+
+    if (launch) resolver_launch(slot, generation, host);
+    return ret;
+}
+
+int ws_resolver_lookup(const char *host, int port, ws_resolved_t *out) {
+    if (!out || port <= 0 || port > 65535) return -1;
+    return resolver_get(host, port, out);
+}
+
+int ws_resolver_prefetch(const char *host) {
+    return resolver_get(host, 0, NULL) < 0 ? -1 : 0;
+}
+
+int ws_resolver_pin(const char *host, const char *ip) {
+    if (!host || !ip || strlen(host) >= RESOLVER_HOST_MAX) return -1;
+
+    struct sockaddr_storage ss;
+    socklen_t len;
+    if (parse_literal(ip, &ss, &len) < 0) return -1;
+
+    pthread_mutex_lock(&resolver_lock);
+    resolver_entry_t *e = entry_find(host);
+    if (!e) e = entry_alloc(host);
+    if (!e || (e->pinned && e->result.count >= WS_RESOLVER_MAX_ADDRS)) {
+        pthread_mutex_unlock(&resolver_lock);
+        return -1;
+    }
+    if (!e->pinned) {
+        e->generation++;  // Drop whatever DNS lookup is still running for this host
+        e->pinned = 1;
+        e->refreshing = 0;
+        e->result.count = 0;
+    }
+    append_addr(&e->result, (const struct sockaddr *)&ss, len);
+    e->state = ENTRY_READY;
+    pthread_mutex_unlock(&resolver_lock);
+    return 0;
+}
+
+void ws_resolver_set_ttl(uint64_t ttl_ns) {
+    pthread_mutex_lock(&resolver_lock);
+    resolver_ttl_ns = ttl_ns ? ttl_ns : RESOLVER_DEFAULT_TTL_NS;
+    pthread_mutex_unlock(&resolver_lock);
+}
+
+void ws_resolver_flush(void) {
+    pthread_mutex_lock(&resolver_lock);
+    for (int i = 0; i < WS_RESOLVER_MAX_HOSTS; i++) {
+        resolver_entry_t *e = &resolver_entries[i];
+        e->generation++;
+        e->state = ENTRY_EMPTY;
+        e->pinned = 0;
+        e->refreshing = 0;
+        e->result.count = 0;
+    }
+    pthread_mutex_unlock(&resolver_lock);
+}
@@ -0,0 +1,45 @@
+#ifndef WS_RESOLVER_H
+#define WS_RESOLVER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/socket.h>
+
+// Process-wide DNS cache used by non-blocking connects (ws_options_t.async_connect)
+//
+// Lookups never block the caller: the first miss for a host starts one background
+// getaddrinfo() thread, every connection to that host waits on the same lookup and
+// copies the cached answer afterwards. Literal addresses skip the lookup, pinned hosts
+// (ws_resolver_pin) never touch DNS. All functions are thread-safe (one mutex, cold path).
+
+#define WS_RESOLVER_MAX_ADDRS 8     // Addresses kept per host (Happy Eyeballs candidates)
+#define WS_RESOLVER_MAX_HOSTS 64    // Cached hosts; the oldest idle entry is evicted when full
+
+typedef struct {
+    int count;
+    struct sockaddr_storage addrs[WS_RESOLVER_MAX_ADDRS];
+    socklen_t lens[WS_RESOLVER_MAX_ADDRS];
+} ws_resolved_t;
+
+// Pre-resolved address injection: pin host to a literal IPv4/IPv6 address
+// Repeat to add more addresses (tried in order); pinned entries never expire
+// Returns 0, -1 if ip is not a literal address or the table is full
+int ws_resolver_pin(const char *host, const char *ip);
+
+// Lifetime of resolved (not pinned) entries, 0 restores the default (60 s)
+void ws_resolver_set_ttl(uint64_t ttl_ns);
+
+// Start resolving host in the background (e.g. right after a disconnect, before the
+// reconnect backoff expires). Returns 0 if started or already cached, -1 on error
+int ws_resolver_prefetch(const char *host);
+
+// Non-blocking lookup; addresses come in Happy Eyeballs order (RFC 8305: families
+// interleaved, starting with the resolver's preferred one) with port filled in
+// Returns 1 with out filled, 0 while the lookup is in flight (started by the first call),
+// -1 if resolution failed (failures are cached for 1 s)
+int ws_resolver_lookup(const char *host, int port, ws_resolved_t *out);
+
+// Drop every cached and pinned entry (lookups in flight finish into the void)
+void ws_resolver_flush(void);
+
+#endif // WS_RESOLVER_H
@@ -0,0 +1,470 @@
+#include "ws_router.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define WS_ROUTER_SSE2 1
+#elif defined(__aarch64__) || defined(__arm64__)
+#include <arm_neon.h>
+#define WS_ROUTER_NEON 1
+#endif
+
+#define WS_ROUTER_SEED_TRIES 32
+#define WS_ROUTER_MAX_DISP 65536        // Displacements tried per bucket before a new seed
+
+typedef struct {
+    ws_route_fn fn;                     // NULL = empty slot
+    void *arg;
+    uint32_t len;
+    uint8_t key[WS_ROUTER_MAX_KEY];
+} ws_route_entry_t;
+
+_Static_assert(sizeof(ws_route_entry_t) == 64, "route entry must be one cache line");
+
+struct ws_router {
+    // Read per message
+    ws_route_entry_t *table;            // slot_mask + 1 entries, NULL while no route exists
+    uint16_t *disp;                     // Displacement per bucket
+    uint64_t seed;
+    uint32_t slot_mask;
+    uint32_t bucket_mask;
+    ws_route_mode_t mode;
+    size_t offset;
+    size_t key_len;
+    size_t scan_limit;
+    size_t needle_len;
+    uint8_t needle[WS_ROUTER_MAX_KEY + 2];  // "field" including the quotes
+    ws_route_fn default_fn;
+    void *default_arg;
+    ws_router_stats_t stats;
+
+    // Registrations (rebuild input)
+    ws_route_entry_t *routes;
+    size_t nroutes;
+    size_t cap;
+};
+
+// Short-key hash: 8 bytes per multiply, then a final avalanche
+static inline uint64_t route_hash(const uint8_t *k, size_t len, uint64_t seed) {
+    uint64_t h = seed ^ ((uint64_t)len * 0x9E3779B97F4A7C15ULL);
+    while (len >= 8) {
+        uint64_t w;
+        memcpy(&w, k, 8);
+        h = (h ^ w) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+        k += 8;
+        len -= 8;
+    }
+    if (len) {
+        uint64_t w = 0;
+        memcpy(&w, k, len);
+        h = (h ^ w) * 0xc4ceb9fe1a85ec53ULL;
+    }
+    h ^= h >> 29;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 32;
+    return h;
+}
+
+// Bucket from bits 32..47, slot = low word stepped by an odd stride from bits 48..63:
+// for a fixed key every displacement lands on a different slot
+static inline uint32_t route_bucket(uint64_t h, uint32_t bucket_mask) {
+    return (uint32_t)(h >> 32) & bucket_mask;
+}
+
+static inline uint32_t route_slot(uint64_t h, uint32_t d, uint32_t slot_mask) {
+    return ((uint32_t)h + d * ((uint32_t)(h >> 48) | 1)) & slot_mask;
+}
+
+static inline const ws_route_entry_t *router_lookup(const ws_router_t *r, const uint8_t *key, size_t len) {
+    if (__builtin_expect(r->table == NULL || len > WS_ROUTER_MAX_KEY, 0)) return NULL;
+    uint64_t h = route_hash(key, len, r->seed);
+    uint32_t d = r->disp[route_bucket(h, r->bucket_mask)];
+    const ws_route_entry_t *e = &r->table[route_slot(h, d, r->slot_mask)];
+    if (__builtin_expect(e->fn != NULL && e->len == len && memcmp(e->key, key, len) == 0, 1)) return e;
+    return NULL;
+}
+
+static uint32_t pow2_at_least(size_t n) {
+    uint32_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// Hash-and-displace with one seed: buckets placed largest first, each gets the first
+// displacement that puts all its keys on free slots. Returns 0 on success
+static int router_place(const ws_router_t *r, uint64_t seed, uint32_t nslots, uint32_t nbuckets,
+                        uint32_t *slot_of, uint16_t *disp) {
+    size_t n = r->nroutes;
+    int ret = -1;
+    uint64_t *h = (uint64_t *)malloc(n * sizeof(uint64_t));
+    uint32_t *start = (uint32_t *)calloc(nbuckets + 1, sizeof(uint32_t));
+    uint32_t *items = (uint32_t *)malloc(n * sizeof(uint32_t));
+    uint32_t *order = (uint32_t *)malloc(nbuckets * sizeof(uint32_t));
+    uint32_t *by_size = (uint32_t *)calloc(n + 2, sizeof(uint32_t));
+    uint8_t *used = (uint8_t *)calloc(nslots, 1);
+    if (!h || !start || !items || !order || !by_size || !used) goto out;
+
+    // Keys grouped per bucket
+    for (size_t i = 0; i < n; i++) {
+        h[i] = route_hash(r->routes[i].key, r->routes[i].len, seed);
+        start[route_bucket(h[i], nbuckets - 1) + 1]++;
+    }
+    for (uint32_t b = 0; b < nbuckets; b++) start[b + 1] += start[b];
+    {
+        uint32_t *fill = (uint32_t *)malloc(nbuckets * sizeof(uint32_t));
+        if (!fill) goto out;
+        memcpy(fill, start, nbuckets * sizeof(uint32_t));
+        for (size_t i = 0; i < n; i++) items[fill[route_bucket(h[i], nbuckets - 1)]++] = (uint32_t)i;
+        free(fill);
+    }
+
+    // Buckets by size, largest first (counting sort)
+    for (uint32_t b = 0; b < nbuckets; b++) by_size[start[b + 1] - start[b]]++;
+    uint32_t pos = 0;
+    for (size_t sz = n + 1; sz-- > 0;) {
+        uint32_t c = by_size[sz];
+        by_size[sz] = pos;
+        pos += c;
+    }
+    for (uint32_t b = 0; b < nbuckets; b++) order[by_size[start[b + 1] - start[b]]++] = b;
+
+    memset(disp, 0, nbuckets * sizeof(uint16_t));
+    for (uint32_t o = 0; o < nbuckets; o++) {
+        uint32_t b = order[o];
+        uint32_t lo = start[b], hi = start[b + 1];
+        if (lo == hi) break;  // Only empty buckets left
+
+        uint32_t d = 0;
+        for (; d < WS_ROUTER_MAX_DISP; d++) {
+            uint32_t k = lo;
+            for (; k < hi; k++) {
+                uint32_t s = route_slot(h[items[k]], d, nslots - 1);
+                if (used[s]) break;
+                used[s] = 2;  // Tentative: also catches two keys of this bucket on one slot
+                slot_of[items[k]] = s;
+            }
+            if (k == hi) break;
+            for (uint32_t j = lo; j < k; j++) used[slot_of[items[j]]] = 0;
+        }
+        if (d == WS_ROUTER_MAX_DISP) goto out;
+        for (uint32_t k = lo; k < hi; k++) used[slot_of[items[k]]] = 1;
+        disp[b] = (uint16_t)d;
+    }
+    ret = 0;
+
+out:
+    free(h);
+    free(start);
+    free(items);
+    free(order);
+    free(by_size);
+    free(used);
+    return ret;
+}
+
+// Rebuild the perfect hash from the registrations; the old table stays on failure
+static int router_build(ws_router_t *r) {
+    if (r->nroutes == 0) {
+        free(r->table);
+        free(r->disp);
+        r->table = NULL;
+        r->disp = NULL;
+        return 0;
+    }
+
+    uint32_t nslots = pow2_at_least(r->nroutes + r->nroutes / 4 + 1);
+    uint32_t nbuckets = pow2_at_least((r->nroutes + 1) / 2);
+    if (nbuckets > 65536) nbuckets = 65536;  // Bucket index comes from 16 hash bits
+
+    uint32_t *slot_of = (uint32_t *)malloc(r->nroutes * sizeof(uint32_t));
+    uint16_t *disp = (uint16_t *)malloc(nbuckets * sizeof(uint16_t));
+    if (!slot_of || !disp) {
+        free(slot_of);
+        free(disp);
+        return -1;
+    }
+
+    uint64_t seed = 0x853c49e6748fea9bULL;
+    for (int attempt = 0; attempt < WS_ROUTER_SEED_TRIES; attempt++) {
+        if (attempt > 0 && attempt % 8 == 0) nslots <<= 1;  // Emptier table, easier placement
+        seed += 0x9E3779B97F4A7C15ULL;
+        if (router_place(r, seed, nslots, nbuckets, slot_of, disp) != 0) continue;
+
+        ws_route_entry_t *table = NULL;
+        if (posix_memalign((void **)&table, 64, (size_t)nslots * sizeof(ws_route_entry_t)) != 0) break;
+        memset(table, 0, (size_t)nslots * sizeof(ws_route_entry_t));
+        for (size_t i = 0; i < r->nroutes; i++) table[slot_of[i]] = r->routes[i];
+
+        free(r->table);
+        free(r->disp);
+        r->table = table;
+        r->disp = disp;
+        r->seed = seed;
+        r->slot_mask = nslots - 1;
+        r->bucket_mask = nbuckets - 1;
+        free(slot_of);
+        return 0;
+    }
+    free(slot_of);
+    free(disp);
+    return -1;
+}
+
+// First position of needle (n >= 2) in hay, -1 if absent
+// SIMD: 16 candidate positions at once, filtered on the needle's first and last byte
+static long find_needle(const uint8_t *hay, size_t len, const uint8_t *needle, size_t n) {
+    if (n > len) return -1;
+    size_t last = len - n;  // Last possible start
+    size_t i = 0;
+#if defined(WS_ROUTER_SSE2)
+    const __m128i first = _mm_set1_epi8((char)needle[0]);
+    const __m128i final = _mm_set1_epi8((char)needle[n - 1]);
+    for (; i + 16 <= last + 1; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(hay + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(hay + i + n - 1));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, final)));
+        while (mask) {
+            unsigned bit = (unsigned)__builtin_ctz(mask);
+            if (memcmp(hay + i + bit + 1, needle + 1, n - 2) == 0) return (long)(i + bit);
+            mask &= mask - 1;
+        }
+    }
+#elif defined(WS_ROUTER_NEON)
+    const uint8x16_t first = vdupq_n_u8(needle[0]);
+    const uint8x16_t final = vdupq_n_u8(needle[n - 1]);
+    for (; i + 16 <= last + 1; i += 16) {
+        uint8x16_t eq = vandq_u8(vceqq_u8(vld1q_u8(hay + i), first), vceqq_u8(vld1q_u8(hay + i + n - 1), final));
+        // Narrow to 4 bits per byte: a 64-bit mask with one nibble per position
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        while (mask) {
+            unsigned bit = (unsigned)__builtin_ctzll(mask) >> 2;
+            if (memcmp(hay + i + bit + 1, needle + 1, n - 2) == 0) return (long)(i + bit);
+            mask &= ~(0xFULL << (bit * 4));
+        }
+    }
+#endif
+    for (; i <= last; i++) {
+        if (hay[i] == needle[0] && memcmp(hay + i + 1, needle + 1, n - 1) == 0) return (long)i;
+    }
+    return -1;
+}
+
+// Scalar JSON structure walk up to a candidate position (usually a few bytes in)
+typedef struct {
+    size_t at;
+    int depth;
+    int in_string;
+    int escaped;
+} json_walk_t;
+
+static void json_walk_to(json_walk_t *w, const uint8_t *p, size_t pos) {
+    for (; w->at < pos; w->at++) {
+        uint8_t c = p[w->at];
+        if (w->in_string) {
+            if (w->escaped) w->escaped = 0;
+            else if (c == '\\') w->escaped = 1;
+            else if (c == '"') w->in_string = 0;
+        } else if (c == '"') {
+            w->in_string = 1;
+        } else if (c == '{' || c == '[') {
+            w->depth++;
+        } else if (c == '}' || c == ']') {
+            w->depth--;
+        }
+    }
+}
+
+static inline int json_space(uint8_t c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static int json_field_key(const ws_router_t *r, const uint8_t *p, size_t len,
+                          const uint8_t **key, size_t *key_len) {
+    size_t limit = len < r->scan_limit ? len : r->scan_limit;
+    json_walk_t w = {0, 0, 0, 0};
+
+    size_t from = 0;
+    while (from < limit) {
+        long found = find_needle(p + from, limit - from, r->needle, r->needle_len);
+        if (found < 0) return -1;
+        size_t pos = from + (size_t)found;
+        from = pos + 1;
+
+        // A field name of the outermost object, not a nested field or a string value
+        json_walk_to(&w, p, pos);
+        if (w.in_string || w.depth != 1) continue;
+
+        size_t i = pos + r->needle_len;
+        while (i < len && json_space(p[i])) i++;
+        if (i >= len || p[i] != ':') continue;
+        i++;
+        while (i < len && json_space(p[i])) i++;
+        if (i >= len) return -1;
+
+        size_t end;
+        if (p[i] == '"') {
+            i++;
+            const uint8_t *q = (const uint8_t *)memchr(p + i, '"', len - i);
+            if (!q) return -1;
+            end = (size_t)(q - p);
+        } else {
+            end = i;
+            while (end < len && p[end] != ',' && p[end] != '}' && p[end] != ']' && !json_space(p[end])) end++;
+        }
+        if (end == i) return -1;
+        *key = p + i;
+        *key_len = end - i;
+        return 0;
+    }
+    return -1;
+}
+
+int ws_router_extract_key(const ws_router_t *r, const uint8_t *payload, size_t len,
+                          const uint8_t **key, size_t *key_len) {
+    if (!r || !payload || !key || !key_len) return -1;
+    if (r->mode == WS_ROUTE_PREFIX) {
+        if (len < r->offset + r->key_len) return -1;
+        *key = payload + r->offset;
+        *key_len = r->key_len;
+        return 0;
+    }
+    return json_field_key(r, payload, len, key, key_len);
+}
+
+ws_router_t *ws_router_create(const ws_router_options_t *opts) {
+    if (!opts) return NULL;
+    size_t field_len = 0;
+    if (opts->mode == WS_ROUTE_PREFIX) {
+        if (opts->key_len == 0 || opts->key_len > WS_ROUTER_MAX_KEY) return NULL;
+    } else if (opts->mode == WS_ROUTE_JSON_FIELD) {
+        if (!opts->field) return NULL;
+        field_len = strlen(opts->field);
+        if (field_len == 0 || field_len > WS_ROUTER_MAX_KEY) return NULL;
+    } else {
+        return NULL;
+    }
+
+    ws_router_t *r = (ws_router_t *)calloc(1, sizeof(ws_router_t));
+    if (!r) return NULL;
+    r->mode = opts->mode;
+    r->offset = opts->offset;
+    r->key_len = opts->key_len;
+    r->scan_limit = opts->scan_limit ? opts->scan_limit : WS_ROUTER_SCAN_LIMIT;
+    if (field_len) {
+        r->needle[0] = '"';
+        memcpy(r->needle + 1, opts->field, field_len);
+        r->needle[field_len + 1] = '"';
+        r->needle_len = field_len + 2;
+    }
+    return r;
+}
+
+void ws_router_free(ws_router_t *r) {
+    if (!r) return;
+    free(r->table);
+    free(r->disp);
+    free(r->routes);
+    free(r);
+}
+
+static long router_find(const ws_router_t *r, const char *key, size_t key_len) {
+    for (size_t i = 0; i < r->nroutes; i++) {
+        if (r->routes[i].len == key_len && memcmp(r->routes[i].key, key, key_len) == 0) return (long)i;
+    }
+    return -1;
+}
+
+int ws_router_add(ws_router_t *r, const char *key, size_t key_len, ws_route_fn fn, void *arg) {
+    if (!r || !key || !fn || key_len == 0 || key_len > WS_ROUTER_MAX_KEY) return -1;
+    if (r->mode == WS_ROUTE_PREFIX && key_len != r->key_len) return -1;  // Could never match
+    if (r->nroutes >= WS_ROUTER_MAX_ROUTES || router_find(r, key, key_len) >= 0) return -1;
+
+    if (r->nroutes == r->cap) {
+        size_t cap = r->cap ? r->cap * 2 : 16;
+        ws_route_entry_t *grown = (ws_route_entry_t *)realloc(r->routes, cap * sizeof(ws_route_entry_t));
+        if (!grown) return -1;
+        r->routes = grown;
+        r->cap = cap;
+    }
+
+    ws_route_entry_t *e = &r->routes[r->nroutes++];
+    memset(e, 0, sizeof(*e));
+    e->fn = fn;
+    e->arg = arg;
+    e->len = (uint32_t)key_len;
+    memcpy(e->key, key, key_len);
+
+    if (router_build(r) != 0) {
+        r->nroutes--;
+        return -1;
+    }
+    return 0;
+}
+
+int ws_router_remove(ws_router_t *r, const char *key, size_t key_len) {
+    if (!r || !key) return -1;
+    long i = router_find(r, key, key_len);
+    if (i < 0) return -1;
+
+    ws_route_entry_t removed = r->routes[i];
+    r->routes[i] = r->routes[--r->nroutes];
+    if (router_build(r) != 0) {
+        // Keep the route rather than a table that no longer matches the registrations
+        r->routes[r->nroutes++] = r->routes[i];
+        r->routes[i] = removed;
+        return -1;
+    }
+    return 0;
+}
+
+void ws_router_set_default(ws_router_t *r, ws_route_fn fn, void *arg) {
+    if (!r) return;
+    r->default_fn = fn;
+    r->default_arg = arg;
+}
+
+void ws_router_dispatch(ws_router_t *r, websocket_context_t *ws, const uint8_t *payload,
+                        size_t len, uint8_t opcode) {
+    if (__builtin_expect(opcode < WS_FRAME_CLOSE, 1)) {
+        const uint8_t *key;
+        size_t key_len;
+        if (__builtin_expect(ws_router_extract_key(r, payload, len, &key, &key_len) == 0, 1)) {
+            const ws_route_entry_t *e = router_lookup(r, key, key_len);
+            if (__builtin_expect(e != NULL, 1)) {
+                r->stats.routed++;
+                e->fn(ws, payload, len, opcode, e->arg);
+                return;
+            }
+        }
+        r->stats.unmatched++;
+    } else {
+        r->stats.control++;
+    }
+    if (r->default_fn) r->default_fn(ws, payload, len, opcode, r->default_arg);
+}
+
+static void router_on_msg(websocket_context_t *ws, const uint8_t *payload, size_t len, uint8_t opcode) {
+    ws_router_dispatch((ws_router_t *)ws_get_user_data(ws), ws, payload, len, opcode);
+}
+
+int ws_router_attach(ws_router_t *r, websocket_context_t *ws) {
+    if (!r || !ws) return -1;
+    ws_set_user_data(ws, r);
+    ws_set_on_msg(ws, router_on_msg);
+    return 0;
+}
+
+size_t ws_router_routes(const ws_router_t *r) {
+    return r ? r->nroutes : 0;
+}
+
+void ws_router_get_stats(const ws_router_t *r, ws_router_stats_t *out) {
+    if (!out) return;
+    if (!r) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    *out = r->stats;
+}
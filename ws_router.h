@@ -0,0 +1,78 @@
+#ifndef WS_ROUTER_H
+#define WS_ROUTER_H
+
+#include "ws.h"
+#include <stdint.h>
+#include <stddef.h>
+
+// Subscription router: one connection carrying many streams (e.g. a Binance combined
+// stream) dispatched to a handler per channel key, so strategies stop scanning payloads
+// to find out which book a message belongs to
+//
+// The key of a data message is either a byte range at a fixed offset, or the value of a
+// named top-level JSON field looked up in the first scan_limit bytes with a SIMD search.
+// Keys map to handlers through a perfect hash rebuilt on every ws_router_add(): one hash,
+// one displacement load and one key compare per message, no probing. Unknown keys and
+// control frames go to the default handler.
+//
+// Single-threaded like a context: register routes before traffic flows (or between two
+// ws_update() calls), dispatch runs inside on_msg.
+
+typedef struct ws_router ws_router_t;
+
+#define WS_ROUTER_MAX_KEY 44         // Key bytes stored inline (fills the entry's cache line)
+#define WS_ROUTER_MAX_ROUTES 65536
+#define WS_ROUTER_SCAN_LIMIT 256     // Default JSON search window: the first 4 cache lines
+
+typedef void (*ws_route_fn)(websocket_context_t *ws, const uint8_t *payload, size_t len,
+                            uint8_t opcode, void *arg);
+
+typedef enum {
+    WS_ROUTE_PREFIX = 0,             // key_len bytes at offset
+    WS_ROUTE_JSON_FIELD = 1          // Value of a top-level field: string contents, or a bare token
+} ws_route_mode_t;
+
+typedef struct {
+    ws_route_mode_t mode;
+    size_t offset;                   // PREFIX: first key byte
+    size_t key_len;                  // PREFIX: key length (1..WS_ROUTER_MAX_KEY)
+    const char *field;               // JSON_FIELD: field name (copied)
+    size_t scan_limit;               // JSON_FIELD: payload bytes searched, 0 = WS_ROUTER_SCAN_LIMIT
+} ws_router_options_t;
+
+typedef struct {
+    uint64_t routed;                 // Messages delivered to a registered handler
+    uint64_t unmatched;              // No key found, or a key without a route
+    uint64_t control;                // Control frames (always the default handler)
+} ws_router_stats_t;
+
+// Returns NULL on invalid options or allocation failure
+ws_router_t *ws_router_create(const ws_router_options_t *opts);
+void ws_router_free(ws_router_t *r);
+
+// Register key -> fn(arg). Keys are exact (PREFIX: exactly key_len bytes)
+// Returns 0, -1 on a duplicate, an invalid key or when the table cannot be rebuilt
+int ws_router_add(ws_router_t *r, const char *key, size_t key_len, ws_route_fn fn, void *arg);
+
+// Drop a route. Returns 0, -1 if the key was not registered
+int ws_router_remove(ws_router_t *r, const char *key, size_t key_len);
+
+// Handler for unknown keys and control frames (NULL = drop them)
+void ws_router_set_default(ws_router_t *r, ws_route_fn fn, void *arg);
+
+// Install the router as ws's on_msg (takes ws's user data slot, see ws_set_user_data)
+int ws_router_attach(ws_router_t *r, websocket_context_t *ws);
+
+// Route one message: call from an existing on_msg (e.g. a ws_redundant_t group's)
+void ws_router_dispatch(ws_router_t *r, websocket_context_t *ws, const uint8_t *payload,
+                        size_t len, uint8_t opcode);
+
+// Key of a payload as the router sees it (points into payload)
+// Returns 0 with *key/*key_len set, -1 if the payload carries no key
+int ws_router_extract_key(const ws_router_t *r, const uint8_t *payload, size_t len,
+                          const uint8_t **key, size_t *key_len);
+
+size_t ws_router_routes(const ws_router_t *r);
+void ws_router_get_stats(const ws_router_t *r, ws_router_stats_t *out);
+
+#endif // WS_ROUTER_H
@@ -0,0 +1,332 @@
+#include "ws_shm.h"
+#include "ringbuffer.h"
+#include "os.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define WS_SHM_MAGIC 0x314752484d485357ULL  // "WSHMHRG1"
+#define WS_SHM_VERSION 1
+#define WS_SHM_NAME_MAX 255
+
+// First page of the segment; the mirrored ring starts at header_size
+typedef struct {
+    uint64_t magic;              // Stored last: readers ignore a segment still being set up
+    uint32_t version;
+    uint32_t header_size;        // Data offset (publisher's page size)
+    uint64_t capacity;           // Ring bytes (power of two)
+    int32_t pid;                 // Publisher process
+    uint32_t closed;             // Set by ws_shm_destroy()
+
+    // Absolute byte positions, written by the publisher only
+    // claim: end of the record being written, everything below claim - capacity is gone
+    // commit: end of the last complete record
+    uint64_t claim __attribute__((aligned(CACHE_LINE_SIZE)));
+    uint64_t commit;
+} ws_shm_header_t;
+
+typedef struct {
+    uint32_t len;
+    uint8_t opcode;
+    uint8_t _pad[3];
+    uint64_t seq;
+    uint64_t stamps[6];          // hw ns, event, recv start, recv end, parsed, publish
+} ws_shm_record_t;
+
+_Static_assert(sizeof(ws_shm_record_t) == WS_SHM_RECORD_ALIGN, "record header is one cache line");
+
+struct ws_shm_publisher {
+    ws_shm_header_t *header;
+    uint8_t *data;               // Mirrored: 2 * capacity of address space
+    uint64_t mask;
+    uint64_t capacity;
+    uint64_t pos;
+    uint64_t seq;
+    size_t header_size;
+    ws_shm_publisher_stats_t stats;
+    char name[WS_SHM_NAME_MAX + 1];
+};
+
+struct ws_shm_reader {
+    const ws_shm_header_t *header;
+    const uint8_t *data;
+    uint64_t mask;
+    uint64_t capacity;
+    uint64_t pos;                // Next record
+    uint64_t last_pos;           // Record returned by the last ws_shm_read()
+    uint64_t next_seq;           // 0 until the first record
+    size_t header_size;
+    ws_shm_reader_stats_t stats;
+};
+
+static inline size_t record_size(size_t len) {
+    return (sizeof(ws_shm_record_t) + len + WS_SHM_RECORD_ALIGN - 1) & ~(size_t)(WS_SHM_RECORD_ALIGN - 1);
+}
+
+// POSIX shm names are "/name" without further slashes
+static int shm_path(const char *name, char *out) {
+    if (!name || !*name) return -1;
+    int n = snprintf(out, WS_SHM_NAME_MAX + 1, "%s%s", name[0] == '/' ? "" : "/", name);
+    if (n < 0 || n > WS_SHM_NAME_MAX || strchr(out + 1, '/')) return -1;
+    return 0;
+}
+
+static int publisher_running(const ws_shm_header_t *h) {
+    if (__atomic_load_n(&h->closed, __ATOMIC_ACQUIRE)) return 0;
+    return kill(h->pid, 0) == 0 || errno == EPERM;
+}
+
+// 1 if name belongs to a live publisher (another process, or this one twice)
+static int segment_in_use(const char *path) {
+    int fd = shm_open(path, O_RDONLY, 0);
+    if (fd < 0) return 0;
+    int live = 0;
+    void *h = mmap(NULL, sizeof(ws_shm_header_t), PROT_READ, MAP_SHARED, fd, 0);
+    if (h != MAP_FAILED) {
+        const ws_shm_header_t *hdr = (const ws_shm_header_t *)h;
+        live = __atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) == WS_SHM_MAGIC && publisher_running(hdr);
+        munmap(h, sizeof(ws_shm_header_t));
+    }
+    close(fd);
+    return live;
+}
+
+ws_shm_publisher_t *ws_shm_create(const char *name, size_t capacity) {
+    char path[WS_SHM_NAME_MAX + 1];
+    if (shm_path(name, path) < 0) return NULL;
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    if (capacity == 0) capacity = WS_SHM_DEFAULT_CAPACITY;
+    if (capacity < WS_SHM_MIN_CAPACITY) capacity = WS_SHM_MIN_CAPACITY;
+    if (capacity < page) capacity = page;
+    size_t cap = 1;
+    while (cap < capacity) cap <<= 1;
+    size_t header_size = page > sizeof(ws_shm_header_t) ? page : sizeof(ws_shm_header_t);
+
+    if (segment_in_use(path)) {
+        fprintf(stderr, "Warning: shared-memory segment %s has a live publisher\n", path);
+        return NULL;
+    }
+    shm_unlink(path);  // Stale segment of a publisher that is gone: its readers keep their mapping
+    int fd = shm_open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) return NULL;
+    if (ftruncate(fd, (off_t)(header_size + cap)) != 0) {
+        close(fd);
+        shm_unlink(path);
+        return NULL;
+    }
+
+    ws_shm_publisher_t *pub = (ws_shm_publisher_t *)calloc(1, sizeof(ws_shm_publisher_t));
+    void *h = mmap(NULL, header_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    uint8_t *data = ringbuffer_map_mirrored(fd, (off_t)header_size, cap, 1);
+    close(fd);
+    if (!pub || h == MAP_FAILED || !data) {
+        if (h != MAP_FAILED) munmap(h, header_size);
+        if (data) munmap(data, 2 * cap);
+        free(pub);
+        shm_unlink(path);
+        return NULL;
+    }
+
+    pub->header = (ws_shm_header_t *)h;
+    pub->data = data;
+    pub->capacity = cap;
+    pub->mask = cap - 1;
+    pub->header_size = header_size;
+    memcpy(pub->name, path, strlen(path) + 1);
+
+    ws_shm_header_t *hdr = pub->header;
+    hdr->version = WS_SHM_VERSION;
+    hdr->header_size = (uint32_t)header_size;
+    hdr->capacity = cap;
+    hdr->pid = (int32_t)getpid();
+    __atomic_store_n(&hdr->magic, WS_SHM_MAGIC, __ATOMIC_RELEASE);
+    return pub;
+}
+
+void ws_shm_destroy(ws_shm_publisher_t *pub) {
+    if (!pub) return;
+    __atomic_store_n(&pub->header->closed, 1, __ATOMIC_RELEASE);
+    shm_unlink(pub->name);
+    munmap(pub->data, 2 * pub->capacity);
+    munmap(pub->header, pub->header_size);
+    free(pub);
+}
+
+int ws_shm_publish(ws_shm_publisher_t *pub, websocket_context_t *ws, const uint8_t *payload,
+                   size_t len, uint8_t opcode) {
+    if (__builtin_expect(!pub, 0)) return -1;
+    size_t size = record_size(len);
+    if (__builtin_expect(size > pub->capacity, 0)) {
+        pub->stats.oversize++;
+        return -1;
+    }
+
+    // Claim before writing: a reader that sees its record under the claim window knows it
+    // may have been overwritten (seqlock order: claim store, then the record stores)
+    uint64_t pos = pub->pos;
+    ws_shm_header_t *hdr = pub->header;
+    __atomic_store_n(&hdr->claim, pos + size, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    ws_shm_record_t *rec = (ws_shm_record_t *)(pub->data + (pos & pub->mask));
+    rec->len = (uint32_t)len;
+    rec->opcode = opcode;
+    rec->seq = ++pub->seq;
+    rec->stamps[0] = ws ? ws_get_hw_timestamp(ws) : 0;
+    rec->stamps[1] = ws ? ws_get_event_timestamp(ws) : 0;
+    rec->stamps[2] = ws ? ws_get_recv_start_timestamp(ws) : 0;
+    rec->stamps[3] = ws ? ws_get_recv_end_timestamp(ws) : 0;
+    rec->stamps[4] = ws ? ws_get_frame_parsed_timestamp(ws) : 0;
+    rec->stamps[5] = os_get_cpu_cycle();
+    if (len) memcpy(rec + 1, payload, len);  // Mirrored: never split at the ring end
+
+    pub->pos = pos + size;
+    __atomic_store_n(&hdr->commit, pub->pos, __ATOMIC_RELEASE);
+    pub->stats.messages++;
+    pub->stats.bytes += len;
+    return 0;
+}
+
+static void shm_on_msg(websocket_context_t *ws, const uint8_t *payload, size_t len, uint8_t opcode) {
+    ws_shm_publish((ws_shm_publisher_t *)ws_get_user_data(ws), ws, payload, len, opcode);
+}
+
+int ws_shm_attach(ws_shm_publisher_t *pub, websocket_context_t *ws) {
+    if (!pub || !ws) return -1;
+    ws_set_user_data(ws, pub);
+    ws_set_on_msg(ws, shm_on_msg);
+    return 0;
+}
+
+void ws_shm_publisher_get_stats(const ws_shm_publisher_t *pub, ws_shm_publisher_stats_t *out) {
+    if (!out) return;
+    if (!pub) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    *out = pub->stats;
+}
+
+ws_shm_reader_t *ws_shm_open(const char *name) {
+    char path[WS_SHM_NAME_MAX + 1];
+    if (shm_path(name, path) < 0) return NULL;
+    int fd = shm_open(path, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    void *h = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size > sizeof(ws_shm_header_t)) {
+        h = mmap(NULL, sizeof(ws_shm_header_t), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    if (h == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    const ws_shm_header_t *hdr = (const ws_shm_header_t *)h;
+    uint64_t cap = hdr->capacity;
+    size_t header_size = hdr->header_size;
+    int valid = __atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) == WS_SHM_MAGIC &&
+                hdr->version == WS_SHM_VERSION && cap && (cap & (cap - 1)) == 0 &&
+                header_size >= sizeof(ws_shm_header_t) && (uint64_t)st.st_size == header_size + cap;
+    munmap(h, sizeof(ws_shm_header_t));
+    if (!valid) {
+        close(fd);
+        return NULL;
+    }
+
+    ws_shm_reader_t *r = (ws_shm_reader_t *)calloc(1, sizeof(ws_shm_reader_t));
+    h = mmap(NULL, header_size, PROT_READ, MAP_SHARED, fd, 0);
+    uint8_t *data = ringbuffer_map_mirrored(fd, (off_t)header_size, cap, 0);
+    close(fd);
+    if (!r || h == MAP_FAILED || !data) {
+        if (h != MAP_FAILED) munmap(h, header_size);
+        if (data) munmap(data, 2 * cap);
+        free(r);
+        return NULL;
+    }
+
+    r->header = (const ws_shm_header_t *)h;
+    r->data = data;
+    r->capacity = cap;
+    r->mask = cap - 1;
+    r->header_size = header_size;
+    r->pos = __atomic_load_n(&r->header->commit, __ATOMIC_ACQUIRE);
+    r->last_pos = r->pos;
+    return r;
+}
+
+void ws_shm_close(ws_shm_reader_t *r) {
+    if (!r) return;
+    munmap((void *)r->data, 2 * r->capacity);
+    munmap((void *)r->header, r->header_size);
+    free(r);
+}
+
+// Record at pos still intact: the publisher has not claimed a full ring past it
+static inline int record_intact(const ws_shm_reader_t *r, uint64_t pos) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);  // Order the record loads before the claim load
+    return __atomic_load_n(&r->header->claim, __ATOMIC_RELAXED) - pos <= r->capacity;
+}
+
+int ws_shm_read(ws_shm_reader_t *r, ws_shm_frame_t *out) {
+    if (__builtin_expect(!r || !out, 0)) return -1;
+    uint64_t commit = __atomic_load_n(&r->header->commit, __ATOMIC_ACQUIRE);
+    if (r->pos == commit) return 0;
+
+    const ws_shm_record_t *rec = (const ws_shm_record_t *)(r->data + (r->pos & r->mask));
+    ws_shm_record_t hdr = *rec;
+    size_t size = record_size(hdr.len);
+    if (__builtin_expect(!record_intact(r, r->pos) || size > commit - r->pos, 0)) {
+        // Lapped: the header may be torn, so no way to walk on; restart at the newest message
+        r->stats.overruns++;
+        r->pos = __atomic_load_n(&r->header->commit, __ATOMIC_ACQUIRE);
+        r->last_pos = r->pos;
+        return -1;
+    }
+
+    out->payload = (const uint8_t *)(rec + 1);
+    out->len = hdr.len;
+    out->seq = hdr.seq;
+    out->opcode = hdr.opcode;
+    out->hw_timestamp_ns = hdr.stamps[0];
+    out->event_cycle = hdr.stamps[1];
+    out->recv_start_cycle = hdr.stamps[2];
+    out->recv_end_cycle = hdr.stamps[3];
+    out->parsed_cycle = hdr.stamps[4];
+    out->publish_cycle = hdr.stamps[5];
+
+    if (r->next_seq && hdr.seq > r->next_seq) r->stats.lost += hdr.seq - r->next_seq;
+    r->next_seq = hdr.seq + 1;
+    r->stats.messages++;
+    r->last_pos = r->pos;
+    r->pos += size;
+    return 1;
+}
+
+int ws_shm_read_valid(const ws_shm_reader_t *r) {
+    return r ? record_intact(r, r->last_pos) : 0;
+}
+
+size_t ws_shm_backlog(const ws_shm_reader_t *r) {
+    return r ? (size_t)(__atomic_load_n(&r->header->commit, __ATOMIC_ACQUIRE) - r->pos) : 0;
+}
+
+int ws_shm_publisher_alive(const ws_shm_reader_t *r) {
+    return r ? publisher_running(r->header) : 0;
+}
+
+void ws_shm_reader_get_stats(const ws_shm_reader_t *r, ws_shm_reader_stats_t *out) {
+    if (!out) return;
+    if (!r) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    *out = r->stats;
+}
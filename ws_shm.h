@@ -0,0 +1,94 @@
+#ifndef WS_SHM_H
+#define WS_SHM_H
+
+#include "ws.h"
+#include <stdint.h>
+#include <stddef.h>
+
+// Shared-memory fan-out: one context decrypts and parses a feed, every parsed message is
+// published into a named POSIX shared-memory ring, and any number of processes on the host
+// read it with their own cursors. One TLS connection (and one rate-limit budget) then
+// serves N strategies.
+//
+// The ring is mirrored like ringbuffer.c, so a record (64-byte header with the six stage
+// timestamps, then the payload) is always contiguous. The publisher never waits for
+// readers: a reader that falls a full ring behind is overrun, detects it (the publisher's
+// claim position moved past its record) and resumes at the newest message, counting lost
+// messages by sequence gap. Readers are lock-free and never write to the segment.
+//
+// Cycle stamps come from the publisher's os_get_cpu_cycle(): the TSC is shared by every
+// process on the host (invariant TSC), so readers subtract their own stamps directly.
+
+typedef struct ws_shm_publisher ws_shm_publisher_t;
+typedef struct ws_shm_reader ws_shm_reader_t;
+
+#define WS_SHM_DEFAULT_CAPACITY (16u << 20)  // Ring bytes when 0 is passed
+#define WS_SHM_MIN_CAPACITY (64u << 10)
+#define WS_SHM_RECORD_ALIGN 64               // Records start on a cache line
+
+typedef struct {
+    const uint8_t *payload;      // Points into the shared ring: see ws_shm_read_valid()
+    size_t len;
+    uint64_t seq;                // 1-based, gapless from the publisher
+    uint8_t opcode;
+    uint64_t hw_timestamp_ns;    // Stage 1 (0 without NIC timestamps)
+    uint64_t event_cycle;        // Stage 2
+    uint64_t recv_start_cycle;   // Stage 3
+    uint64_t recv_end_cycle;     // Stage 4
+    uint64_t parsed_cycle;       // Stage 5
+    uint64_t publish_cycle;      // Stage 6: the publisher's on_msg
+} ws_shm_frame_t;
+
+typedef struct {
+    uint64_t messages;
+    uint64_t bytes;              // Payload bytes
+    uint64_t oversize;           // Messages larger than the ring, dropped
+} ws_shm_publisher_stats_t;
+
+typedef struct {
+    uint64_t messages;
+    uint64_t lost;               // Messages skipped by overruns
+    uint64_t overruns;
+} ws_shm_reader_stats_t;
+
+// Create (or take over) the segment name ("/btc" or "btc"), capacity: ring bytes rounded up
+// to a power of two, 0 = WS_SHM_DEFAULT_CAPACITY. A stale segment of a crashed publisher is
+// replaced; its readers see ws_shm_publisher_alive() turn 0 and should reopen
+// Returns NULL on failure
+ws_shm_publisher_t *ws_shm_create(const char *name, size_t capacity);
+
+// Marks the segment closed for readers and unlinks the name
+void ws_shm_destroy(ws_shm_publisher_t *pub);
+
+// Install the publisher as ws's on_msg (takes ws's user data slot, see ws_set_user_data)
+int ws_shm_attach(ws_shm_publisher_t *pub, websocket_context_t *ws);
+
+// Publish one message with ws's stage timestamps: call from an existing on_msg
+// Returns 0, -1 if the message does not fit the ring
+int ws_shm_publish(ws_shm_publisher_t *pub, websocket_context_t *ws, const uint8_t *payload,
+                   size_t len, uint8_t opcode);
+
+void ws_shm_publisher_get_stats(const ws_shm_publisher_t *pub, ws_shm_publisher_stats_t *out);
+
+// Attach to a published segment; reading starts at the next message published
+// Returns NULL if the segment does not exist or is not initialized
+ws_shm_reader_t *ws_shm_open(const char *name);
+void ws_shm_close(ws_shm_reader_t *r);
+
+// Next message: 1 = *out filled, 0 = nothing new, -1 = overrun (cursor moved to the newest
+// message, read again). Never blocks
+int ws_shm_read(ws_shm_reader_t *r, ws_shm_frame_t *out);
+
+// 1 if the payload of the last message read is still intact; check after processing it in
+// place, 0 means the publisher lapped the reader meanwhile (copy out first when lagging)
+int ws_shm_read_valid(const ws_shm_reader_t *r);
+
+// Bytes published but not read yet
+size_t ws_shm_backlog(const ws_shm_reader_t *r);
+
+// 0 once the publisher destroyed the segment or its process is gone
+int ws_shm_publisher_alive(const ws_shm_reader_t *r);
+
+void ws_shm_reader_get_stats(const ws_shm_reader_t *r, ws_shm_reader_stats_t *out);
+
+#endif // WS_SHM_H
@@ -0,0 +1,29 @@
+#include "ws_spsc.h"
+#include <stdlib.h>
+#include <string.h>
+
+ws_spsc_t *ws_spsc_create(size_t depth) {
+    if (depth < 2) depth = 2;
+    size_t cap = 1;
+    while (cap < depth) cap <<= 1;
+
+    ws_spsc_t *q = NULL;
+    if (posix_memalign((void **)&q, CACHE_LINE_SIZE, sizeof(ws_spsc_t)) != 0 || !q) {
+        return NULL;
+    }
+    memset(q, 0, sizeof(*q));
+
+    if (posix_memalign((void **)&q->slots, CACHE_LINE_SIZE, cap * sizeof(ws_msg_desc_t)) != 0 || !q->slots) {
+        free(q);
+        return NULL;
+    }
+    memset(q->slots, 0, cap * sizeof(ws_msg_desc_t));  // Prefault
+    q->mask = cap - 1;
+    return q;
+}
+
+void ws_spsc_free(ws_spsc_t *q) {
+    if (!q) return;
+    free(q->slots);
+    free(q);
+}
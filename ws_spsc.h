@@ -0,0 +1,70 @@
+#ifndef WS_SPSC_H
+#define WS_SPSC_H
+
+#include "ws.h"
+#include "ringbuffer.h"
+#include <stdint.h>
+#include <stddef.h>
+
+_Static_assert(sizeof(ws_msg_desc_t) == 64, "descriptor must be one cache line");
+
+// Bounded single-producer/single-consumer queue of message descriptors (pipeline mode)
+//
+// Head and tail live on separate cache lines; each side also keeps a cached copy of the
+// other side's index on its own line, so the shared lines are only touched when the cached
+// view says the queue looks full (producer) or empty (consumer).
+
+typedef struct {
+    // === PRODUCER-OWNED CACHE LINE ===
+    uint64_t head __attribute__((aligned(CACHE_LINE_SIZE)));  // Next slot to publish
+    uint64_t tail_cache;                                        // Last tail seen by the producer
+
+    // === CONSUMER-OWNED CACHE LINE ===
+    uint64_t tail __attribute__((aligned(CACHE_LINE_SIZE)));  // Next slot to consume
+    uint64_t head_cache;                                        // Last head seen by the consumer
+
+    // === READ-ONLY AFTER INIT ===
+    ws_msg_desc_t *slots __attribute__((aligned(CACHE_LINE_SIZE)));
+    uint64_t mask;
+} ws_spsc_t;
+
+// depth is rounded up to a power of two (minimum 2); returns NULL on allocation failure
+ws_spsc_t *ws_spsc_create(size_t depth);
+void ws_spsc_free(ws_spsc_t *q);
+
+// Producer: slot to fill, NULL when full (nothing is published until ws_spsc_publish)
+static inline ws_msg_desc_t *ws_spsc_claim(ws_spsc_t *q) {
+    uint64_t head = q->head;
+    if (__builtin_expect(head - q->tail_cache > q->mask, 0)) {
+        q->tail_cache = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+        if (head - q->tail_cache > q->mask) return NULL;
+    }
+    return &q->slots[head & q->mask];
+}
+
+// Producer: make the claimed slot visible to the consumer
+static inline void ws_spsc_publish(ws_spsc_t *q) {
+    __atomic_store_n(&q->head, q->head + 1, __ATOMIC_RELEASE);
+}
+
+// Consumer: oldest published descriptor, NULL when empty
+static inline const ws_msg_desc_t *ws_spsc_peek(ws_spsc_t *q) {
+    uint64_t tail = q->tail;
+    if (tail == q->head_cache) {
+        q->head_cache = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+        if (tail == q->head_cache) return NULL;
+    }
+    return &q->slots[tail & q->mask];
+}
+
+// Consumer: hand the slot returned by ws_spsc_peek back to the producer
+static inline void ws_spsc_pop(ws_spsc_t *q) {
+    __atomic_store_n(&q->tail, q->tail + 1, __ATOMIC_RELEASE);
+}
+
+// Descriptors published and not yet consumed (approximate from any thread)
+static inline size_t ws_spsc_size(const ws_spsc_t *q) {
+    return (size_t)(__atomic_load_n(&q->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE));
+}
+
+#endif // WS_SPSC_H
@@ -0,0 +1,70 @@
+#include "ws_stats.h"
+#include <string.h>
+
+// Snapshot/delta walk the struct as an array of counters
+_Static_assert(sizeof(ws_stats_t) % sizeof(uint64_t) == 0, "ws_stats_t must be all uint64_t");
+
+uint64_t ws_hist_bucket_upper(size_t idx) {
+    if (idx < WS_HIST_SUB_COUNT) return (uint64_t)idx;
+    if (idx >= WS_HIST_BUCKETS) return UINT64_MAX;
+
+    size_t group = idx / WS_HIST_SUB_COUNT;          // 1 => [2^5, 2^6)
+    uint64_t sub = idx % WS_HIST_SUB_COUNT;
+    unsigned shift = (unsigned)(group - 1);
+    uint64_t low = (WS_HIST_SUB_COUNT + sub) << shift;
+    return low + (1ULL << shift) - 1;
+}
+
+uint64_t ws_hist_percentile(const ws_histogram_t *h, double percentile) {
+    if (!h || h->count == 0) return 0;
+    if (percentile < 0.0) percentile = 0.0;
+    if (percentile > 100.0) percentile = 100.0;
+
+    // Rank of the target sample (1-based), at least the first
+    uint64_t rank = (uint64_t)((double)h->count * percentile / 100.0 + 0.5);
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < WS_HIST_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= rank) return ws_hist_bucket_upper(i);
+    }
+
+    // Snapshot raced with a writer (count ahead of buckets): report the top
+    for (size_t i = WS_HIST_BUCKETS; i-- > 0;) {
+        if (h->buckets[i]) return ws_hist_bucket_upper(i);
+    }
+    return 0;
+}
+
+double ws_hist_mean(const ws_histogram_t *h) {
+    if (!h || h->count == 0) return 0.0;
+    return (double)h->sum / (double)h->count;
+}
+
+static inline uint64_t load_relaxed(const uint64_t *p) {
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+
+void ws_stats_snapshot(const ws_stats_t *live, ws_stats_t *out) {
+    if (!live || !out) return;
+
+    // Field by field: a 64-bit relaxed load never tears, and every counter is monotonic
+    const uint64_t *src = (const uint64_t *)live;
+    uint64_t *dst = (uint64_t *)out;
+    for (size_t i = 0; i < sizeof(ws_stats_t) / sizeof(uint64_t); i++) {
+        dst[i] = load_relaxed(&src[i]);
+    }
+}
+
+void ws_stats_delta(const ws_stats_t *now, const ws_stats_t *before, ws_stats_t *out) {
+    if (!now || !before || !out) return;
+
+    const uint64_t *a = (const uint64_t *)now;
+    const uint64_t *b = (const uint64_t *)before;
+    uint64_t *d = (uint64_t *)out;
+    for (size_t i = 0; i < sizeof(ws_stats_t) / sizeof(uint64_t); i++) {
+        d[i] = a[i] >= b[i] ? a[i] - b[i] : 0;
+    }
+    out->rx_ring_high_water = now->rx_ring_high_water;
+}
@@ -0,0 +1,106 @@
+#ifndef WS_STATS_H
+#define WS_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Always-on per-connection statistics
+//
+// Written only by the thread calling ws_update() (single writer): every update is a
+// relaxed atomic store - a plain mov on x86/ARM64, no lock prefix or fence - so the
+// hot path pays a few L1 stores per batch. Monitoring threads read with
+// ws_stats_snapshot() (relaxed loads, no locks) and diff two snapshots with
+// ws_stats_delta() to get windowed percentiles, e.g. p99.9 over the last minute.
+
+// Log-linear histogram (HDR style): values below 2^WS_HIST_SUB_BITS are exact, every
+// power of two above is split into WS_HIST_SUB_COUNT linear buckets (~3% relative error)
+#define WS_HIST_SUB_BITS 5
+#define WS_HIST_SUB_COUNT (1u << WS_HIST_SUB_BITS)
+#define WS_HIST_MAX_BITS 36   // Values >= 2^36 cycles (~20 s at 3.5 GHz) land in the last bucket
+#define WS_HIST_BUCKETS (WS_HIST_SUB_COUNT * (WS_HIST_MAX_BITS - WS_HIST_SUB_BITS + 1))
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum;                       // For the mean (cycles)
+    uint64_t buckets[WS_HIST_BUCKETS];
+} ws_histogram_t;
+
+// Latency stages recorded once per receive batch (TSC cycles, see ws.h stages 2-6)
+typedef enum {
+    WS_STAT_EVENT_TO_RECV,  // Stage 2 -> 3: ws_update() entry to SSL_read start
+    WS_STAT_SSL_READ,       // Stage 3 -> 4: SSL_read/recv (decrypt) duration
+    WS_STAT_PARSE,          // Stage 4 -> 5: SSL_read end to first frame parsed
+    WS_STAT_DISPATCH,       // Stage 5 -> batch done: parsing + all on_msg callbacks
+    WS_STAT_STAGE_COUNT
+} ws_stat_stage_t;
+
+typedef struct {
+    uint64_t frames_rx;           // Frames parsed (data + control)
+    uint64_t messages_rx;         // Data messages delivered to on_msg
+    uint64_t bytes_rx;            // Bytes read from TLS into the RX ring
+    uint64_t pings_rx;            // PING frames received
+    uint64_t reads;               // Receive batches that returned data
+    uint64_t ssl_pending_loops;   // Extra SSL_read calls because ssl_pending() > 0
+    uint64_t partial_reads;       // Batches that ended on an incomplete frame
+    uint64_t rx_ring_high_water;  // Max bytes buffered in the RX ring (not additive)
+    uint64_t frames_tx;           // Frames queued for sending
+    uint64_t bytes_tx;            // Bytes written to the socket
+    uint64_t pipeline_full;       // Parse passes paused because the pipeline queue was full
+    uint64_t connects;            // Upgrades completed (first connection and every reconnect)
+    uint64_t connect_failures;    // Attempts that failed in DNS, TCP, TLS or the HTTP upgrade
+    uint64_t disconnects;         // Established connections lost (EOF, socket/protocol error, server CLOSE)
+    uint64_t reconnects;          // Reconnect attempts started (ws_reconnect / auto_reconnect)
+    uint64_t tls_resumptions;     // Handshakes that resumed a cached TLS session
+    uint64_t pings_tx;            // Heartbeat PINGs sent
+    uint64_t urgent_tx;           // Frames queued on the urgent lane (PONG, CLOSE, PING, ws_send_urgent)
+    uint64_t urgent_dropped;      // PONGs dropped because the urgent lane was full
+    uint64_t stale_timeouts;      // WS_STATUS_STALE reports (no data for stale_timeout_ms)
+    ws_histogram_t stages[WS_STAT_STAGE_COUNT];
+    ws_histogram_t connect_time;            // Attempt start to upgrade complete (cycles)
+    ws_histogram_t reconnect_to_first_msg;  // Connection lost to first message on the new one (cycles, backoff included)
+    ws_histogram_t ping_rtt;                // Heartbeat PING sent to its PONG received (cycles)
+} ws_stats_t;
+
+// Bucket index for a value
+static inline size_t ws_hist_bucket_index(uint64_t v) {
+    if (v < WS_HIST_SUB_COUNT) return (size_t)v;
+    unsigned msb = 63u - (unsigned)__builtin_clzll(v);
+    if (__builtin_expect(msb >= WS_HIST_MAX_BITS, 0)) return WS_HIST_BUCKETS - 1;
+    unsigned shift = msb - WS_HIST_SUB_BITS;
+    return (size_t)(msb - WS_HIST_SUB_BITS + 1) * WS_HIST_SUB_COUNT +
+           (size_t)((v >> shift) & (WS_HIST_SUB_COUNT - 1));
+}
+
+// Single-writer increment: readers may run concurrently on other threads
+#define WS_STAT_ADD(field, n) \
+    __atomic_store_n(&(field), (field) + (uint64_t)(n), __ATOMIC_RELAXED)
+
+#define WS_STAT_MAX(field, v) do { \
+    uint64_t ws_stat_v_ = (uint64_t)(v); \
+    if (ws_stat_v_ > (field)) __atomic_store_n(&(field), ws_stat_v_, __ATOMIC_RELAXED); \
+} while (0)
+
+static inline void ws_hist_record(ws_histogram_t *h, uint64_t v) {
+    size_t idx = ws_hist_bucket_index(v);
+    WS_STAT_ADD(h->buckets[idx], 1);
+    WS_STAT_ADD(h->sum, v);
+    WS_STAT_ADD(h->count, 1);
+}
+
+// Highest value that maps to bucket idx
+uint64_t ws_hist_bucket_upper(size_t idx);
+
+// Value at percentile (0-100) as the bucket's upper bound; 0 if empty
+// ws_hist_percentile(h, 100.0) is the (bucketed) maximum
+uint64_t ws_hist_percentile(const ws_histogram_t *h, double percentile);
+
+// Mean value, 0 if empty
+double ws_hist_mean(const ws_histogram_t *h);
+
+// Consistent-enough copy of live stats from any thread (each field read atomically)
+void ws_stats_snapshot(const ws_stats_t *live, ws_stats_t *out);
+
+// out = now - before (counters and histograms); rx_ring_high_water is taken from now
+void ws_stats_delta(const ws_stats_t *now, const ws_stats_t *before, ws_stats_t *out);
+
+#endif // WS_STATS_H
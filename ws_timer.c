@@ -0,0 +1,124 @@
+#include "ws_timer.h"
+#include "os.h"
+#include <stdlib.h>
+
+#define WS_TIMER_MASK (WS_TIMER_SLOTS - 1)
+#define WS_TIMER_DEFAULT_TICK_NS 1000000ULL   // 1 ms
+
+_Static_assert((WS_TIMER_SLOTS & WS_TIMER_MASK) == 0, "WS_TIMER_SLOTS must be a power of two");
+
+struct ws_timer_wheel {
+    unsigned tick_shift;            // Tick = 2^tick_shift cycles (shift instead of a divide per advance)
+    uint64_t current;               // Last tick processed
+    uint64_t next_hint;             // Lower bound of the earliest expiry (cycles)
+    size_t count;
+    ws_timer_t *slots[WS_TIMER_SLOTS];
+};
+
+ws_timer_wheel_t *ws_timer_wheel_create(uint64_t tick_ns) {
+    ws_timer_wheel_t *w = (ws_timer_wheel_t *)calloc(1, sizeof(ws_timer_wheel_t));
+    if (!w) return NULL;
+
+    // Largest power of two cycles not above the requested tick
+    uint64_t cycles = os_ns_to_cycles(tick_ns ? tick_ns : WS_TIMER_DEFAULT_TICK_NS);
+    w->tick_shift = 0;
+    while (w->tick_shift < 62 && (1ULL << (w->tick_shift + 1)) <= cycles) w->tick_shift++;
+
+    w->current = os_get_cpu_cycle() >> w->tick_shift;
+    w->next_hint = WS_TIMER_NEVER;
+    return w;
+}
+
+void ws_timer_wheel_free(ws_timer_wheel_t *wheel) {
+    if (!wheel) return;
+    for (size_t i = 0; i < WS_TIMER_SLOTS; i++) {
+        while (wheel->slots[i]) ws_timer_cancel(wheel->slots[i]);
+    }
+    free(wheel);
+}
+
+// Link into the slot of its tick; anything already due goes to the next tick processed
+static void timer_link(ws_timer_wheel_t *w, ws_timer_t *t) {
+    uint64_t tick = t->expires >> w->tick_shift;
+    if (tick <= w->current) tick = w->current + 1;
+
+    ws_timer_t **head = &w->slots[tick & WS_TIMER_MASK];
+    t->next = *head;
+    if (t->next) t->next->pprev = &t->next;
+    t->pprev = head;
+    *head = t;
+    w->count++;
+
+    uint64_t at = tick << w->tick_shift;
+    if (at < w->next_hint) w->next_hint = at;
+}
+
+void ws_timer_schedule(ws_timer_wheel_t *wheel, ws_timer_t *timer, uint64_t expires) {
+    if (!wheel || !timer) return;
+    ws_timer_cancel(timer);
+    timer->wheel = wheel;
+    timer->expires = expires;
+    timer_link(wheel, timer);
+}
+
+void ws_timer_cancel(ws_timer_t *timer) {
+    if (!timer || !timer->pprev) return;
+    *timer->pprev = timer->next;
+    if (timer->next) timer->next->pprev = timer->pprev;
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->wheel->count--;
+}
+
+int ws_timer_wheel_advance(ws_timer_wheel_t *wheel, uint64_t now) {
+    if (!wheel) return 0;
+    uint64_t target = now >> wheel->tick_shift;
+    if (__builtin_expect(target <= wheel->current, 1)) return 0;  // Same tick as the last advance
+    if (wheel->count == 0) {
+        wheel->current = target;
+        wheel->next_hint = WS_TIMER_NEVER;
+        return 0;
+    }
+
+    // One rotation at most: every slot is visited once however long the gap was
+    uint64_t first = target - wheel->current > WS_TIMER_SLOTS ? target - WS_TIMER_SLOTS + 1 : wheel->current + 1;
+    int fired = 0;
+    for (uint64_t tick = first; tick <= target; tick++) {
+        wheel->current = tick;  // Timers scheduled from callbacks land after this tick
+
+        // Detach the slot so callbacks can reschedule into it without being revisited
+        ws_timer_t *pending = wheel->slots[tick & WS_TIMER_MASK];
+        wheel->slots[tick & WS_TIMER_MASK] = NULL;
+        if (pending) pending->pprev = &pending;
+
+        while (pending) {
+            ws_timer_t *t = pending;
+            ws_timer_cancel(t);  // Unlinks from the detached list (callbacks may cancel others in it)
+            if (t->expires <= now) {
+                fired++;
+                t->fn(t, now);
+            } else {
+                timer_link(wheel, t);  // Later rotation
+            }
+        }
+    }
+    wheel->current = target;
+
+    // Earliest non-empty slot ahead
+    wheel->next_hint = WS_TIMER_NEVER;
+    for (uint64_t tick = target + 1; wheel->count && tick <= target + WS_TIMER_SLOTS; tick++) {
+        if (wheel->slots[tick & WS_TIMER_MASK]) {
+            wheel->next_hint = tick << wheel->tick_shift;
+            break;
+        }
+    }
+    return fired;
+}
+
+uint64_t ws_timer_wheel_next(const ws_timer_wheel_t *wheel) {
+    return (wheel && wheel->count) ? wheel->next_hint : WS_TIMER_NEVER;
+}
+
+size_t ws_timer_wheel_count(const ws_timer_wheel_t *wheel) {
+    return wheel ? wheel->count : 0;
+}
@@ -0,0 +1,66 @@
+#ifndef WS_TIMER_H
+#define WS_TIMER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Hashed timing wheel in TSC cycles (os_get_cpu_cycle())
+//
+// Timers are intrusive (embedded in their owner, no allocation per schedule) and land in
+// slot (expires / tick) % WS_TIMER_SLOTS; schedule and cancel are O(1), an advance visits
+// only the slots of the ticks that passed. Timers further out than one rotation wait in
+// their slot and are skipped until due. Single-threaded: one wheel per ws_notifier, every
+// context bound to that notifier keeps its heartbeat timer there.
+
+#define WS_TIMER_SLOTS 256          // Power of two
+#define WS_TIMER_NEVER UINT64_MAX
+
+typedef struct ws_timer ws_timer_t;
+typedef struct ws_timer_wheel ws_timer_wheel_t;
+
+// Fired once per schedule; may reschedule or cancel any timer, itself included
+typedef void (*ws_timer_fn)(ws_timer_t *timer, uint64_t now);
+
+struct ws_timer {
+    ws_timer_t *next;
+    ws_timer_t **pprev;             // NULL while not scheduled
+    ws_timer_wheel_t *wheel;
+    uint64_t expires;               // Cycles
+    ws_timer_fn fn;
+};
+
+// tick_ns: wheel resolution (0 = 1 ms); timers fire up to one tick late
+// Returns NULL on allocation failure
+ws_timer_wheel_t *ws_timer_wheel_create(uint64_t tick_ns);
+
+// Pending timers are unlinked (their owners see them as not scheduled)
+void ws_timer_wheel_free(ws_timer_wheel_t *wheel);
+
+static inline void ws_timer_init(ws_timer_t *timer, ws_timer_fn fn) {
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->wheel = NULL;
+    timer->expires = 0;
+    timer->fn = fn;
+}
+
+static inline int ws_timer_pending(const ws_timer_t *timer) {
+    return timer->pprev != NULL;
+}
+
+// (Re)arm: fires from the first advance with now >= expires (cycles)
+void ws_timer_schedule(ws_timer_wheel_t *wheel, ws_timer_t *timer, uint64_t expires);
+
+// No-op if not scheduled
+void ws_timer_cancel(ws_timer_t *timer);
+
+// Fire every timer due at now; returns the number fired
+int ws_timer_wheel_advance(ws_timer_wheel_t *wheel, uint64_t now);
+
+// Earliest cycle a timer may be due (lower bound, rounded down to its tick),
+// WS_TIMER_NEVER when nothing is scheduled. Bounds blocking waits
+uint64_t ws_timer_wheel_next(const ws_timer_wheel_t *wheel);
+
+size_t ws_timer_wheel_count(const ws_timer_wheel_t *wheel);
+
+#endif // WS_TIMER_H
@@ -0,0 +1,85 @@
+#include "ws_trace.h"
+#include "os.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+static uint64_t round_up_pow2(uint64_t v) {
+    if (v <= 1) return 1;
+    return 1ULL << (64 - __builtin_clzll(v - 1));
+}
+
+ws_trace_t *ws_trace_open(const char *path, size_t records, size_t stream_bytes, const char *url) {
+    if (!path || records == 0) return NULL;
+
+    uint64_t record_cap = round_up_pow2(records);
+    uint64_t stream_cap = stream_bytes ? round_up_pow2(stream_bytes) : 0;
+    if (stream_cap && stream_cap < 4096) stream_cap = 4096;
+    size_t records_len = (size_t)(record_cap * sizeof(ws_trace_record_t));
+    size_t map_len = WS_TRACE_HEADER_SIZE + records_len + (size_t)stream_cap;
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Warning: cannot open trace file %s\n", path);
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)map_len) < 0) {
+        close(fd);
+        return NULL;
+    }
+
+    void *map = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+
+    ws_trace_t *t = (ws_trace_t *)calloc(1, sizeof(ws_trace_t));
+    if (!t) {
+        munmap(map, map_len);
+        close(fd);
+        return NULL;
+    }
+
+    t->hdr = (ws_trace_header_t *)map;
+    t->records = (ws_trace_record_t *)((uint8_t *)map + WS_TRACE_HEADER_SIZE);
+    t->stream = stream_cap ? (uint8_t *)map + WS_TRACE_HEADER_SIZE + records_len : NULL;
+    t->record_mask = record_cap - 1;
+    t->stream_mask = stream_cap ? stream_cap - 1 : 0;
+    t->map_len = map_len;
+    t->fd = fd;
+
+    // Prefault both rings so tracing never takes page faults on the hot path
+    memset(t->records, 0, records_len);
+    if (t->stream) memset(t->stream, 0, (size_t)stream_cap);
+
+    ws_trace_header_t *h = t->hdr;
+    memcpy(h->magic, WS_TRACE_MAGIC, sizeof(h->magic));
+    h->version = WS_TRACE_VERSION;
+    h->record_size = sizeof(ws_trace_record_t);
+    h->record_capacity = record_cap;
+    h->stream_capacity = stream_cap;
+    h->stream_file_offset = stream_cap ? WS_TRACE_HEADER_SIZE + records_len : 0;
+    h->ns_per_cycle = os_cycles_to_ns(1ULL << 30) / (double)(1ULL << 30);
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    h->start_cycle = os_get_cpu_cycle();
+    h->start_realtime_ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    if (url) {
+        snprintf(h->url, sizeof(h->url), "%s", url);
+    }
+
+    return t;
+}
+
+void ws_trace_close(ws_trace_t *t) {
+    if (!t) return;
+    msync(t->hdr, t->map_len, MS_ASYNC);
+    munmap(t->hdr, t->map_len);
+    close(t->fd);
+    free(t);
+}
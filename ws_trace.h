@@ -0,0 +1,107 @@
+#ifndef WS_TRACE_H
+#define WS_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Binary trace ring for post-mortem latency analysis and replay
+//
+// File layout (mmap'ed MAP_SHARED, survives a crash of the writer):
+//   [ws_trace_header_t, 4096 bytes][record ring: capacity x 64 bytes][optional stream ring]
+//
+// One 64-byte record per received frame: batch timestamps, per-frame parse cycle,
+// length, opcode and the first payload bytes. When stream capture is enabled the raw
+// decrypted RX byte stream is copied alongside, so tools/ws_trace_dump can export the
+// exact frame sequence for replay. Decode with: make trace-dump-build && tools/ws_trace_dump FILE
+
+#define WS_TRACE_MAGIC "WSTRACE1"
+#define WS_TRACE_VERSION 1
+#define WS_TRACE_HEADER_SIZE 4096
+
+// Record flags
+#define WS_TRACE_FLAG_FIN  0x01
+#define WS_TRACE_FLAG_RSV1 0x02   // Compressed (permessage-deflate)
+
+typedef struct {
+    uint64_t hw_timestamp_ns;     // Stage 1 (0 if unavailable)
+    uint64_t event_cycle;         // Stage 2 (batch)
+    uint64_t recv_start_cycle;    // Stage 3 (batch)
+    uint64_t recv_end_cycle;      // Stage 4 (batch)
+    uint64_t parsed_cycle;        // This frame's header decoded
+    uint64_t stream_offset;       // Frame start in the captured RX stream (see stream_base)
+    uint32_t payload_len;
+    uint8_t opcode;
+    uint8_t flags;                // WS_TRACE_FLAG_*
+    uint8_t header_len;
+    uint8_t reserved;
+    uint8_t prefix[8];            // First payload bytes (zero padded)
+} ws_trace_record_t;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t record_capacity;     // Power of two
+    uint64_t stream_capacity;     // Power of two, 0 = stream not captured
+    uint64_t stream_file_offset;  // Where the stream ring starts in the file
+    double ns_per_cycle;          // os_cycles_to_ns() calibration when the trace was opened
+    uint64_t start_cycle;         // os_get_cpu_cycle() at open
+    uint64_t start_realtime_ns;   // CLOCK_REALTIME at open (pairs with start_cycle)
+    char url[256];
+
+    // Advanced by the writer with release stores; readers may follow a live file
+    uint64_t record_head __attribute__((aligned(64)));  // Records ever written
+    uint64_t stream_head;                               // Stream bytes ever captured
+} ws_trace_header_t;
+
+typedef struct {
+    ws_trace_header_t *hdr;
+    ws_trace_record_t *records;
+    uint8_t *stream;
+    uint64_t record_mask;
+    uint64_t stream_mask;
+    uint64_t stream_base;         // RX byte count at open: record offsets are relative to it
+    size_t map_len;
+    int fd;
+} ws_trace_t;
+
+_Static_assert(sizeof(ws_trace_record_t) == 64, "trace record must be one cache line");
+_Static_assert(sizeof(ws_trace_header_t) <= WS_TRACE_HEADER_SIZE, "trace header too large");
+
+// Create (truncate) path and map it
+// records / stream_bytes are rounded up to powers of two; stream_bytes = 0 disables capture
+// Returns NULL on failure
+ws_trace_t *ws_trace_open(const char *path, size_t records, size_t stream_bytes, const char *url);
+
+// Unmap and close (data already written stays in the file)
+void ws_trace_close(ws_trace_t *t);
+
+// Slot for the next record (overwrites the oldest once the ring wraps)
+static inline ws_trace_record_t *ws_trace_next(ws_trace_t *t) {
+    return &t->records[t->hdr->record_head & t->record_mask];
+}
+
+// Publish the record returned by ws_trace_next()
+static inline void ws_trace_commit(ws_trace_t *t) {
+    __atomic_store_n(&t->hdr->record_head, t->hdr->record_head + 1, __ATOMIC_RELEASE);
+}
+
+// Append raw RX bytes to the stream ring (no-op when capture is disabled)
+static inline void ws_trace_capture(ws_trace_t *t, const uint8_t *data, size_t len) {
+    if (t->stream_mask == 0) return;
+    uint64_t head = t->hdr->stream_head;
+    uint64_t cap = t->stream_mask + 1;
+    if (len > cap) {  // Keep only the newest cap bytes
+        head += len - cap;
+        data += len - cap;
+        len = cap;
+    }
+    size_t pos = (size_t)(head & t->stream_mask);
+    size_t first = (size_t)(cap - pos) < len ? (size_t)(cap - pos) : len;
+    memcpy(t->stream + pos, data, first);
+    memcpy(t->stream, data + first, len - first);
+    __atomic_store_n(&t->hdr->stream_head, head + len, __ATOMIC_RELEASE);
+}
+
+#endif // WS_TRACE_H
@@ -0,0 +1,71 @@
+#include "ws_transport.h"
+#include "ssl.h"
+#include "tcp.h"
+
+// TLS: OpenSSL, kTLS when the kernel takes the records over (ssl.c)
+static void *tls_open(const char *hostname, int port) { return ssl_init(hostname, port); }
+static void *tls_open_async(const char *hostname, int port) { return ssl_init_async(hostname, port); }
+static void tls_close(void *c) { ssl_free((ssl_context_t *)c); }
+static int tls_handshake(void *c) { return ssl_handshake((ssl_context_t *)c); }
+static int tls_send(void *c, const uint8_t *d, size_t n) { return ssl_send((ssl_context_t *)c, d, n); }
+static int tls_read_into(void *c, uint8_t *b, size_t n) { return ssl_read_into((ssl_context_t *)c, b, n); }
+static int tls_read_failed(void *c, int ret) { return ssl_read_failed((ssl_context_t *)c, ret); }
+static int tls_pending(void *c) { return ssl_pending((ssl_context_t *)c); }
+static int tls_get_fd(void *c) { return ssl_get_fd((ssl_context_t *)c); }
+static int tls_hw_ts_enabled(void *c) { return ssl_hw_timestamping_enabled((ssl_context_t *)c); }
+static uint64_t tls_hw_timestamp(void *c) { return ssl_get_hw_timestamp((ssl_context_t *)c); }
+static int tls_session_reused(void *c) { return ssl_session_reused((ssl_context_t *)c); }
+static const char *tls_cipher_name(void *c) { return ssl_get_cipher_name((ssl_context_t *)c); }
+static const char *tls_mode(void *c) { return ssl_get_tls_mode((ssl_context_t *)c); }
+
+const ws_transport_t ws_transport_tls = {
+    .name = "tls",
+    .open = tls_open,
+    .open_async = tls_open_async,
+    .close = tls_close,
+    .handshake = tls_handshake,
+    .send = tls_send,
+    .read_into = tls_read_into,
+    .read_failed = tls_read_failed,
+    .pending = tls_pending,
+    .get_fd = tls_get_fd,
+    .hw_timestamping_enabled = tls_hw_ts_enabled,
+    .hw_timestamp = tls_hw_timestamp,
+    .session_reused = tls_session_reused,
+    .cipher_name = tls_cipher_name,
+    .mode = tls_mode,
+    .prewarm = ssl_global_init,
+};
+
+// Plain TCP (tcp.c): nothing is ever buffered above the socket
+static void *tcp_open(const char *hostname, int port) { return tcp_init(hostname, port); }
+static void *tcp_open_async(const char *hostname, int port) { return tcp_init_async(hostname, port); }
+static void tcp_close(void *c) { tcp_free((tcp_context_t *)c); }
+static int tcp_handshake_step(void *c) { return tcp_handshake((tcp_context_t *)c); }
+static int tcp_send_bytes(void *c, const uint8_t *d, size_t n) { return tcp_send((tcp_context_t *)c, d, n); }
+static int tcp_read(void *c, uint8_t *b, size_t n) { return tcp_read_into((tcp_context_t *)c, b, n); }
+static int tcp_failed(void *c, int ret) { return tcp_read_failed((tcp_context_t *)c, ret); }
+static int tcp_pending(void *c) { (void)c; return 0; }
+static int tcp_fd(void *c) { return tcp_get_fd((tcp_context_t *)c); }
+static int tcp_hw_ts_enabled(void *c) { return tcp_hw_timestamping_enabled((tcp_context_t *)c); }
+static uint64_t tcp_hw_timestamp(void *c) { return tcp_get_hw_timestamp((tcp_context_t *)c); }
+static const char *tcp_mode(void *c) { (void)c; return "None (Plain TCP)"; }
+
+const ws_transport_t ws_transport_tcp = {
+    .name = "tcp",
+    .open = tcp_open,
+    .open_async = tcp_open_async,
+    .close = tcp_close,
+    .handshake = tcp_handshake_step,
+    .send = tcp_send_bytes,
+    .read_into = tcp_read,
+    .read_failed = tcp_failed,
+    .pending = tcp_pending,
+    .get_fd = tcp_fd,
+    .hw_timestamping_enabled = tcp_hw_ts_enabled,
+    .hw_timestamp = tcp_hw_timestamp,
+    .session_reused = NULL,
+    .cipher_name = NULL,
+    .mode = tcp_mode,
+    .prewarm = NULL,
+};
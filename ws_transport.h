@@ -0,0 +1,60 @@
+#ifndef WS_TRANSPORT_H
+#define WS_TRANSPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Byte transport under a context: ws.c connects, reads and writes only through this table,
+// so the framing, rings and callbacks are the same whatever carries the bytes
+//
+// Backends: ws_transport_tls (OpenSSL, kTLS where available; wss://) and ws_transport_tcp
+// (recv()/recvmsg() straight into the RX ring; ws://, e.g. colocated feeds or a TLS-terminating
+// gateway). A kernel-bypass stack (Onload, ef_vi, ...) plugs in as another table through
+// ws_options_t.transport. Onload's socket acceleration also works under ws_transport_tcp as is.
+//
+// Return conventions follow ssl.h: conn is the backend's own context
+typedef struct ws_transport {
+    const char *name;
+
+    // Create a connection: open() connects before returning (ws_init), open_async() returns
+    // at once and handshake() drives DNS/connect (ws_options_t.async_connect, reconnects)
+    void *(*open)(const char *hostname, int port);
+    void *(*open_async)(const char *hostname, int port);
+    void (*close)(void *conn);
+
+    // 1 = ready for the upgrade request, 0 = in progress, -1 = failed
+    int (*handshake)(void *conn);
+
+    // Bytes written, 0 = would block, -1 = error
+    int (*send)(void *conn, const uint8_t *data, size_t len);
+
+    // RX straight into the ring: bytes read, <= 0 when nothing was read (see read_failed)
+    int (*read_into)(void *conn, uint8_t *buf, size_t len);
+
+    // 1 if a read result <= 0 means the connection is gone, 0 if merely drained
+    int (*read_failed)(void *conn, int ret);
+
+    // Bytes the backend holds above the socket (decrypted TLS records), read before polling
+    int (*pending)(void *conn);
+
+    // Socket for the event loop, -1 while connecting (or for fd-less backends: poll ws_update())
+    int (*get_fd)(void *conn);
+
+    // Optional (NULL = not supported): NIC RX timestamps of the last read_into(), in ns
+    int (*hw_timestamping_enabled)(void *conn);
+    uint64_t (*hw_timestamp)(void *conn);
+
+    // Optional: connection details for ws_get_session_reused/ws_get_cipher_name/ws_get_tls_mode
+    int (*session_reused)(void *conn);
+    const char *(*cipher_name)(void *conn);
+    const char *(*mode)(void *conn);
+
+    // Optional: process-wide setup done ahead of the first connection (ws_library_prewarm)
+    // Returns 0, -1 on failure
+    int (*prewarm)(void);
+} ws_transport_t;
+
+extern const ws_transport_t ws_transport_tls;
+extern const ws_transport_t ws_transport_tcp;
+
+#endif // WS_TRANSPORT_H